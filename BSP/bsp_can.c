@@ -26,6 +26,7 @@
 
 #include "bsp_can.h"
 #include "FreeRTOS.h"
+#include "bsp_trace.h"
 
 uint8_t can1_rx_buffer[CAN1_DEVICE_NUM][CAN_DATA_SIZE];
 uint8_t can2_rx_buffer[CAN2_DEVICE_NUM][CAN_DATA_SIZE];
@@ -107,8 +108,10 @@ static void can_transmit(CAN_HandleTypeDef* hcan, uint16_t id, int16_t msg1, int
 
     if (HAL_CAN_AddTxMessage(hcan, &tx_header, data, &pTxMailbox) != HAL_OK)
         bsp_error_handler(__FUNCTION__, __LINE__, "can transmit fail");
-    else
+    else {
+        TRACE_POINT((hcan == &CAN_BUS_1 ? TRACE_CAN1_TX : TRACE_CAN2_TX) + trace_tx_group(id));
         while (HAL_CAN_IsTxMessagePending(hcan, pTxMailbox));
+    }
 }
 
 static void can_filter_config(CAN_HandleTypeDef* hcan) {
@@ -144,6 +147,8 @@ void HAL_CAN_RxFifo0MsgPendingCallback(CAN_HandleTypeDef *hcan) {
         UBaseType_t it_status = taskENTER_CRITICAL_FROM_ISR();
         uint8_t idx = rx_header.StdId - CAN1_RX_ID_START;
         HAL_CAN_GetRxMessage(hcan, CAN_RX_FIFO0, &rx_header, can1_rx_buffer[idx]);
+        if (idx < CAN1_DEVICE_NUM)
+            TRACE_POINT(TRACE_CAN1_RX + idx);
         /* Exit critical section here */
         taskEXIT_CRITICAL_FROM_ISR(it_status);
     }
@@ -153,6 +158,8 @@ void HAL_CAN_RxFifo0MsgPendingCallback(CAN_HandleTypeDef *hcan) {
         UBaseType_t it_status = taskENTER_CRITICAL_FROM_ISR();
         uint8_t idx = rx_header.StdId - CAN2_RX_ID_START;
         HAL_CAN_GetRxMessage(hcan, CAN_RX_FIFO0, &rx_header, can2_rx_buffer[idx]);
+        if (idx < CAN2_DEVICE_NUM)
+            TRACE_POINT(TRACE_CAN2_RX + idx);
         /* Exit critical section here */
         taskEXIT_CRITICAL_FROM_ISR(it_status);
     }
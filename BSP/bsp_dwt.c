@@ -0,0 +1,64 @@
+/**************************************************************************
+ *  Copyright (C) 2018 
+ *  Illini RoboMaster @ University of Illinois at Urbana-Champaign.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#include "bsp_dwt.h"
+
+static uint32_t dwt_cycles_per_us;
+static uint32_t dwt_last_cycles;
+static uint32_t dwt_residual;
+static uint32_t dwt_us;
+
+void dwt_init(void) {
+    /* a second call would restart dwt_get_us under whoever already stamps with it */
+    if (dwt_cycles_per_us != 0)
+        return;
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    dwt_cycles_per_us = SystemCoreClock / 1000000;
+    dwt_last_cycles   = 0;
+    dwt_residual      = 0;
+    dwt_us            = 0;
+}
+
+uint32_t dwt_cycles_to_us(uint32_t cycles) {
+    if (dwt_cycles_per_us == 0)
+        dwt_init();
+    return cycles / dwt_cycles_per_us;
+}
+
+uint32_t dwt_us_to_cycles(uint32_t us) {
+    if (dwt_cycles_per_us == 0)
+        dwt_init();
+    return us * dwt_cycles_per_us;
+}
+
+uint32_t dwt_get_us(void) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    if (dwt_cycles_per_us == 0)
+        dwt_init();
+    uint32_t now     = DWT->CYCCNT;
+    uint32_t elapsed = now - dwt_last_cycles + dwt_residual;
+    dwt_us          += elapsed / dwt_cycles_per_us;
+    dwt_residual     = elapsed % dwt_cycles_per_us;
+    dwt_last_cycles  = now;
+    uint32_t ret     = dwt_us;
+    __set_PRIMASK(primask);
+    return ret;
+}
@@ -0,0 +1,76 @@
+/**************************************************************************
+ *  Copyright (C) 2018 
+ *  Illini RoboMaster @ University of Illinois at Urbana-Champaign.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#ifndef _BSP_DWT_H_
+#define _BSP_DWT_H_
+
+#include "stm32f4xx_hal.h"
+
+/**
+ * @ingroup bsp
+ * @defgroup bsp_dwt BSP DWT
+ * @{
+ */
+
+/**
+ * Enable the Cortex-M DWT cycle counter
+ *
+ * @note   Only the first call has an effect, and the conversions and dwt_get_us
+ *         make it themselves if nobody did. Call it at boot before reading
+ *         dwt_get_cycles directly. CYCCNT wraps every 2^32 / SystemCoreClock
+ *         seconds (~23.8s at 180MHz).
+ */
+void dwt_init(void);
+
+/**
+ * Read the raw 32-bit cycle counter
+ *
+ * @return            Current CYCCNT value
+ */
+static inline uint32_t dwt_get_cycles(void) {
+    return DWT->CYCCNT;
+}
+
+/**
+ * Convert a cycle count to microseconds
+ *
+ * @param  cycles     Number of core clock cycles
+ * @return            Equivalent time in microseconds
+ */
+uint32_t dwt_cycles_to_us(uint32_t cycles);
+
+/**
+ * Convert microseconds to a cycle count
+ *
+ * @param  us         Time in microseconds
+ * @return            Equivalent number of core clock cycles
+ */
+uint32_t dwt_us_to_cycles(uint32_t us);
+
+/**
+ * Get a monotonic microsecond timestamp extended beyond the CYCCNT wrap
+ *
+ * @return            Microseconds since the counter was enabled
+ * @note   Safe to call from ISR. Must be called at least once per CYCCNT wrap
+ *         period, which any periodic control loop does.
+ */
+uint32_t dwt_get_us(void);
+
+/** @} */
+
+#endif
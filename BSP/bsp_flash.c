@@ -0,0 +1,69 @@
+/**************************************************************************
+ *  Copyright (C) 2018 
+ *  Illini RoboMaster @ University of Illinois at Urbana-Champaign.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#include "bsp_flash.h"
+
+uint8_t flash_erase_sector(uint32_t sector) {
+    FLASH_EraseInitTypeDef erase;
+    uint32_t sector_error;
+    erase.TypeErase    = FLASH_TYPEERASE_SECTORS;
+    erase.VoltageRange = FLASH_VOLTAGE_RANGE_3;
+    erase.Sector       = sector;
+    erase.NbSectors    = 1;
+    HAL_FLASH_Unlock();
+    HAL_StatusTypeDef status = HAL_FLASHEx_Erase(&erase, &sector_error);
+    HAL_FLASH_Lock();
+    if (status != HAL_OK) {
+        bsp_error_handler(__FUNCTION__, __LINE__, "Flash erase failed.");
+        return 0;
+    }
+    return 1;
+}
+
+uint8_t flash_write(uint32_t addr, const void* data, uint32_t len) {
+    if ((addr & 0x3) || (len & 0x3)) {
+        bsp_error_handler(__FUNCTION__, __LINE__, "Unaligned flash write.");
+        return 0;
+    }
+    const uint8_t *src = data;
+    HAL_FLASH_Unlock();
+    for (uint32_t i = 0; i < len; i += 4) {
+        uint32_t word;
+        memcpy(&word, src + i, 4);
+        if (HAL_FLASH_Program(FLASH_TYPEPROGRAM_WORD, addr + i, word) != HAL_OK) {
+            HAL_FLASH_Lock();
+            bsp_error_handler(__FUNCTION__, __LINE__, "Flash program failed.");
+            return 0;
+        }
+    }
+    HAL_FLASH_Lock();
+    /* read back, programming can only clear bits */
+    return memcmp((const void*)addr, data, len) == 0;
+}
+
+void flash_read(uint32_t addr, void* data, uint32_t len) {
+    memcpy(data, (const void*)addr, len);
+}
+
+uint8_t flash_is_erased(uint32_t addr, uint32_t len) {
+    const uint32_t *word = (const uint32_t*)addr;
+    for (uint32_t i = 0; i < len / 4; ++i)
+        if (word[i] != 0xFFFFFFFF)
+            return 0;
+    return 1;
+}
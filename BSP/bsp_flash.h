@@ -0,0 +1,77 @@
+/**************************************************************************
+ *  Copyright (C) 2018 
+ *  Illini RoboMaster @ University of Illinois at Urbana-Champaign.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#ifndef _BSP_FLASH_H_
+#define _BSP_FLASH_H_
+
+#include "stm32f4xx_hal.h"
+#include "bsp_error_handler.h"
+#include <string.h>
+
+/**
+ * @ingroup bsp
+ * @defgroup bsp_flash BSP Flash
+ * @{
+ */
+
+/* Sector reserved for persistent data; must be excluded from the linker script */
+#define BSP_FLASH_DATA_SECTOR   FLASH_SECTOR_11
+#define BSP_FLASH_DATA_ADDR     0x080E0000
+#define BSP_FLASH_DATA_SIZE     0x20000     // 128KB
+
+/**
+ * Erase a flash sector
+ *
+ * @param  sector     Sector number, e.g. FLASH_SECTOR_11
+ * @return            1 for success, 0 for failed
+ * @note   Takes 1-2s on a 128KB sector and stalls code fetch from the same bank.
+ *         Never call it from a control loop.
+ */
+uint8_t flash_erase_sector(uint32_t sector);
+
+/**
+ * Program erased flash word by word
+ *
+ * @param  addr       Word aligned destination address
+ * @param  data       Source data
+ * @param  len        Length in bytes, multiple of 4
+ * @return            1 for success, 0 for failed
+ */
+uint8_t flash_write(uint32_t addr, const void* data, uint32_t len);
+
+/**
+ * Read flash into RAM
+ *
+ * @param  addr       Source address
+ * @param  data       Destination buffer
+ * @param  len        Length in bytes
+ */
+void flash_read(uint32_t addr, void* data, uint32_t len);
+
+/**
+ * Check whether a flash region is erased
+ *
+ * @param  addr       Word aligned start address
+ * @param  len        Length in bytes, multiple of 4
+ * @return            1 if every byte is 0xFF, 0 otherwise
+ */
+uint8_t flash_is_erased(uint32_t addr, uint32_t len);
+
+/** @} */
+
+#endif
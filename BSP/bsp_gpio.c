@@ -26,6 +26,7 @@
 
 #include "bsp_gpio.h"
 #include "FreeRTOS.h"
+#include "bsp_imu.h"
 
 gpio_t *gpio_init(gpio_t *gpio, GPIO_TypeDef *group, uint16_t pin) {
     if (!gpio)
@@ -62,6 +63,7 @@ gpio_state_t gpio_read(gpio_t *gpio) {
  * @date   2018-05-27
  */
 void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin) {
+    onboard_imu_exti_callback(GPIO_Pin);
     gpio_interrupt(GPIO_Pin);
 }
 
@@ -25,6 +25,7 @@
  */
 
 #include "bsp_imu.h"
+#include "bsp_trace.h"
 
 #define ONBOARD_NSS_LOW     HAL_GPIO_WritePin(GPIOF, GPIO_PIN_6, GPIO_PIN_RESET)
 #define ONBOARD_NSS_HIGH    HAL_GPIO_WritePin(GPIOF, GPIO_PIN_6, GPIO_PIN_SET)
@@ -32,43 +33,229 @@
 
 static uint8_t mpu_tx, mpu_rx;
 
+typedef enum {
+    IMU_ASYNC_OFF = 0,
+    IMU_ASYNC_DRDY,
+    IMU_ASYNC_FIFO,
+}   imu_async_mode_t;
+
+typedef enum {
+    IMU_XFER_IDLE = 0,
+    IMU_XFER_BURST,
+    IMU_XFER_FIFO_COUNT,
+    IMU_XFER_FIFO_DATA,
+    IMU_XFER_FIFO_RESET,
+    IMU_XFER_INIT,
+}   imu_xfer_t;
+
+typedef enum {
+    IMU_STEP_WRITE,
+    IMU_STEP_CHECK,
+}   imu_step_op_t;
+
+typedef struct {
+    imu_step_op_t   op;
+    uint8_t         reg;
+    uint8_t         val;        // value to write, or expected value for a check
+    uint8_t         delay_ms;   // settle time after the step
+    const char      *msg;       // error reported when a check fails
+}   imu_init_step_t;
+
+static uint8_t mpu_dma_start(imu_xfer_t xfer, uint16_t len);
+
+/* Async mode: one transfer in flight, results published through sequence indexed double buffers */
+static uint8_t                      imu_dma_tx[ONBOARD_FIFO_SIZE + 1];
+static uint8_t                      imu_dma_rx[ONBOARD_FIFO_SIZE + 1];
+static volatile imu_async_mode_t    imu_async_mode;
+static volatile imu_xfer_t          imu_xfer;
+static uint32_t                     imu_async_stamp;
+static imu_async_stats_t            imu_async_stats;
+static imu_sample_t                 imu_samples[2];
+static volatile uint32_t            imu_sample_seq;
+static imu_batch_t                  imu_batches[2];
+static volatile uint32_t            imu_batch_seq;
+static volatile uint8_t             imu_fifo_resync;
+static uint16_t                     imu_fifo_count;
+static uint32_t                     imu_fifo_total;
+static uint32_t                     imu_fifo_period_us;
+static osThreadId                   imu_fusion_task;
+/* Tick driven bring-up */
+static volatile imu_init_state_t    imu_init_state;
+static uint16_t                     imu_init_idx;
+static volatile uint16_t            imu_init_wait;
+static osThreadId                   imu_init_task;
+
+/* Bring-up sequence shared by the blocking and the tick driven init */
+#define MPU_W(reg, val, ms)     {IMU_STEP_WRITE, reg, val, ms, NULL}
+#define MPU_C(reg, val, ms, msg){IMU_STEP_CHECK, reg, val, ms, msg}
+/* IST8310 access goes through the MPU6500 I2C master: slave 1 writes, slave 4 reads */
+#define IST_W(addr, val, ms)    MPU_W(MPU6500_I2C_SLV1_CTRL, 0x00, 2),        /* Turn off slave 1 at first */ \
+                                MPU_W(MPU6500_I2C_SLV1_REG, addr, 2),         \
+                                MPU_W(MPU6500_I2C_SLV1_DO, val, 2),           \
+                                MPU_W(MPU6500_I2C_SLV1_CTRL, 0x80 | 0x01, ms) /* Turn on slave 1 with one byte transmitting */
+#define IST_C(addr, val, ms, msg) MPU_W(MPU6500_I2C_SLV4_REG, addr, 10),      \
+                                MPU_W(MPU6500_I2C_SLV4_CTRL, 0x80, 10),       \
+                                MPU_C(MPU6500_I2C_SLV4_DI, val, 0, msg),      \
+                                MPU_W(MPU6500_I2C_SLV4_CTRL, 0x00, ms)        /* Turn off slave4 after read */
+
+static const imu_init_step_t imu_init_steps[] = {
+    /* MPU6500 */
+    MPU_W(MPU6500_PWR_MGMT_1, 0x80, 100),           // Reset the internal registers
+    MPU_W(MPU6500_SIGNAL_PATH_RESET, 0x07, 100),    // Reset gyro/accel/temp digital signal path
+    MPU_C(MPU6500_WHO_AM_I, MPU6500_ID, 0, "MPU6500 ID does not match."),
+    MPU_W(MPU6500_PWR_MGMT_1, 0x03, 1),             // Clock Source - Gyro-Z
+    MPU_W(MPU6500_PWR_MGMT_2, 0x00, 1),             // Enable Acc & Gyro
+    MPU_W(MPU6500_CONFIG, 0x04, 1),                 // gyro bandwidth 184Hz 01
+    MPU_W(MPU6500_GYRO_CONFIG, 0x18, 1),            // 0x00 = 250dps / factor 131, 0x08 = 500dps / 65.5, 0x10 = 1000dps / 32.8, 0x18 = 2000dps / 16.4
+    MPU_W(MPU6500_ACCEL_CONFIG, 0x10, 1),           // 0x00 = 2g / 16384, 0x08 = 4g / 8192, 0x10 = 8g / 4096, 0x18 = 16g / 2048
+    MPU_W(MPU6500_ACCEL_CONFIG_2, 0x04, 1),         // acc bandwidth 20Hz
+    MPU_W(MPU6500_USER_CTRL, 0x20, 1),              // Enable the I2C Master I/F module, pins ES_DA and ES_SCL are isolated from pins SDA/SDI and SCL/SCLK.
+    /* IST8310 */
+    MPU_W(MPU6500_USER_CTRL, 0x30, 10),             // Enable the I2C Master I/F module, Reset I2C Slave module
+    MPU_W(MPU6500_I2C_MST_CTRL, 0x0D, 10),          // I2C master clock 400kHz
+    MPU_W(MPU6500_I2C_SLV1_ADDR, IST8310_ADDRESS, 10),          // Write from slave 1
+    MPU_W(MPU6500_I2C_SLV4_ADDR, 0x80 | IST8310_ADDRESS, 10),   // Read from slave 4
+    IST_W(IST8310_R_CONFB, 0x01, 20),               // reset ist8310
+    IST_C(IST8310_WHO_AM_I, IST8310_DEVICE_ID_A, 10, "IST8310 ID does not match."),
+    IST_W(IST8310_R_CONFB, 0x01, 20),               // Reset ist8310
+    IST_W(IST8310_R_CONFA, 0x00, 10),               // Config as ready mode to access reg
+    IST_C(IST8310_R_CONFA, 0x00, 20, "IST ready mode failed."),
+    IST_W(IST8310_R_CONFB, 0x00, 10),               // Normal state, no int
+    IST_C(IST8310_R_CONFB, 0x00, 20, "IST normal state init failed."),
+    IST_W(IST8310_AVGCNTL, 0x24, 10),               // Config low noise mode, x,y,z axis 16 time 1 avg, 100100
+    IST_C(IST8310_AVGCNTL, 0x24, 20, "IST low noise mode failed."),
+    IST_W(IST8310_PDCNTL, 0xC0, 10),                // Set/Reset pulse duration setup, normal mode
+    IST_C(IST8310_PDCNTL, 0xC0, 20, "IST pulse duration set failed."),
+    MPU_W(MPU6500_I2C_SLV1_CTRL, 0x00, 10),         // Turn off slave1 & slave 4
+    MPU_W(MPU6500_I2C_SLV4_CTRL, 0x00, 10),
+    /* Slave 1 automatically triggers single measure mode, slave 0 reads 6 bytes of data into EXT_SENS_DATA */
+    MPU_W(MPU6500_I2C_SLV1_ADDR, IST8310_ADDRESS, 2),
+    MPU_W(MPU6500_I2C_SLV1_REG, IST8310_R_CONFA, 2),
+    MPU_W(MPU6500_I2C_SLV1_DO, IST8310_ODR_MODE, 2),
+    MPU_W(MPU6500_I2C_SLV0_ADDR, 0x80 | IST8310_ADDRESS, 2),
+    MPU_W(MPU6500_I2C_SLV0_REG, IST8310_R_XL, 2),
+    MPU_W(MPU6500_I2C_SLV4_CTRL, 0x03, 2),          // Every 8 mpu6500 internal samples, one i2c master read
+    MPU_W(MPU6500_I2C_MST_DELAY_CTRL, 0x01 | 0x02, 2),  // Enable slave 0 and 1 access delay
+    MPU_W(MPU6500_I2C_SLV1_CTRL, 0x80 | 0x01, 6),   // Enable slave 1 auto transmit, wait 6ms (minimum waiting time for 16 times internal average setup)
+    MPU_W(MPU6500_I2C_SLV0_CTRL, 0x80 | 0x06, 100), // Enable slave 0 with 6 bytes reading
+};
+
+#define IMU_INIT_STEPS  (sizeof(imu_init_steps) / sizeof(imu_init_steps[0]))
+
 uint8_t onboard_imu_init(void) {
-    if (mpu6500_init() == 0) {
-        bsp_error_handler(__FUNCTION__, __LINE__, "MPU6500 init failed.");
-        return 0;
+    for (uint16_t i = 0; i < IMU_INIT_STEPS; ++i) {
+        const imu_init_step_t *step = &imu_init_steps[i];
+        if (step->op == IMU_STEP_WRITE)
+            mpu6500_write_reg(step->reg, step->val);
+        else if (mpu6500_read_reg(step->reg) != step->val) {
+            bsp_error_handler(__FUNCTION__, __LINE__, (char*)step->msg);
+            return 0;
+        }
+        if (step->delay_ms)
+            HAL_Delay(step->delay_ms);
     }
-    if (ist8310_init() == 0) {
-        bsp_error_handler(__FUNCTION__, __LINE__, "IST8310 init failed.");
+    return 1;
+}
+
+uint8_t onboard_imu_init_async(osThreadId notify_task) {
+    if (imu_init_state == IMU_INIT_RUNNING || imu_async_mode != IMU_ASYNC_OFF) {
+        bsp_error_handler(__FUNCTION__, __LINE__, "Onboard imu busy.");
         return 0;
     }
+    imu_init_task  = notify_task;
+    imu_init_idx   = 0;
+    imu_init_wait  = 0;
+    imu_init_state = IMU_INIT_RUNNING;
     return 1;
 }
 
+void onboard_imu_init_tick(void) {
+    if (imu_init_state != IMU_INIT_RUNNING || imu_xfer != IMU_XFER_IDLE)
+        return;
+    if (imu_init_wait) {
+        imu_init_wait--;
+        return;
+    }
+    mpu_init_next();
+}
+
+imu_init_state_t onboard_imu_init_state(void) {
+    return imu_init_state;
+}
+
+const char* onboard_imu_init_error(void) {
+    return imu_init_state == IMU_INIT_FAILED ? imu_init_steps[imu_init_idx].msg : NULL;
+}
+
 void mpu6500_get_data(imu_t* imu) {
     if (imu == NULL) {
         bsp_error_handler(__FUNCTION__, __LINE__, "Invalid imu object.");
         return;
     }
+    if (imu_async_mode != IMU_ASYNC_OFF) {
+        imu_sample_t sample;
+        onboard_imu_read_sample(&sample);
+        imu->acce = sample.imu.acce;
+        imu->temp = sample.imu.temp;
+        imu->gyro = sample.imu.gyro;
+        imu->stamp_us = sample.imu.stamp_us;
+        return;
+    }
+    static uint8_t  mpu_last_buff[ONBOARD_IMU_BUFFER];
+    static uint32_t mpu_last_stamp;
     uint8_t mpu_rx_buff[ONBOARD_IMU_BUFFER];
     /* Must read 14 regs all together */
     mpu6500_read_regs(MPU6500_ACCEL_XOUT_H, mpu_rx_buff, ONBOARD_IMU_BUFFER);
+    /* Sensor noise makes two real samples differ, identical registers are a re-read of the last one */
+    if (memcmp(mpu_rx_buff, mpu_last_buff, ONBOARD_IMU_BUFFER) != 0) {
+        memcpy(mpu_last_buff, mpu_rx_buff, ONBOARD_IMU_BUFFER);
+        mpu_last_stamp = dwt_get_us();
+    }
+    imu->stamp_us = mpu_last_stamp;
+    TRACE_POINT(TRACE_IMU_READ);
+    mpu6500_decode(mpu_rx_buff, imu);
+}
 
-    int16_t imu_acce_x_raw = (int16_t)(mpu_rx_buff[0] << 8 | mpu_rx_buff[1]);
-    int16_t imu_acce_y_raw = (int16_t)(mpu_rx_buff[2] << 8 | mpu_rx_buff[3]);
-    int16_t imu_acce_z_raw = (int16_t)(mpu_rx_buff[4] << 8 | mpu_rx_buff[5]);
-    imu->acce.x = (float)(imu_acce_x_raw / ONBOARD_ACCE_FACTOR);
-    imu->acce.y = (float)(imu_acce_y_raw / ONBOARD_ACCE_FACTOR);
-    imu->acce.z = (float)(imu_acce_z_raw / ONBOARD_ACCE_FACTOR);
+void mpu6500_get_data_fixed(imu_fixed_t* imu) {
+    if (imu == NULL || imu_async_mode != IMU_ASYNC_OFF) {
+        bsp_error_handler(__FUNCTION__, __LINE__, "Invalid imu object or imu in async mode.");
+        return;
+    }
+    uint8_t mpu_rx_buff[ONBOARD_IMU_BUFFER];
+    mpu6500_read_regs(MPU6500_ACCEL_XOUT_H, mpu_rx_buff, ONBOARD_IMU_BUFFER);
+    TRACE_POINT(TRACE_IMU_READ);
+    mpu6500_convert_fixed(mpu_rx_buff, 1, imu);
+}
 
-    int16_t imu_temp_raw   = (int16_t)(mpu_rx_buff[6] << 8 | mpu_rx_buff[7]);
-    imu->temp   = (float)(((imu_temp_raw - ONBOARD_TEMP_OFFSET) / ONBOARD_TEMP_FACTOR) + ONBOARD_TEMP_ROOM);  // Eq in register map p33
+/* Records are big endian halfwords. One unaligned word load and one REV16
+ * swaps two of them; the 7th halfword of a record goes through REVSH. */
+void mpu6500_convert_fixed(const uint8_t* buff, uint16_t count, imu_fixed_t* out) {
+    for (uint16_t i = 0; i < count; ++i, buff += ONBOARD_IMU_BUFFER, ++out) {
+        uint32_t word[3];
+        uint16_t half;
+        memcpy(word, buff, sizeof(word));
+        memcpy(&half, buff + sizeof(word), sizeof(half));
+        word[0] = __REV16(word[0]);
+        word[1] = __REV16(word[1]);
+        word[2] = __REV16(word[2]);
+        half    = (uint16_t)__REVSH((int16_t)half);
+        memcpy(out, word, sizeof(word));
+        memcpy((uint8_t*)out + sizeof(word), &half, sizeof(half));
+    }
+}
 
-    int16_t imu_gyro_x_raw = (int16_t)(mpu_rx_buff[8] << 8 | mpu_rx_buff[9]);
-    int16_t imu_gyro_y_raw = (int16_t)(mpu_rx_buff[10] << 8 | mpu_rx_buff[11]);
-    int16_t imu_gyro_z_raw = (int16_t)(mpu_rx_buff[12] << 8 | mpu_rx_buff[13]);
-    imu->gyro.x = (float)(imu_gyro_x_raw / ONBOARD_GYRO_FACTOR);
-    imu->gyro.y = (float)(imu_gyro_y_raw / ONBOARD_GYRO_FACTOR);
-    imu->gyro.z = (float)(imu_gyro_z_raw / ONBOARD_GYRO_FACTOR);
+void mpu6500_convert(const uint8_t* buff, uint16_t count, imu_t* out) {
+    for (uint16_t i = 0; i < count; ++i, buff += ONBOARD_IMU_BUFFER, ++out) {
+        imu_fixed_t raw;
+        mpu6500_convert_fixed(buff, 1, &raw);
+        out->acce.x = raw.acce[0] * ONBOARD_ACCE_SCALE;
+        out->acce.y = raw.acce[1] * ONBOARD_ACCE_SCALE;
+        out->acce.z = raw.acce[2] * ONBOARD_ACCE_SCALE;
+        out->temp   = (raw.temp - ONBOARD_TEMP_OFFSET) * ONBOARD_TEMP_SCALE + ONBOARD_TEMP_ROOM;  // Eq in register map p33
+        out->gyro.x = raw.gyro[0] * ONBOARD_GYRO_SCALE;
+        out->gyro.y = raw.gyro[1] * ONBOARD_GYRO_SCALE;
+        out->gyro.z = raw.gyro[2] * ONBOARD_GYRO_SCALE;
+    }
 }
 
 void ist8310_get_data(imu_t* imu) {
@@ -76,42 +263,295 @@ void ist8310_get_data(imu_t* imu) {
         bsp_error_handler(__FUNCTION__, __LINE__, "Invalid imu object.");
         return;
     }
+    if (imu_async_mode != IMU_ASYNC_OFF) {
+        imu_sample_t sample;
+        onboard_imu_read_sample(&sample);
+        imu->mag = sample.imu.mag;
+        return;
+    }
     uint8_t ist_buff[6];
     mpu6500_read_regs(MPU6500_EXT_SENS_DATA_00, ist_buff, 6);
-    imu->mag.x = (int16_t)(ist_buff[1]<<8 | ist_buff[0]);
-    imu->mag.y = (int16_t)(ist_buff[3]<<8 | ist_buff[2]);
-    imu->mag.z = (int16_t)(ist_buff[5]<<8 | ist_buff[4]);
+    ist8310_decode(ist_buff, imu);
 }
 
-/* Static function for MPU6500 */
-static uint8_t mpu6500_init(void) {
-    // Reset the internal registers
-    mpu6500_write_reg(MPU6500_PWR_MGMT_1, 0x80);
-    HAL_Delay(100);
-    // Reset gyro/accel/temp digital signal path
-    mpu6500_write_reg(MPU6500_SIGNAL_PATH_RESET, 0x07);
-    HAL_Delay(100);
-    if (MPU6500_ID != mpu6500_read_reg(MPU6500_WHO_AM_I)) {
-        bsp_error_handler(__FUNCTION__, __LINE__, "MPU6500 ID does not match.");
+uint8_t onboard_imu_start_async(osThreadId fusion_task) {
+    onboard_imu_stop_async();
+    imu_fusion_task = fusion_task;
+    memset(imu_dma_tx, 0xFF, sizeof(imu_dma_tx));
+    // 1kHz output: internal 1kHz with DLPF on, no divider
+    mpu6500_write_reg(MPU6500_SMPLRT_DIV, 0x00);
+    // Active high push-pull pulse, cleared by any register read
+    mpu6500_write_reg(MPU6500_INT_PIN_CFG, 0x10);
+    // Raw data ready interrupt only
+    mpu6500_write_reg(MPU6500_INT_ENABLE, 0x01);
+    if (mpu6500_read_reg(MPU6500_INT_ENABLE) != 0x01) {
+        bsp_error_handler(__FUNCTION__, __LINE__, "MPU6500 data ready interrupt failed.");
+        return 0;
+    }
+    imu_async_mode = IMU_ASYNC_DRDY;
+    return 1;
+}
+
+uint8_t onboard_imu_start_fifo(osThreadId fusion_task, uint16_t rate_hz) {
+    if (rate_hz == 0 || rate_hz > ONBOARD_FIFO_MAX_RATE) {
+        bsp_error_handler(__FUNCTION__, __LINE__, "Invalid FIFO rate.");
+        return 0;
+    }
+    /* Above 1kHz bypass the gyro DLPF for the 8kHz internal rate; accel stays at 1kHz and repeats */
+    uint16_t internal_hz = rate_hz > 1000 ? 8000 : 1000;
+    if (internal_hz % rate_hz != 0 || internal_hz / rate_hz > 256) {
+        bsp_error_handler(__FUNCTION__, __LINE__, "FIFO rate does not divide the internal sample rate.");
+        return 0;
+    }
+    uint8_t  div         = internal_hz / rate_hz - 1;
+    onboard_imu_stop_async();
+    imu_fusion_task = fusion_task;
+    memset(imu_dma_tx, 0xFF, sizeof(imu_dma_tx));
+    mpu6500_write_reg(MPU6500_CONFIG, rate_hz > 1000 ? 0x07 : 0x04);
+    mpu6500_write_reg(MPU6500_SMPLRT_DIV, div);
+    imu_fifo_period_us = 1000000 / rate_hz;
+    mpu6500_write_reg(MPU6500_INT_ENABLE, 0x00);
+    // Accel, temp and gyro, ONBOARD_FIFO_SAMPLE bytes per sample
+    mpu6500_write_reg(MPU6500_FIFO_EN, 0xF8);
+    mpu6500_write_reg(MPU6500_USER_CTRL, ONBOARD_FIFO_USER_CTRL | 0x04);
+    if (mpu6500_read_reg(MPU6500_FIFO_EN) != 0xF8) {
+        bsp_error_handler(__FUNCTION__, __LINE__, "MPU6500 FIFO enable failed.");
         return 0;
     }
-    uint8_t MPU6500_Init_Data[7][2] = {
-        {MPU6500_PWR_MGMT_1,     0x03},      // Clock Source - Gyro-Z
-        {MPU6500_PWR_MGMT_2,     0x00},      // Enable Acc & Gyro
-        {MPU6500_CONFIG,         0x04},      // gyro bandwidth 184Hz 01
-        {MPU6500_GYRO_CONFIG,    0x18},      // 0x00 = 250dps / factor 131, 0x08 = 500dps / 65.5, 0x10 = 1000dps / 32.8, 0x18 = 2000dps / 16.4
-        {MPU6500_ACCEL_CONFIG,   0x10},      // 0x00 = 2g / 16384, 0x08 = 4g / 8192, 0x10 = 8g / 4096, 0x18 = 16g / 2048
-        {MPU6500_ACCEL_CONFIG_2, 0x04},      // acc bandwidth 20Hz
-        {MPU6500_USER_CTRL,      0x20},      // Enable the I2C Master I/F module, pins ES_DA and ES_SCL are isolated from pins SDA/SDI and SCL/SCLK.
-    };
-    uint8_t index = 0;
-    for(index = 0; index < 7; index++) {
-        mpu6500_write_reg(MPU6500_Init_Data[index][0], MPU6500_Init_Data[index][1]);
-        HAL_Delay(1);
+    imu_fifo_resync = 0;
+    imu_async_mode  = IMU_ASYNC_FIFO;
+    return 1;
+}
+
+void onboard_imu_stop_async(void) {
+    imu_async_mode_t mode = imu_async_mode;
+    imu_async_mode = IMU_ASYNC_OFF;
+    /* let an in-flight transfer finish before using the bus again */
+    while (imu_xfer != IMU_XFER_IDLE);
+    if (mode == IMU_ASYNC_DRDY)
+        mpu6500_write_reg(MPU6500_INT_ENABLE, 0x00);
+    else if (mode == IMU_ASYNC_FIFO) {
+        mpu6500_write_reg(MPU6500_FIFO_EN, 0x00);
+        mpu6500_write_reg(MPU6500_USER_CTRL, 0x20);
+        mpu6500_write_reg(MPU6500_CONFIG, 0x04);
+        mpu6500_write_reg(MPU6500_SMPLRT_DIV, 0x00);
+    }
+}
+
+uint32_t onboard_imu_read_sample(imu_sample_t* sample) {
+    uint32_t seq;
+    do {
+        seq = imu_sample_seq;
+        *sample = imu_samples[seq & 1];
+        __DMB();
+    } while (seq != imu_sample_seq);
+    return seq;
+}
+
+uint32_t onboard_imu_read_batch(imu_batch_t* batch) {
+    uint32_t seq;
+    do {
+        seq = imu_batch_seq;
+        imu_batch_t *src = &imu_batches[seq & 1];
+        batch->seq   = src->seq;
+        batch->count = src->count;
+        memcpy(batch->sample, src->sample, batch->count * sizeof(imu_sample_t));
+        __DMB();
+    } while (seq != imu_batch_seq);
+    return seq;
+}
+
+void onboard_imu_get_async_stats(imu_async_stats_t* stats) {
+    *stats = imu_async_stats;
+}
+
+void onboard_imu_exti_callback(uint16_t gpio_pin) {
+    if (gpio_pin != ONBOARD_IMU_INT_PIN || imu_async_mode != IMU_ASYNC_DRDY)
+        return;
+    if (imu_xfer != IMU_XFER_IDLE) {
+        imu_async_stats.busy_drop++;
+        return;
+    }
+    imu_async_stamp = dwt_get_us();
+    imu_dma_tx[0]   = MPU6500_ACCEL_XOUT_H | 0x80;
+    mpu_dma_start(IMU_XFER_BURST, ONBOARD_IMU_BURST + 1);
+}
+
+void onboard_imu_fifo_poll(void) {
+    if (imu_async_mode != IMU_ASYNC_FIFO)
+        return;
+    if (imu_xfer != IMU_XFER_IDLE) {
+        imu_async_stats.busy_drop++;
+        return;
+    }
+    if (imu_fifo_resync) {
+        mpu_fifo_reset();
+        return;
+    }
+    imu_dma_tx[0] = MPU6500_FIFO_COUNTH | 0x80;
+    mpu_dma_start(IMU_XFER_FIFO_COUNT, 3);
+}
+
+void HAL_SPI_TxRxCpltCallback(SPI_HandleTypeDef *hspi) {
+    if (hspi != &ONBOARD_IMU_SPI || imu_xfer == IMU_XFER_IDLE)
+        return;
+    ONBOARD_NSS_HIGH;
+    imu_xfer_t xfer = imu_xfer;
+    imu_xfer = IMU_XFER_IDLE;
+    imu_async_stats.completed++;
+    switch (xfer) {
+        case IMU_XFER_BURST:
+            mpu_burst_complete();
+            break;
+        case IMU_XFER_FIFO_COUNT:
+            mpu_fifo_count_complete();
+            break;
+        case IMU_XFER_FIFO_DATA:
+            mpu_fifo_data_complete();
+            break;
+        case IMU_XFER_FIFO_RESET:
+            imu_fifo_resync = 0;
+            imu_async_stats.fifo_resync++;
+            break;
+        case IMU_XFER_INIT:
+            mpu_init_complete();
+            break;
+        default:
+            break;
     }
+}
+
+void HAL_SPI_ErrorCallback(SPI_HandleTypeDef *hspi) {
+    if (hspi != &ONBOARD_IMU_SPI || imu_xfer == IMU_XFER_IDLE)
+        return;
+    ONBOARD_NSS_HIGH;
+    /* a partial FIFO read leaves the byte stream misaligned */
+    if (imu_xfer != IMU_XFER_BURST)
+        imu_fifo_resync = 1;
+    imu_xfer = IMU_XFER_IDLE;
+    imu_async_stats.spi_error++;
+}
+
+/* Static function for async transfers */
+static uint8_t mpu_dma_start(imu_xfer_t xfer, uint16_t len) {
+    imu_xfer = xfer;
+    ONBOARD_NSS_LOW;
+    if (HAL_SPI_TransmitReceive_DMA(&ONBOARD_IMU_SPI, imu_dma_tx, imu_dma_rx, len) != HAL_OK) {
+        ONBOARD_NSS_HIGH;
+        imu_xfer = IMU_XFER_IDLE;
+        imu_async_stats.spi_error++;
+        return 0;
+    }
+    imu_async_stats.started++;
     return 1;
 }
 
+static void mpu_publish_sample(const imu_t* imu, uint32_t stamp_us) {
+    /* write the slot readers are not looking at, then publish it */
+    uint32_t next = imu_sample_seq + 1;
+    imu_sample_t *sample = &imu_samples[next & 1];
+    sample->imu          = *imu;
+    sample->imu.stamp_us = stamp_us;
+    sample->seq          = next;
+    __DMB();
+    imu_sample_seq   = next;
+}
+
+static void mpu_burst_complete(void) {
+    imu_t imu;
+    TRACE_POINT(TRACE_IMU_READ);
+    mpu6500_decode(&imu_dma_rx[1], &imu);
+    ist8310_decode(&imu_dma_rx[1 + ONBOARD_IMU_BUFFER], &imu);
+    mpu_publish_sample(&imu, imu_async_stamp);
+    if (imu_fusion_task)
+        osSignalSet(imu_fusion_task, ONBOARD_IMU_SIGNAL);
+}
+
+static void mpu_fifo_count_complete(void) {
+    uint16_t count = (imu_dma_rx[1] << 8 | imu_dma_rx[2]) & 0x1FFF;
+    /* a full FIFO has dropped samples and may have been cut mid-sample */
+    if (count >= ONBOARD_FIFO_SIZE) {
+        imu_async_stats.fifo_overflow++;
+        mpu_fifo_reset();
+        return;
+    }
+    /* only whole samples are read so the stream stays aligned */
+    imu_fifo_count = count / ONBOARD_FIFO_SAMPLE;
+    if (imu_fifo_count == 0)
+        return;
+    imu_async_stamp = dwt_get_us();
+    imu_dma_tx[0]   = MPU6500_FIFO_R_W | 0x80;
+    if (!mpu_dma_start(IMU_XFER_FIFO_DATA, imu_fifo_count * ONBOARD_FIFO_SAMPLE + 1))
+        imu_fifo_resync = 1;
+}
+
+static void mpu_fifo_data_complete(void) {
+    TRACE_POINT(TRACE_IMU_READ);
+    uint32_t next = imu_batch_seq + 1;
+    imu_batch_t *batch = &imu_batches[next & 1];
+    const uint8_t *buff = &imu_dma_rx[1];
+    /* the newest sample was taken just before the count was read */
+    uint32_t stamp = imu_async_stamp - (imu_fifo_count - 1) * imu_fifo_period_us;
+    for (uint16_t i = 0; i < imu_fifo_count; ++i, buff += ONBOARD_FIFO_SAMPLE) {
+        imu_sample_t *sample = &batch->sample[i];
+        mpu6500_decode(buff, &sample->imu);
+        /* magnetometer is not queued in the FIFO */
+        sample->imu.mag.x = sample->imu.mag.y = sample->imu.mag.z = 0;
+        sample->imu.stamp_us = stamp + i * imu_fifo_period_us;
+        sample->seq          = imu_fifo_total + i + 1;
+    }
+    imu_fifo_total += imu_fifo_count;
+    batch->count = imu_fifo_count;
+    batch->seq   = next;
+    __DMB();
+    imu_batch_seq = next;
+    imu_sample_t *last = &batch->sample[imu_fifo_count - 1];
+    mpu_publish_sample(&last->imu, last->imu.stamp_us);
+    if (imu_fusion_task)
+        osSignalSet(imu_fusion_task, ONBOARD_IMU_SIGNAL);
+}
+
+static void mpu_init_next(void) {
+    if (imu_init_idx >= IMU_INIT_STEPS) {
+        imu_init_state = IMU_INIT_READY;
+        if (imu_init_task)
+            osSignalSet(imu_init_task, ONBOARD_IMU_READY_SIGNAL);
+        return;
+    }
+    const imu_init_step_t *step = &imu_init_steps[imu_init_idx];
+    imu_dma_tx[0] = step->op == IMU_STEP_WRITE ? step->reg & 0x7f : step->reg | 0x80;
+    imu_dma_tx[1] = step->val;
+    /* a failed start is retried on the next tick */
+    mpu_dma_start(IMU_XFER_INIT, 2);
+}
+
+static void mpu_init_complete(void) {
+    const imu_init_step_t *step = &imu_init_steps[imu_init_idx];
+    if (step->op == IMU_STEP_CHECK && imu_dma_rx[1] != step->val) {
+        imu_init_state = IMU_INIT_FAILED;
+        if (imu_init_task)
+            osSignalSet(imu_init_task, ONBOARD_IMU_READY_SIGNAL);
+        return;
+    }
+    imu_init_idx++;
+    imu_init_wait = step->delay_ms;
+    /* chain steps without settle time straight from the completion */
+    if (imu_init_wait == 0)
+        mpu_init_next();
+}
+
+static void mpu_fifo_reset(void) {
+    imu_fifo_resync = 1;
+    imu_dma_tx[0]   = MPU6500_USER_CTRL & 0x7f;
+    imu_dma_tx[1]   = ONBOARD_FIFO_USER_CTRL | 0x04;   // FIFO_RST clears itself
+    mpu_dma_start(IMU_XFER_FIFO_RESET, 2);
+}
+
+/* Static function for MPU6500 */
+static void mpu6500_decode(const uint8_t* buff, imu_t* imu) {
+    mpu6500_convert(buff, 1, imu);
+}
+
 static uint8_t mpu6500_write_reg(uint8_t const reg, uint8_t const data) {
     ONBOARD_NSS_LOW;
     mpu_tx = reg & 0x7f;
@@ -143,115 +583,8 @@ static uint8_t mpu6500_read_regs(uint8_t const reg_addr, uint8_t* data, uint8_t
 }
 
 /* Static function for IST8310 */
-static uint8_t ist8310_init(void) {
-    // Enable the I2C Master I/F module, Reset I2C Slave module
-    mpu6500_write_reg(MPU6500_USER_CTRL, 0x30);
-    HAL_Delay(10);
-    // I2C master clock 400kHz
-    mpu6500_write_reg(MPU6500_I2C_MST_CTRL, 0x0D);
-    HAL_Delay(10);
-    // Turn on slave 1 for ist write and slave 4 for ist read
-    mpu6500_write_reg(MPU6500_I2C_SLV1_ADDR, IST8310_ADDRESS); // Write from slave 1
-    HAL_Delay(10);
-    mpu6500_write_reg(MPU6500_I2C_SLV4_ADDR, 0x80 | IST8310_ADDRESS); // Read from slave 4
-    HAL_Delay(10);
-    // reset ist8310
-    ist8310_write_reg(IST8310_R_CONFB, 0x01);
-    HAL_Delay(10);
-    // Check IST id
-    if(IST8310_DEVICE_ID_A != ist8310_read_reg(IST8310_WHO_AM_I)) {
-        bsp_error_handler(__FUNCTION__, __LINE__, "IST8310 ID does not match.");
-        return 0;
-    }
-    // Reset ist8310
-    ist8310_write_reg(IST8310_R_CONFB, 0x01);
-    HAL_Delay(10);
-    // Config as ready mode to access reg
-    ist8310_write_reg(IST8310_R_CONFA, 0x00);
-    if(ist8310_read_reg(IST8310_R_CONFA) != 0x00) {
-        bsp_error_handler(__FUNCTION__, __LINE__, "IST ready mode failed.");
-        return 0;
-    }
-    HAL_Delay(10);
-    // Normal state, no int
-    ist8310_write_reg(IST8310_R_CONFB, 0x00);
-    if(ist8310_read_reg(IST8310_R_CONFB) != 0x00) {
-        bsp_error_handler(__FUNCTION__, __LINE__, "IST normal state init failed.");
-        return 0;
-    }
-    HAL_Delay(10);
-    // Config low noise mode, x,y,z axis 16 time 1 avg,
-    ist8310_write_reg(IST8310_AVGCNTL, 0x24); // 100100
-    if(ist8310_read_reg(IST8310_AVGCNTL) != 0x24) {
-        bsp_error_handler(__FUNCTION__, __LINE__, "IST low noise mode failed.");
-        return 0;
-    }
-    HAL_Delay(10);
-    // Set/Reset pulse duration setup, normal mode
-    ist8310_write_reg(IST8310_PDCNTL, 0xC0);
-    if(ist8310_read_reg(IST8310_PDCNTL) != 0xC0) {
-        bsp_error_handler(__FUNCTION__, __LINE__, "IST pulse duration set failed.");
-        return 0;
-    }
-    HAL_Delay(10);
-    // Turn off slave1 & slave 4
-    mpu6500_write_reg(MPU6500_I2C_SLV1_CTRL, 0x00);
-    HAL_Delay(10);
-    mpu6500_write_reg(MPU6500_I2C_SLV4_CTRL, 0x00);
-    HAL_Delay(10);
-    // Configure and turn on slave 0
-    mpu_read_ist_config(IST8310_ADDRESS, IST8310_R_XL, 0x06);
-    HAL_Delay(100);
-    return 1;
-}
-
-static uint8_t ist8310_read_reg(uint8_t addr) {
-    mpu6500_write_reg(MPU6500_I2C_SLV4_REG, addr);
-    HAL_Delay(10);
-    mpu6500_write_reg(MPU6500_I2C_SLV4_CTRL, 0x80);
-    HAL_Delay(10);
-    uint8_t data = mpu6500_read_reg(MPU6500_I2C_SLV4_DI);
-    mpu6500_write_reg(MPU6500_I2C_SLV4_CTRL, 0x00);     // Turn off slave4 after read
-    HAL_Delay(10);
-    return data;
-}
-
-static uint8_t ist8310_write_reg(uint8_t addr, uint8_t data) {
-    mpu6500_write_reg(MPU6500_I2C_SLV1_CTRL, 0x00);     // Turn off slave 1 at first
-    HAL_Delay(2);
-    mpu6500_write_reg(MPU6500_I2C_SLV1_REG, addr);
-    HAL_Delay(2);
-    mpu6500_write_reg(MPU6500_I2C_SLV1_DO, data);
-    HAL_Delay(2);
-    // Turn on slave 1 with one byte transmitting
-    mpu6500_write_reg(MPU6500_I2C_SLV1_CTRL, 0x80 | 0x01);
-    HAL_Delay(10);
-    return 1;
-}
-
-static void mpu_read_ist_config(uint8_t device_address, uint8_t reg_base_addr, uint8_t data_num) {
-    // Use slave 1 to automatically transmit single measure mode
-    mpu6500_write_reg(MPU6500_I2C_SLV1_ADDR, device_address);
-    HAL_Delay(2);
-    mpu6500_write_reg(MPU6500_I2C_SLV1_REG, IST8310_R_CONFA);
-    HAL_Delay(2);
-    mpu6500_write_reg(MPU6500_I2C_SLV1_DO, IST8310_ODR_MODE);
-    HAL_Delay(2);
-    // Use slave 0 to read data automatically
-    mpu6500_write_reg(MPU6500_I2C_SLV0_ADDR, 0x80 | device_address);
-    HAL_Delay(2);
-    mpu6500_write_reg(MPU6500_I2C_SLV0_REG, reg_base_addr);
-    HAL_Delay(2);
-    // Every 8 mpu6500 internal samples, one i2c master read
-    mpu6500_write_reg(MPU6500_I2C_SLV4_CTRL, 0x03);
-    HAL_Delay(2);
-    // Enable slave 0 and 1 access delay
-    mpu6500_write_reg(MPU6500_I2C_MST_DELAY_CTRL, 0x01 | 0x02);
-    HAL_Delay(2);
-    // Enable slave 1 auto transmit
-    mpu6500_write_reg(MPU6500_I2C_SLV1_CTRL, 0x80 | 0x01);
-    HAL_Delay(6); // Wait 6ms (minimum waiting time for 16 times internal average setup)
-    // Enable slave 0 with data_num bytes reading
-    mpu6500_write_reg(MPU6500_I2C_SLV0_CTRL, 0x80 | data_num);
-    HAL_Delay(2);
+static void ist8310_decode(const uint8_t* buff, imu_t* imu) {
+    imu->mag.x = (int16_t)(buff[1]<<8 | buff[0]);
+    imu->mag.y = (int16_t)(buff[3]<<8 | buff[2]);
+    imu->mag.z = (int16_t)(buff[5]<<8 | buff[4]);
 }
@@ -31,8 +31,10 @@
 #include "bsp_ist8310_reg.h"
 #include "bsp_error_handler.h"
 #include "bsp_print.h"
+#include "bsp_dwt.h"
 #include "spi.h"
 #include "main.h"
+#include "cmsis_os.h"
 
 /**
  * @ingroup bsp
@@ -41,8 +43,8 @@
  */
 
 /* Constants and Common Functions */
-#define RAD_2_DEG 57.29578
-#define DEG_2_RAD 0.017453
+#define RAD_2_DEG 57.29578f
+#define DEG_2_RAD 0.01745329f
 
 #define ONBOARD_IMU_SPI     hspi5
 #define ONBOARD_IMU_TIMEOUT 55
@@ -52,6 +54,20 @@
 #define ONBOARD_TEMP_OFFSET 0
 #define ONBOARD_TEMP_FACTOR 333.87f // Datasheet p12
 #define ONBOARD_GYRO_FACTOR 16.384f // Check datasheet, 2000dps = 16.384
+#define ONBOARD_ACCE_SCALE  (1.0f / ONBOARD_ACCE_FACTOR)    // g per LSB, multiplied instead of dividing
+#define ONBOARD_TEMP_SCALE  (1.0f / ONBOARD_TEMP_FACTOR)
+#define ONBOARD_GYRO_SCALE  (1.0f / ONBOARD_GYRO_FACTOR)
+
+#define ONBOARD_IMU_BURST   20          // accel, temp, gyro followed by 6 IST8310 bytes in EXT_SENS_DATA
+#define ONBOARD_IMU_INT_PIN GPIO_PIN_8  // EXTI line wired to MPU6500 INT
+#define ONBOARD_IMU_SIGNAL  0x0002      // Signal sent to the fusion task on every new sample / batch
+#define ONBOARD_IMU_READY_SIGNAL 0x0004 // Signal sent when tick driven bring-up finishes or fails
+
+#define ONBOARD_FIFO_SIZE       512     // MPU6500 FIFO depth in bytes
+#define ONBOARD_FIFO_SAMPLE     14      // accel, temp and gyro, same layout as the register burst
+#define ONBOARD_FIFO_BATCH      (ONBOARD_FIFO_SIZE / ONBOARD_FIFO_SAMPLE)
+#define ONBOARD_FIFO_MAX_RATE   8000
+#define ONBOARD_FIFO_USER_CTRL  0x60    // FIFO_EN | I2C_MST_EN
 
 typedef struct {
     struct {
@@ -67,14 +83,52 @@ typedef struct {
         float y;
         float z;
     } __packed gyro;
-    // Raw value of magnetomitor
+    // Raw value of magnetomitor, signed
     struct {
-        uint16_t x;
-        uint16_t y;
-        uint16_t z;
+        int16_t x;
+        int16_t y;
+        int16_t z;
     } __packed mag;
+    // dwt_get_us() at the data-ready interrupt, or at the SPI read that first saw the sample when polled
+    uint32_t stamp_us;
 } __packed imu_t;
 
+/* Raw MPU6500 counts in register order, i.e. fixed point with the LSB of
+ * 1 / ONBOARD_ACCE_FACTOR g, 1 / ONBOARD_TEMP_FACTOR C above ONBOARD_TEMP_ROOM
+ * and 1 / ONBOARD_GYRO_FACTOR deg/s */
+typedef struct {
+    int16_t acce[3];
+    int16_t temp;
+    int16_t gyro[3];
+} __packed imu_fixed_t;
+
+typedef enum {
+    IMU_INIT_IDLE = 0,
+    IMU_INIT_RUNNING,
+    IMU_INIT_READY,
+    IMU_INIT_FAILED,
+} imu_init_state_t;
+
+typedef struct {
+    imu_t       imu;        // imu.stamp_us holds the sample time
+    uint32_t    seq;        // increments on every published sample
+} imu_sample_t;
+
+typedef struct {
+    uint32_t    started;    // DMA bursts kicked by data-ready
+    uint32_t    completed;  // DMA bursts decoded and published
+    uint32_t    busy_drop;  // data-ready while previous burst still running
+    uint32_t    spi_error;  // bursts aborted by SPI errors
+    uint32_t    fifo_overflow;  // FIFO found full, samples lost
+    uint32_t    fifo_resync;    // FIFO resets after overflow or a broken read
+} imu_async_stats_t;
+
+typedef struct {
+    uint32_t        seq;        // increments on every published batch, a gap means batches were overwritten unread
+    uint16_t        count;      // valid entries in sample
+    imu_sample_t    sample[ONBOARD_FIFO_BATCH];
+} imu_batch_t;
+
 /**
  * Initialize onboard imu
  *
@@ -84,6 +138,35 @@ typedef struct {
  */
 uint8_t onboard_imu_init(void);
 
+/**
+ * Start bringing up MPU6500 and IST8310 without blocking. The same register
+ * sequence as onboard_imu_init runs one SPI DMA transfer per step, paced by
+ * onboard_imu_init_tick, so other peripherals can initialize meanwhile.
+ *
+ * @param  notify_task Thread to receive ONBOARD_IMU_READY_SIGNAL, NULL for none
+ * @return            1 for started, 0 if the imu is busy
+ */
+uint8_t onboard_imu_init_async(osThreadId notify_task);
+
+/**
+ * Advance the bring-up sequence. Call at 1kHz, e.g. from a timer interrupt.
+ */
+void onboard_imu_init_tick(void);
+
+/**
+ * Get the state of the tick driven bring-up
+ *
+ * @return            Current state
+ */
+imu_init_state_t onboard_imu_init_state(void);
+
+/**
+ * Get the reason the tick driven bring-up failed
+ *
+ * @return            Error message, NULL if not failed
+ */
+const char* onboard_imu_init_error(void);
+
 /**
  * Get accelerometer and gyroscope data
  *
@@ -93,6 +176,34 @@ uint8_t onboard_imu_init(void);
  */
 void mpu6500_get_data(imu_t* imu);
 
+/**
+ * Get accelerometer, temperature and gyroscope data as raw fixed point counts
+ *
+ * @param  imu        A valid imu_fixed_t object
+ * @note   Blocking register read only, not available in async modes
+ */
+void mpu6500_get_data_fixed(imu_fixed_t* imu);
+
+/**
+ * Byte swap count 14 byte accel / temp / gyro records (register dump or
+ * FIFO) into fixed point counts, two halfwords per REV16
+ *
+ * @param  buff       Records starting at ACCEL_XOUT_H, any alignment
+ * @param  count      Number of records
+ * @param  out        count fixed point samples
+ */
+void mpu6500_convert_fixed(const uint8_t* buff, uint16_t count, imu_fixed_t* out);
+
+/**
+ * Convert count 14 byte accel / temp / gyro records to physical units with
+ * single precision multiplies only
+ *
+ * @param  buff       Records starting at ACCEL_XOUT_H, any alignment
+ * @param  count      Number of records
+ * @param  out        count imu objects, magnetometer left untouched
+ */
+void mpu6500_convert(const uint8_t* buff, uint16_t count, imu_t* out);
+
 /**
  * Get magnetomitor data
  *
@@ -103,13 +214,72 @@ void mpu6500_get_data(imu_t* imu);
 void ist8310_get_data(imu_t* imu);
 
 /**
- * Initialize MPU6500
+ * Switch the onboard imu to interrupt driven DMA reads. Each MPU6500
+ * data-ready interrupt starts one burst read of ONBOARD_IMU_BURST bytes;
+ * completion publishes a timestamped sample and signals the fusion task.
  *
+ * @param  fusion_task Thread to receive ONBOARD_IMU_SIGNAL, NULL for none
  * @return            1 for success, 0 for failed
- * @author Nickel_Liang
- * @date   2018-04-21
+ * @note   onboard_imu_init must succeed beforehand. mpu6500_get_data and
+ *         ist8310_get_data return the latest sample while async mode is on.
+ */
+uint8_t onboard_imu_start_async(osThreadId fusion_task);
+
+/**
+ * Switch the onboard imu to FIFO batching. Accel, temp and gyro are queued in the
+ * MPU6500 FIFO at rate_hz; onboard_imu_fifo_poll drains it in one DMA burst
+ * and publishes a batch of timestamped samples.
+ *
+ * @param  fusion_task Thread to receive ONBOARD_IMU_SIGNAL, NULL for none
+ * @param  rate_hz    Sample rate, up to ONBOARD_FIFO_MAX_RATE. Must divide 1000 (from 4Hz),
+ *                    or 8000 above 1kHz, as the MPU6500 only divides its internal rate
+ * @return            1 for success, 0 for failed
+ * @note   Poll faster than the FIFO fills, ONBOARD_FIFO_BATCH samples at rate_hz.
+ *         Magnetometer is not sampled in this mode.
+ */
+uint8_t onboard_imu_start_fifo(osThreadId fusion_task, uint16_t rate_hz);
+
+/**
+ * Start draining the FIFO. Call periodically from a timer interrupt.
  */
-static uint8_t mpu6500_init(void);
+void onboard_imu_fifo_poll(void);
+
+/**
+ * Copy the latest published FIFO batch
+ *
+ * @param  batch      Output batch
+ * @return            Sequence number of the batch, 0 if none yet
+ * @note   Only the latest batch is kept. Batches between the previous read and
+ *         this one were overwritten, seq - last_seq - 1 of them.
+ */
+uint32_t onboard_imu_read_batch(imu_batch_t* batch);
+
+/**
+ * Leave data-ready or FIFO mode and return to blocking reads
+ */
+void onboard_imu_stop_async(void);
+
+/**
+ * Copy the latest published sample without blocking the DMA completion
+ *
+ * @param  sample     Output sample
+ * @return            Sequence number of the sample, 0 if none yet
+ */
+uint32_t onboard_imu_read_sample(imu_sample_t* sample);
+
+/**
+ * Copy async transfer counters
+ *
+ * @param  stats      Output counters
+ */
+void onboard_imu_get_async_stats(imu_async_stats_t* stats);
+
+/**
+ * EXTI handler for MPU6500 data-ready. Called from HAL_GPIO_EXTI_Callback.
+ *
+ * @param  gpio_pin   Pin that generated the interrupt
+ */
+void onboard_imu_exti_callback(uint16_t gpio_pin);
 
 /**
  * Write MPU6500 register
@@ -145,45 +315,58 @@ static uint8_t mpu6500_read_reg(uint8_t const reg);
 static uint8_t mpu6500_read_regs(uint8_t const reg_addr, uint8_t* data, uint8_t len);
 
 /**
- * Initialize IST8310
+ * Convert a 14 byte accel / temp / gyro register dump
  *
- * @return            1 for success, 0 for failed
- * @author Nickel_Liang
- * @date   2018-04-21
+ * @param  buff       Registers starting at ACCEL_XOUT_H
+ * @param  imu        A valid imu object
  */
-static uint8_t ist8310_init(void);
+static void mpu6500_decode(const uint8_t* buff, imu_t* imu);
 
 /**
- * Read IST8310 register
+ * Convert 6 bytes of IST8310 data mirrored in EXT_SENS_DATA
  *
- * @param  addr       Register address to read
- * @return            Register data
- * @author Nickel_Liang
- * @date   2018-04-21
+ * @param  buff       Registers starting at EXT_SENS_DATA_00
+ * @param  imu        A valid imu object
  */
-static uint8_t ist8310_read_reg(uint8_t addr);
+static void ist8310_decode(const uint8_t* buff, imu_t* imu);
 
 /**
- * Write IST8310 register
+ * Publish one sample for onboard_imu_read_sample
  *
- * @param  addr       Register address to write
- * @param  data       Register data
- * @return            1
- * @author Nickel_Liang
- * @date   2018-04-21
+ * @param  imu        Decoded sample
+ * @param  stamp_us   Sample time
  */
-static uint8_t ist8310_write_reg(uint8_t addr, uint8_t data);
+static void mpu_publish_sample(const imu_t* imu, uint32_t stamp_us);
 
 /**
- * Configure IST8310 read throught MPU6500 mode
- *
- * @param  device_address Address of IST8310
- * @param  reg_base_addr  Base address of IST8310
- * @param  data_num       Number of data for each auto read
- * @author Nickel_Liang
- * @date   2018-04-21
+ * Handle completion of a data-ready burst read
+ */
+static void mpu_burst_complete(void);
+
+/**
+ * Handle completion of a FIFO count read and start draining whole samples
+ */
+static void mpu_fifo_count_complete(void);
+
+/**
+ * Unpack a drained FIFO into the next batch and publish it
+ */
+static void mpu_fifo_data_complete(void);
+
+/**
+ * Start the next bring-up step, or finish the bring-up
+ */
+static void mpu_init_next(void);
+
+/**
+ * Check the result of a bring-up step and schedule the next one
+ */
+static void mpu_init_complete(void);
+
+/**
+ * Reset the FIFO to realign the byte stream on a sample boundary
  */
-static void mpu_read_ist_config(uint8_t device_address, uint8_t reg_base_addr, uint8_t data_num);
+static void mpu_fifo_reset(void);
 
 /** @} */
 
@@ -0,0 +1,158 @@
+/**************************************************************************
+ *  Copyright (C) 2018 
+ *  Illini RoboMaster @ University of Illinois at Urbana-Champaign.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#include "bsp_prof.h"
+
+#ifdef HOST_BUILD
+#define PROF_LOCK()     uint32_t prof_primask = 0
+#define PROF_UNLOCK()   (void)prof_primask
+#else
+#include "FreeRTOS.h"
+#include "task.h"
+#define PROF_LOCK()     uint32_t prof_primask = __get_PRIMASK(); __disable_irq()
+#define PROF_UNLOCK()   __set_PRIMASK(prof_primask)
+#endif
+
+#define PROF_ZONE_RECORD_SIZE   (PROF_NAME_LEN + 4 * 3 + 8 + PROF_HIST_BINS * 4)
+
+static prof_zone_t  *prof_zones;
+static uint8_t      prof_zone_count;
+static prof_task_t  prof_tasks[PROF_MAX_TASKS];
+static uint32_t     prof_slice_start;
+
+static uint8_t prof_log2_bin(uint32_t ticks) {
+    uint8_t bin = ticks ? 32 - __builtin_clz(ticks) : 0;
+    return bin < PROF_HIST_BINS ? bin : PROF_HIST_BINS - 1;
+}
+
+static prof_task_t *prof_find_task(void *handle) {
+    for (uint8_t i = 0; i < PROF_MAX_TASKS; ++i) {
+        if (prof_tasks[i].handle == handle)
+            return &prof_tasks[i];
+        if (prof_tasks[i].handle == NULL) {
+            prof_tasks[i].handle = handle;
+            return &prof_tasks[i];
+        }
+    }
+    return NULL;
+}
+
+static uint8_t *prof_put(uint8_t *buf, const void *src, uint32_t len) {
+    memcpy(buf, src, len);
+    return buf + len;
+}
+
+uint32_t prof_ticks_to_us(uint32_t ticks) {
+#ifdef HOST_BUILD
+    return ticks / 1000;
+#else
+    return dwt_cycles_to_us(ticks);
+#endif
+}
+
+void prof_zone_record(prof_zone_t *zone, uint32_t ticks) {
+    PROF_LOCK();
+    if (!zone->registered) {
+        zone->next       = prof_zones;
+        zone->registered = 1;
+        prof_zones       = zone;
+        prof_zone_count++;
+    }
+    zone->count++;
+    zone->total += ticks;
+    if (ticks < zone->min)
+        zone->min = ticks;
+    if (ticks > zone->max)
+        zone->max = ticks;
+    zone->hist[prof_log2_bin(ticks)]++;
+    PROF_UNLOCK();
+}
+
+void prof_task_switched_in(void *handle) {
+    (void)handle;
+    prof_slice_start = prof_get_ticks();
+}
+
+void prof_task_switched_out(void *handle) {
+    prof_task_t *task = prof_find_task(handle);
+    if (task)
+        task->ticks += prof_get_ticks() - prof_slice_start;
+}
+
+void prof_reset(void) {
+    PROF_LOCK();
+    for (prof_zone_t *zone = prof_zones; zone; zone = zone->next) {
+        zone->count = 0;
+        zone->total = 0;
+        zone->min   = UINT32_MAX;
+        zone->max   = 0;
+        memset(zone->hist, 0, sizeof(zone->hist));
+    }
+    for (uint8_t i = 0; i < PROF_MAX_TASKS; ++i)
+        prof_tasks[i].ticks = 0;
+    PROF_UNLOCK();
+}
+
+void prof_print_report(void) {
+    print("[PROF] zone             count    min   mean    max (us)\r\n");
+    for (prof_zone_t *zone = prof_zones; zone; zone = zone->next) {
+        if (zone->count == 0)
+            continue;
+        print("%-16s %8u %6u %6u %6u\r\n", zone->name, zone->count,
+                prof_ticks_to_us(zone->min),
+                prof_ticks_to_us((uint32_t)(zone->total / zone->count)),
+                prof_ticks_to_us(zone->max));
+    }
+#ifndef HOST_BUILD
+    uint64_t busy = 0;
+    for (uint8_t i = 0; i < PROF_MAX_TASKS && prof_tasks[i].handle; ++i)
+        busy += prof_tasks[i].ticks;
+    if (busy == 0)
+        return;
+    print("[PROF] task             cpu %%\r\n");
+    for (uint8_t i = 0; i < PROF_MAX_TASKS && prof_tasks[i].handle; ++i)
+        print("%-16s %5u.%u\r\n", pcTaskGetName(prof_tasks[i].handle),
+                (uint32_t)(prof_tasks[i].ticks * 100 / busy),
+                (uint32_t)(prof_tasks[i].ticks * 1000 / busy % 10));
+#endif
+}
+
+uint32_t prof_serialize(uint8_t *buf, uint32_t size) {
+    /* zones registering meanwhile are pushed in front of the snapshot head */
+    PROF_LOCK();
+    prof_zone_t *zone = prof_zones;
+    uint8_t     num   = prof_zone_count;
+    PROF_UNLOCK();
+    uint32_t len = 4 + num * PROF_ZONE_RECORD_SIZE;
+    if (len > size)
+        return 0;
+    uint16_t magic = PROF_MAGIC;
+    uint8_t *ptr = prof_put(buf, &magic, 2);
+    *ptr++ = PROF_VERSION;
+    *ptr++ = num;
+    for (uint8_t i = 0; i < num && zone; ++i, zone = zone->next) {
+        strncpy((char*)ptr, zone->name, PROF_NAME_LEN);
+        ptr += PROF_NAME_LEN;
+        ptr = prof_put(ptr, &zone->count, 4);
+        ptr = prof_put(ptr, &zone->min, 4);
+        ptr = prof_put(ptr, &zone->max, 4);
+        ptr = prof_put(ptr, &zone->total, 8);
+        ptr = prof_put(ptr, zone->hist, sizeof(zone->hist));
+    }
+    return len;
+}
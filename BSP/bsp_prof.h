@@ -0,0 +1,170 @@
+/**************************************************************************
+ *  Copyright (C) 2018 
+ *  Illini RoboMaster @ University of Illinois at Urbana-Champaign.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#ifndef _BSP_PROF_H_
+#define _BSP_PROF_H_
+
+#include <stdint.h>
+#include <string.h>
+
+#ifdef HOST_BUILD
+#include <time.h>
+#else
+#include "stm32f4xx_hal.h"
+#include "bsp_dwt.h"
+#endif
+
+#include "bsp_config.h"
+#include "bsp_print.h"
+
+/**
+ * @ingroup bsp
+ * @defgroup bsp_prof BSP Profiler
+ * @{
+ */
+
+#define PROF_ENABLE         OFF     // ON: time the PROF_ZONE_* zones; a debug aid
+#define PROF_HIST_BINS      24      // bin k holds durations in [2^(k-1), 2^k) ticks
+#define PROF_MAX_TASKS      16
+#define PROF_NAME_LEN       16      // zone name length in the binary report
+#define PROF_MAGIC          0x5046  // "PF"
+#define PROF_VERSION        1
+
+/**
+ * @struct prof_zone_t
+ * @brief statistics of one named code zone; durations are in profiler ticks
+ *        (core cycles on target, nanoseconds on host)
+ */
+typedef struct prof_zone {
+    const char          *name;
+    uint32_t            count;
+    uint32_t            min;
+    uint32_t            max;
+    uint64_t            total;
+    uint32_t            hist[PROF_HIST_BINS];
+    struct prof_zone    *next;
+    uint8_t             registered;
+}   prof_zone_t;
+
+/**
+ * @struct prof_task_t
+ * @brief CPU time accumulated by one RTOS task
+ */
+typedef struct {
+    void        *handle;
+    uint64_t    ticks;
+}   prof_task_t;
+
+/**
+ * Usage:
+ *   PROF_ZONE_DEFINE(gimbal_pid);
+ *   ...
+ *   PROF_ZONE_BEGIN(gimbal_pid);
+ *   pid_calc(...);
+ *   PROF_ZONE_END(gimbal_pid);
+ *
+ * Zones register themselves on their first PROF_ZONE_END.
+ */
+#if PROF_ENABLE == ON
+#define PROF_ZONE_DEFINE(zone)  static prof_zone_t prof_zone_##zone = { .name = #zone, .min = UINT32_MAX }
+#define PROF_ZONE_BEGIN(zone)   uint32_t prof_start_##zone = prof_get_ticks()
+#define PROF_ZONE_END(zone)     prof_zone_record(&prof_zone_##zone, prof_get_ticks() - prof_start_##zone)
+#else
+#define PROF_ZONE_DEFINE(zone)
+#define PROF_ZONE_BEGIN(zone)
+#define PROF_ZONE_END(zone)
+#endif
+
+/**
+ * FreeRTOS per-task accounting. Add to FreeRTOSConfig.h:
+ *   #define traceTASK_SWITCHED_IN()     prof_task_switched_in(pxCurrentTCB)
+ *   #define traceTASK_SWITCHED_OUT()    prof_task_switched_out(pxCurrentTCB)
+ * and declare both functions there, since bsp headers are not visible to tasks.c.
+ */
+
+/**
+ * Read the profiler time base
+ *
+ * @return            Core cycles on target, nanoseconds on host
+ */
+static inline uint32_t prof_get_ticks(void) {
+#ifdef HOST_BUILD
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec);
+#else
+    return dwt_get_cycles();
+#endif
+}
+
+/**
+ * Convert profiler ticks to microseconds
+ *
+ * @param  ticks      Duration in profiler ticks
+ * @return            Duration in microseconds
+ */
+uint32_t prof_ticks_to_us(uint32_t ticks);
+
+/**
+ * Accumulate one measurement into a zone, registering the zone if needed
+ *
+ * @param  zone       Zone descriptor defined by PROF_ZONE_DEFINE
+ * @param  ticks      Measured duration
+ */
+void prof_zone_record(prof_zone_t *zone, uint32_t ticks);
+
+/**
+ * Record the start of a task time slice. Called from traceTASK_SWITCHED_IN.
+ *
+ * @param  handle     Handle of the task switched in
+ */
+void prof_task_switched_in(void *handle);
+
+/**
+ * Charge the elapsed slice to a task. Called from traceTASK_SWITCHED_OUT.
+ *
+ * @param  handle     Handle of the task switched out
+ */
+void prof_task_switched_out(void *handle);
+
+/**
+ * Clear zone and task statistics; zones stay registered
+ */
+void prof_reset(void);
+
+/**
+ * Print zone statistics and per-task CPU usage
+ */
+void prof_print_report(void);
+
+/**
+ * Serialize zone statistics into a little-endian binary report
+ *
+ * Layout: magic (2B), version (1B), zone count (1B), then per zone
+ *         name (PROF_NAME_LEN), count, min, max (4B each), total (8B),
+ *         hist (PROF_HIST_BINS * 4B)
+ *
+ * @param  buf        Output buffer
+ * @param  size       Size of the output buffer
+ * @return            Number of bytes written, 0 if the buffer is too small
+ */
+uint32_t prof_serialize(uint8_t *buf, uint32_t size);
+
+/** @} */
+
+#endif
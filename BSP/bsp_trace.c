@@ -0,0 +1,126 @@
+/**************************************************************************
+ *  Copyright (C) 2018 
+ *  Illini RoboMaster @ University of Illinois at Urbana-Champaign.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#include "bsp_trace.h"
+
+static uint32_t     trace_stamps[TRACE_POINT_NUM];
+static uint8_t      trace_valid[TRACE_POINT_NUM];
+static trace_path_t trace_paths[TRACE_MAX_PATHS];
+static uint8_t      trace_path_count;
+static uint32_t     trace_bin_cycles;
+
+static void trace_clear_path(trace_path_t *path) {
+    path->count = 0;
+    path->min   = UINT32_MAX;
+    path->max   = 0;
+    path->total = 0;
+    memset(path->hist, 0, sizeof(path->hist));
+}
+
+static void trace_record(trace_path_t *path, uint32_t latency) {
+    uint32_t bin = latency / trace_bin_cycles;
+    if (bin >= TRACE_HIST_BINS)
+        bin = TRACE_HIST_BINS - 1;
+    path->hist[bin]++;
+    path->count++;
+    path->total += latency;
+    if (latency < path->min)
+        path->min = latency;
+    if (latency > path->max)
+        path->max = latency;
+}
+
+void trace_init(void) {
+    memset(trace_valid, 0, sizeof(trace_valid));
+    trace_path_count = 0;
+    trace_bin_cycles = dwt_us_to_cycles(TRACE_HIST_BIN_US);
+}
+
+trace_path_t *trace_add_path(const char *name, trace_point_t source, trace_point_t sink) {
+    if (source >= TRACE_POINT_NUM || sink >= TRACE_POINT_NUM || trace_path_count >= TRACE_MAX_PATHS) {
+        bsp_error_handler(__FUNCTION__, __LINE__, "Invalid trace path.");
+        return NULL;
+    }
+    /* trace_init is optional, this also starts the dwt that trace_point reads */
+    if (trace_bin_cycles == 0)
+        trace_bin_cycles = dwt_us_to_cycles(TRACE_HIST_BIN_US);
+    trace_path_t *path = &trace_paths[trace_path_count];
+    path->name   = name;
+    path->source = source;
+    path->sink   = sink;
+    trace_clear_path(path);
+    trace_path_count++;
+    return path;
+}
+
+void trace_point(trace_point_t point) {
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    uint32_t now = dwt_get_cycles();
+    for (uint8_t i = 0; i < trace_path_count; ++i) {
+        trace_path_t *path = &trace_paths[i];
+        if (path->sink == point && trace_valid[path->source])
+            trace_record(path, now - trace_stamps[path->source]);
+    }
+    trace_stamps[point] = now;
+    trace_valid[point]  = 1;
+    __set_PRIMASK(primask);
+}
+
+trace_tx_group_t trace_tx_group(uint16_t id) {
+    switch (id) {
+        case 0x1FF:
+            return TRACE_TX_1FF;
+        case 0x2FF:
+            return TRACE_TX_2FF;
+        default:
+            return TRACE_TX_200;
+    }
+}
+
+uint32_t trace_percentile_us(trace_path_t *path, uint8_t percent) {
+    uint32_t target = ((uint64_t)path->count * percent + 99) / 100;
+    uint32_t seen = 0;
+    for (uint32_t bin = 0; bin < TRACE_HIST_BINS; ++bin) {
+        seen += path->hist[bin];
+        if (seen >= target && seen != 0)
+            return (bin + 1) * TRACE_HIST_BIN_US;
+    }
+    return TRACE_HIST_BINS * TRACE_HIST_BIN_US;
+}
+
+void trace_reset(void) {
+    for (uint8_t i = 0; i < trace_path_count; ++i)
+        trace_clear_path(&trace_paths[i]);
+}
+
+void trace_print_report(void) {
+    print("[TRACE] path            count    min   mean    p99    max (us)\r\n");
+    for (uint8_t i = 0; i < trace_path_count; ++i) {
+        trace_path_t *path = &trace_paths[i];
+        if (path->count == 0) {
+            print("%-16s %8u      -      -      -      -\r\n", path->name, 0);
+            continue;
+        }
+        print("%-16s %8u %6u %6u %6u %6u\r\n", path->name, path->count,
+                dwt_cycles_to_us(path->min),
+                dwt_cycles_to_us((uint32_t)(path->total / path->count)),
+                trace_percentile_us(path, 99),
+                dwt_cycles_to_us(path->max));
+    }
+}
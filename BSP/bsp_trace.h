@@ -0,0 +1,144 @@
+/**************************************************************************
+ *  Copyright (C) 2018 
+ *  Illini RoboMaster @ University of Illinois at Urbana-Champaign.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#ifndef _BSP_TRACE_H_
+#define _BSP_TRACE_H_
+
+#include "stm32f4xx_hal.h"
+#include "bsp_config.h"
+#include "bsp_dwt.h"
+#include "bsp_print.h"
+#include "bsp_error_handler.h"
+#include <string.h>
+
+/**
+ * @ingroup bsp
+ * @defgroup bsp_trace BSP Trace
+ * @{
+ */
+
+#define TRACE_ENABLE        OFF     // ON: record trace points; a debug aid, every point costs an irq-off write
+#define TRACE_CAN_NODES     12      // same as CAN1_DEVICE_NUM / CAN2_DEVICE_NUM
+#define TRACE_MAX_PATHS     8
+#define TRACE_HIST_BINS     64      // latency histogram bins per path
+#define TRACE_HIST_BIN_US   50      // width of a histogram bin; last bin collects overflow
+
+/**
+ * Trace points along the sense-to-actuate path. CAN points are indexed by
+ * node (rx id - 0x201) for RX / pid and by tx group for TX.
+ *
+ * Usage:
+ *   trace_add_path("yaw enc->cmd", TRACE_CAN1_RX + 8, TRACE_CAN1_TX + TRACE_TX_2FF);
+ *   trace_add_path("mouse->yaw",   TRACE_DBUS_FRAME,  TRACE_CAN1_TX + TRACE_TX_2FF);
+ */
+typedef enum {
+    TRACE_CAN1_RX       = 0,
+    TRACE_CAN2_RX       = TRACE_CAN1_RX + TRACE_CAN_NODES,
+    TRACE_PID_CAN1      = TRACE_CAN2_RX + TRACE_CAN_NODES,
+    TRACE_PID_CAN2      = TRACE_PID_CAN1 + TRACE_CAN_NODES,
+    TRACE_CAN1_TX       = TRACE_PID_CAN2 + TRACE_CAN_NODES,
+    TRACE_CAN2_TX       = TRACE_CAN1_TX + 3,
+    TRACE_IMU_READ      = TRACE_CAN2_TX + 3,
+    TRACE_DBUS_FRAME,
+    TRACE_POINT_NUM,
+}   trace_point_t;
+
+/* Offsets of CAN transmit groups from TRACE_CANx_TX */
+typedef enum {
+    TRACE_TX_200        = 0,
+    TRACE_TX_1FF        = 1,
+    TRACE_TX_2FF        = 2,
+}   trace_tx_group_t;
+
+/**
+ * @struct trace_path_t
+ * @brief latency statistics between a source and a sink trace point (cycles)
+ */
+typedef struct {
+    const char      *name;
+    trace_point_t   source;
+    trace_point_t   sink;
+    uint32_t        count;
+    uint32_t        min;
+    uint32_t        max;
+    uint64_t        total;
+    uint32_t        hist[TRACE_HIST_BINS];
+}   trace_path_t;
+
+#if TRACE_ENABLE == ON
+#define TRACE_POINT(point)  trace_point(point)
+#else
+#define TRACE_POINT(point)
+#endif
+
+/**
+ * Initialize trace points and remove all paths
+ *
+ * @note   Optional before the first trace_add_path, which sets up the dwt
+ *         and the histogram bins itself
+ */
+void trace_init(void);
+
+/**
+ * Register a latency path. Every time the sink is hit, the age of the latest
+ * source stamp is recorded.
+ *
+ * @param  name       Path name used in reports
+ * @param  source     Trace point where data is produced
+ * @param  sink       Trace point where data is consumed
+ * @return            Registered path, NULL if failed
+ */
+trace_path_t *trace_add_path(const char *name, trace_point_t source, trace_point_t sink);
+
+/**
+ * Stamp a trace point with the current cycle count. Safe to call from ISR.
+ *
+ * @param  point      Trace point that is hit
+ */
+void trace_point(trace_point_t point);
+
+/**
+ * Map a CAN transmit id to its tx group
+ *
+ * @param  id         One of 0x200, 0x1FF, 0x2FF
+ * @return            Offset from TRACE_CANx_TX
+ */
+trace_tx_group_t trace_tx_group(uint16_t id);
+
+/**
+ * Get a latency percentile of a path from its histogram
+ *
+ * @param  path       A valid path
+ * @param  percent    Percentile in [0, 100]
+ * @return            Upper bound of the percentile in microseconds
+ */
+uint32_t trace_percentile_us(trace_path_t *path, uint8_t percent);
+
+/**
+ * Clear the statistics of every path
+ */
+void trace_reset(void);
+
+/**
+ * Print min / mean / p99 / max latency of every path
+ */
+void trace_print_report(void);
+
+/** @} */
+
+#endif
@@ -26,6 +26,8 @@
 
 #include "bsp_uart.h"
 
+static uart_tx_queue_t *uart_tx_queues[UART_TX_MAX_PORTS];
+
 /* ===== UART Utilities ===== */
 
 uint8_t uart_rx_dma_without_it(UART_HandleTypeDef* huart, uint8_t* pData, uint32_t size) {
@@ -130,6 +132,125 @@ void uart_tx_blocking(UART_HandleTypeDef *huart, uint8_t *p_data, uint16_t size)
     HAL_UART_Transmit(huart, p_data, size, UART_TX_BLOCKING_TIMEOUT);
 }
 
+uint8_t uart_tx_queue_init(uart_tx_queue_t *queue, UART_HandleTypeDef *huart, uart_tx_done_t done, void *context) {
+    if ((queue == NULL) || (huart == NULL)) {
+        bsp_error_handler(__FUNCTION__, __LINE__, "Invalid parameter.");
+        return 0;
+    }
+    memset(queue, 0, sizeof(uart_tx_queue_t));
+    queue->huart   = huart;
+    queue->active  = -1;
+    queue->done    = done;
+    queue->context = context;
+    for (uint8_t i = 0; i < UART_TX_MAX_PORTS; ++i) {
+        if ((uart_tx_queues[i] == NULL) || (uart_tx_queues[i]->huart == huart)) {
+            uart_tx_queues[i] = queue;
+            return 1;
+        }
+    }
+    bsp_error_handler(__FUNCTION__, __LINE__, "Too many tx queues, raise UART_TX_MAX_PORTS.");
+    return 0;
+}
+
+uint16_t uart_tx_depth(uart_tx_queue_t *queue) {
+    uint16_t depth = 0;
+    for (uint8_t p = 0; p < UART_TX_PRIORITIES; ++p)
+        depth += queue->head[p] - queue->tail[p];
+    return depth;
+}
+
+int32_t uart_tx_reserve(uart_tx_queue_t *queue, uint8_t priority) {
+    if (priority >= UART_TX_PRIORITIES)
+        priority = UART_TX_PRIORITIES - 1;
+    int32_t handle = -1;
+    UART_TX_LOCK();
+    if (queue->head[priority] - queue->tail[priority] < UART_TX_QUEUE_DEPTH) {
+        handle = queue->head[priority] % UART_TX_QUEUE_DEPTH;
+        queue->desc[priority][handle].ready = 0;
+        queue->head[priority]++;
+        uint16_t depth = uart_tx_depth(queue);
+        if (depth > queue->high_water)
+            queue->high_water = depth;
+    }
+    else
+        queue->rejected++;
+    UART_TX_UNLOCK();
+    return handle;
+}
+
+/* Caller holds the lock */
+static void uart_tx_start(uart_tx_queue_t *queue) {
+    if (queue->active >= 0)
+        return;
+    /* Highest class first, and within a class only the oldest descriptor may go */
+    for (int8_t p = UART_TX_PRIORITIES - 1; p >= 0; --p) {
+        if (queue->head[p] == queue->tail[p])
+            continue;
+        uart_tx_desc_t *desc = &queue->desc[p][queue->tail[p] % UART_TX_QUEUE_DEPTH];
+        if (!desc->ready)
+            continue;
+        queue->active = p;
+        HAL_StatusTypeDef status;
+        if (queue->huart->hdmatx != NULL)
+            status = HAL_UART_Transmit_DMA(queue->huart, (uint8_t*)desc->data, desc->size);
+        else
+            status = HAL_UART_Transmit_IT(queue->huart, (uint8_t*)desc->data, desc->size);
+        if (status != HAL_OK)
+            queue->active = -1; // Port busy with someone else, retried on next commit or kick
+        return;
+    }
+}
+
+void uart_tx_commit(uart_tx_queue_t *queue, uint8_t priority, int32_t handle, const uint8_t *data, uint16_t size) {
+    if (priority >= UART_TX_PRIORITIES)
+        priority = UART_TX_PRIORITIES - 1;
+    uart_tx_desc_t *desc = &queue->desc[priority][handle];
+    desc->data  = data;
+    desc->size  = size;
+    UART_TX_LOCK();
+    desc->ready = 1;
+    uart_tx_start(queue);
+    UART_TX_UNLOCK();
+}
+
+void uart_tx_kick(uart_tx_queue_t *queue) {
+    UART_TX_LOCK();
+    uart_tx_start(queue);
+    UART_TX_UNLOCK();
+}
+
+/**
+ * Retire the frame on the wire and start the next one. Called from the tx complete interrupt
+ *
+ * @param  queue      A valid tx queue
+ * @param  sent       0 if the frame was aborted by an error
+ */
+static void uart_tx_complete(uart_tx_queue_t *queue, uint8_t sent) {
+    UART_TX_LOCK();
+    int8_t p = queue->active;
+    if (p < 0) {
+        UART_TX_UNLOCK();
+        return;
+    }
+    uart_tx_desc_t *desc = &queue->desc[p][queue->tail[p] % UART_TX_QUEUE_DEPTH];
+    const uint8_t *data = desc->data;
+    uint16_t size = desc->size;
+    queue->tail[p]++;
+    queue->sent += sent;
+    queue->active = -1;
+    uart_tx_start(queue);
+    UART_TX_UNLOCK();
+    if (queue->done != NULL)
+        queue->done(queue->context, p, data, size);
+}
+
+static uart_tx_queue_t* uart_tx_find(UART_HandleTypeDef *huart) {
+    for (uint8_t i = 0; i < UART_TX_MAX_PORTS && uart_tx_queues[i] != NULL; ++i)
+        if (uart_tx_queues[i]->huart == huart)
+            return uart_tx_queues[i];
+    return NULL;
+}
+
 /* ===== DMA Utilities ===== */
 
 uint16_t dma_current_data_counter(DMA_Stream_TypeDef *dma_stream) {
@@ -195,8 +316,11 @@ void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart) {
  * @date   2018-04-19
  */
 void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart) {
-    /* @todo Consider add signal handling here */
-    if (huart == &BSP_REFEREE_PORT) {
+    uart_tx_queue_t *queue = uart_tx_find(huart);
+    if (queue != NULL) {
+        uart_tx_complete(queue, 1);
+    }
+    else if (huart == &BSP_REFEREE_PORT) {
         bsp_error_handler(__FUNCTION__, __LINE__, "Referee TX callbacked.");
     }
     else if (huart == &BSP_TX2_PORT) {
@@ -209,3 +333,15 @@ void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart) {
         bsp_error_handler(__FUNCTION__, __LINE__, "Undefined active UART device TX callbacked.");
     }
 }
+
+/**
+ * This is a weak function. Indicate a UART error, which also aborts DMA tx.
+ *
+ * @param  huart      Which uart to handle
+ */
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart) {
+    uart_tx_queue_t *queue = uart_tx_find(huart);
+    /* Drop the frame on the wire so the queue does not stall */
+    if ((queue != NULL) && (huart->gState == HAL_UART_STATE_READY))
+        uart_tx_complete(queue, 0);
+}
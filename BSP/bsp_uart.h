@@ -33,6 +33,7 @@
 #include "bsp_error_handler.h"
 #include "stm32f4xx_hal.h"
 #include "cmsis_os.h"
+#include <string.h>
 
 /**
  * @ingroup bsp
@@ -40,6 +41,66 @@
  * @{
  */
 
+/* Guards tx queues against tasks and the tx complete interrupt, hold it only for a few instructions */
+#ifdef HOST_BUILD
+#define UART_TX_LOCK()          uint32_t uart_primask = 0
+#define UART_TX_UNLOCK()        (void)uart_primask
+#else
+#define UART_TX_LOCK()          uint32_t uart_primask = __get_PRIMASK(); __disable_irq()
+#define UART_TX_UNLOCK()        __set_PRIMASK(uart_primask)
+#endif
+
+#define UART_TX_QUEUE_DEPTH     8   // Descriptors per priority class, power of two
+#define UART_TX_PRIORITIES      2   // Number of priority classes
+#define UART_TX_NORMAL          0
+#define UART_TX_URGENT          1   // Sent before any queued normal frame, never preempts one on the wire
+#define UART_TX_MAX_PORTS       4   // UARTs that may own an async tx queue
+
+/**
+ * Called from the tx complete interrupt after a frame leaves, in queueing order within a priority class
+ */
+typedef void (*uart_tx_done_t)(void *context, uint8_t priority, const uint8_t *data, uint16_t size);
+
+/**
+ * @struct  uart_tx_desc_t
+ * @brief   A frame queued by reference. The buffer must stay valid until the done callback
+ * @var data    Frame to send
+ * @var size    Frame size in bytes
+ * @var ready   Set by uart_tx_commit, a reserved descriptor holds back the ones behind it until then
+ */
+typedef struct {
+    const uint8_t       *data;
+    uint16_t            size;
+    volatile uint8_t    ready;
+} uart_tx_desc_t;
+
+/**
+ * @struct  uart_tx_queue_t
+ * @brief   Async DMA transmit engine of a UART port
+ * @var huart       UART port
+ * @var desc        Descriptor ring of every priority class
+ * @var head        Next descriptor to reserve, free running
+ * @var tail        Next descriptor to send, free running
+ * @var active      Priority class of the frame on the wire, -1 if idle
+ * @var done        Callback when a frame leaves, may be NULL
+ * @var context     Passed to done
+ * @var high_water  Most descriptors queued at once, over all classes
+ * @var sent        Frames sent
+ * @var rejected    Frames refused because their class was full
+ */
+typedef struct {
+    UART_HandleTypeDef  *huart;
+    uart_tx_desc_t      desc[UART_TX_PRIORITIES][UART_TX_QUEUE_DEPTH];
+    volatile uint32_t   head[UART_TX_PRIORITIES];
+    volatile uint32_t   tail[UART_TX_PRIORITIES];
+    volatile int8_t     active;
+    uart_tx_done_t      done;
+    void                *context;
+    uint16_t            high_water;
+    uint32_t            sent;
+    uint32_t            rejected;
+} uart_tx_queue_t;
+
 /* ===== UART Utilities ===== */
 
 /**
@@ -100,6 +161,53 @@ void uart_port_init(UART_HandleTypeDef* huart);
  */
 void uart_tx_blocking(UART_HandleTypeDef *huart, uint8_t *p_data, uint16_t size);
 
+/**
+ * Initialize an async tx queue and attach it to the tx complete interrupt of its port
+ *
+ * @param  queue      Queue to initialize, must outlive the port
+ * @param  huart      Which UART to tx. Uses its tx DMA in normal mode if configured, interrupt mode otherwise
+ * @param  done       Callback when a frame leaves, may be NULL
+ * @param  context    Passed to done
+ * @return            1 for success, 0 for failed
+ */
+uint8_t uart_tx_queue_init(uart_tx_queue_t *queue, UART_HandleTypeDef *huart, uart_tx_done_t done, void *context);
+
+/**
+ * Reserve the next descriptor of a priority class. Never blocks, safe from tasks and interrupts
+ *
+ * @param  queue      A valid tx queue
+ * @param  priority   UART_TX_NORMAL or UART_TX_URGENT
+ * @return            Descriptor handle for uart_tx_commit, -1 if the class is full
+ * @note   Frames leave in reservation order within a class, so reserve while holding whatever orders their buffers
+ */
+int32_t uart_tx_reserve(uart_tx_queue_t *queue, uint8_t priority);
+
+/**
+ * Fill a reserved descriptor and start DMA if the port is idle
+ *
+ * @param  queue      A valid tx queue
+ * @param  priority   Class the descriptor was reserved in
+ * @param  handle     Handle from uart_tx_reserve
+ * @param  data       Frame to send, must stay valid until the done callback
+ * @param  size       Frame size in bytes
+ */
+void uart_tx_commit(uart_tx_queue_t *queue, uint8_t priority, int32_t handle, const uint8_t *data, uint16_t size);
+
+/**
+ * Start DMA on the next ready frame if the port is idle
+ *
+ * @param  queue      A valid tx queue
+ */
+void uart_tx_kick(uart_tx_queue_t *queue);
+
+/**
+ * Count descriptors queued or on the wire
+ *
+ * @param  queue      A valid tx queue
+ * @return            Queue depth over all priority classes
+ */
+uint16_t uart_tx_depth(uart_tx_queue_t *queue);
+
 /* ===== DMA Utilities ===== */
 
 /**
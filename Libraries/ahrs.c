@@ -0,0 +1,220 @@
+/**************************************************************************
+ *  Copyright (C) 2018 
+ *  Illini RoboMaster @ University of Illinois at Urbana-Champaign.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#include "ahrs.h"
+
+#define AHRS_RAD_2_DEG 57.29578f
+
+static void ahrs_mahony(ahrs_t *ahrs, float g[3], const float a[3], const float *m, float dt) {
+    float q0 = ahrs->q[0], q1 = ahrs->q[1], q2 = ahrs->q[2], q3 = ahrs->q[3];
+    float norm = a[0] * a[0] + a[1] * a[1] + a[2] * a[2];
+    if (norm == 0.0f)
+        return;
+    norm = ahrs_inv_sqrt(norm);
+    float ax = a[0] * norm, ay = a[1] * norm, az = a[2] * norm;
+
+    /* estimated gravity direction, halved */
+    float halfvx = q1 * q3 - q0 * q2;
+    float halfvy = q0 * q1 + q2 * q3;
+    float halfvz = q0 * q0 - 0.5f + q3 * q3;
+    float halfex = ay * halfvz - az * halfvy;
+    float halfey = az * halfvx - ax * halfvz;
+    float halfez = ax * halfvy - ay * halfvx;
+
+    if (m) {
+        norm = m[0] * m[0] + m[1] * m[1] + m[2] * m[2];
+        if (norm != 0.0f) {
+            norm = ahrs_inv_sqrt(norm);
+            float mx = m[0] * norm, my = m[1] * norm, mz = m[2] * norm;
+            /* earth field in the horizontal / vertical plane */
+            float hx = 2.0f * (mx * (0.5f - q2 * q2 - q3 * q3) + my * (q1 * q2 - q0 * q3) + mz * (q1 * q3 + q0 * q2));
+            float hy = 2.0f * (mx * (q1 * q2 + q0 * q3) + my * (0.5f - q1 * q1 - q3 * q3) + mz * (q2 * q3 - q0 * q1));
+            float bx = sqrtf(hx * hx + hy * hy);
+            float bz = 2.0f * (mx * (q1 * q3 - q0 * q2) + my * (q2 * q3 + q0 * q1) + mz * (0.5f - q1 * q1 - q2 * q2));
+            /* estimated field direction, halved */
+            float halfwx = bx * (0.5f - q2 * q2 - q3 * q3) + bz * (q1 * q3 - q0 * q2);
+            float halfwy = bx * (q1 * q2 - q0 * q3) + bz * (q0 * q1 + q2 * q3);
+            float halfwz = bx * (q0 * q2 + q1 * q3) + bz * (0.5f - q1 * q1 - q2 * q2);
+            halfex += my * halfwz - mz * halfwy;
+            halfey += mz * halfwx - mx * halfwz;
+            halfez += mx * halfwy - my * halfwx;
+        }
+    }
+
+    /* integral feedback is the negated gyro bias */
+    ahrs->bias[0] -= 2.0f * ahrs->gain_i * halfex * dt;
+    ahrs->bias[1] -= 2.0f * ahrs->gain_i * halfey * dt;
+    ahrs->bias[2] -= 2.0f * ahrs->gain_i * halfez * dt;
+    g[0] += 2.0f * ahrs->gain_p * halfex - ahrs->bias[0];
+    g[1] += 2.0f * ahrs->gain_p * halfey - ahrs->bias[1];
+    g[2] += 2.0f * ahrs->gain_p * halfez - ahrs->bias[2];
+}
+
+static void ahrs_madgwick(ahrs_t *ahrs, float g[3], float s[4], const float a[3], const float *m, float dt) {
+    float q0 = ahrs->q[0], q1 = ahrs->q[1], q2 = ahrs->q[2], q3 = ahrs->q[3];
+    float norm = a[0] * a[0] + a[1] * a[1] + a[2] * a[2];
+    s[0] = s[1] = s[2] = s[3] = 0.0f;
+    if (norm == 0.0f)
+        return;
+    norm = ahrs_inv_sqrt(norm);
+    float ax = a[0] * norm, ay = a[1] * norm, az = a[2] * norm;
+    float _2q0 = 2.0f * q0, _2q1 = 2.0f * q1, _2q2 = 2.0f * q2, _2q3 = 2.0f * q3;
+    float q0q0 = q0 * q0, q1q1 = q1 * q1, q2q2 = q2 * q2, q3q3 = q3 * q3;
+
+    norm = m ? m[0] * m[0] + m[1] * m[1] + m[2] * m[2] : 0.0f;
+    if (norm == 0.0f) {
+        /* gradient of the gravity objective only */
+        s[0] = 4.0f * q0 * q2q2 + _2q2 * ax + 4.0f * q0 * q1q1 - _2q1 * ay;
+        s[1] = 4.0f * q1 * q3q3 - _2q3 * ax + 4.0f * q0q0 * q1 - _2q0 * ay - 4.0f * q1
+             + 8.0f * q1 * q1q1 + 8.0f * q1 * q2q2 + 4.0f * q1 * az;
+        s[2] = 4.0f * q0q0 * q2 + _2q0 * ax + 4.0f * q2 * q3q3 - _2q3 * ay - 4.0f * q2
+             + 8.0f * q2 * q1q1 + 8.0f * q2 * q2q2 + 4.0f * q2 * az;
+        s[3] = 4.0f * q1q1 * q3 - _2q1 * ax + 4.0f * q2q2 * q3 - _2q2 * ay;
+    } else {
+        norm = ahrs_inv_sqrt(norm);
+        float mx = m[0] * norm, my = m[1] * norm, mz = m[2] * norm;
+        float q0q1 = q0 * q1, q0q2 = q0 * q2, q0q3 = q0 * q3;
+        float q1q2 = q1 * q2, q1q3 = q1 * q3, q2q3 = q2 * q3;
+        /* reference field direction */
+        float hx = mx * q0q0 - 2.0f * q0 * my * q3 + 2.0f * q0 * mz * q2 + mx * q1q1
+                 + _2q1 * my * q2 + _2q1 * mz * q3 - mx * q2q2 - mx * q3q3;
+        float hy = 2.0f * q0 * mx * q3 + my * q0q0 - 2.0f * q0 * mz * q1 + _2q1 * mx * q2
+                 - my * q1q1 + my * q2q2 + _2q2 * mz * q3 - my * q3q3;
+        float _2bx = sqrtf(hx * hx + hy * hy);
+        float _2bz = -2.0f * q0 * mx * q2 + 2.0f * q0 * my * q1 + mz * q0q0 + _2q1 * mx * q3
+                   - mz * q1q1 + _2q2 * my * q3 - mz * q2q2 + mz * q3q3;
+        float _4bx = 2.0f * _2bx, _4bz = 2.0f * _2bz;
+        /* objective residuals */
+        float fgx = 2.0f * q1q3 - 2.0f * q0q2 - ax;
+        float fgy = 2.0f * q0q1 + 2.0f * q2q3 - ay;
+        float fgz = 1.0f - 2.0f * q1q1 - 2.0f * q2q2 - az;
+        float fmx = _2bx * (0.5f - q2q2 - q3q3) + _2bz * (q1q3 - q0q2) - mx;
+        float fmy = _2bx * (q1q2 - q0q3) + _2bz * (q0q1 + q2q3) - my;
+        float fmz = _2bx * (q0q2 + q1q3) + _2bz * (0.5f - q1q1 - q2q2) - mz;
+        s[0] = -_2q2 * fgx + _2q1 * fgy - _2bz * q2 * fmx + (-_2bx * q3 + _2bz * q1) * fmy + _2bx * q2 * fmz;
+        s[1] = _2q3 * fgx + _2q0 * fgy - 4.0f * q1 * fgz + _2bz * q3 * fmx + (_2bx * q2 + _2bz * q0) * fmy
+             + (_2bx * q3 - _4bz * q1) * fmz;
+        s[2] = -_2q0 * fgx + _2q3 * fgy - 4.0f * q2 * fgz + (-_4bx * q2 - _2bz * q0) * fmx
+             + (_2bx * q1 + _2bz * q3) * fmy + (_2bx * q0 - _4bz * q2) * fmz;
+        s[3] = _2q1 * fgx + _2q2 * fgy + (-_4bx * q3 + _2bz * q1) * fmx + (-_2bx * q0 + _2bz * q2) * fmy
+             + _2bx * q1 * fmz;
+    }
+    norm = s[0] * s[0] + s[1] * s[1] + s[2] * s[2] + s[3] * s[3];
+    if (norm == 0.0f)
+        return;
+    norm = ahrs_inv_sqrt(norm);
+    s[0] *= norm; s[1] *= norm; s[2] *= norm; s[3] *= norm;
+
+    /* gyro error is the rate part of 2 * conj(q) x s, its integral is the bias */
+    ahrs->bias[0] += ahrs->gain_i * 2.0f * (q0 * s[1] - q1 * s[0] - q2 * s[3] + q3 * s[2]) * dt;
+    ahrs->bias[1] += ahrs->gain_i * 2.0f * (q0 * s[2] + q1 * s[3] - q2 * s[0] - q3 * s[1]) * dt;
+    ahrs->bias[2] += ahrs->gain_i * 2.0f * (q0 * s[3] - q1 * s[2] + q2 * s[1] - q3 * s[0]) * dt;
+    g[0] -= ahrs->bias[0];
+    g[1] -= ahrs->bias[1];
+    g[2] -= ahrs->bias[2];
+}
+
+void ahrs_init(ahrs_t *ahrs, ahrs_algo_t algo) {
+    ahrs->algo = algo;
+    ahrs->q[0] = 1.0f;
+    ahrs->q[1] = ahrs->q[2] = ahrs->q[3] = 0.0f;
+    ahrs->bias[0] = ahrs->bias[1] = ahrs->bias[2] = 0.0f;
+    if (algo == AHRS_MAHONY)
+        ahrs_set_gain(ahrs, AHRS_MAHONY_KP, AHRS_MAHONY_KI);
+    else
+        ahrs_set_gain(ahrs, AHRS_MADGWICK_BETA, AHRS_MADGWICK_ZETA);
+    ahrs->yaw_last    = 0.0f;
+    ahrs->yaw_turns   = 0;
+    ahrs->cycles_last = 0;
+    ahrs->cycles_max  = 0;
+}
+
+void ahrs_set_gain(ahrs_t *ahrs, float gain_p, float gain_i) {
+    ahrs->gain_p = gain_p;
+    ahrs->gain_i = gain_i;
+}
+
+void ahrs_align(ahrs_t *ahrs, const float acce[3]) {
+    float roll  = atan2f(acce[1], acce[2]);
+    float pitch = atan2f(-acce[0], sqrtf(acce[1] * acce[1] + acce[2] * acce[2]));
+    float cr = cosf(roll * 0.5f), sr = sinf(roll * 0.5f);
+    float cp = cosf(pitch * 0.5f), sp = sinf(pitch * 0.5f);
+    ahrs->q[0] = cr * cp;
+    ahrs->q[1] = sr * cp;
+    ahrs->q[2] = cr * sp;
+    ahrs->q[3] = -sr * sp;
+    ahrs->yaw_last  = 0.0f;
+    ahrs->yaw_turns = 0;
+}
+
+void ahrs_update(ahrs_t *ahrs, const float gyro[3], const float acce[3], const float *mag, float dt) {
+    uint32_t start = prof_get_ticks();
+    float g[3] = {gyro[0], gyro[1], gyro[2]};
+    float s[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    if (ahrs->algo == AHRS_MAHONY)
+        ahrs_mahony(ahrs, g, acce, mag, dt);
+    else
+        ahrs_madgwick(ahrs, g, s, acce, mag, dt);
+
+    /* q' = 0.5 * q x omega - beta * s, s is zero for Mahony */
+    float q0 = ahrs->q[0], q1 = ahrs->q[1], q2 = ahrs->q[2], q3 = ahrs->q[3];
+    float beta = ahrs->algo == AHRS_MADGWICK ? ahrs->gain_p : 0.0f;
+    float dq0 = 0.5f * (-q1 * g[0] - q2 * g[1] - q3 * g[2]) - beta * s[0];
+    float dq1 = 0.5f * ( q0 * g[0] + q2 * g[2] - q3 * g[1]) - beta * s[1];
+    float dq2 = 0.5f * ( q0 * g[1] - q1 * g[2] + q3 * g[0]) - beta * s[2];
+    float dq3 = 0.5f * ( q0 * g[2] + q1 * g[1] - q2 * g[0]) - beta * s[3];
+    q0 += dq0 * dt;
+    q1 += dq1 * dt;
+    q2 += dq2 * dt;
+    q3 += dq3 * dt;
+    float norm = ahrs_inv_sqrt(q0 * q0 + q1 * q1 + q2 * q2 + q3 * q3);
+    ahrs->q[0] = q0 * norm;
+    ahrs->q[1] = q1 * norm;
+    ahrs->q[2] = q2 * norm;
+    ahrs->q[3] = q3 * norm;
+
+    ahrs->cycles_last = prof_get_ticks() - start;
+    if (ahrs->cycles_last > ahrs->cycles_max)
+        ahrs->cycles_max = ahrs->cycles_last;
+}
+
+void ahrs_get_euler(ahrs_t *ahrs, float angle[3]) {
+    float q0 = ahrs->q[0], q1 = ahrs->q[1], q2 = ahrs->q[2], q3 = ahrs->q[3];
+    float sinp = 2.0f * (q0 * q2 - q3 * q1);
+    sinp = sinp > 1.0f ? 1.0f : (sinp < -1.0f ? -1.0f : sinp);
+    angle[0] = atan2f(2.0f * (q0 * q1 + q2 * q3), 1.0f - 2.0f * (q1 * q1 + q2 * q2)) * AHRS_RAD_2_DEG;
+    angle[1] = -asinf(sinp) * AHRS_RAD_2_DEG;
+
+    float yaw = atan2f(2.0f * (q0 * q3 + q1 * q2), 1.0f - 2.0f * (q2 * q2 + q3 * q3)) * AHRS_RAD_2_DEG;
+    if (yaw - ahrs->yaw_last > 180.0f)
+        ahrs->yaw_turns--;
+    else if (yaw - ahrs->yaw_last < -180.0f)
+        ahrs->yaw_turns++;
+    ahrs->yaw_last = yaw;
+    angle[2] = yaw + 360.0f * ahrs->yaw_turns;
+}
+
+float ahrs_inv_sqrt(float x) {
+    union {
+        float       f;
+        uint32_t    i;
+    } conv = { .f = x };
+    conv.i = 0x5f3759df - (conv.i >> 1);
+    conv.f *= 1.5f - 0.5f * x * conv.f * conv.f;
+    return conv.f;
+}
@@ -0,0 +1,123 @@
+/**************************************************************************
+ *  Copyright (C) 2018 
+ *  Illini RoboMaster @ University of Illinois at Urbana-Champaign.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#ifndef _AHRS_H_
+#define _AHRS_H_
+
+#include <stdint.h>
+#include <math.h>
+#include "bsp_prof.h"
+
+/**
+ * @ingroup library
+ * @defgroup ahrs AHRS
+ * @{
+ */
+
+#define AHRS_MAHONY_KP      1.0f    // proportional gain towards the accel / mag reference
+#define AHRS_MAHONY_KI      0.05f   // integral gain, i.e. gyro bias learning rate
+#define AHRS_MADGWICK_BETA  0.1f    // gradient descent step
+#define AHRS_MADGWICK_ZETA  0.015f  // gyro bias drift learning rate
+
+/**
+ * @enum ahrs_algo_t
+ * @brief attitude filter algorithm
+ * @var AHRS_MAHONY     nonlinear complementary filter with PI error feedback
+ * @var AHRS_MADGWICK   gradient descent orientation filter
+ */
+typedef enum {
+    AHRS_MAHONY,
+    AHRS_MADGWICK,
+}   ahrs_algo_t;
+
+/**
+ * @struct ahrs_t
+ * @brief quaternion attitude estimator state
+ * @var algo        algorithm in use
+ * @var q           attitude quaternion (w, x, y, z), body to earth
+ * @var bias        estimated gyro bias in rad/s
+ * @var gain_p      Mahony kp or Madgwick beta
+ * @var gain_i      Mahony ki or Madgwick zeta
+ * @var yaw_last    last wrapped yaw in degrees, used to unwrap
+ * @var yaw_turns   full turns accumulated by the unwrapped yaw
+ * @var cycles_last profiler ticks spent in the latest update
+ * @var cycles_max  maximum profiler ticks spent in one update
+ */
+typedef struct {
+    ahrs_algo_t algo;
+    float       q[4];
+    float       bias[3];
+    float       gain_p;
+    float       gain_i;
+    float       yaw_last;
+    int32_t     yaw_turns;
+    uint32_t    cycles_last;
+    uint32_t    cycles_max;
+}   ahrs_t;
+
+/**
+ * @brief initialize an estimator with the default gains of an algorithm
+ * @param ahrs  estimator to initialize
+ * @param algo  AHRS_MAHONY or AHRS_MADGWICK
+ */
+void ahrs_init(ahrs_t *ahrs, ahrs_algo_t algo);
+
+/**
+ * @brief override the filter gains
+ * @param ahrs      a valid estimator
+ * @param gain_p    Mahony kp or Madgwick beta
+ * @param gain_i    Mahony ki or Madgwick zeta
+ */
+void ahrs_set_gain(ahrs_t *ahrs, float gain_p, float gain_i);
+
+/**
+ * @brief align roll and pitch with gravity, yaw set to zero
+ * @param ahrs  a valid estimator
+ * @param acce  accelerometer reading in any unit
+ */
+void ahrs_align(ahrs_t *ahrs, const float acce[3]);
+
+/**
+ * @brief propagate the attitude by one sample
+ * @param ahrs  a valid estimator
+ * @param gyro  angular rate in rad/s
+ * @param acce  accelerometer reading in any unit
+ * @param mag   magnetometer reading in any unit, NULL to skip yaw correction
+ * @param dt    time since last update in seconds
+ */
+void ahrs_update(ahrs_t *ahrs, const float gyro[3], const float acce[3], const float *mag, float dt);
+
+/**
+ * @brief get Euler angles in the imuBoard.angle convention
+ * @param ahrs  a valid estimator
+ * @param angle output in degrees indexed by ROLL / PITCH / YAW; roll is
+ *              atan2(ay, az), pitch is positive nose down as atan2(ax, az)
+ *              and yaw is counterclockwise positive and unwrapped
+ */
+void ahrs_get_euler(ahrs_t *ahrs, float angle[3]);
+
+/**
+ * @brief fast inverse square root with one Newton iteration
+ * @param x positive input
+ * @return approximately 1 / sqrt(x), relative error below 0.2%
+ */
+float ahrs_inv_sqrt(float x);
+
+/** @} */
+
+#endif
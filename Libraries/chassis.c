@@ -72,6 +72,8 @@ void calc_keyboard_move(pid_ctl_t *my_chassis[4], dbus_t *rc, float yaw_angle, f
     if (rc->key.bit.A) v_x -= 1;
     if (rc->key.bit.D) v_x += 1;
 #if defined(INFANTRY1) || defined(INFANTRY2) || defined(INFANTRY3)
+    referee_snapshot_t referee;
+    referee_snapshot(&referee);
     if (sign(v_y) * sign(*prev_vy) == -1)
         v_y = 0;
     /*
@@ -79,9 +81,9 @@ void calc_keyboard_move(pid_ctl_t *my_chassis[4], dbus_t *rc, float yaw_angle, f
         v_y = sign(v_y) * 0.2;
         */
     else if (fabs(v_y) - fabs(*prev_vy) >= 0.01) {
-        if (referee_info.power_heat_data.chassis_power <= 50)
+        if (referee.chassis_power <= 50)
             v_y = *prev_vy + sign(v_y - *prev_vy) * 0.01;
-        else if (referee_info.power_heat_data.chassis_power >= 70)
+        else if (referee.chassis_power >= 70)
             v_y = *prev_vy - sign(v_y - *prev_vy) * 0.01;
         else
             v_y = *prev_vy;
@@ -94,9 +96,9 @@ void calc_keyboard_move(pid_ctl_t *my_chassis[4], dbus_t *rc, float yaw_angle, f
         v_x = sign(v_x) * 0.1;
         */
     else if (fabs(v_x) - fabs(*prev_vx) >= 0.007) {
-        if (referee_info.power_heat_data.chassis_power <= 50)
+        if (referee.chassis_power <= 50)
             v_x = *prev_vx + sign(v_x - *prev_vx) * 0.007;
-        else if (referee_info.power_heat_data.chassis_power >= 70)
+        else if (referee.chassis_power >= 70)
             v_x = *prev_vx - sign(v_x - *prev_vx) * 0.007;
         else
             v_x = *prev_vx;
@@ -119,12 +121,14 @@ void calc_remote_move(pid_ctl_t *my_chassis[4], dbus_t *rc, float yaw_angle, flo
     float v_y = rc->ch1 * 1.0 / 660;
     float v_x = rc->ch0 * 1.0 / 660;
 #if defined(INFANTRY1) || defined(INFANTRY2) || defined(INFANTRY3)
+    referee_snapshot_t referee;
+    referee_snapshot(&referee);
     if (sign(v_y) * sign(*prev_vy) == -1)
         v_y = 0;
     else if (fabs(v_y) - fabs(*prev_vy) >= 0.007) {
-        if (referee_info.power_heat_data.chassis_power <= 45)
+        if (referee.chassis_power <= 45)
             v_y = *prev_vy + sign(v_y - *prev_vy) * 0.007;
-        else if (referee_info.power_heat_data.chassis_power >= 70)
+        else if (referee.chassis_power >= 70)
             v_y = *prev_vy - sign(v_y - *prev_vy) * 0.007;
         else
             v_y = *prev_vy;
@@ -133,9 +137,9 @@ void calc_remote_move(pid_ctl_t *my_chassis[4], dbus_t *rc, float yaw_angle, flo
     if (sign(v_x) * sign(*prev_vx) == -1)
         v_x = 0;
     else if (fabs(v_x) - fabs(*prev_vx) >= 0.007) {
-        if (referee_info.power_heat_data.chassis_power <= 45)
+        if (referee.chassis_power <= 45)
             v_x = *prev_vx + sign(v_x - *prev_vx) * 0.007;
-        else if (referee_info.power_heat_data.chassis_power >= 70)
+        else if (referee.chassis_power >= 70)
             v_x = *prev_vx - sign(v_x - *prev_vx) * 0.007;
         else
             v_x = *prev_vx;
@@ -27,10 +27,14 @@
 #include "data_process.h"
 
 data_process_t* data_process_init(UART_HandleTypeDef *huart, osMutexId mutex, uint32_t fifo_size, uint16_t buffer_size, uint8_t sof, dispatcher_func_t dispatcher_func, void *source_struct, osMutexId tx_mutex, packer_func_t packer_func) {
-    if ((huart == NULL) || (mutex == NULL) || (buffer_size == 0) || (fifo_size == 0) || (dispatcher_func == NULL) || (source_struct == NULL) || (tx_mutex == NULL) || (packer_func == NULL)) {
+    if ((huart == NULL) || (buffer_size == 0) || (fifo_size == 0) || (source_struct == NULL) || (packer_func == NULL)) {
         bsp_error_handler(__FUNCTION__, __LINE__, "Invalid parameter.");
         return NULL;
     }
+    if ((2 * (uint32_t)buffer_size <= DATA_PROCESS_MAX_FRAME_LEN) || (fifo_size < DATA_PROCESS_MAX_FRAME_LEN)) {
+        bsp_error_handler(__FUNCTION__, __LINE__, "Buffer cannot hold a full frame.");
+        return NULL;
+    }
 
     data_process_t *source  = (data_process_t*)pvPortMalloc(sizeof(data_process_t));   /* Initialize a data process instance */
     if (source == NULL) {
@@ -41,23 +45,29 @@ data_process_t* data_process_init(UART_HandleTypeDef *huart, osMutexId mutex, ui
     source->huart           = huart;
     source->buff_size       = buffer_size;
     source->read_index      = 0;
+    source->scan_index      = 0;
+    source->state           = DATA_PROCESS_HUNT;
+    source->frame_len       = 0;
+    source->next_sof        = DATA_PROCESS_NO_SOF;
+    source->scan_pos        = 0;
+    source->frame_pos       = 0;
+    source->cut_end         = 0;
+    memset(&source->stats, 0, sizeof(data_process_stats_t));
+    source->rx_seq          = 0;
+    source->rx_seq_valid    = 0;
+    source->link_start      = HAL_GetTick();
+    memset(&source->link_base, 0, sizeof(data_process_stats_t));
+    memset(&source->link, 0, sizeof(data_process_link_t));
+    source->tx_seq          = 0;
     source->source_struct   = source_struct;
     source->dispatcher_func = dispatcher_func;
+    source->cmd_count       = 0;
     source->sof             = sof;
-    source->data_len        = 0;
     source->packer_func     = packer_func;
 
-    source->data_fifo       = fifo_s_create(fifo_size, mutex);
-    if (source->data_fifo == NULL) {
-        bsp_error_handler(__FUNCTION__, __LINE__, "Unable to allocate FIFO for data process object.");
-        free(source);
-        return NULL;
-    }
-
     source->buff[0]         = (uint8_t*)pvPortMalloc(2 * source->buff_size);
     if (source->buff[0] == NULL) {
         bsp_error_handler(__FUNCTION__, __LINE__, "Unable to allocate DMA buffer for data process object.");
-        fifo_s_destory(source->data_fifo);
         free(source);
         return NULL;
     }
@@ -68,70 +78,238 @@ data_process_t* data_process_init(UART_HandleTypeDef *huart, osMutexId mutex, ui
     print("source->buff[1] 0x%08x \r\n", source->buff[1]);
 #endif
 
-    source->frame_packet    = (uint8_t*)pvPortMalloc(fifo_size);
-    if (source->frame_packet == NULL) {
-        bsp_error_handler(__FUNCTION__, __LINE__, "Unable to allocate frame packet buffer for data process object.");
+    source->stitch          = (uint8_t*)pvPortMalloc(DATA_PROCESS_MAX_FRAME_LEN);
+    if (source->stitch == NULL) {
+        bsp_error_handler(__FUNCTION__, __LINE__, "Unable to allocate stitch buffer for data process object.");
         free(source->buff[0]);
-        fifo_s_destory(source->data_fifo);
         free(source);
         return NULL;
     }
 
-    source->transmit_fifo   = fifo_s_create(fifo_size, tx_mutex);
-    if (source->transmit_fifo == NULL) {
+    source->tx_arena_size   = fifo_size;
+    source->tx_arena[0]     = (uint8_t*)pvPortMalloc(UART_TX_PRIORITIES * fifo_size);
+    if (source->tx_arena[0] == NULL) {
         bsp_error_handler(__FUNCTION__, __LINE__, "Unable to allocate transmit FIFO for data process object.");
-        free(source->frame_packet);
+        free(source->stitch);
         free(source->buff[0]);
-        fifo_s_destory(source->data_fifo);
         free(source);
         return NULL;
     }
+    for (uint8_t p = 0; p < UART_TX_PRIORITIES; ++p) {
+        source->tx_arena[p] = source->tx_arena[0] + p * fifo_size;
+        source->tx_head[p]  = 0;
+        source->tx_tail[p]  = 0;
+    }
+    uart_tx_queue_init(&source->tx_queue, huart, data_process_tx_done, source);
 
     return source;
 }
 
 uint8_t data_process_rx(data_process_t *source) {
-    if (!buffer_to_fifo(source)) {
-        bsp_error_handler(__FUNCTION__, __LINE__, "Buffer to FIFO error.");
+    if (source == NULL) {
+        bsp_error_handler(__FUNCTION__, __LINE__, "Invalid parameter.");
         return 0;
     }
-    if (!fifo_to_struct(source)) {
-        bsp_error_handler(__FUNCTION__, __LINE__, "FIFO to struct error.");
+    /* Nothing to dispatch is not an error, the rest of a frame may still be on the wire */
+    return buffer_to_struct(source);
+}
+
+uint8_t data_process_register(data_process_t *source, uint16_t cmdid, void *target, uint16_t size, cmd_decode_t decode) {
+    if ((source == NULL) || (target == NULL) || (size > DATA_PROCESS_MAX_DATA_LEN)) {
+        bsp_error_handler(__FUNCTION__, __LINE__, "Invalid parameter.");
         return 0;
     }
+    data_process_cmd_t *cmd = data_process_find(source, cmdid);
+    if (cmd == NULL) {
+        if (source->cmd_count == DATA_PROCESS_MAX_CMDS) {
+            bsp_error_handler(__FUNCTION__, __LINE__, "Command table full, raise DATA_PROCESS_MAX_CMDS.");
+            return 0;
+        }
+        /* Insertion keeps the table sorted for the binary search */
+        uint8_t i = source->cmd_count++;
+        for (; i > 0 && source->cmds[i - 1].cmdid > cmdid; --i)
+            source->cmds[i] = source->cmds[i - 1];
+        cmd = &source->cmds[i];
+    }
+    cmd->cmdid    = cmdid;
+    cmd->size     = size;
+    cmd->target   = target;
+    cmd->decode   = decode;
+    cmd->updated  = 0;
+    cmd->stamp_ms = 0;
     return 1;
 }
 
-uint8_t data_process_tx(data_process_t *source) {
-    uint32_t count = fifo_used_count(source->transmit_fifo);
-    uint8_t buffer[count];
-    if (count != 0) {
-        if (fifo_s_gets(source->transmit_fifo, buffer, count) != count) {
-            bsp_error_handler(__FUNCTION__, __LINE__, "Failed to get enough FIFO data.");
+uint8_t data_process_register_table(data_process_t *source, void *target, const data_process_msg_t *table, uint8_t count) {
+    for (uint8_t i = 0; i < count; ++i) {
+        if (!(table[i].direction & DATA_PROCESS_RX))
+            continue;
+        if (!data_process_register(source, table[i].cmdid, (uint8_t*)target + table[i].offset, table[i].size, table[i].decode))
             return 0;
+    }
+    return 1;
+}
+
+uint8_t* data_process_msg_payload(const data_process_msg_t *table, uint8_t count, void *target, uint16_t cmdid, uint16_t *length) {
+    for (uint8_t i = 0; i < count; ++i) {
+        if (table[i].cmdid == cmdid && (table[i].direction & DATA_PROCESS_TX)) {
+            *length = table[i].size;
+            return (uint8_t*)target + table[i].offset;
         }
-        uart_tx_blocking(source->huart, buffer, count); // @todo Try DMA TX
     }
+    return NULL;
+}
+
+uint8_t data_process_is_updated(data_process_t *source, uint16_t cmdid) {
+    data_process_cmd_t *cmd = data_process_find(source, cmdid);
+    if ((cmd == NULL) || !cmd->updated)
+        return 0;
+    cmd->updated = 0;
     return 1;
 }
 
-static uint8_t buffer_to_fifo(data_process_t *source) {
-    if (source == NULL) {
-        bsp_error_handler(__FUNCTION__, __LINE__, "Invalid parameter.");
+uint32_t data_process_stamp(data_process_t *source, uint16_t cmdid) {
+    data_process_cmd_t *cmd = data_process_find(source, cmdid);
+    return cmd == NULL ? 0 : cmd->stamp_ms;
+}
+
+static data_process_cmd_t* data_process_find(data_process_t *source, uint16_t cmdid) {
+    int16_t low = 0, high = (int16_t)source->cmd_count - 1;
+    while (low <= high) {
+        int16_t mid = (low + high) / 2;
+        if (source->cmds[mid].cmdid == cmdid)
+            return &source->cmds[mid];
+        if (source->cmds[mid].cmdid < cmdid)
+            low = mid + 1;
+        else
+            high = mid - 1;
+    }
+    return NULL;
+}
+
+static void data_process_dispatch(data_process_t *source, uint16_t cmdid, const uint8_t *data, uint16_t length) {
+    data_process_cmd_t *cmd = data_process_find(source, cmdid);
+    if (cmd == NULL) {
+        source->stats.unknown++;
+        if (source->dispatcher_func != NULL)
+            source->dispatcher_func(source->source_struct, source, cmdid, data, length);
+        return;
+    }
+    /* A frame that does not match the struct would overrun or half fill it */
+    if (length != cmd->size) {
+        source->stats.bad_length++;
+        return;
+    }
+    if (cmd->decode != NULL) {
+        if (!cmd->decode(cmd->target, data, length))
+            return;
+    }
+    else
+        memcpy(cmd->target, data, length);
+    cmd->stamp_ms = HAL_GetTick();
+    cmd->updated  = 1;
+}
+
+uint8_t data_process_link_quality(data_process_t *source, data_process_link_t *link) {
+    /* The rx task may close a window meanwhile */
+    UART_TX_LOCK();
+    *link = source->link;
+    uint32_t start = source->link_start;
+    UART_TX_UNLOCK();
+    /* Windows only close on rx, a silent link would keep its last numbers forever */
+    if (HAL_GetTick() - start >= 2 * DATA_PROCESS_LINK_WINDOW_MS) {
+        link->frames_per_s    = 0;
+        link->interarrival_us = 0;
         return 0;
     }
+    return 1;
+}
 
-    int32_t write_len;                  /* Helper to calculate how many bytes to write */
-    uint8_t *buff = source->buff[0];    /* Source data buffer starting addr */
-    uint16_t write_index;               /* Helper to store where our new head is */
+static void sequence_check(data_process_t *source, uint8_t seq) {
+    if (!source->rx_seq_valid) {
+        source->rx_seq       = seq;
+        source->rx_seq_valid = 1;
+        return;
+    }
+    uint8_t ahead = seq - source->rx_seq;  // 1 when in order, wraps at 256
+    if (ahead == 0)
+        source->stats.duplicate++;
+    else if (ahead >= 256 - DATA_PROCESS_SEQ_REORDER) {
+        /* A late frame, it was counted lost when the newer one came in */
+        source->stats.reordered++;
+        if (source->stats.lost > source->link_base.lost)
+            source->stats.lost--;
+    }
+    else {
+        /* A seq further back than a late frame looks like a large gap. The peer restarted, so only resync */
+        if (ahead < 256 - 2 * DATA_PROCESS_SEQ_REORDER)
+            source->stats.lost += ahead - 1;
+        source->rx_seq = seq;
+    }
+}
 
-#ifdef DEBUG
-    int32_t total_write_len;
-#endif
+static void link_update(data_process_t *source) {
+    uint32_t now     = HAL_GetTick();
+    uint32_t elapsed = now - source->link_start;
+    if (elapsed < DATA_PROCESS_LINK_WINDOW_MS)
+        return;
 
-    /* @todo Following condition should be atomic. Actually whole function should be atomic */
+    data_process_stats_t *stats = &source->stats;
+    data_process_stats_t *base  = &source->link_base;
+    uint32_t frames = stats->frames - base->frames;
+    uint32_t lost   = stats->lost - base->lost;
+    uint32_t crc    = (stats->crc8_fail - base->crc8_fail) + (stats->crc16_fail - base->crc16_fail);
+    data_process_link_t link;
+    link.window_ms       = elapsed;
+    link.frames_per_s    = (uint32_t)((uint64_t)frames * 1000 / elapsed);
+    link.loss_permille   = frames + lost ? (uint16_t)((uint64_t)lost * 1000 / (frames + lost)) : 0;
+    link.crc_permille    = frames + crc ? (uint16_t)((uint64_t)crc * 1000 / (frames + crc)) : 0;
+    link.interarrival_us = frames ? (uint32_t)((uint64_t)elapsed * 1000 / frames) : 0;
+
+    UART_TX_LOCK();
+    source->link       = link;
+    source->link_start = now;
+    UART_TX_UNLOCK();
+    *base = *stats;
+    /* After a silent window the peer may have restarted its numbering */
+    if (frames == 0)
+        source->rx_seq_valid = 0;
+}
+
+void print_data_process_stats(data_process_t *source) {
+    data_process_stats_t *stats = &source->stats;
+    print("Frames %u \tCRC8 %u \tCRC16 %u \t| ", (unsigned)stats->frames, (unsigned)stats->crc8_fail, (unsigned)stats->crc16_fail);
+    print("Resync %u \tTruncated %u \tSkipped %u \tUnknown %u \tBad length %u\r\n", (unsigned)stats->resync, (unsigned)stats->truncated,
+          (unsigned)stats->skipped, (unsigned)stats->unknown, (unsigned)stats->bad_length);
+    data_process_link_t link;
+    data_process_link_quality(source, &link);
+    print("Lost %u \tDuplicate %u \tReordered %u \t| %u frames/s \tLoss %u%% \tCRC error %u%% \tInterarrival %u us\r\n",
+          (unsigned)stats->lost, (unsigned)stats->duplicate, (unsigned)stats->reordered, (unsigned)link.frames_per_s,
+          (unsigned)link.loss_permille / 10, (unsigned)link.crc_permille / 10, (unsigned)link.interarrival_us);
+    uart_tx_queue_t *queue = &source->tx_queue;
+    print("TX depth %u \tHigh water %u \tSent %u \tRejected %u\r\n", (unsigned)uart_tx_depth(queue), (unsigned)queue->high_water,
+          (unsigned)queue->sent, (unsigned)queue->rejected);
+}
+
+uint8_t data_process_tx(data_process_t *source) {
+    uart_tx_kick(&source->tx_queue);
+    return 1;
+}
+
+static void data_process_tx_done(void *context, uint8_t priority, const uint8_t *data, uint16_t size) {
+    data_process_t *source = context;
+    uint32_t size_arena    = source->tx_arena_size;
+    uint32_t offset        = data - source->tx_arena[priority];
+    /* Frames leave in allocation order, so release up to the end of this one, including any padding before it */
+    uint32_t padding       = (offset + size_arena - source->tx_tail[priority] % size_arena) % size_arena;
+    source->tx_tail[priority] += padding + size;
+}
+
+static uint16_t buffer_write_index(data_process_t *source) {
+    /* @todo Following condition should be atomic */
     uint8_t dma_memory_target = dma_current_memory_target(source->huart->hdmarx->Instance);
     uint16_t dma_remain_space = dma_current_data_counter(source->huart->hdmarx->Instance);
+    uint16_t write_index;
 
     /* Calculate correct write index - where we stop writting */
     if (dma_memory_target == 0)     // Writing in buffer 1
@@ -139,140 +317,204 @@ static uint8_t buffer_to_fifo(data_process_t *source) {
     else                            // Writing in buffer 2
         write_index = source->buff_size * 2 - dma_remain_space;
 
-    /* Unnecessary check @todo delete if never triggered */
-    if (write_index > source->buff_size * 2) {
-        bsp_error_handler(__FUNCTION__, __LINE__, "Write index exceed limit. Logic error.");
-        return 0;
-    }
-
-    /* Handle wrap around condition */
-    if (write_index < source->read_index) {
-        /* Last time we left in buffer 2 and now head is in buffer 1. Wrap around needed. */
 #ifdef DEBUG
-        total_write_len = source->buff_size * 2 - source->read_index + write_index;
-#endif
-        /* Read index points to where we left last time, so read till the end of second buffer */
-        write_len = source->buff_size * 2 - source->read_index;
-        if (write_len < 0) {
-            bsp_error_handler(__FUNCTION__, __LINE__, "Write length is negative.");
-            return 0;
-        }
-        if (write_len != fifo_s_puts(source->data_fifo, &buff[source->read_index], write_len)) {
-            print("write index: %d\r\n", write_index);
-            print("memory target: %d\r\n", dma_memory_target);
-            bsp_error_handler(__FUNCTION__, __LINE__, "FIFO overflow, need to resize.");
-            return 0;
-        }
-        source->read_index = 0;
-    }
-    else {
-        /* Head haven't wrap around yet. Simple direct write. */
-#ifdef DEBUG
-        total_write_len = write_index - source->read_index;
+    BSP_DEBUG;
+    print("Mem target:      %u\r\n", dma_memory_target);
+    print("Mem remain:      %d\r\n", dma_remain_space);
+    print("Write index:     %d\r\n", write_index);
 #endif
-    }
+    /* The counter reloads right after reaching the end, this only catches the transient */
+    return write_index >= source->buff_size * 2 ? 0 : write_index;
+}
 
-#ifdef DEBUG
-        BSP_DEBUG;
-        print("Total write len: %d\r\n", total_write_len);
-        print("Mem target:      %u\r\n", dma_memory_target);
-        print("Mem remain:      %d\r\n", dma_remain_space);
-        print("Write index:     %d\r\n", write_index);
-        print("\r\n");
-#endif
+static const uint8_t* buffer_view(data_process_t *source, uint16_t offset, uint16_t length) {
+    uint16_t ring_size = source->buff_size * 2;
+    uint16_t start = (source->read_index + offset) % ring_size;
+    uint8_t *buff = source->buff[0];
+    if (start + length <= ring_size)
+        return &buff[start];    // Common case, parse straight from DMA memory
 
-    /* General write condition */
-    write_len = write_index - source->read_index;
-    if (write_len != fifo_s_puts(source->data_fifo, &buff[source->read_index], write_len)) {
-        bsp_error_handler(__FUNCTION__, __LINE__, "FIFO overflow, need to resize.");
-        return 0;
+    /* Bytes wrap from the end of buffer 2 to the start of buffer 1 */
+    uint16_t head = ring_size - start;
+    memcpy(source->stitch, &buff[start], head);
+    memcpy(source->stitch + head, buff, length - head);
+    return source->stitch;
+}
+
+static void buffer_resync(data_process_t *source) {
+    source->stats.resync++;
+    if (source->next_sof == DATA_PROCESS_NO_SOF) {
+        /* No SOF inside the failed frame, nothing in it can start a frame */
+        source->read_index = source->scan_index;
+        source->frame_pos  = source->scan_pos;
+        source->state      = DATA_PROCESS_HUNT;
     }
-    source->read_index = write_index;
-    return 1;
+    else {
+        /* Bytes from the candidate on are fed again as the new frame */
+        uint16_t ring_size = source->buff_size * 2;
+        source->frame_pos += (source->next_sof + ring_size - source->read_index) % ring_size;
+        source->scan_pos   = source->frame_pos + 1;
+        source->read_index = source->next_sof;
+        source->scan_index = (source->next_sof + 1) % ring_size;
+        source->crc8       = crc8_update(CRC8_INIT_VALUE, &source->sof, 1);
+        source->crc16      = crc16_update(CRC16_INIT_VALUE, &source->sof, 1);
+        source->state      = DATA_PROCESS_HEADER;
+    }
+    source->next_sof = DATA_PROCESS_NO_SOF;
 }
 
-static uint8_t fifo_to_struct(data_process_t *source) {
-    uint8_t byte = 0;
-    uint8_t func_ret = 0;
+static uint8_t buffer_to_struct(data_process_t *source) {
+    uint16_t ring_size   = source->buff_size * 2;
+    uint16_t write_index = buffer_write_index(source);
+    uint8_t *buff        = source->buff[0];
     uint8_t flag = 0;
 
-    while (!fifo_is_empty(source->data_fifo)) {
-        byte = fifo_s_peek(source->data_fifo, 0); // Peek head
-#ifdef DEBUG
-        print("Byte: %02x\r\n", byte);
-        print("Used: %d\r\n", source->data_fifo->used);
-        print("Free: %d\r\n", source->data_fifo->free);
-#endif
-        if (byte != source->sof) {
-            fifo_s_get(source->data_fifo);
+    link_update(source);
+    while (source->scan_index != write_index) {
+        uint16_t index    = source->scan_index;
+        uint16_t received = (index + ring_size - source->read_index) % ring_size;   // Bytes of the frame before index
+
+        /* Payload runs go through CRC16 as a block, up to the CRC16 field, the newest byte or the end of the ring */
+        if (source->state == DATA_PROCESS_PAYLOAD && received < source->frame_len - DATA_PROCESS_CRC16_LEN) {
+            uint16_t span = (write_index > index ? write_index : ring_size) - index;
+            if (span > source->frame_len - DATA_PROCESS_CRC16_LEN - received)
+                span = source->frame_len - DATA_PROCESS_CRC16_LEN - received;
+            if (source->next_sof == DATA_PROCESS_NO_SOF) {
+                const uint8_t *sof = memchr(&buff[index], source->sof, span);
+                if (sof != NULL)
+                    source->next_sof = sof - buff;
+            }
+            source->crc16      = crc16_update(source->crc16, &buff[index], span);
+            source->scan_index = (index + span) % ring_size;
+            source->scan_pos  += span;
             continue;
         }
 
-        if (process_header(source) && process_frame(source)) {
-            source->dispatcher_func(source->source_struct, source);
+        uint8_t byte = buff[index];
+        source->scan_index = (index + 1) % ring_size;
+        source->scan_pos++;
+
+        if (source->state == DATA_PROCESS_HUNT) {
+            if (byte == source->sof) {
+                source->read_index = index;
+                source->frame_pos  = source->scan_pos - 1;
+                source->crc8       = crc8_update(CRC8_INIT_VALUE, &byte, 1);
+                source->crc16      = crc16_update(CRC16_INIT_VALUE, &byte, 1);
+                source->state      = DATA_PROCESS_HEADER;
+            }
+            else {
+                source->read_index = source->scan_index;
+                source->frame_pos  = source->scan_pos;
+                source->stats.skipped++;
+            }
+            continue;
+        }
+
+        /* Remember where to rewind to if this frame turns out bad */
+        if (byte == source->sof && source->next_sof == DATA_PROCESS_NO_SOF)
+            source->next_sof = index;
+        received++;
+
+        if (source->state == DATA_PROCESS_HEADER) {
+            if (received < DATA_PROCESS_HEADER_LEN) {
+                source->crc8  = crc8_update(source->crc8, &byte, 1);
+                source->crc16 = crc16_update(source->crc16, &byte, 1);
+                continue;
+            }
+            /* This byte is the CRC8 */
+            const uint8_t *header = buffer_view(source, 0, DATA_PROCESS_HEADER_LEN);
+            uint16_t data_len     = (uint16_t)((header[2] << 8) | header[1]);
+            if ((byte != source->crc8) || (data_len > DATA_PROCESS_MAX_DATA_LEN)) {
+                source->stats.crc8_fail++;
+                buffer_resync(source);
+                continue;
+            }
+            source->crc16     = crc16_update(source->crc16, &byte, 1);
+            source->frame_len = DATA_PROCESS_HEADER_LEN + DATA_PROCESS_CMD_LEN + data_len + DATA_PROCESS_CRC16_LEN;
+            source->state     = DATA_PROCESS_PAYLOAD;
+        }
+        else if (received == source->frame_len) {
+            /* This byte is the high half of the CRC16, the low half is right before it */
+            uint16_t expected = (uint16_t)((byte << 8) | buff[(index + ring_size - 1) % ring_size]);
+            if (expected != source->crc16) {
+                source->stats.crc16_fail++;
+                source->cut_end = source->scan_pos;
+                buffer_resync(source);
+                continue;
+            }
+            sequence_check(source, buffer_view(source, 3, 1)[0]);
+            const uint8_t *cmd = buffer_view(source, DATA_PROCESS_HEADER_LEN, DATA_PROCESS_CMD_LEN);
+            uint16_t cmdid     = (uint16_t)((cmd[1] << 8) | cmd[0]);
+            uint16_t data_len  = source->frame_len - DATA_PROCESS_HEADER_LEN - DATA_PROCESS_CMD_LEN - DATA_PROCESS_CRC16_LEN;
+            const uint8_t *data = buffer_view(source, DATA_PROCESS_HEADER_LEN + DATA_PROCESS_CMD_LEN, data_len);
+            data_process_dispatch(source, cmdid, data, data_len);
+            source->stats.frames++;
+            if (source->frame_pos < source->cut_end) {
+                source->stats.truncated++;
+                source->cut_end = 0;    // Frames after this one did not cut anything
+            }
+            source->next_sof   = DATA_PROCESS_NO_SOF;
+            source->read_index = source->scan_index;
+            source->frame_pos  = source->scan_pos;
+            source->state      = DATA_PROCESS_HUNT;
             flag = 1;
         }
     }
 #ifdef DEBUG
     BSP_DEBUG;
     print("End of loop.\r\n");
+    print_data_process_stats(source);
 #endif
     return flag;
 }
 
 uint8_t data_to_fifo(uint16_t cmdid, uint8_t *data, uint16_t length, data_process_t *source) {
+    return data_to_fifo_priority(cmdid, data, length, source, UART_TX_NORMAL);
+}
+
+uint8_t data_to_fifo_priority(uint16_t cmdid, uint8_t *data, uint16_t length, data_process_t *source, uint8_t priority) {
+    if (length > DATA_PROCESS_MAX_DATA_LEN) {
+        bsp_error_handler(__FUNCTION__, __LINE__, "Data length exceed maximum.");
+        return 0;
+    }
+    if (priority >= UART_TX_PRIORITIES)
+        priority = UART_TX_PRIORITIES - 1;
     uint16_t frame_length = DATA_PROCESS_HEADER_LEN + DATA_PROCESS_CMD_LEN + length + DATA_PROCESS_CRC16_LEN;
-    uint8_t buffer[frame_length];
-    uint8_t sof             = source->sof;
-    uint16_t data_length    = length;
-    uint8_t seq             = 0;
+    uint32_t size_arena   = source->tx_arena_size;
+    uint8_t *buffer       = NULL;
+    int32_t handle        = -1;
+    uint8_t seq           = 0;
+
+    /* Take arena space and a descriptor together, so frames leave in the order their space was taken */
+    UART_TX_LOCK();
+    uint32_t head    = source->tx_head[priority];
+    uint32_t offset  = head % size_arena;
+    uint32_t padding = (offset + frame_length > size_arena) ? size_arena - offset : 0; // Frames never wrap, DMA needs them contiguous
+    if (head + padding + frame_length - source->tx_tail[priority] <= size_arena) {
+        handle = uart_tx_reserve(&source->tx_queue, priority);
+        if (handle >= 0) {
+            buffer = source->tx_arena[priority] + (offset + padding) % size_arena;
+            source->tx_head[priority] = head + padding + frame_length;
+            seq    = source->tx_seq++;
+        }
+    }
+    UART_TX_UNLOCK();
+    if (buffer == NULL) {
+        bsp_error_handler(__FUNCTION__, __LINE__, "Failed to put data into FIFO.");
+        return 0;
+    }
 
     /* Construct data header */
-    buffer[0]   = sof;
-    memcpy(&buffer[1], (uint8_t*)&data_length, sizeof(uint16_t));
+    buffer[0]   = source->sof;
+    memcpy(&buffer[1], (uint8_t*)&length, sizeof(uint16_t));
     buffer[3]   = seq;
     append_crc8_check_sum(buffer, DATA_PROCESS_HEADER_LEN);
 
     /* Construct data frame */
     memcpy(&buffer[DATA_PROCESS_HEADER_LEN], (uint8_t*)&cmdid, DATA_PROCESS_CMD_LEN);
-    memcpy(&buffer[DATA_PROCESS_HEADER_LEN + DATA_PROCESS_CMD_LEN], data, data_length);
+    memcpy(&buffer[DATA_PROCESS_HEADER_LEN + DATA_PROCESS_CMD_LEN], data, length);
     append_crc16_check_sum(buffer, frame_length);
 
-    /* Put data into fifo */
-    if (fifo_s_puts(source->transmit_fifo, buffer, frame_length) != frame_length) {
-        bsp_error_handler(__FUNCTION__, __LINE__, "Failed to put data into FIFO.");
-        return 0;
-    }
-
-    return 1;
-}
-
-static uint8_t process_header(data_process_t *source) {
-    if (fifo_s_gets(source->data_fifo, (uint8_t*)(source->frame_packet), DATA_PROCESS_HEADER_LEN) != DATA_PROCESS_HEADER_LEN) {
-        bsp_error_handler(__FUNCTION__, __LINE__, "Failed to get enough FIFO data.");
-        return 0;
-    }
-    source->data_len = (uint16_t)((source->frame_packet[2] << 8) | source->frame_packet[1]);
-    if (source->data_len > DATA_PROCESS_MAX_DATA_LEN) {
-        bsp_error_handler(__FUNCTION__, __LINE__, "Data length exceed maximum.");
-        return 0;
-    }
-    if (!verify_crc8_check_sum(source->frame_packet, DATA_PROCESS_HEADER_LEN)) {
-        bsp_error_handler(__FUNCTION__, __LINE__, "CRC8 check failed.");
-        return 0;
-    }
-    return 1;
-}
-
-static uint8_t process_frame(data_process_t *source) {
-    uint16_t frame_length = DATA_PROCESS_CMD_LEN + source->data_len + DATA_PROCESS_CRC16_LEN;
-    if (fifo_s_gets(source->data_fifo, (uint8_t*)(source->frame_packet + DATA_PROCESS_HEADER_LEN), frame_length) != frame_length) {
-        bsp_error_handler(__FUNCTION__, __LINE__, "Failed to get enough FIFO data.");
-        return 0;
-    }
-    if (!verify_crc16_check_sum(source->frame_packet, DATA_PROCESS_HEADER_LEN + frame_length)) {
-        bsp_error_handler(__FUNCTION__, __LINE__, "CRC16 check failed.");
-        return 0;
-    }
+    uart_tx_commit(&source->tx_queue, priority, handle, buffer, frame_length);
     return 1;
 }
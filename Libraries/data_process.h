@@ -27,7 +27,6 @@
 #ifndef _DATA_PROCESS_H_
 #define _DATA_PROCESS_H_
 
-#include "data_fifo.h"
 #include "crc_check.h"
 #include "bsp_error_handler.h"
 #include "bsp_uart.h"
@@ -46,6 +45,10 @@
 
 #define DATA_PROCESS_MAX_FRAME_LEN  256
 #define DATA_PROCESS_MAX_DATA_LEN   (DATA_PROCESS_MAX_FRAME_LEN - DATA_PROCESS_HEADER_LEN - DATA_PROCESS_CMD_LEN - DATA_PROCESS_CRC16_LEN)
+#define DATA_PROCESS_NO_SOF         -1
+#define DATA_PROCESS_MAX_CMDS       16  // Commands one data process instance can register
+#define DATA_PROCESS_SEQ_REORDER    16  // A seq at most this far behind the newest is a late frame, further back the peer restarted
+#define DATA_PROCESS_LINK_WINDOW_MS 1000    // Link quality is measured over windows of this length
 
 /**
  * Package frame format:
@@ -55,11 +58,112 @@
  *  FrameTail   2B CRC16
  */
 
+/* Parser state, one byte is fed at a time */
+typedef enum {
+    DATA_PROCESS_HUNT = 0,      // Looking for SOF
+    DATA_PROCESS_HEADER,        // Collecting the rest of the header
+    DATA_PROCESS_PAYLOAD,       // Collecting cmdid, data and CRC16
+} data_process_state_t;
+
+/**
+ * @struct  data_process_stats_t
+ * @brief   rx parser counters, since init
+ * @var frames      Frames dispatched
+ * @var crc8_fail   Headers that failed CRC8 or claimed an oversized frame
+ * @var crc16_fail  Frames that failed CRC16
+ * @var resync      Times the parser gave up a frame and rewound to the next SOF candidate
+ * @var truncated   Frames with a good header cut short by the start of the next frame, counted when the next one parses inside it
+ * @var skipped     Bytes dropped while hunting for SOF
+ * @var unknown     Frames with a cmdid that is not registered
+ * @var bad_length  Frames whose payload size differs from the registered size, never copied
+ * @var lost        Frames missing from the seq numbering, less those that showed up late
+ * @var duplicate   Frames repeating the seq of the frame before
+ * @var reordered   Frames that arrived after a newer seq
+ */
+typedef struct {
+    uint32_t frames;
+    uint32_t crc8_fail;
+    uint32_t crc16_fail;
+    uint32_t resync;
+    uint32_t truncated;
+    uint32_t skipped;
+    uint32_t unknown;
+    uint32_t bad_length;
+    uint32_t lost;
+    uint32_t duplicate;
+    uint32_t reordered;
+} data_process_stats_t;
+
+/**
+ * @struct  data_process_link_t
+ * @brief   rx link quality over the last closed window
+ * @var window_ms       Length of the window, 0 until the first window closes
+ * @var frames_per_s    Frames dispatched per second
+ * @var loss_permille   Frames lost per thousand sent by the peer
+ * @var crc_permille    Frames failing CRC8 or CRC16 per thousand seen
+ * @var interarrival_us Mean time between dispatched frames, 0 without frames
+ */
+typedef struct {
+    uint32_t window_ms;
+    uint32_t frames_per_s;
+    uint16_t loss_permille;
+    uint16_t crc_permille;
+    uint32_t interarrival_us;
+} data_process_link_t;
+
+/* Fill target from a payload of the registered size. Return 0 to reject the frame */
+typedef uint8_t (*cmd_decode_t)(void* target, const uint8_t* data, uint16_t length);
+
+/**
+ * @struct  data_process_cmd_t
+ * @brief   A registered rx command
+ * @var cmdid       Command ID
+ * @var size        Payload size the command must have
+ * @var target      Where the payload goes
+ * @var decode      Fills target instead of a plain copy, may be NULL
+ * @var updated     Set on every accepted frame, cleared by data_process_is_updated
+ * @var stamp_ms    HAL tick of the last accepted frame
+ */
+typedef struct {
+    uint16_t            cmdid;
+    uint16_t            size;
+    void                *target;
+    cmd_decode_t        decode;
+    volatile uint8_t    updated;
+    volatile uint32_t   stamp_ms;
+} data_process_cmd_t;
+
+/* Message directions, seen from this board */
+#define DATA_PROCESS_RX     0x01
+#define DATA_PROCESS_TX     0x02
+
+/**
+ * @struct  data_process_msg_t
+ * @brief   A message of a protocol table, located by offset inside the link's aggregate struct
+ * @var cmdid       Command ID
+ * @var direction   DATA_PROCESS_RX, DATA_PROCESS_TX or both
+ * @var offset      Offset of the message struct inside the aggregate
+ * @var size        Payload size
+ * @var decode      Decode callback for rx, may be NULL
+ */
+typedef struct {
+    uint16_t        cmdid;
+    uint8_t         direction;
+    uint16_t        offset;
+    uint16_t        size;
+    cmd_decode_t    decode;
+} data_process_msg_t;
+
 /* Declare data_process_t */
 typedef struct _data_process data_process_t;
 
-/* Define dispatcher_func_t */
-typedef uint8_t (*dispatcher_func_t)(void* target_struct, data_process_t* process_struct);
+/**
+ * Define dispatcher_func_t. Only called for cmdids that are not registered with
+ * data_process_register. The payload is a view into the DMA buffer, or into
+ * the stitch buffer when the frame straddles the end of the DMA buffer. It is
+ * only valid during the call and may be unaligned, so copy out with memcpy.
+ */
+typedef uint8_t (*dispatcher_func_t)(void* target_struct, data_process_t* process_struct, uint16_t cmdid, const uint8_t* data, uint16_t length);
 
 /* Define packer_func_t */
 typedef uint8_t (*packer_func_t)(void* target_struct, data_process_t* process_struct, uint16_t cmdid);
@@ -68,20 +172,38 @@ typedef uint8_t (*packer_func_t)(void* target_struct, data_process_t* process_st
 typedef struct _data_process {
     /* Commonly used */
     UART_HandleTypeDef *huart;  // Which UART data is comming from
-    /* Used for incomming rx msg */
-    fifo_s_t    *data_fifo;     // FIFO to store data into
-    /* Used in buffer_to_fifo */
+    /* Used for incomming rx msg. buff[0] and buff[1] are contiguous, so together they form one ring parsed in place */
     uint8_t     *buff[2];       // Pointer to double buffer
     uint16_t    buff_size;      // Size of single buffer
-    uint16_t    read_index;     // Where we left last time
-    /* Used in fifo_to_struct */
+    uint16_t    read_index;     // Start of the frame being parsed, bytes before it are released
+    uint16_t    scan_index;     // Next byte to feed to the parser
+    data_process_state_t state; // Parser state
+    uint16_t    frame_len;      // Full frame length once the header is accepted
+    uint8_t     crc8;           // Running CRC8 of the header so far
+    uint16_t    crc16;          // Running CRC16 of the frame so far
+    int32_t     next_sof;       // First SOF candidate after read_index in the current frame, -1 if none
+    uint32_t    scan_pos;       // Stream offset of scan_index, counting every byte fed since init
+    uint32_t    frame_pos;      // Stream offset of read_index
+    uint32_t    cut_end;        // Stream offset just past the last frame that failed CRC16 after a good header
+    data_process_stats_t stats; // rx parser counters
+    uint8_t     rx_seq;         // Newest seq received
+    uint8_t     rx_seq_valid;   // rx_seq holds a received seq
+    uint32_t    link_start;     // HAL tick the current link window opened
+    data_process_stats_t link_base; // Counters when the current link window opened
+    data_process_link_t link;   // Link quality of the last closed window
+    data_process_cmd_t cmds[DATA_PROCESS_MAX_CMDS]; // Registered commands, sorted by cmdid
+    uint8_t     cmd_count;      // Number of registered commands
     void        *source_struct; // Used by dispatcher. = target_struct
-    dispatcher_func_t dispatcher_func;  // A dispatcjer function pointer
+    dispatcher_func_t dispatcher_func;  // Fallback for unregistered cmdids, may be NULL
     uint8_t     sof;            // Start of frame
-    uint8_t     *frame_packet;  // Contain one frame of data. Same length as fifo
-    uint16_t    data_len;       // Store the data length got from header
-    /* Used for outgoing tx msg */
-    fifo_s_t    *transmit_fifo; // FIFO to store outgoing msg
+    uint8_t     *stitch;        // DATA_PROCESS_MAX_FRAME_LEN bytes, only used for frames that wrap around the double buffer
+    /* Used for outgoing tx msg. Frames are built in place in an arena per priority class and sent by reference */
+    uart_tx_queue_t tx_queue;   // Async tx engine of the port
+    uint8_t     *tx_arena[UART_TX_PRIORITIES];  // Frame storage, contiguous frames released in sending order
+    uint32_t    tx_arena_size;  // Size of each arena
+    uint8_t     tx_seq;         // seq of the next frame, one counter for the port across priority classes
+    uint32_t    tx_head[UART_TX_PRIORITIES];    // Arena allocation offset, free running
+    volatile uint32_t tx_tail[UART_TX_PRIORITIES];  // Arena release offset, moved by the tx complete interrupt
     packer_func_t packer_func;  // A packer function pointer
 } data_process_t;
 
@@ -89,13 +211,13 @@ typedef struct _data_process {
  * Initialize a data process instance for a UART port
  *
  * @param  huart         Which UART port to process
- * @param  mutex         Mutex to be used by FIFO
- * @param  fifo_size     Size of FIFO
- * @param  buffer_size   Size of DMA buffer
+ * @param  mutex         Unused, rx frames are parsed in place and need no lock
+ * @param  fifo_size     Size of tx frame storage of each priority class, at least DATA_PROCESS_MAX_FRAME_LEN
+ * @param  buffer_size   Size of a single DMA buffer, twice of it must exceed DATA_PROCESS_MAX_FRAME_LEN
  * @param  sof           SOF of UART
- * @param  dispatcher    Function pointer to appropriate dispatcher
+ * @param  dispatcher    Called for cmdids that are not registered, may be NULL
  * @param  source_struct Struct of the source
- * @param  tx_mutex      Mutex to be used by tx FIFO
+ * @param  tx_mutex      Unused, data_to_fifo never blocks and is safe from several tasks
  * @param  packer_func   Function pointer to corresponding packer
  * @return               A data process instance, NULL if failed
  * @author Nickel_Liang
@@ -107,14 +229,15 @@ data_process_t* data_process_init(UART_HandleTypeDef *huart, osMutexId mutex, ui
  * Perform a rx data process sequence
  *
  * @param  source     A valid data process instance
- * @return            1 for success, 0 for failed
+ * @return            1 if any frame is dispatched, 0 otherwise
  * @author Nickel_Liang
  * @date   2018-04-21
  */
 uint8_t data_process_rx(data_process_t* source);
 
 /**
- * Perform a tx data process sequence
+ * Perform a tx data process sequence. Frames are sent as soon as they are queued,
+ * this only restarts a port that was busy with another user when the frame was queued
  *
  * @param  source     A valid data process instance
  * @return            1 for success, 0 for failed
@@ -124,57 +247,181 @@ uint8_t data_process_rx(data_process_t* source);
 uint8_t data_process_tx(data_process_t* source);
 
 /**
- * Convert DMA double buffer to FIFO. This can improve data retrive efficiency
+ * Register a rx command. Its frames are size checked and copied to target without a dispatcher
  *
  * @param  source     A valid data process instance
- * @return            1 for success, 0 for failed
+ * @param  cmdid      Command ID, registering it again replaces the entry
+ * @param  target     Where the payload goes
+ * @param  size       Payload size the command must have, frames of other sizes are dropped
+ * @param  decode     Fills target instead of a plain copy, may be NULL
+ * @return            1 for success, 0 if the table is full
+ * @note   Register before rx starts, the table is not locked against the parser
+ */
+uint8_t data_process_register(data_process_t* source, uint16_t cmdid, void* target, uint16_t size, cmd_decode_t decode);
+
+/**
+ * Register every rx message of a protocol table
+ *
+ * @param  source     A valid data process instance
+ * @param  target     Aggregate struct the table offsets point into
+ * @param  table      Protocol table
+ * @param  count      Number of messages in the table
+ * @return            1 for success, 0 if the command table is full
+ */
+uint8_t data_process_register_table(data_process_t* source, void* target, const data_process_msg_t* table, uint8_t count);
+
+/**
+ * Find the payload of a tx message in a protocol table
+ *
+ * @param  table      Protocol table
+ * @param  count      Number of messages in the table
+ * @param  target     Aggregate struct the table offsets point into
+ * @param  cmdid      Command ID
+ * @param  length     Set to the payload size
+ * @return            The payload inside target, NULL if cmdid is not a tx message of the table
+ */
+uint8_t* data_process_msg_payload(const data_process_msg_t* table, uint8_t count, void* target, uint16_t cmdid, uint16_t* length);
+
+/**
+ * Check whether a registered command got a new frame since the last check, and clear the flag
+ *
+ * @param  source     A valid data process instance
+ * @param  cmdid      Command ID
+ * @return            1 if updated, 0 if not or not registered
+ */
+uint8_t data_process_is_updated(data_process_t* source, uint16_t cmdid);
+
+/**
+ * Time of the last accepted frame of a registered command
+ *
+ * @param  source     A valid data process instance
+ * @param  cmdid      Command ID
+ * @return            HAL tick in ms, 0 if never received or not registered
+ */
+uint32_t data_process_stamp(data_process_t* source, uint16_t cmdid);
+
+/**
+ * Get rx link quality of the last closed window
+ *
+ * @param  source     A valid data process instance
+ * @param  link       Filled with the window, rates are zeroed if nothing arrived for the last two windows
+ * @return            1 if the link is alive, 0 if it went quiet
+ */
+uint8_t data_process_link_quality(data_process_t* source, data_process_link_t* link);
+
+/**
+ * Print rx parser counters and link quality of a data process instance
+ *
+ * @param  source     A valid data process instance
+ */
+void print_data_process_stats(data_process_t* source);
+
+/**
+ * Find where DMA will write the next byte in the double buffer
+ *
+ * @param  source     A valid data process instance
+ * @return            Write index in [0, 2 * buff_size)
  * @author Nickel_Liang
  * @date   2018-04-19
  */
-static uint8_t buffer_to_fifo(data_process_t* source);
+static uint16_t buffer_write_index(data_process_t* source);
 
 /**
- * Convert a FIFO to appropriate data structure
+ * Get a contiguous view of bytes in the double buffer, relative to read index
  *
  * @param  source     A valid data process instance
- * @return            1 for success, 0 for failed
+ * @param  offset     First byte, counted from read index
+ * @param  length     Number of bytes, no more than DATA_PROCESS_MAX_FRAME_LEN
+ * @return            Pointer into the DMA buffer, or into the stitch buffer if the bytes wrap around
+ */
+static const uint8_t* buffer_view(data_process_t* source, uint16_t offset, uint16_t length);
+
+/**
+ * Account the seq of a good frame
+ *
+ * @param  source     A valid data process instance
+ * @param  seq        seq byte of the frame header
+ */
+static void sequence_check(data_process_t* source, uint8_t seq);
+
+/**
+ * Close the link window once it is DATA_PROCESS_LINK_WINDOW_MS long
+ *
+ * @param  source     A valid data process instance
+ */
+static void link_update(data_process_t* source);
+
+/**
+ * Binary search the registered commands
+ *
+ * @param  source     A valid data process instance
+ * @param  cmdid      Command ID
+ * @return            The command, NULL if not registered
+ */
+static data_process_cmd_t* data_process_find(data_process_t* source, uint16_t cmdid);
+
+/**
+ * Hand a checked frame to its registered command, or to the dispatcher
+ *
+ * @param  source     A valid data process instance
+ * @param  cmdid      Command ID of the frame
+ * @param  data       Payload view
+ * @param  length     Payload size
+ */
+static void data_process_dispatch(data_process_t* source, uint16_t cmdid, const uint8_t* data, uint16_t length);
+
+/**
+ * Release arena storage of a frame that left. Called from the tx complete interrupt
+ *
+ * @param  context    The data process instance
+ * @param  priority   Class of the frame
+ * @param  data       Frame that left
+ * @param  size       Size of frame
+ */
+static void data_process_tx_done(void* context, uint8_t priority, const uint8_t* data, uint16_t size);
+
+/**
+ * Give up the current frame, and rewind to the next SOF candidate seen inside it if any
+ *
+ * @param  source     A valid data process instance
+ */
+static void buffer_resync(data_process_t* source);
+
+/**
+ * Feed every byte received in the DMA double buffer to the parser, and dispatch complete frames in place.
+ * A partial frame is kept across calls, and hunting never looks at a byte twice.
+ *
+ * @param  source     A valid data process instance
+ * @return            1 if any frame is dispatched, 0 otherwise
  * @author Nickel_Liang
  * @date   2018-04-20
  */
-static uint8_t fifo_to_struct(data_process_t* source);
+static uint8_t buffer_to_struct(data_process_t* source);
 
 /**
- * Convert a data stream to FIFO
+ * Convert a data stream to a frame and queue it for async transmit. Never blocks
  *
  * @param  cmdid      Message CMDID
- * @param  data       Data stream
+ * @param  data       Data stream, copied into the frame
  * @param  length     length of data
  * @param  source     A valid data process structure
- * @return            1 for success, 0 for failed
+ * @return            1 for success, 0 if the queue or frame storage is full
  * @author Nickel_Liang
  * @date   2018-05-26
  */
 uint8_t data_to_fifo(uint16_t cmdid, uint8_t *data, uint16_t length, data_process_t *source);
 
 /**
- * Process a data header and perform CRC8 check
- *
- * @param  source     A valid data process instance
- * @return            1 for success, 0 for failed
- * @author Nickel_Liang
- * @date   2018-04-21
- */
-static uint8_t process_header(data_process_t* source);
-
-/**
- * Process a data frame and perfrom CRC16 check
+ * data_to_fifo in a chosen priority class. Urgent frames go out before queued normal ones
  *
- * @param  source     A valid data process instance
- * @return            1 for success, 0 for failed
- * @author Nickel_Liang
- * @date   2018-04-21
+ * @param  cmdid      Message CMDID
+ * @param  data       Data stream, copied into the frame
+ * @param  length     length of data
+ * @param  source     A valid data process structure
+ * @param  priority   UART_TX_NORMAL or UART_TX_URGENT
+ * @return            1 for success, 0 if the queue or frame storage is full
  */
-static uint8_t process_frame(data_process_t* source);
+uint8_t data_to_fifo_priority(uint16_t cmdid, uint8_t *data, uint16_t length, data_process_t *source, uint8_t priority);
 
 /** @} */
 
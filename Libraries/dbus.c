@@ -25,6 +25,7 @@
  */
 
 #include "dbus.h"
+#include "bsp_trace.h"
 
 /* DMA buffer of raw data. Local var. */
 uint8_t dbus_rx_buffer[DBUS_BUF_LEN];
@@ -121,6 +122,7 @@ void uart_dbus_callback(void) {
     if ((BSP_DBUS_MAX_LEN - dma_current_data_counter(BSP_DBUS_PORT.hdmarx->Instance)) == DBUS_BUF_LEN) {
         /* @todo Consider add signal handling here? */
         dbus_data_process(dbus_rx_buffer, dbus_get_struct());
+        TRACE_POINT(TRACE_DBUS_FRAME);
         /* @todo Add offline detection for dbus */
     }
     /* Exit critical section here */
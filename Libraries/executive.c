@@ -0,0 +1,215 @@
+/**************************************************************************
+ *  Copyright (C) 2018 
+ *  Illini RoboMaster @ University of Illinois at Urbana-Champaign.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#include "executive.h"
+
+static exec_job_t           exec_jobs[EXEC_MAX_JOBS];
+static uint8_t              exec_job_count;
+static exec_stats_t         exec_stats;
+static exec_mode_t          exec_mode;
+static TIM_HandleTypeDef    *exec_htim;
+static osThreadId           exec_thread;
+static uint32_t             exec_tick_cycles;
+
+static volatile uint8_t     exec_running;
+static volatile uint8_t     exec_busy;
+static volatile uint32_t    exec_release_tick;
+static volatile uint32_t    exec_release_cycles;
+
+static inline uint8_t job_is_due(exec_job_t *job, uint32_t tick) {
+    return (tick % job->period) == job->phase;
+}
+
+static void reset_job_stats(exec_job_t *job) {
+    job->run_count      = 0;
+    job->exec_last      = 0;
+    job->exec_min       = UINT32_MAX;
+    job->exec_max       = 0;
+    job->exec_total     = 0;
+    job->jitter_max     = 0;
+    job->deadline_miss  = 0;
+    job->overrun        = 0;
+}
+
+static void executive_dispatch(uint32_t tick, uint32_t release) {
+    uint32_t start, end = release;
+
+    for (uint8_t i = 0; i < exec_job_count; ++i) {
+        exec_job_t *job = &exec_jobs[i];
+        if (!job_is_due(job, tick))
+            continue;
+
+        start = dwt_get_cycles();
+        job->func(job->arg);
+        end = dwt_get_cycles();
+
+        job->exec_last = end - start;
+        job->exec_total += job->exec_last;
+        job->run_count++;
+        if (job->exec_last < job->exec_min)
+            job->exec_min = job->exec_last;
+        if (job->exec_last > job->exec_max)
+            job->exec_max = job->exec_last;
+        if (start - release > job->jitter_max)
+            job->jitter_max = start - release;
+        if (end - release > job->deadline)
+            job->deadline_miss++;
+    }
+
+    if (end - release > exec_stats.frame_max)
+        exec_stats.frame_max = end - release;
+    if (end - release > exec_tick_cycles)
+        exec_stats.frame_overrun++;
+}
+
+static void executive_task(void const *argument) {
+    osEvent event;
+    while (1) {
+        event = osSignalWait(EXEC_SIGNAL, osWaitForever);
+        if (event.status != osEventSignal)
+            continue;
+        executive_dispatch(exec_release_tick, exec_release_cycles);
+        exec_busy = 0;
+    }
+}
+
+uint8_t executive_init(TIM_HandleTypeDef *htim, exec_mode_t mode) {
+    if (htim == NULL) {
+        bsp_error_handler(__FUNCTION__, __LINE__, "Invalid timer.");
+        return 0;
+    }
+    exec_htim           = htim;
+    exec_mode           = mode;
+    exec_job_count      = 0;
+    exec_running        = 0;
+    exec_busy           = 0;
+    exec_tick_cycles    = dwt_us_to_cycles(1000000 / EXEC_TICK_HZ);
+    executive_reset_stats();
+
+    if (mode == EXEC_MODE_RTOS) {
+        osThreadDef(executive, executive_task, osPriorityRealtime, 0, EXEC_TASK_STACK);
+        exec_thread = osThreadCreate(osThread(executive), NULL);
+        if (exec_thread == NULL) {
+            bsp_error_handler(__FUNCTION__, __LINE__, "Unable to create executive task.");
+            return 0;
+        }
+    }
+    return 1;
+}
+
+exec_job_t *executive_add_job(const char *name, exec_job_func_t func, void *arg, uint16_t rate_hz, uint16_t phase) {
+    if (func == NULL || rate_hz == 0 || rate_hz > EXEC_TICK_HZ || EXEC_TICK_HZ % rate_hz != 0) {
+        bsp_error_handler(__FUNCTION__, __LINE__, "Invalid job rate.");
+        return NULL;
+    }
+    if (exec_job_count >= EXEC_MAX_JOBS) {
+        bsp_error_handler(__FUNCTION__, __LINE__, "Too many jobs.");
+        return NULL;
+    }
+    if (exec_running) {
+        bsp_error_handler(__FUNCTION__, __LINE__, "Cannot add job while executive is running.");
+        return NULL;
+    }
+
+    exec_job_t *job = &exec_jobs[exec_job_count];
+    job->name       = name;
+    job->func       = func;
+    job->arg        = arg;
+    job->period     = EXEC_TICK_HZ / rate_hz;
+    job->phase      = phase % job->period;
+    job->deadline   = dwt_us_to_cycles(1000000 / rate_hz);
+    reset_job_stats(job);
+    exec_job_count++;
+    return job;
+}
+
+void executive_set_deadline(exec_job_t *job, uint32_t deadline_us) {
+    job->deadline = dwt_us_to_cycles(deadline_us);
+}
+
+uint8_t executive_start(void) {
+    exec_running = 1;
+    if (HAL_TIM_Base_Start_IT(exec_htim) != HAL_OK) {
+        exec_running = 0;
+        bsp_error_handler(__FUNCTION__, __LINE__, "Unable to start executive timer.");
+        return 0;
+    }
+    return 1;
+}
+
+void executive_stop(void) {
+    HAL_TIM_Base_Stop_IT(exec_htim);
+    exec_running = 0;
+}
+
+void executive_timer_callback(TIM_HandleTypeDef *htim) {
+    if (htim != exec_htim || !exec_running)
+        return;
+
+    uint32_t release = dwt_get_cycles();
+    uint32_t tick    = exec_stats.tick++;
+    /* Keep the extended microsecond clock alive across CYCCNT wrap */
+    dwt_get_us();
+
+    if (exec_busy) {
+        /* Previous frame still running in the executive task. Drop this tick. */
+        exec_stats.tick_dropped++;
+        for (uint8_t i = 0; i < exec_job_count; ++i)
+            if (job_is_due(&exec_jobs[i], tick))
+                exec_jobs[i].overrun++;
+        return;
+    }
+
+    exec_busy = 1;
+    if (exec_mode == EXEC_MODE_ISR) {
+        executive_dispatch(tick, release);
+        exec_busy = 0;
+    }
+    else {
+        exec_release_tick   = tick;
+        exec_release_cycles = release;
+        osSignalSet(exec_thread, EXEC_SIGNAL);
+    }
+}
+
+exec_stats_t *executive_get_stats(void) {
+    return &exec_stats;
+}
+
+void executive_reset_stats(void) {
+    exec_stats.frame_max     = 0;
+    exec_stats.frame_overrun = 0;
+    exec_stats.tick_dropped  = 0;
+    for (uint8_t i = 0; i < exec_job_count; ++i)
+        reset_job_stats(&exec_jobs[i]);
+}
+
+void executive_print_stats(void) {
+    print("[EXEC] tick %u dropped %u frame overrun %u frame max %uus\r\n",
+            exec_stats.tick, exec_stats.tick_dropped, exec_stats.frame_overrun,
+            dwt_cycles_to_us(exec_stats.frame_max));
+    for (uint8_t i = 0; i < exec_job_count; ++i) {
+        exec_job_t *job = &exec_jobs[i];
+        uint32_t avg = job->run_count ? (uint32_t)(job->exec_total / job->run_count) : 0;
+        print("%-10s %4uHz runs %u exec min/avg/max %u/%u/%uus jitter %uus miss %u overrun %u\r\n",
+                job->name, EXEC_TICK_HZ / job->period, job->run_count,
+                dwt_cycles_to_us(job->run_count ? job->exec_min : 0), dwt_cycles_to_us(avg),
+                dwt_cycles_to_us(job->exec_max), dwt_cycles_to_us(job->jitter_max),
+                job->deadline_miss, job->overrun);
+    }
+}
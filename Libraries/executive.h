@@ -0,0 +1,166 @@
+/**************************************************************************
+ *  Copyright (C) 2018 
+ *  Illini RoboMaster @ University of Illinois at Urbana-Champaign.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#ifndef _EXECUTIVE_H_
+#define _EXECUTIVE_H_
+
+#include "stm32f4xx_hal.h"
+#include "cmsis_os.h"
+#include "tim.h"
+#include "bsp_dwt.h"
+#include "bsp_error_handler.h"
+#include "bsp_print.h"
+
+/**
+ * @ingroup library
+ * @defgroup executive Executive
+ * @{
+ */
+
+#define EXEC_TICK_HZ        1000    // base rate of the hardware timer driving the executive
+#define EXEC_MAX_JOBS       12      // maximum number of registered jobs
+#define EXEC_SIGNAL         0x0001  // signal used to release the executive task in RTOS mode
+#define EXEC_TASK_STACK     512     // executive task stack size in words
+
+/**
+ * @enum exec_mode_t
+ * @brief where registered jobs are executed
+ * @var EXEC_MODE_ISR   jobs run directly in the timer interrupt (bare-metal)
+ * @var EXEC_MODE_RTOS  the timer interrupt releases a realtime FreeRTOS task
+ */
+typedef enum {
+    EXEC_MODE_ISR,
+    EXEC_MODE_RTOS,
+}   exec_mode_t;
+
+typedef void (*exec_job_func_t)(void *arg);
+
+/**
+ * @struct exec_job_t
+ * @brief a periodic job and its timing statistics (all times in cycles)
+ * @var name            job name used in reports
+ * @var func            job body
+ * @var arg             argument passed to the job body
+ * @var period          period in executive ticks
+ * @var phase           tick offset inside the period at which the job is released
+ * @var deadline        relative deadline counted from release
+ * @var run_count       number of completed runs
+ * @var exec_last       execution time of the latest run
+ * @var exec_min        minimum execution time
+ * @var exec_max        maximum execution time
+ * @var exec_total      accumulated execution time
+ * @var jitter_max      maximum delay between release and start
+ * @var deadline_miss   number of runs that completed after their deadline
+ * @var overrun         number of releases dropped because the executive was still busy
+ */
+typedef struct {
+    const char      *name;
+    exec_job_func_t func;
+    void            *arg;
+    uint16_t        period;
+    uint16_t        phase;
+    uint32_t        deadline;
+
+    uint32_t        run_count;
+    uint32_t        exec_last;
+    uint32_t        exec_min;
+    uint32_t        exec_max;
+    uint64_t        exec_total;
+    uint32_t        jitter_max;
+    uint32_t        deadline_miss;
+    uint32_t        overrun;
+}   exec_job_t;
+
+/**
+ * @struct exec_stats_t
+ * @brief executive wide statistics
+ * @var tick            executive ticks since start
+ * @var frame_max       longest frame (all due jobs of one tick) in cycles
+ * @var frame_overrun   number of frames that ran past the next tick
+ * @var tick_dropped    number of ticks dropped because the previous frame was still running
+ */
+typedef struct {
+    uint32_t    tick;
+    uint32_t    frame_max;
+    uint32_t    frame_overrun;
+    uint32_t    tick_dropped;
+}   exec_stats_t;
+
+/**
+ * @brief initialize the executive and bind it to a hardware timer
+ * @param htim  timer configured (in CubeMX) to overflow at EXEC_TICK_HZ
+ * @param mode  run jobs in the timer ISR or in a realtime task
+ * @return 1 for success, 0 for failed
+ * @note jobs should be registered before executive_start
+ */
+uint8_t executive_init(TIM_HandleTypeDef *htim, exec_mode_t mode);
+
+/**
+ * @brief register a periodic job. Jobs due in the same tick run in registration order.
+ * @param name      job name used in reports
+ * @param func      job body
+ * @param arg       argument passed to the job body
+ * @param rate_hz   job rate; EXEC_TICK_HZ must be a multiple of it
+ * @param phase     tick offset inside the period [0, period)
+ * @return registered job, NULL if failed
+ */
+exec_job_t *executive_add_job(const char *name, exec_job_func_t func, void *arg, uint16_t rate_hz, uint16_t phase);
+
+/**
+ * @brief override the relative deadline of a job (defaults to its period)
+ * @param job           registered job
+ * @param deadline_us   deadline in microseconds counted from release
+ */
+void executive_set_deadline(exec_job_t *job, uint32_t deadline_us);
+
+/**
+ * @brief start the hardware timer and begin releasing jobs
+ * @return 1 for success, 0 for failed
+ */
+uint8_t executive_start(void);
+
+/**
+ * @brief stop releasing jobs
+ */
+void executive_stop(void);
+
+/**
+ * @brief executive tick handler. Call from HAL_TIM_PeriodElapsedCallback.
+ * @param htim  timer that elapsed
+ */
+void executive_timer_callback(TIM_HandleTypeDef *htim);
+
+/**
+ * @brief get executive wide statistics
+ * @return pointer to the statistics
+ */
+exec_stats_t *executive_get_stats(void);
+
+/**
+ * @brief reset all job and executive statistics
+ */
+void executive_reset_stats(void);
+
+/**
+ * @brief print timing statistics of every job
+ */
+void executive_print_stats(void);
+
+/** @} */
+
+#endif
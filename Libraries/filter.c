@@ -0,0 +1,115 @@
+/**************************************************************************
+ *  Copyright (C) 2018 
+ *  Illini RoboMaster @ University of Illinois at Urbana-Champaign.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#include "filter.h"
+
+#define FILTER_PI   3.14159265f
+
+static int32_t filter_sat32(int64_t x) {
+    if (x > INT32_MAX)
+        return INT32_MAX;
+    if (x < INT32_MIN)
+        return INT32_MIN;
+    return (int32_t)x;
+}
+
+static int32_t filter_to_q30(float x) {
+    return (int32_t)lrintf(x * (float)(1 << FILTER_Q31_SHIFT));
+}
+
+void biquad_lowpass(biquad_t *bq, float fs, float fc, float q) {
+    float w0    = 2.0f * FILTER_PI * fc / fs;
+    float cosw  = cosf(w0);
+    float alpha = sinf(w0) / (2.0f * q);
+    float a0_r  = 1.0f / (1.0f + alpha);
+    bq->b0 = (1.0f - cosw) * 0.5f * a0_r;
+    bq->b1 = (1.0f - cosw) * a0_r;
+    bq->b2 = bq->b0;
+    bq->a1 = -2.0f * cosw * a0_r;
+    bq->a2 = (1.0f - alpha) * a0_r;
+}
+
+void biquad_notch(biquad_t *bq, float fs, float f0, float q) {
+    float w0    = 2.0f * FILTER_PI * f0 / fs;
+    float cosw  = cosf(w0);
+    float alpha = sinf(w0) / (2.0f * q);
+    float a0_r  = 1.0f / (1.0f + alpha);
+    bq->b0 = a0_r;
+    bq->b1 = -2.0f * cosw * a0_r;
+    bq->b2 = a0_r;
+    bq->a1 = bq->b1;
+    bq->a2 = (1.0f - alpha) * a0_r;
+}
+
+void biquad_bypass(biquad_t *bq) {
+    bq->b0 = 1.0f;
+    bq->b1 = bq->b2 = bq->a1 = bq->a2 = 0;
+}
+
+void biquad_reset(biquad_t *bq) {
+    bq->z1 = bq->z2 = 0;
+}
+
+void biquad_cascade_init(biquad_cascade_t *cascade, uint8_t stages) {
+    if (stages > FILTER_MAX_STAGES)
+        stages = FILTER_MAX_STAGES;
+    cascade->stages = stages;
+    for (int i = 0; i < FILTER_MAX_STAGES; ++i) {
+        biquad_bypass(&cascade->stage[i]);
+        biquad_reset(&cascade->stage[i]);
+    }
+}
+
+void biquad_cascade_reset(biquad_cascade_t *cascade) {
+    for (int i = 0; i < cascade->stages; ++i)
+        biquad_reset(&cascade->stage[i]);
+}
+
+float biquad_cascade_step(biquad_cascade_t *cascade, float x) {
+    for (int i = 0; i < cascade->stages; ++i)
+        x = biquad_step(&cascade->stage[i], x);
+    return x;
+}
+
+void biquad_to_q31(const biquad_t *bq, biquad_q31_t *out) {
+    out->b0 = filter_to_q30(bq->b0);
+    out->b1 = filter_to_q30(bq->b1);
+    out->b2 = filter_to_q30(bq->b2);
+    out->a1 = filter_to_q30(bq->a1);
+    out->a2 = filter_to_q30(bq->a2);
+    out->z1 = out->z2 = 0;
+}
+
+int32_t biquad_q31_step(biquad_q31_t *bq, int32_t x) {
+    int32_t y = filter_sat32((((int64_t)bq->b0 * x) >> FILTER_Q31_SHIFT) + bq->z1);
+    bq->z1 = filter_sat32((((int64_t)bq->b1 * x - (int64_t)bq->a1 * y) >> FILTER_Q31_SHIFT) + bq->z2);
+    bq->z2 = filter_sat32(((int64_t)bq->b2 * x - (int64_t)bq->a2 * y) >> FILTER_Q31_SHIFT);
+    return y;
+}
+
+void biquad_cascade_to_q31(const biquad_cascade_t *cascade, biquad_cascade_q31_t *out) {
+    out->stages = cascade->stages;
+    for (int i = 0; i < cascade->stages; ++i)
+        biquad_to_q31(&cascade->stage[i], &out->stage[i]);
+}
+
+int32_t biquad_cascade_q31_step(biquad_cascade_q31_t *cascade, int32_t x) {
+    for (int i = 0; i < cascade->stages; ++i)
+        x = biquad_q31_step(&cascade->stage[i], x);
+    return x;
+}
@@ -0,0 +1,175 @@
+/**************************************************************************
+ *  Copyright (C) 2018 
+ *  Illini RoboMaster @ University of Illinois at Urbana-Champaign.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#ifndef _FILTER_H_
+#define _FILTER_H_
+
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+/**
+ * @ingroup library
+ * @defgroup filter Filter
+ * @{
+ */
+
+#define FILTER_MAX_STAGES   4           // biquads per cascade
+#define FILTER_Q31_SHIFT    30          // Q31 coefficients are stored as Q30 so |a1| < 2 fits
+#define FILTER_Q_BUTTER     0.7071068f  // Q of a second order Butterworth section
+
+/**
+ * @struct biquad_t
+ * @brief second order section in direct form II transposed, a0 normalized to 1
+ * @var b0, b1, b2  feed forward coefficients
+ * @var a1, a2      feedback coefficients
+ * @var z1, z2      state
+ */
+typedef struct {
+    float       b0, b1, b2;
+    float       a1, a2;
+    float       z1, z2;
+}   biquad_t;
+
+/**
+ * @struct biquad_q31_t
+ * @brief fixed point biquad, coefficients in Q30 and state in the signal format
+ */
+typedef struct {
+    int32_t     b0, b1, b2;
+    int32_t     a1, a2;
+    int32_t     z1, z2;
+}   biquad_q31_t;
+
+/**
+ * @struct biquad_cascade_t
+ * @brief biquads run in series
+ * @var stages  sections in use
+ * @var stage   sections, stage[0] sees the input first
+ */
+typedef struct {
+    uint8_t     stages;
+    biquad_t    stage[FILTER_MAX_STAGES];
+}   biquad_cascade_t;
+
+/**
+ * @struct biquad_cascade_q31_t
+ * @brief fixed point biquads run in series
+ */
+typedef struct {
+    uint8_t         stages;
+    biquad_q31_t    stage[FILTER_MAX_STAGES];
+}   biquad_cascade_q31_t;
+
+/**
+ * @brief design a lowpass section (RBJ cookbook), state is kept
+ * @param bq    section
+ * @param fs    sample rate in Hz
+ * @param fc    cutoff frequency in Hz
+ * @param q     quality factor, FILTER_Q_BUTTER for a maximally flat response
+ */
+void biquad_lowpass(biquad_t *bq, float fs, float fc, float q);
+
+/**
+ * @brief design a notch section (RBJ cookbook), state is kept so it can be retuned while running
+ * @param bq    section
+ * @param fs    sample rate in Hz
+ * @param f0    center frequency in Hz
+ * @param q     quality factor, center frequency over -3dB bandwidth
+ */
+void biquad_notch(biquad_t *bq, float fs, float f0, float q);
+
+/**
+ * @brief make a section pass its input through unchanged
+ * @param bq    section
+ */
+void biquad_bypass(biquad_t *bq);
+
+/**
+ * @brief clear the state of a section
+ * @param bq    section
+ */
+void biquad_reset(biquad_t *bq);
+
+/**
+ * @brief run one sample through a section
+ * @param bq    section
+ * @param x     input sample
+ * @return filtered sample
+ */
+static inline float biquad_step(biquad_t *bq, float x) {
+    float y = bq->b0 * x + bq->z1;
+    bq->z1  = bq->b1 * x - bq->a1 * y + bq->z2;
+    bq->z2  = bq->b2 * x - bq->a2 * y;
+    return y;
+}
+
+/**
+ * @brief set up an empty cascade
+ * @param cascade   cascade to initialize
+ * @param stages    sections in use, up to FILTER_MAX_STAGES
+ */
+void biquad_cascade_init(biquad_cascade_t *cascade, uint8_t stages);
+
+/**
+ * @brief clear the state of every section
+ * @param cascade   cascade
+ */
+void biquad_cascade_reset(biquad_cascade_t *cascade);
+
+/**
+ * @brief run one sample through all sections
+ * @param cascade   cascade
+ * @param x         input sample
+ * @return filtered sample
+ */
+float biquad_cascade_step(biquad_cascade_t *cascade, float x);
+
+/**
+ * @brief convert a float section to fixed point, state is cleared
+ * @param bq    float section
+ * @param out   fixed point section
+ */
+void biquad_to_q31(const biquad_t *bq, biquad_q31_t *out);
+
+/**
+ * @brief run one sample through a fixed point section
+ * @param bq    section
+ * @param x     input sample, leave headroom for the filter gain
+ * @return filtered sample, saturated
+ */
+int32_t biquad_q31_step(biquad_q31_t *bq, int32_t x);
+
+/**
+ * @brief convert every section of a float cascade to fixed point
+ * @param cascade   float cascade
+ * @param out       fixed point cascade
+ */
+void biquad_cascade_to_q31(const biquad_cascade_t *cascade, biquad_cascade_q31_t *out);
+
+/**
+ * @brief run one sample through all fixed point sections
+ * @param cascade   cascade
+ * @param x         input sample
+ * @return filtered sample
+ */
+int32_t biquad_cascade_q31_step(biquad_cascade_q31_t *cascade, int32_t x);
+
+/** @} */
+
+#endif
@@ -20,6 +20,7 @@
 #include "imu_onboard.h"
 #include "motor.h"
 #include "utils.h"
+#include <string.h>
 
 void gimbal_init(gimbal_t *my_gimbal) {
     /* Init Yaw */
@@ -51,6 +52,10 @@ void gimbal_init(gimbal_t *my_gimbal) {
 #endif
     /* Init Camera Pitch */
     // not implemented yet
+#if GIMBAL_USE_ESTIMATOR == ON
+    gimbal_est_init(&my_gimbal->est, INIT_MIDDLE_YAW, INIT_MIDDLE_PITCH);
+    my_gimbal->est_us = dwt_get_us();
+#endif
 }
 
 void gimbal_kill(gimbal_t *my_gimbal) {
@@ -85,9 +90,36 @@ void gimbal_remote_move(gimbal_t *my_gimbal, dbus_t *rc, int32_t observed_abs_ya
 }
 
 void gimbal_update(gimbal_t *my_gimbal) {
-    //get_motor_data(my_gimbal->pitch->motor);
+#if GIMBAL_USE_ESTIMATOR == ON
+    get_motor_data(my_gimbal->pitch->motor);
+#endif
     get_motor_data(my_gimbal->yaw->motor);
     //get_motor_data(my_gimbal->camera_pitch->motor);
+#if GIMBAL_USE_ESTIMATOR == ON
+    // the profiler clock may be off, dwt_get_us starts the counter itself
+    uint32_t now = dwt_get_us();
+    float dt = (now - my_gimbal->est_us) * 1e-6f;
+    my_gimbal->est_us = now;
+    float q[4];
+    float gyro[3] = {(imuBoard.my_raw_imu.gyro.x - imuBoard.angle_zero_bias[IMU_X]) * DEG_2_RAD,
+                     (imuBoard.my_raw_imu.gyro.y - imuBoard.angle_zero_bias[IMU_Y]) * DEG_2_RAD,
+                     (imuBoard.my_raw_imu.gyro.z - imuBoard.angle_zero_bias[IMU_Z]) * DEG_2_RAD};
+#if IMU_USE_AHRS == ON
+    memcpy(q, imuBoard.ahrs.q, sizeof(q));
+#else
+    gimbal_est_euler_to_quat(imuBoard.angle, q);
+#endif
+    gimbal_est_update(&my_gimbal->est, q, gyro, get_motor_angle(my_gimbal->yaw->motor),
+                      get_motor_angle(my_gimbal->pitch->motor), dt);
+#endif
+}
+
+int32_t gimbal_get_abs_yaw(gimbal_t *my_gimbal) {
+#if GIMBAL_USE_ESTIMATOR == ON
+    return (int32_t)(my_gimbal->est.euler[2] * DEG_2_MOTOR);
+#else
+    return (int32_t)(imuBoard.angle[YAW] * DEG_2_MOTOR);
+#endif
 }
 
 void yaw_ramp_ctl(gimbal_t *my_gimbal, int32_t delta_ang, uint16_t step_size) {
@@ -23,6 +23,7 @@
 #include "motor.h"
 #include "dbus.h"
 #include "lib_config.h"
+#include "gimbal_estimator.h"
 
 /**
  * @ingroup library
@@ -30,6 +31,8 @@
  * @{
  */
 
+#define GIMBAL_USE_ESTIMATOR    OFF // ON: fuse chassis IMU with gimbal encoders for world frame feedback
+
 typedef struct {
     float pitch_ang;            // pitch err intergrated based on mouse input
     float yaw_ang;              // yaw error integrated from mouse movement
@@ -37,6 +40,8 @@ typedef struct {
     int16_t yaw_middle;         // a pre-determined value for yaw motor
     pid_ctl_t *yaw;             // yaw motor pid
     pid_ctl_t *camera_pitch;    // camera pitch motor pid
+    gimbal_est_t est;           // world frame gimbal attitude, valid when GIMBAL_USE_ESTIMATOR is ON
+    uint32_t est_us;            // dwt_get_us() at the previous estimator step
 } gimbal_t;
 
 /**
@@ -46,6 +51,14 @@ typedef struct {
  */
 void gimbal_update(gimbal_t *my_gimbal);
 
+/**
+ * Absolute yaw of the gimbal from the estimator, latency compensated
+ * @brief
+ * @param my_gimbal my gimbal object
+ * @return yaw with respect to the ground in motor units, suitable as observed_abs_yaw
+ */
+int32_t gimbal_get_abs_yaw(gimbal_t *my_gimbal);
+
 /**
  * Initialize gimbal motors
  * @brief
@@ -0,0 +1,139 @@
+/**************************************************************************
+ *  Copyright (C) 2018 
+ *  Illini RoboMaster @ University of Illinois at Urbana-Champaign.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#include "gimbal_estimator.h"
+#include <string.h>
+
+#define GIMBAL_EST_RAD_2_DEG    57.29578f
+#define GIMBAL_EST_DEG_2_RAD    0.01745329f
+
+static void gimbal_quat_mul(const float a[4], const float b[4], float out[4]) {
+    out[0] = a[0] * b[0] - a[1] * b[1] - a[2] * b[2] - a[3] * b[3];
+    out[1] = a[0] * b[1] + a[1] * b[0] + a[2] * b[3] - a[3] * b[2];
+    out[2] = a[0] * b[2] - a[1] * b[3] + a[2] * b[0] + a[3] * b[1];
+    out[3] = a[0] * b[3] + a[1] * b[2] - a[2] * b[1] + a[3] * b[0];
+}
+
+/* Rotate a body frame vector into the frame q maps to */
+static void gimbal_quat_rotate(const float q[4], const float v[3], float out[3]) {
+    float w = q[0], x = q[1], y = q[2], z = q[3];
+    out[0] = (1 - 2 * (y * y + z * z)) * v[0] + 2 * (x * y - w * z) * v[1] + 2 * (x * z + w * y) * v[2];
+    out[1] = 2 * (x * y + w * z) * v[0] + (1 - 2 * (x * x + z * z)) * v[1] + 2 * (y * z - w * x) * v[2];
+    out[2] = 2 * (x * z - w * y) * v[0] + 2 * (y * z + w * x) * v[1] + (1 - 2 * (x * x + y * y)) * v[2];
+}
+
+/* Propagate q by a constant body rate for t seconds */
+static void gimbal_quat_integrate(const float q[4], const float rate[3], float t, float out[4]) {
+    float norm = sqrtf(rate[0] * rate[0] + rate[1] * rate[1] + rate[2] * rate[2]);
+    float half = 0.5f * norm * t;
+    float s    = norm > 1e-6f ? sinf(half) / norm : 0.5f * t;
+    float dq[4] = {cosf(half), rate[0] * s, rate[1] * s, rate[2] * s};
+    gimbal_quat_mul(q, dq, out);
+}
+
+static void gimbal_joint_update(gimbal_joint_t *joint, int16_t raw, int16_t zero, float dt) {
+    if (!joint->init) {
+        joint->meas     = clip(raw - zero, ANGLE_RANGE_DJI) * MOTOR_2_RAD;
+        joint->angle    = joint->meas;
+        joint->rate     = 0;
+        joint->last_raw = raw;
+        joint->init     = 1;
+        return;
+    }
+    /* encoders wrap every turn, the measured angle does not */
+    joint->meas    += clip(raw - joint->last_raw, ANGLE_RANGE_DJI) * MOTOR_2_RAD;
+    joint->last_raw = raw;
+    float pred = joint->angle + joint->rate * dt;
+    float res  = joint->meas - pred;
+    joint->angle = pred + GIMBAL_EST_ALPHA * res;
+    if (dt > 0)
+        joint->rate += GIMBAL_EST_BETA * res / dt;
+}
+
+void gimbal_est_init(gimbal_est_t *est, int16_t yaw_zero, int16_t pitch_zero) {
+    memset(est, 0, sizeof(gimbal_est_t));
+    est->yaw_zero   = yaw_zero;
+    est->pitch_zero = pitch_zero;
+    est->q[0]       = 1.0f;
+    est->q_pred[0]  = 1.0f;
+    gimbal_est_set_latency(est, GIMBAL_EST_IMU_DELAY, GIMBAL_EST_ENC_DELAY, GIMBAL_EST_LEAD);
+}
+
+void gimbal_est_set_latency(gimbal_est_t *est, float imu_delay, float enc_delay, float lead) {
+    est->imu_delay = imu_delay;
+    est->enc_delay = enc_delay;
+    est->lead      = lead;
+}
+
+void gimbal_est_update(gimbal_est_t *est, const float q_chassis[4], const float gyro_chassis[3],
+                       int16_t yaw_enc, int16_t pitch_enc, float dt) {
+    uint32_t start = prof_get_ticks();
+    gimbal_joint_update(&est->yaw, yaw_enc, est->yaw_zero, dt);
+    gimbal_joint_update(&est->pitch, pitch_enc, est->pitch_zero, dt);
+
+    /* bring chassis attitude and joint angles to the same instant */
+    float psi   = est->yaw.angle + est->yaw.rate * est->enc_delay;
+    float theta = est->pitch.angle + est->pitch.rate * est->enc_delay;
+    float qc[4], qcz[4];
+    gimbal_quat_integrate(q_chassis, gyro_chassis, est->imu_delay, qc);
+
+    /* q_gimbal = q_chassis * q_z(psi) * q_y(theta) */
+    float cp = cosf(0.5f * psi), sp = sinf(0.5f * psi);
+    float ct = cosf(0.5f * theta), st = sinf(0.5f * theta);
+    float qz[4] = {cp, 0, 0, sp};
+    float qy[4] = {ct, 0, st, 0};
+    gimbal_quat_mul(qc, qz, qcz);
+    gimbal_quat_mul(qcz, qy, est->q);
+
+    /* gimbal frame rate = Ry' (Rz' w_chassis + psi_dot z) + theta_dot y */
+    float c = cosf(psi), s = sinf(psi);
+    float w1[3] = { c * gyro_chassis[0] + s * gyro_chassis[1],
+                   -s * gyro_chassis[0] + c * gyro_chassis[1],
+                    gyro_chassis[2] + est->yaw.rate};
+    c = cosf(theta);
+    s = sinf(theta);
+    est->rate[0] = c * w1[0] - s * w1[2];
+    est->rate[1] = w1[1] + est->pitch.rate;
+    est->rate[2] = s * w1[0] + c * w1[2];
+    gimbal_quat_rotate(est->q, est->rate, est->rate_world);
+
+    gimbal_quat_integrate(est->q, est->rate, est->lead, est->q_pred);
+    const float *q = est->q_pred;
+    est->euler[0] = atan2f(2 * (q[0] * q[1] + q[2] * q[3]), 1 - 2 * (q[1] * q[1] + q[2] * q[2])) * GIMBAL_EST_RAD_2_DEG;
+    float sinp = 2 * (q[0] * q[2] - q[3] * q[1]);
+    sinp = sinp > 1 ? 1 : (sinp < -1 ? -1 : sinp);
+    est->euler[1] = asinf(sinp) * GIMBAL_EST_RAD_2_DEG;
+    float yaw = atan2f(2 * (q[0] * q[3] + q[1] * q[2]), 1 - 2 * (q[2] * q[2] + q[3] * q[3])) * GIMBAL_EST_RAD_2_DEG;
+    if (yaw - est->yaw_last > 180.0f)
+        est->yaw_turns--;
+    else if (yaw - est->yaw_last < -180.0f)
+        est->yaw_turns++;
+    est->yaw_last = yaw;
+    est->euler[2] = yaw + 360.0f * est->yaw_turns;
+    est->cycles = prof_get_ticks() - start;
+}
+
+void gimbal_est_euler_to_quat(const float euler[3], float q[4]) {
+    float cr = cosf(0.5f * euler[0] * GIMBAL_EST_DEG_2_RAD), sr = sinf(0.5f * euler[0] * GIMBAL_EST_DEG_2_RAD);
+    float cp = cosf(0.5f * euler[1] * GIMBAL_EST_DEG_2_RAD), sp = sinf(0.5f * euler[1] * GIMBAL_EST_DEG_2_RAD);
+    float cy = cosf(0.5f * euler[2] * GIMBAL_EST_DEG_2_RAD), sy = sinf(0.5f * euler[2] * GIMBAL_EST_DEG_2_RAD);
+    q[0] = cr * cp * cy + sr * sp * sy;
+    q[1] = sr * cp * cy - cr * sp * sy;
+    q[2] = cr * sp * cy + sr * cp * sy;
+    q[3] = cr * cp * sy - sr * sp * cy;
+}
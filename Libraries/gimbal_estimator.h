@@ -0,0 +1,131 @@
+/**************************************************************************
+ *  Copyright (C) 2018 
+ *  Illini RoboMaster @ University of Illinois at Urbana-Champaign.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#ifndef _GIMBAL_ESTIMATOR_H_
+#define _GIMBAL_ESTIMATOR_H_
+
+#include <stdint.h>
+#include <math.h>
+#include "motor.h"
+#include "bsp_prof.h"
+
+/**
+ * @ingroup library
+ * @defgroup gimbal_estimator Gimbal Estimator
+ * @{
+ */
+
+#define GIMBAL_EST_ALPHA        0.35f   // encoder tracker position gain
+#define GIMBAL_EST_BETA         0.03f   // encoder tracker rate gain
+#define GIMBAL_EST_IMU_DELAY    0.002f  // s, age of the chassis attitude when it is used
+#define GIMBAL_EST_ENC_DELAY    0.001f  // s, age of the encoder angles from CAN
+#define GIMBAL_EST_LEAD         0.003f  // s, prediction horizon covering output latency
+
+/**
+ * @struct gimbal_joint_t
+ * @brief alpha beta tracker on an unwrapped encoder
+ * @var meas        unwrapped measured angle in rad
+ * @var angle       filtered joint angle in rad
+ * @var rate        joint rate in rad/s
+ * @var last_raw    previous encoder reading
+ * @var init        1 once the first reading was taken
+ */
+typedef struct {
+    float       meas;
+    float       angle;
+    float       rate;
+    int16_t     last_raw;
+    uint8_t     init;
+}   gimbal_joint_t;
+
+/**
+ * @struct gimbal_est_t
+ * @brief world frame gimbal attitude from chassis attitude and joint encoders
+ * @var yaw         yaw joint tracker, about the chassis z axis
+ * @var pitch       pitch joint tracker, about the yawed y axis
+ * @var yaw_zero    yaw encoder reading with the gimbal aligned to the chassis
+ * @var pitch_zero  pitch encoder reading with the gimbal level on the chassis
+ * @var imu_delay   chassis attitude age compensated, s
+ * @var enc_delay   encoder age compensated, s
+ * @var lead        prediction horizon, s
+ * @var q           gimbal attitude now (w, x, y, z), gimbal to world
+ * @var q_pred      gimbal attitude predicted lead seconds ahead
+ * @var rate        gimbal angular rate in the gimbal frame, rad/s
+ * @var rate_world  gimbal angular rate in the world frame, rad/s
+ * @var euler       roll, pitch, unwrapped yaw of q_pred in degrees
+ * @var yaw_last    last wrapped yaw, used to unwrap
+ * @var yaw_turns   full turns of the unwrapped yaw
+ * @var cycles      profiler ticks spent in the latest update
+ */
+typedef struct {
+    gimbal_joint_t  yaw;
+    gimbal_joint_t  pitch;
+    int16_t         yaw_zero;
+    int16_t         pitch_zero;
+    float           imu_delay;
+    float           enc_delay;
+    float           lead;
+    float           q[4];
+    float           q_pred[4];
+    float           rate[3];
+    float           rate_world[3];
+    float           euler[3];
+    float           yaw_last;
+    int32_t         yaw_turns;
+    uint32_t        cycles;
+}   gimbal_est_t;
+
+/**
+ * @brief initialize an estimator with the default latencies
+ * @param est           estimator
+ * @param yaw_zero      yaw encoder reading with the gimbal aligned to the chassis
+ * @param pitch_zero    pitch encoder reading with the gimbal level on the chassis
+ */
+void gimbal_est_init(gimbal_est_t *est, int16_t yaw_zero, int16_t pitch_zero);
+
+/**
+ * @brief set latency compensation
+ * @param est       estimator
+ * @param imu_delay age of the chassis attitude in s
+ * @param enc_delay age of the encoder readings in s
+ * @param lead      prediction horizon in s, typically control period plus actuation delay
+ */
+void gimbal_est_set_latency(gimbal_est_t *est, float imu_delay, float enc_delay, float lead);
+
+/**
+ * @brief run one estimator step at the control rate
+ * @param est           estimator
+ * @param q_chassis     chassis attitude quaternion (w, x, y, z), chassis to world
+ * @param gyro_chassis  bias corrected chassis angular rate in rad/s
+ * @param yaw_enc       yaw motor encoder reading
+ * @param pitch_enc     pitch motor encoder reading
+ * @param dt            time since the previous step in s
+ */
+void gimbal_est_update(gimbal_est_t *est, const float q_chassis[4], const float gyro_chassis[3],
+                       int16_t yaw_enc, int16_t pitch_enc, float dt);
+
+/**
+ * @brief chassis quaternion from roll, pitch, yaw in degrees (z y x order)
+ * @param euler roll, pitch, yaw in degrees
+ * @param q     output quaternion (w, x, y, z)
+ */
+void gimbal_est_euler_to_quat(const float euler[3], float q[4]);
+
+/** @} */
+
+#endif
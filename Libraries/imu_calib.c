@@ -0,0 +1,145 @@
+/**************************************************************************
+ *  Copyright (C) 2018 
+ *  Illini RoboMaster @ University of Illinois at Urbana-Champaign.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#include "imu_calib.h"
+
+#define IMU_CALIB_SLOT_ADDR(slot)   (BSP_FLASH_DATA_ADDR + (slot) * IMU_CALIB_SLOT)
+
+static uint32_t imu_calib_next_slot = IMU_CALIB_SLOTS + 1;  // unknown until scanned
+static uint32_t imu_calib_last_seq;
+
+static uint8_t imu_calib_valid(const imu_calib_t *calib) {
+    return calib->magic == IMU_CALIB_MAGIC
+        && calib->version == IMU_CALIB_VERSION
+        && calib->length == sizeof(imu_calib_t)
+        && verify_crc16_check_sum((uint8_t*)calib, sizeof(imu_calib_t));
+}
+
+/* Records are appended in order, so the first erased slot ends the scan */
+static const imu_calib_t *imu_calib_scan(void) {
+    const imu_calib_t *newest = NULL;
+    imu_calib_next_slot = IMU_CALIB_SLOTS;
+    for (uint32_t slot = 0; slot < IMU_CALIB_SLOTS; ++slot) {
+        const imu_calib_t *calib = (const imu_calib_t*)IMU_CALIB_SLOT_ADDR(slot);
+        if (calib->magic == 0xFFFFFFFF && flash_is_erased(IMU_CALIB_SLOT_ADDR(slot), IMU_CALIB_SLOT)) {
+            imu_calib_next_slot = slot;
+            break;
+        }
+        if (imu_calib_valid(calib) && (!newest || calib->seq > newest->seq))
+            newest = calib;
+    }
+    imu_calib_last_seq = newest ? newest->seq : 0;
+    return newest;
+}
+
+void imu_calib_default(imu_calib_t *calib) {
+    memset(calib, 0, sizeof(imu_calib_t));
+    for (int i = 0; i < 3; ++i) {
+        calib->acce_scale[i]    = 1.0f;
+        calib->mag_matrix[i][i] = 1.0f;
+    }
+}
+
+uint8_t imu_calib_load(imu_calib_t *calib) {
+    const imu_calib_t *newest = imu_calib_scan();
+    if (!newest)
+        return 0;
+    flash_read((uint32_t)newest, calib, sizeof(imu_calib_t));
+    return 1;
+}
+
+uint8_t imu_calib_save(imu_calib_t *calib) {
+    if (imu_calib_next_slot > IMU_CALIB_SLOTS)
+        imu_calib_scan();
+    if (imu_calib_next_slot == IMU_CALIB_SLOTS) {
+        if (!flash_erase_sector(BSP_FLASH_DATA_SECTOR))
+            return 0;
+        imu_calib_next_slot = 0;
+    }
+    calib->magic    = IMU_CALIB_MAGIC;
+    calib->version  = IMU_CALIB_VERSION;
+    calib->length   = sizeof(imu_calib_t);
+    calib->seq      = imu_calib_last_seq + 1;
+    calib->reserved = 0xFFFF;
+    append_crc16_check_sum((uint8_t*)calib, sizeof(imu_calib_t));
+    /* a failed slot is skipped, the next save uses a fresh one */
+    uint32_t slot = imu_calib_next_slot++;
+    if (!flash_write(IMU_CALIB_SLOT_ADDR(slot), calib, sizeof(imu_calib_t)))
+        return 0;
+    imu_calib_last_seq = calib->seq;
+    return 1;
+}
+
+void imu_calib_gyro_bias(const imu_calib_t *calib, float temp, float bias[3]) {
+    float dtemp = (calib->flags & IMU_CALIB_GYRO_TEMP) ? temp - calib->gyro_ref_temp : 0.0f;
+    for (int i = 0; i < 3; ++i)
+        bias[i] = calib->gyro_bias[i] + calib->gyro_slope[i] * dtemp;
+}
+
+void imu_calib_apply_acce(const imu_calib_t *calib, imu_t *imu) {
+    imu->acce.x = calib->acce_scale[0] * (imu->acce.x - calib->acce_offset[0]);
+    imu->acce.y = calib->acce_scale[1] * (imu->acce.y - calib->acce_offset[1]);
+    imu->acce.z = calib->acce_scale[2] * (imu->acce.z - calib->acce_offset[2]);
+}
+
+void imu_calib_apply_mag(const imu_calib_t *calib, const imu_t *imu, float mag[3]) {
+    float m[3] = {imu->mag.x - calib->mag_offset[0],
+                  imu->mag.y - calib->mag_offset[1],
+                  imu->mag.z - calib->mag_offset[2]};
+    for (int i = 0; i < 3; ++i)
+        mag[i] = calib->mag_matrix[i][0] * m[0] + calib->mag_matrix[i][1] * m[1] + calib->mag_matrix[i][2] * m[2];
+}
+
+void imu_calib_fit_reset(imu_calib_fit_t *fit) {
+    memset(fit, 0, sizeof(imu_calib_fit_t));
+}
+
+void imu_calib_fit_add(imu_calib_fit_t *fit, float temp, const float gyro[3]) {
+    if (fit->n == 0)
+        fit->t0 = fit->t_min = fit->t_max = temp;
+    if (temp < fit->t_min)
+        fit->t_min = temp;
+    if (temp > fit->t_max)
+        fit->t_max = temp;
+    float t = temp - fit->t0;
+    fit->n++;
+    fit->st  += t;
+    fit->stt += t * t;
+    for (int i = 0; i < 3; ++i) {
+        fit->sb[i]  += gyro[i];
+        fit->stb[i] += t * gyro[i];
+    }
+}
+
+uint8_t imu_calib_fit_solve(const imu_calib_fit_t *fit, imu_calib_t *calib) {
+    if (fit->n < IMU_CALIB_FIT_MIN || fit->t_max - fit->t_min < IMU_CALIB_FIT_SPAN)
+        return 0;
+    float n      = (float)fit->n;
+    float t_mean = fit->st / n;
+    float sxx    = fit->stt - fit->st * t_mean;
+    if (sxx <= 0)
+        return 0;
+    /* the regression line passes through the means, use them as the reference point */
+    for (int i = 0; i < 3; ++i) {
+        calib->gyro_slope[i] = (fit->stb[i] - t_mean * fit->sb[i]) / sxx;
+        calib->gyro_bias[i]  = fit->sb[i] / n;
+    }
+    calib->gyro_ref_temp = fit->t0 + t_mean;
+    calib->flags |= IMU_CALIB_GYRO | IMU_CALIB_GYRO_TEMP;
+    return 1;
+}
@@ -0,0 +1,171 @@
+/**************************************************************************
+ *  Copyright (C) 2018 
+ *  Illini RoboMaster @ University of Illinois at Urbana-Champaign.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#ifndef _IMU_CALIB_H_
+#define _IMU_CALIB_H_
+
+#include "stm32f4xx_hal.h"
+#include "bsp_flash.h"
+#include "bsp_imu.h"
+#include "crc_check.h"
+
+/**
+ * @ingroup library
+ * @defgroup imu_calib IMU Calibration
+ * @{
+ */
+
+#define IMU_CALIB_MAGIC     0x43554D49  // "IMUC"
+#define IMU_CALIB_VERSION   1
+#define IMU_CALIB_SLOT      128         // bytes reserved per record in flash
+#define IMU_CALIB_SLOTS     (BSP_FLASH_DATA_SIZE / IMU_CALIB_SLOT)
+#define IMU_CALIB_FIT_SPAN  5.0f        // celsius, minimum temperature span for a bias vs temperature fit
+#define IMU_CALIB_FIT_MIN   500         // minimum samples for a bias vs temperature fit
+
+/* imu_calib_t flags */
+#define IMU_CALIB_GYRO      0x01        // gyro_bias / gyro_ref_temp valid
+#define IMU_CALIB_GYRO_TEMP 0x02        // gyro_slope fitted
+#define IMU_CALIB_ACCE      0x04        // acce_scale / acce_offset valid
+#define IMU_CALIB_MAG       0x08        // mag_offset / mag_matrix valid
+
+/**
+ * @struct imu_calib_t
+ * @brief persistent imu calibration record, one per flash slot
+ * @var magic           IMU_CALIB_MAGIC
+ * @var version         IMU_CALIB_VERSION, records of other versions are ignored
+ * @var length          sizeof(imu_calib_t)
+ * @var seq             write sequence, the valid record with the largest seq wins
+ * @var flags           IMU_CALIB_* bits telling which parts are valid
+ * @var gyro_bias       gyro zero bias at gyro_ref_temp in deg/s
+ * @var gyro_slope      gyro bias change per degree celsius
+ * @var gyro_ref_temp   reference temperature of gyro_bias
+ * @var acce_scale      accelerometer scale, corrected = scale * (raw - offset)
+ * @var acce_offset     accelerometer offset in g
+ * @var mag_offset      magnetometer hard iron offset in raw counts
+ * @var mag_matrix      magnetometer soft iron correction, corrected = M * (raw - offset)
+ * @var crc             CRC16 over all preceding bytes
+ */
+typedef struct {
+    uint32_t    magic;
+    uint16_t    version;
+    uint16_t    length;
+    uint32_t    seq;
+    uint32_t    flags;
+    float       gyro_bias[3];
+    float       gyro_slope[3];
+    float       gyro_ref_temp;
+    float       acce_scale[3];
+    float       acce_offset[3];
+    float       mag_offset[3];
+    float       mag_matrix[3][3];
+    uint16_t    reserved;
+    uint16_t    crc;
+} __packed imu_calib_t;
+
+/**
+ * @struct imu_calib_fit_t
+ * @brief least squares accumulator for gyro bias against temperature
+ * @var n       samples so far
+ * @var t0      temperature of the first sample, sums are relative to it
+ * @var t_min   lowest temperature seen
+ * @var t_max   highest temperature seen
+ * @var st      sum of (t - t0)
+ * @var stt     sum of (t - t0)^2
+ * @var sb      sum of gyro readings per axis
+ * @var stb     sum of (t - t0) * gyro per axis
+ */
+typedef struct {
+    uint32_t    n;
+    float       t0;
+    float       t_min;
+    float       t_max;
+    float       st;
+    float       stt;
+    float       sb[3];
+    float       stb[3];
+} imu_calib_fit_t;
+
+/**
+ * @brief fill a record with identity calibration and no valid parts
+ * @param calib record to fill
+ */
+void imu_calib_default(imu_calib_t *calib);
+
+/**
+ * @brief load the newest valid record from flash
+ * @param calib output record, untouched if none is found
+ * @return 1 if a record was found, 0 otherwise
+ */
+uint8_t imu_calib_load(imu_calib_t *calib);
+
+/**
+ * @brief append a record to the next free slot, erasing the sector when full
+ * @param calib record to store; seq, header and crc are filled in
+ * @return 1 for success, 0 for failed
+ * @note blocks for 1-2s whenever the sector has to be erased, once every IMU_CALIB_SLOTS writes
+ */
+uint8_t imu_calib_save(imu_calib_t *calib);
+
+/**
+ * @brief gyro bias at a given temperature
+ * @param calib a valid record
+ * @param temp  imu temperature in celsius
+ * @param bias  output bias in deg/s
+ */
+void imu_calib_gyro_bias(const imu_calib_t *calib, float temp, float bias[3]);
+
+/**
+ * @brief correct accelerometer data in place
+ * @param calib a valid record
+ * @param imu   imu data to correct
+ */
+void imu_calib_apply_acce(const imu_calib_t *calib, imu_t *imu);
+
+/**
+ * @brief correct magnetometer data
+ * @param calib a valid record
+ * @param imu   imu data holding raw magnetometer counts
+ * @param mag   output corrected field
+ */
+void imu_calib_apply_mag(const imu_calib_t *calib, const imu_t *imu, float mag[3]);
+
+/**
+ * @brief clear a bias vs temperature accumulator
+ * @param fit   accumulator to clear
+ */
+void imu_calib_fit_reset(imu_calib_fit_t *fit);
+
+/**
+ * @brief add one static gyro sample to a bias vs temperature accumulator
+ * @param fit   accumulator
+ * @param temp  imu temperature in celsius
+ * @param gyro  raw gyro reading in deg/s
+ */
+void imu_calib_fit_add(imu_calib_fit_t *fit, float temp, const float gyro[3]);
+
+/**
+ * @brief solve the linear bias vs temperature model into a record
+ * @param fit   accumulator
+ * @param calib record receiving gyro_bias, gyro_slope and gyro_ref_temp
+ * @return 1 if the fit spans IMU_CALIB_FIT_SPAN with IMU_CALIB_FIT_MIN samples, 0 otherwise
+ */
+uint8_t imu_calib_fit_solve(const imu_calib_fit_t *fit, imu_calib_t *calib);
+
+/** @} */
+
+#endif
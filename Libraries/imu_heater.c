@@ -0,0 +1,105 @@
+/**************************************************************************
+ *  Copyright (C) 2018 
+ *  Illini RoboMaster @ University of Illinois at Urbana-Champaign.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#include "imu_heater.h"
+
+imu_heater_t imuHeater;
+
+static void imu_heater_set_duty(float duty) {
+    if (duty < 0)
+        duty = 0;
+    if (duty > IMU_HEATER_PWM_MAX)
+        duty = IMU_HEATER_PWM_MAX;
+    imuHeater.duty = duty;
+    pwm_set_pulse_width(&imuHeater.pwm, (uint32_t)duty);
+}
+
+void imu_heater_init(float target) {
+    pwm_init(&imuHeater.pwm, &IMU_HEATER_TIM, IMU_HEATER_CHANNEL);
+    imuHeater.target    = target;
+    imuHeater.kp        = IMU_HEATER_KP;
+    imuHeater.ki        = IMU_HEATER_KI;
+    imuHeater.integral  = 0;
+    imuHeater.start_ms  = HAL_GetTick();
+    imuHeater.last_ms   = imuHeater.start_ms;
+    imuHeater.band_ms   = 0;
+    imuHeater.stable_ms = 0;
+    imu_heater_set_duty(0);
+    imuHeater.state     = IMU_HEATER_WARMING;
+}
+
+void imu_heater_update(float temp) {
+    if (imuHeater.state == IMU_HEATER_OFF || imuHeater.state == IMU_HEATER_FAULT)
+        return;
+    imuHeater.temp = temp;
+    if (temp > IMU_HEATER_MAX_TEMP) {
+        imu_heater_set_duty(0);
+        imuHeater.state = IMU_HEATER_FAULT;
+        bsp_error_handler(__FUNCTION__, __LINE__, "IMU over temperature, heater off.");
+        return;
+    }
+    uint32_t now = HAL_GetTick();
+    if (now - imuHeater.last_ms < IMU_HEATER_PERIOD_MS)
+        return;
+    float dt  = (now - imuHeater.last_ms) * 0.001f;
+    float err = imuHeater.target - temp;
+    imuHeater.last_ms = now;
+
+    /* only integrate while the output is not pushed further into saturation */
+    float out = imuHeater.kp * err + imuHeater.integral;
+    if ((out < IMU_HEATER_PWM_MAX || err < 0) && (out > 0 || err > 0))
+        imuHeater.integral += imuHeater.ki * err * dt;
+    if (imuHeater.integral < 0)
+        imuHeater.integral = 0;
+    if (imuHeater.integral > IMU_HEATER_PWM_MAX)
+        imuHeater.integral = IMU_HEATER_PWM_MAX;
+    imu_heater_set_duty(imuHeater.kp * err + imuHeater.integral);
+
+    float abs_err = fabsf(err);
+    if (imuHeater.state == IMU_HEATER_STABLE) {
+        if (abs_err > IMU_HEATER_LOST_BAND) {
+            imuHeater.state   = IMU_HEATER_WARMING;
+            imuHeater.band_ms = 0;
+        }
+        return;
+    }
+    if (abs_err > IMU_HEATER_STABLE_BAND) {
+        imuHeater.band_ms = 0;
+        return;
+    }
+    if (imuHeater.band_ms == 0)
+        imuHeater.band_ms = now;
+    if (now - imuHeater.band_ms >= IMU_HEATER_STABLE_MS) {
+        imuHeater.state = IMU_HEATER_STABLE;
+        if (imuHeater.stable_ms == 0) {
+            imuHeater.stable_ms = now - imuHeater.start_ms;
+            print("IMU temperature stable at %.1f C after %u ms\r\n", temp, (unsigned)imuHeater.stable_ms);
+        }
+    }
+}
+
+void imu_heater_stop(void) {
+    if (imuHeater.state == IMU_HEATER_OFF)
+        return;
+    imu_heater_set_duty(0);
+    imuHeater.state = IMU_HEATER_OFF;
+}
+
+uint8_t imu_heater_is_stable(void) {
+    return imuHeater.state == IMU_HEATER_STABLE;
+}
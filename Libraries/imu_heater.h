@@ -0,0 +1,119 @@
+/**************************************************************************
+ *  Copyright (C) 2018 
+ *  Illini RoboMaster @ University of Illinois at Urbana-Champaign.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#ifndef _IMU_HEATER_H_
+#define _IMU_HEATER_H_
+
+#include "stm32f4xx_hal.h"
+#include "bsp_pwm.h"
+#include "bsp_error_handler.h"
+#include <math.h>
+
+/**
+ * @ingroup library
+ * @defgroup imu_heater IMU Heater
+ * @{
+ */
+
+#define IMU_HEATER_TIM          htim3   // board heater resistor under the MPU6500
+#define IMU_HEATER_CHANNEL      2
+#define IMU_HEATER_PWM_MAX      1000    // timer auto reload value, i.e. full duty
+#define IMU_HEATER_TARGET       45.0f   // celsius, above any ambient temperature we run in
+#define IMU_HEATER_MAX_TEMP     65.0f   // heater is shut off for good above this
+#define IMU_HEATER_KP           400.0f  // duty counts per degree
+#define IMU_HEATER_KI           40.0f   // duty counts per degree second
+#define IMU_HEATER_PERIOD_MS    10      // control period, faster updates are skipped
+#define IMU_HEATER_STABLE_BAND  0.5f    // degree, error band considered on target
+#define IMU_HEATER_STABLE_MS    2000    // time to stay in band before reporting stable
+#define IMU_HEATER_LOST_BAND    2.0f    // degree, error that drops a stable heater back to warming
+
+/**
+ * @enum imu_heater_state_t
+ * @brief heater controller state
+ * @var IMU_HEATER_OFF      not initialized, heater off
+ * @var IMU_HEATER_WARMING  driving towards the target
+ * @var IMU_HEATER_STABLE   held within IMU_HEATER_STABLE_BAND for IMU_HEATER_STABLE_MS
+ * @var IMU_HEATER_FAULT    over temperature, heater off until re-initialized
+ */
+typedef enum {
+    IMU_HEATER_OFF,
+    IMU_HEATER_WARMING,
+    IMU_HEATER_STABLE,
+    IMU_HEATER_FAULT,
+}   imu_heater_state_t;
+
+/**
+ * @struct imu_heater_t
+ * @brief temperature PI controller driving the heater pwm
+ * @var pwm         heater pwm channel
+ * @var state       controller state
+ * @var target      temperature setpoint in celsius
+ * @var kp          proportional gain
+ * @var ki          integral gain
+ * @var integral    integral term in duty counts
+ * @var duty        latest duty in [0, IMU_HEATER_PWM_MAX]
+ * @var temp        latest temperature
+ * @var start_ms    tick when the controller started
+ * @var last_ms     tick of the latest control update
+ * @var band_ms     tick when the temperature entered the stable band
+ * @var stable_ms   time from start to first stable, 0 until reached
+ */
+typedef struct {
+    pwm_t               pwm;
+    imu_heater_state_t  state;
+    float               target;
+    float               kp;
+    float               ki;
+    float               integral;
+    float               duty;
+    float               temp;
+    uint32_t            start_ms;
+    uint32_t            last_ms;
+    uint32_t            band_ms;
+    uint32_t            stable_ms;
+}   imu_heater_t;
+
+extern imu_heater_t imuHeater;
+
+/**
+ * @brief start the heater pwm and the temperature controller
+ * @param target    temperature setpoint in celsius
+ */
+void imu_heater_init(float target);
+
+/**
+ * @brief feed a fresh imu temperature and run the controller if a period has passed
+ * @param temp  imu temperature in celsius
+ * @note  call with every sample, the controller limits itself to IMU_HEATER_PERIOD_MS
+ */
+void imu_heater_update(float temp);
+
+/**
+ * @brief switch the heater off
+ */
+void imu_heater_stop(void);
+
+/**
+ * @brief tell whether the imu temperature has settled
+ * @return 1 if stable, 0 otherwise
+ */
+uint8_t imu_heater_is_stable(void);
+
+/** @} */
+
+#endif
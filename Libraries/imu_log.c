@@ -0,0 +1,119 @@
+/**************************************************************************
+ *  Copyright (C) 2018 
+ *  Illini RoboMaster @ University of Illinois at Urbana-Champaign.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#include "imu_log.h"
+
+static int16_t imu_log_pack(float val, float factor) {
+    float counts = val * factor;
+    if (counts > 32767.0f)
+        return 32767;
+    if (counts < -32768.0f)
+        return -32768;
+    return (int16_t)(counts + (counts >= 0 ? 0.5f : -0.5f));
+}
+
+void imu_log_init(imu_log_t *log, imu_log_write_t write) {
+    log->head        = 0;
+    log->tail        = 0;
+    log->dropped     = 0;
+    log->header_sent = 0;
+    log->write       = write;
+}
+
+void imu_log_header(imu_log_header_t *header) {
+    header->magic       = IMU_LOG_MAGIC;
+    header->version     = IMU_LOG_VERSION;
+    header->record_size = sizeof(imu_log_record_t);
+    header->acce_lsb    = ONBOARD_ACCE_SCALE;
+    header->gyro_lsb    = ONBOARD_GYRO_SCALE;
+    header->temp_lsb    = ONBOARD_TEMP_SCALE;
+    header->temp_offset = ONBOARD_TEMP_ROOM;
+}
+
+void imu_log_encode(const imu_t *imu, imu_log_record_t *record) {
+    record->stamp_us = imu->stamp_us;
+    record->acce[0]  = imu_log_pack(imu->acce.x, ONBOARD_ACCE_FACTOR);
+    record->acce[1]  = imu_log_pack(imu->acce.y, ONBOARD_ACCE_FACTOR);
+    record->acce[2]  = imu_log_pack(imu->acce.z, ONBOARD_ACCE_FACTOR);
+    record->gyro[0]  = imu_log_pack(imu->gyro.x, ONBOARD_GYRO_FACTOR);
+    record->gyro[1]  = imu_log_pack(imu->gyro.y, ONBOARD_GYRO_FACTOR);
+    record->gyro[2]  = imu_log_pack(imu->gyro.z, ONBOARD_GYRO_FACTOR);
+    record->mag[0]   = imu->mag.x;
+    record->mag[1]   = imu->mag.y;
+    record->mag[2]   = imu->mag.z;
+    record->temp     = imu_log_pack(imu->temp - ONBOARD_TEMP_ROOM, ONBOARD_TEMP_FACTOR);
+}
+
+void imu_log_decode(const imu_log_header_t *header, const imu_log_record_t *record, imu_t *imu) {
+    imu->stamp_us = record->stamp_us;
+    imu->acce.x   = record->acce[0] * header->acce_lsb;
+    imu->acce.y   = record->acce[1] * header->acce_lsb;
+    imu->acce.z   = record->acce[2] * header->acce_lsb;
+    imu->gyro.x   = record->gyro[0] * header->gyro_lsb;
+    imu->gyro.y   = record->gyro[1] * header->gyro_lsb;
+    imu->gyro.z   = record->gyro[2] * header->gyro_lsb;
+    imu->mag.x    = record->mag[0];
+    imu->mag.y    = record->mag[1];
+    imu->mag.z    = record->mag[2];
+    imu->temp     = record->temp * header->temp_lsb + header->temp_offset;
+}
+
+uint8_t imu_log_push(imu_log_t *log, const imu_t *imu) {
+    uint32_t head = log->head;
+    if (head - log->tail >= IMU_LOG_DEPTH) {
+        log->dropped++;
+        return 0;
+    }
+    imu_log_encode(imu, &log->ring[head & (IMU_LOG_DEPTH - 1)]);
+    /* the record must land before the consumer sees the new head */
+    __DMB();
+    log->head = head + 1;
+    return 1;
+}
+
+uint32_t imu_log_flush(imu_log_t *log) {
+    if (log->write == NULL)
+        return 0;
+    if (!log->header_sent) {
+        imu_log_header_t header;
+        imu_log_header(&header);
+        if (log->write((const uint8_t*)&header, sizeof(header)) != sizeof(header))
+            return 0;
+        log->header_sent = 1;
+    }
+    uint32_t written = 0;
+    uint32_t head = log->head;
+    __DMB();
+    while (log->tail != head) {
+        /* hand over contiguous runs, split where the ring wraps */
+        uint32_t idx = log->tail & (IMU_LOG_DEPTH - 1);
+        uint32_t count = head - log->tail;
+        if (count > IMU_LOG_DEPTH - idx)
+            count = IMU_LOG_DEPTH - idx;
+        if (count > IMU_LOG_CHUNK)
+            count = IMU_LOG_CHUNK;
+        uint32_t size = count * sizeof(imu_log_record_t);
+        uint32_t done = log->write((const uint8_t*)&log->ring[idx], size) / sizeof(imu_log_record_t);
+        __DMB();
+        log->tail += done;
+        written += done;
+        if (done < count)
+            break;
+    }
+    return written;
+}
@@ -0,0 +1,143 @@
+/**************************************************************************
+ *  Copyright (C) 2018 
+ *  Illini RoboMaster @ University of Illinois at Urbana-Champaign.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#ifndef _IMU_LOG_H_
+#define _IMU_LOG_H_
+
+#include "bsp_imu.h"
+
+/**
+ * @ingroup library
+ * @defgroup imu_log IMU Log
+ * @{
+ */
+
+#define IMU_LOG_MAGIC       0x474C4D49  // "IMLG"
+#define IMU_LOG_VERSION     1
+#define IMU_LOG_DEPTH       256         // records buffered between flushes, power of two
+#define IMU_LOG_CHUNK       32          // most records handed to the sink per write
+
+/**
+ * @struct imu_log_header_t
+ * @brief written once at the start of a log, tells a reader how to scale records
+ * @var magic       IMU_LOG_MAGIC
+ * @var version     IMU_LOG_VERSION
+ * @var record_size sizeof(imu_log_record_t)
+ * @var acce_lsb    g per accelerometer count
+ * @var gyro_lsb    deg/s per gyroscope count
+ * @var temp_lsb    celsius per temperature count
+ * @var temp_offset celsius at temperature count 0
+ */
+typedef struct {
+    uint32_t    magic;
+    uint16_t    version;
+    uint16_t    record_size;
+    float       acce_lsb;
+    float       gyro_lsb;
+    float       temp_lsb;
+    float       temp_offset;
+} __packed imu_log_header_t;
+
+/**
+ * @struct imu_log_record_t
+ * @brief one raw sample, 24 bytes
+ * @var stamp_us    sample time in microseconds
+ * @var acce        accelerometer counts
+ * @var gyro        gyroscope counts
+ * @var mag         magnetometer counts, 0 when not read
+ * @var temp        temperature counts
+ */
+typedef struct {
+    uint32_t    stamp_us;
+    int16_t     acce[3];
+    int16_t     gyro[3];
+    int16_t     mag[3];
+    int16_t     temp;
+} __packed imu_log_record_t;
+
+/**
+ * @brief sink for log bytes, e.g. a file on the SD card or a UART
+ * @return bytes accepted; a short write must still end on a record boundary
+ */
+typedef uint32_t (*imu_log_write_t)(const uint8_t *data, uint32_t size);
+
+/**
+ * @struct imu_log_t
+ * @brief single producer single consumer record ring between the sampling context and a flushing task
+ * @var ring        buffered records
+ * @var head        records pushed, only written by the producer
+ * @var tail        records flushed, only written by the consumer
+ * @var dropped     records lost because the ring was full
+ * @var header_sent 1 once the header went to the sink
+ * @var write       sink
+ */
+typedef struct {
+    imu_log_record_t    ring[IMU_LOG_DEPTH];
+    volatile uint32_t   head;
+    volatile uint32_t   tail;
+    uint32_t            dropped;
+    uint8_t             header_sent;
+    imu_log_write_t     write;
+}   imu_log_t;
+
+/**
+ * @brief reset a log and attach a sink
+ * @param log   log to reset
+ * @param write sink receiving header and records from imu_log_flush
+ */
+void imu_log_init(imu_log_t *log, imu_log_write_t write);
+
+/**
+ * @brief fill the header matching imu_log_encode
+ * @param header output header
+ */
+void imu_log_header(imu_log_header_t *header);
+
+/**
+ * @brief pack a sample into a record
+ * @param imu       decoded sample
+ * @param record    output record
+ */
+void imu_log_encode(const imu_t *imu, imu_log_record_t *record);
+
+/**
+ * @brief unpack a record into a sample
+ * @param header    header of the log the record came from
+ * @param record    record to unpack
+ * @param imu       output sample
+ */
+void imu_log_decode(const imu_log_header_t *header, const imu_log_record_t *record, imu_t *imu);
+
+/**
+ * @brief queue a sample, safe from the sampling context
+ * @param log   log
+ * @param imu   sample to queue
+ * @return 1 if queued, 0 if the ring was full and the sample was dropped
+ */
+uint8_t imu_log_push(imu_log_t *log, const imu_t *imu);
+
+/**
+ * @brief hand buffered records to the sink, call from a low priority task
+ * @param log   log
+ * @return records written
+ */
+uint32_t imu_log_flush(imu_log_t *log);
+
+/** @} */
+
+#endif
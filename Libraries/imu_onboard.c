@@ -20,6 +20,27 @@
 #include "cmsis_os.h"
 
 imu_onboard_t imuBoard;
+#if IMU_LOG == ON
+imu_log_t imuLog;
+#endif
+
+static imu_batch_t imu_batch;
+static uint32_t    imu_batch_last;
+
+static void onboard_imu_step(void);
+static void onboard_imu_calib_step(void);
+static float onboard_imu_calib_accumulate(void);
+static void onboard_imu_calib_finish(const float bias[3]);
+static void onboard_imu_calib_fallback(void);
+static void onboard_imu_refine_step(void);
+static void onboard_imu_calib_store(void);
+static void onboard_imu_thermal_step(void);
+static float onboard_imu_thermal_clamp(float temp);
+static void onboard_imu_stored_bias(float bias[3]);
+static uint8_t onboard_imu_temp_settled(void);
+static void onboard_imu_filter_design(void);
+static void onboard_imu_filter_step(void);
+static float onboard_imu_timing_step(uint32_t stamp_us);
 
 void print_mpu_data(imu_t* imu) {
     if (imu == NULL) {
@@ -44,8 +65,41 @@ void print_imu_data(void){
     print("\r\n");
 }
 
+void print_imu_timing(void){
+    imu_timing_t *timing = &imuBoard.timing;
+    print("Period %.1f us \tJitter %.1f us \tMax %.1f us \t| ", timing->period * 1e6f,
+          sqrtf(timing->jitter_var) * 1e6f, timing->max_jitter * 1e6f);
+    print("Samples %u \tMissed %u \tDup %u \tClamped %u\r\n", (unsigned)timing->samples,
+          (unsigned)timing->missed, (unsigned)timing->duplicate, (unsigned)timing->clamped);
+}
+
 void onboard_imu_lib_init(void){
     print("Initializing and calibrating onboard imu\r\n");
+    onboard_imu_calib_start();
+    // poll at the sample rate and let lower priority tasks run in between
+    for(uint32_t waited = 0; imuBoard.calibrating; ++waited) {
+        if(waited >= IMU_CALIB_TIMEOUT_MS) {
+            onboard_imu_calib_fallback();
+            break;
+        }
+        onboard_imu_update();
+        osDelay(1);
+    }
+}
+
+void onboard_imu_calib_start(void){
+    imuBoard.calibrating = 0;
+    imuBoard.dt = IMU_DT;
+    imuBoard.timing.samples = 0;
+    imuBoard.timing.missed = 0;
+    imuBoard.timing.duplicate = 0;
+    imuBoard.timing.clamped = 0;
+    imuBoard.timing.period = IMU_DT;
+    imuBoard.timing.jitter_var = 0;
+    imuBoard.timing.max_jitter = 0;
+    for(int n = 0; n < IMU_GYRO_NOTCHES; ++n)
+        imuBoard.notch_hz[n] = 0;
+    onboard_imu_filter_design();
     for(int i = 0; i < 3; ++i){
         imuBoard.angle[i] = 0;
         for(int j = 0; j < 2; ++j){
@@ -54,31 +108,460 @@ void onboard_imu_lib_init(void){
             }
         }
     }
-    // grab some samples of gyro data for an initial estimate of zero biases
-    imuBoard.total_measurement_count = 0;
-    while(imuBoard.total_measurement_count < IMUSAMPLES) {
-        mpu6500_get_data(&(imuBoard.my_raw_imu));
-        //TODO: add foolproof logic or assume none of us is a fool.
-        update_zero_bias();
+    imuBoard.calib_count = 0;
+    imuBoard.calib_confidence = 0;
+    imuBoard.refining = 0;
+#if IMU_USE_HEATER == ON
+    if(imuHeater.state == IMU_HEATER_OFF)
+        imu_heater_init(IMU_HEATER_TARGET);
+#endif
+    imu_calib_fit_reset(&imuBoard.fit);
+    imuBoard.fitting = 1;
+    imuBoard.thermal_tracking = 0;
+#if IMU_CALIB_STORE == ON
+    if(imu_calib_load(&imuBoard.calib))
+        print("Found stored imu calibration #%u\r\n", (unsigned)imuBoard.calib.seq);
+    else
+        imu_calib_default(&imuBoard.calib);
+#else
+    imu_calib_default(&imuBoard.calib);
+#endif
+    // a stored record keeps the center of its fit only, assume the minimum span around it
+    imuBoard.thermal_min = imuBoard.calib.gyro_ref_temp - IMU_CALIB_FIT_SPAN / 2;
+    imuBoard.thermal_max = imuBoard.calib.gyro_ref_temp + IMU_CALIB_FIT_SPAN / 2;
+    imuBoard.calibrating = 1;
+}
+
+uint8_t onboard_imu_wait_calibrated(float min_confidence, uint32_t timeout_ms){
+    for(uint32_t waited = 0; imuBoard.calib_confidence < min_confidence; waited += IMU_CALIB_POLL_MS) {
+        if(waited >= timeout_ms)
+            return 0;
+        osDelay(IMU_CALIB_POLL_MS);
+    }
+    return 1;
+}
+
+static void onboard_imu_calib_step(void){
+#if IMU_CALIB_STORE == ON
+    if(imuBoard.calib.flags & IMU_CALIB_GYRO) {
+        // warm start: trust the stored bias right away and refine it while static
+        float bias[3];
+        onboard_imu_stored_bias(bias);
+        onboard_imu_calib_finish(bias);
+        imuBoard.calib_count = 0;
+        imuBoard.refining = 1;
+        imuBoard.calib_confidence = IMU_CALIB_WARM_CONF;
+        return;
+    }
+#endif
+    float confidence = onboard_imu_calib_accumulate();
+    if(confidence < 1.0f) {
+        imuBoard.calib_confidence = confidence;
+        return;
+    }
+    onboard_imu_calib_finish(imuBoard.calib_mean);
+    imuBoard.calib_confidence = 1.0f;
+#if IMU_CALIB_STORE == ON
+    onboard_imu_calib_store();
+#endif
+}
+
+static void onboard_imu_refine_step(void){
+    if(onboard_imu_calib_accumulate() < 1.0f)
+        return;
+    for(int axis = 0; axis < 3; ++axis)
+        imuBoard.angle_zero_bias[axis] = imuBoard.calib_mean[axis];
+    imuBoard.refining = 0;
+    imuBoard.calib_confidence = 1.0f;
+    onboard_imu_calib_store();
+}
+
+/* Feed one gyro sample to the running estimate, returns its confidence */
+static float onboard_imu_calib_accumulate(void){
+    float* pgyro = (float*)(&imuBoard.my_raw_imu.gyro.x);
+    // any motion invalidates the samples so far
+    for(int axis = 0; axis < 3 && imuBoard.calib_count; ++axis)
+        if(fabsf(*(pgyro + axis) - imuBoard.calib_mean[axis]) > STATIC_LIM)
+            imuBoard.calib_count = 0;
+    if(imuBoard.calib_count == 0) {
+        for(int axis = 0; axis < 3; ++axis)
+            imuBoard.calib_mean[axis] = imuBoard.calib_m2[axis] = 0;
+    }
+    // Welford running mean and variance
+    int n = ++imuBoard.calib_count;
+    float var_max = 0;
+    for(int axis = 0; axis < 3; ++axis){
+        float delta = *(pgyro + axis) - imuBoard.calib_mean[axis];
+        imuBoard.calib_mean[axis] += delta / n;
+        imuBoard.calib_m2[axis] += delta * (*(pgyro + axis) - imuBoard.calib_mean[axis]);
+        if(n > 1 && imuBoard.calib_m2[axis] / (n - 1) > var_max)
+            var_max = imuBoard.calib_m2[axis] / (n - 1);
     }
+    // enough samples and a small enough standard error of the mean
+    float sem = sqrtf(var_max / n);
+    float count_conf = n < IMUSAMPLES ? (float)n / IMUSAMPLES : 1.0f;
+    float sem_conf = sem > IMU_CALIB_SEM ? IMU_CALIB_SEM / sem : 1.0f;
+    return count_conf * sem_conf;
+}
+
+static void onboard_imu_calib_finish(const float bias[3]){
+    for(int axis = 0; axis < 3; ++axis)
+        imuBoard.angle_zero_bias[axis] = bias[axis];
+    imuBoard.total_measurement_count = imuBoard.calib_count;
     update_acc_angle();
     for(int AXIS = 0; AXIS < 3; ++AXIS) {
         imuBoard.init_acc_angle[AXIS] = imuBoard.acc_angle[AXIS];
         imuBoard.angle[AXIS] = 0;
     }
     imuBoard.static_measurement_count = 0;
+#if IMU_USE_AHRS == ON
+    float acce[3] = {imuBoard.my_raw_imu.acce.x, imuBoard.my_raw_imu.acce.y, imuBoard.my_raw_imu.acce.z};
+    ahrs_init(&imuBoard.ahrs, IMU_AHRS_ALGO);
+    ahrs_align(&imuBoard.ahrs, acce);
+    ahrs_get_euler(&imuBoard.ahrs, imuBoard.ahrs_zero);
+#endif
+    imuBoard.calibrating = 0;
+}
+
+/* The robot never kept still: start from the stored or zero bias and refine it once static */
+static void onboard_imu_calib_fallback(void){
+    float bias[3];
+    print("Imu calibration timed out, using the %s gyro bias\r\n",
+          (imuBoard.calib.flags & IMU_CALIB_GYRO) ? "stored" : "zero");
+    onboard_imu_stored_bias(bias);
+    onboard_imu_calib_finish(bias);
+    imuBoard.calib_count = 0;
+    imuBoard.refining = IMU_CALIB_STORE == ON;
+}
+
+/* Take the converged bias into the record, write it only if it moved noticeably */
+static void onboard_imu_calib_store(void){
+    float stored[3];
+    float delta = 0;
+    imu_calib_gyro_bias(&imuBoard.calib, onboard_imu_thermal_clamp(imuBoard.my_raw_imu.temp), stored);
+    for(int axis = 0; axis < 3; ++axis)
+        if(fabsf(imuBoard.angle_zero_bias[axis] - stored[axis]) > delta)
+            delta = fabsf(imuBoard.angle_zero_bias[axis] - stored[axis]);
+    uint8_t changed = !(imuBoard.calib.flags & IMU_CALIB_GYRO) || delta >= IMU_CALIB_SAVE_DELTA;
+    for(int axis = 0; axis < 3; ++axis)
+        imuBoard.calib.gyro_bias[axis] = imuBoard.angle_zero_bias[axis];
+    imuBoard.calib.gyro_ref_temp = imuBoard.my_raw_imu.temp;
+    imuBoard.calib.flags |= IMU_CALIB_GYRO;
+    if(changed)
+        imuBoard.calib_dirty = 1;
+}
+
+uint8_t onboard_imu_calib_flush(void){
+    if(!imuBoard.calib_dirty)
+        return 1;
+    // the sampling context keeps updating the record, write a consistent copy of it
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    imu_calib_t calib = imuBoard.calib;
+    imuBoard.calib_dirty = 0;
+    __set_PRIMASK(primask);
+    if(!imu_calib_save(&calib)) {
+        bsp_error_handler(__FUNCTION__, __LINE__, "Failed to store imu calibration.");
+        return 0;
+    }
+    return 1;
+}
+
+static uint8_t onboard_imu_temp_settled(void){
+#if IMU_USE_HEATER == ON
+    return imu_heater_is_stable();
+#else
+    return 0;
+#endif
+}
+
+/* Only trust the bias vs temperature model over the span it was fitted on */
+static float onboard_imu_thermal_clamp(float temp){
+    if(temp < imuBoard.thermal_min)
+        return imuBoard.thermal_min;
+    if(temp > imuBoard.thermal_max)
+        return imuBoard.thermal_max;
+    return temp;
+}
+
+/* Stored bias at the current temperature, onboard_imu_thermal_step follows its drift from there */
+static void onboard_imu_stored_bias(float bias[3]){
+    imuBoard.thermal_temp = onboard_imu_thermal_clamp(imuBoard.my_raw_imu.temp);
+    imuBoard.thermal_tracking = 1;
+    imu_calib_gyro_bias(&imuBoard.calib, imuBoard.thermal_temp, bias);
+}
+
+/* Fit gyro bias against temperature while warming up, and follow its drift until settled */
+static void onboard_imu_thermal_step(void){
+    float temp = imuBoard.my_raw_imu.temp;
+    uint8_t settled = onboard_imu_temp_settled();
+    if(imuBoard.fitting) {
+        if(imuBoard.static_measurement_count > STATIC_TURN)
+            imu_calib_fit_add(&imuBoard.fit, temp, (float*)(&imuBoard.my_raw_imu.gyro.x));
+        // with the heater the fit ends once settled, without it as soon as it spans enough
+        if(settled || IMU_USE_HEATER == OFF) {
+            if(imu_calib_fit_solve(&imuBoard.fit, &imuBoard.calib)) {
+                imuBoard.fitting = 0;
+                imuBoard.thermal_min = imuBoard.fit.t_min;
+                imuBoard.thermal_max = imuBoard.fit.t_max;
+                print("Gyro bias fitted over %.1f to %.1f C\r\n", imuBoard.fit.t_min, imuBoard.fit.t_max);
+#if IMU_CALIB_STORE == ON
+                imuBoard.calib_dirty = 1;
+#endif
+            } else if(settled) {
+                imuBoard.fitting = 0;
+            }
+        }
+    }
+    if(!(imuBoard.calib.flags & IMU_CALIB_GYRO_TEMP))
+        return;
+    temp = onboard_imu_thermal_clamp(temp);
+    // shift the bias by the modelled drift only, the static average and kalman keep trimming it
+    if(imuBoard.thermal_tracking && !settled)
+        for(int axis = 0; axis < 3; ++axis)
+            imuBoard.angle_zero_bias[axis] += imuBoard.calib.gyro_slope[axis] * (temp - imuBoard.thermal_temp);
+    imuBoard.thermal_temp = temp;
+    imuBoard.thermal_tracking = 1;
 }
 
 void onboard_imu_update(void){
     mpu6500_get_data(&(imuBoard.my_raw_imu));
-    update_acc_angle();
-    if(fabs(imuBoard.my_raw_imu.gyro.x) < STATIC_LIM
-                && fabs(imuBoard.my_raw_imu.gyro.y) < STATIC_LIM
-                && fabs(imuBoard.my_raw_imu.gyro.z) < STATIC_LIM) {
+#if IMU_USE_AHRS == ON && IMU_AHRS_USE_MAG == ON
+    ist8310_get_data(&(imuBoard.my_raw_imu));
+#else
+    if(imuBoard.mag_calibrating)
+        ist8310_get_data(&(imuBoard.my_raw_imu));
+#endif
+    float dt = onboard_imu_timing_step(imuBoard.my_raw_imu.stamp_us);
+    // polling faster than the sensor returns the same sample again
+    if(dt <= 0)
+        return;
+    imuBoard.dt = dt;
+    onboard_imu_step();
+}
+
+/* Measure the step from sample stamps so scheduling jitter does not turn into drift.
+ * Returns the integration step in seconds, 0 for a sample already integrated. */
+static float onboard_imu_timing_step(uint32_t stamp_us){
+    imu_timing_t *timing = &imuBoard.timing;
+    if(timing->samples == 0) {
+        timing->last_us = stamp_us;
+        timing->samples = 1;
+        return timing->period;
+    }
+    uint32_t delta_us = stamp_us - timing->last_us;
+    if(delta_us == 0) {
+        ++timing->duplicate;
+        return 0;
+    }
+    timing->last_us = stamp_us;
+    ++timing->samples;
+    float dt = delta_us * 1e-6f;
+    if(dt > IMU_TIMING_MISS * timing->period) {
+        // a gap of n periods means n - 1 samples never reached us; keep it out of the period estimate
+        timing->missed += (uint32_t)(dt / timing->period + 0.5f) - 1;
+    } else {
+        float dev = dt - timing->period;
+        timing->period += IMU_TIMING_ALPHA * dev;
+        timing->jitter_var += IMU_TIMING_ALPHA * (dev * dev - timing->jitter_var);
+        if(fabsf(dev) > timing->max_jitter)
+            timing->max_jitter = fabsf(dev);
+    }
+    if(dt > IMU_DT_MAX_SCALE * timing->period) {
+        ++timing->clamped;
+        dt = IMU_DT_MAX_SCALE * timing->period;
+    }
+    return dt;
+}
+
+static void onboard_imu_filter_design(void){
+    float fs = 1.0f / imuBoard.timing.period;
+    float fc = IMU_GYRO_LPF_HZ < 0.45f * fs ? IMU_GYRO_LPF_HZ : 0.45f * fs;
+    for(int axis = 0; axis < 3; ++axis) {
+        biquad_cascade_init(&imuBoard.gyro_filter[axis], 1 + IMU_GYRO_NOTCHES);
+        biquad_lowpass(&imuBoard.gyro_filter[axis].stage[0], fs, fc, FILTER_Q_BUTTER);
+    }
+    // notches found so far are redesigned for the new rate by the next filter step,
+    // onboard_imu_vib_analyze restarts its window once it sees the new generation
+    imuBoard.notch_pending = 1;
+    imuBoard.filter_fs = fs;
+    imuBoard.filter_gen++;
+}
+
+static void onboard_imu_filter_step(void){
+    float* pgyro = (float*)(&imuBoard.my_raw_imu.gyro.x);
+    vib_add(&imuBoard.vib, pgyro);
+    if(imuBoard.notch_pending) {
+        // retuned in the sampling context so a step never sees half written coefficients
+        for(int n = 0; n < IMU_GYRO_NOTCHES; ++n) {
+            for(int axis = 0; axis < 3; ++axis) {
+                biquad_t* notch = &imuBoard.gyro_filter[axis].stage[1 + n];
+                if(imuBoard.notch_hz[n] > 0)
+                    biquad_notch(notch, imuBoard.filter_fs, imuBoard.notch_hz[n], IMU_GYRO_NOTCH_Q);
+                else
+                    biquad_bypass(notch);
+            }
+        }
+        imuBoard.notch_pending = 0;
+    }
+    for(int axis = 0; axis < 3; ++axis)
+        *(pgyro + axis) = biquad_cascade_step(&imuBoard.gyro_filter[axis], *(pgyro + axis));
+}
+
+uint8_t onboard_imu_vib_analyze(void){
+    if(imuBoard.vib_gen != imuBoard.filter_gen) {
+        // the window holds samples from before the last redesign, restart it at the new rate
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+        vib_init(&imuBoard.vib, imuBoard.filter_fs, 3);
+        imuBoard.vib_gen = imuBoard.filter_gen;
+        __set_PRIMASK(primask);
+        return 0;
+    }
+    if(imuBoard.notch_pending)
+        return 0;
+    uint8_t gen = imuBoard.vib_gen;
+    float max_hz = IMU_VIB_MAX_HZ < 0.45f * imuBoard.vib.fs ? IMU_VIB_MAX_HZ : 0.45f * imuBoard.vib.fs;
+    uint8_t found = vib_analyze(&imuBoard.vib, IMU_VIB_MIN_HZ, max_hz);
+    // redesigned while transforming, the peaks may belong to the old rate
+    if(imuBoard.filter_gen != gen)
+        return 0;
+    uint8_t taken[IMU_GYRO_NOTCHES] = {0};
+    for(int p = 0; p < VIB_PEAKS && p < found; ++p) {
+        // follow the nearest notch so peaks swapping rank do not make notches jump
+        int best = -1;
+        float best_dist = 0;
+        for(int n = 0; n < IMU_GYRO_NOTCHES; ++n) {
+            float dist = imuBoard.notch_hz[n] > 0 ? fabsf(imuBoard.notch_hz[n] - imuBoard.vib.peak_hz[p]) : max_hz;
+            if(!taken[n] && (best < 0 || dist < best_dist)) {
+                best = n;
+                best_dist = dist;
+            }
+        }
+        if(best < 0)
+            break;
+        taken[best] = 1;
+        if(imuBoard.notch_hz[best] > 0)
+            imuBoard.notch_hz[best] += IMU_VIB_SMOOTH * (imuBoard.vib.peak_hz[p] - imuBoard.notch_hz[best]);
+        else
+            imuBoard.notch_hz[best] = imuBoard.vib.peak_hz[p];
+    }
+    if(found)
+        imuBoard.notch_pending = 1;
+    return found;
+}
+
+void onboard_imu_mag_calib_start(void){
+    mag_calib_start(&imuBoard.mag_fit);
+    imuBoard.mag_calibrating = 1;
+}
+
+uint8_t onboard_imu_mag_calib_finish(void){
+    imu_calib_t solved;
+    imuBoard.mag_calibrating = 0;
+    imu_calib_default(&solved);
+    if(!mag_calib_solve(&imuBoard.mag_fit, &solved)) {
+        print("Magnetometer calibration failed with %u samples\r\n", (unsigned)imuBoard.mag_fit.count);
+        return 0;
+    }
+    // the sampling context applies the record, so it must never see half of a new matrix
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    memcpy(imuBoard.calib.mag_offset, solved.mag_offset, sizeof(solved.mag_offset));
+    memcpy(imuBoard.calib.mag_matrix, solved.mag_matrix, sizeof(solved.mag_matrix));
+    imuBoard.calib.flags |= IMU_CALIB_MAG;
+    mag_disturb_init(&imuBoard.mag_gate, imuBoard.mag_gate.current, imuBoard.mag_gate.current_lim);
+#if IMU_CALIB_STORE == ON
+    imuBoard.calib_dirty = 1;
+#endif
+    __set_PRIMASK(primask);
+    return 1;
+}
+
+void onboard_imu_mag_set_current_source(float (*current)(void), float limit){
+    mag_disturb_init(&imuBoard.mag_gate, current, limit);
+}
+
+uint16_t onboard_imu_update_batch(void){
+    uint32_t seq = onboard_imu_read_batch(&imu_batch);
+    if(seq == imu_batch_last || imu_batch.count == 0)
+        return 0;
+    if(imu_batch_last != 0)
+        imuBoard.batch_dropped += seq - imu_batch_last - 1;
+    imu_batch_last = seq;
+    for(uint16_t i = 0; i < imu_batch.count; ++i) {
+        float dt = onboard_imu_timing_step(imu_batch.sample[i].imu.stamp_us);
+        if(dt <= 0)
+            continue;
+        imuBoard.dt = dt;
+        // FIFO carries no magnetometer, keep the last one
+        imuBoard.my_raw_imu.acce = imu_batch.sample[i].imu.acce;
+        imuBoard.my_raw_imu.temp = imu_batch.sample[i].imu.temp;
+        imuBoard.my_raw_imu.gyro = imu_batch.sample[i].imu.gyro;
+        imuBoard.my_raw_imu.stamp_us = imu_batch.sample[i].imu.stamp_us;
+        onboard_imu_step();
+    }
+    return imu_batch.count;
+}
+
+static void onboard_imu_step(void){
+#if IMU_LOG == ON
+    // raw samples, before any calibration, so logs replay through the whole pipeline
+    imu_log_push(&imuLog, &imuBoard.my_raw_imu);
+#endif
+#if IMU_USE_HEATER == ON
+    imu_heater_update(imuBoard.my_raw_imu.temp);
+#endif
+    if(imuBoard.calib.flags & IMU_CALIB_ACCE)
+        imu_calib_apply_acce(&imuBoard.calib, &imuBoard.my_raw_imu);
+#if IMU_GYRO_FILTER == ON
+    // designed for the nominal rate, follow the measured one in both the polled and batch paths once it really moved
+    if(fabsf(1.0f / imuBoard.timing.period - imuBoard.filter_fs) > 0.01f * imuBoard.filter_fs)
+        onboard_imu_filter_design();
+    onboard_imu_filter_step();
+#endif
+    if(imuBoard.mag_calibrating) {
+        float raw[3] = {imuBoard.my_raw_imu.mag.x, imuBoard.my_raw_imu.mag.y, imuBoard.my_raw_imu.mag.z};
+        mag_calib_add(&imuBoard.mag_fit, raw);
+    }
+    if(imuBoard.calibrating) {
+        onboard_imu_calib_step();
+        return;
+    }
+    if(fabsf(imuBoard.my_raw_imu.gyro.x) < STATIC_LIM
+                && fabsf(imuBoard.my_raw_imu.gyro.y) < STATIC_LIM
+                && fabsf(imuBoard.my_raw_imu.gyro.z) < STATIC_LIM) {
         ++imuBoard.static_measurement_count;
     } else {
         imuBoard.static_measurement_count = 0;
     }
+    onboard_imu_thermal_step();
+#if IMU_CALIB_STORE == ON
+    // refine at a steady temperature, a drifting one is covered by the fit
+    if(imuBoard.refining && imuBoard.static_measurement_count > STATIC_TURN
+                && (onboard_imu_temp_settled() || IMU_USE_HEATER == OFF))
+        onboard_imu_refine_step();
+#endif
+#if IMU_USE_AHRS == ON
+    float gyro[3] = {(imuBoard.my_raw_imu.gyro.x - imuBoard.angle_zero_bias[IMU_X]) * DEG_2_RAD,
+                     (imuBoard.my_raw_imu.gyro.y - imuBoard.angle_zero_bias[IMU_Y]) * DEG_2_RAD,
+                     (imuBoard.my_raw_imu.gyro.z - imuBoard.angle_zero_bias[IMU_Z]) * DEG_2_RAD};
+    float acce[3] = {imuBoard.my_raw_imu.acce.x, imuBoard.my_raw_imu.acce.y, imuBoard.my_raw_imu.acce.z};
+    float mag[3];
+    uint8_t use_mag = 0;
+    // an uncalibrated or disturbed field would pull yaw towards the motors
+    if(IMU_AHRS_USE_MAG == ON && (imuBoard.calib.flags & IMU_CALIB_MAG) && !imuBoard.mag_calibrating) {
+        imu_calib_apply_mag(&imuBoard.calib, &imuBoard.my_raw_imu, mag);
+        use_mag = !mag_disturb_update(&imuBoard.mag_gate, mag, acce);
+    }
+    float euler[3];
+    ahrs_update(&imuBoard.ahrs, gyro, acce, use_mag ? mag : NULL, imuBoard.dt);
+    ahrs_get_euler(&imuBoard.ahrs, euler);
+    for(int axis = 0; axis < 3; ++axis)
+        imuBoard.angle[axis] = euler[axis] - imuBoard.ahrs_zero[axis];
+    return;
+#endif
+    update_acc_angle();
     if(imuBoard.static_measurement_count > STATIC_TURN){
         // Robot has been static for a while. We calibrate IMU accordingly.
         update_zero_bias();
@@ -103,7 +586,7 @@ void update_zero_bias(void){
 void discrete_integral(imu_axis_t desired_axis){
     float* pgyro = (float*)(&imuBoard.my_raw_imu.gyro.x);
     float rate = *(pgyro + desired_axis) - imuBoard.angle_zero_bias[desired_axis];
-    imuBoard.angle[desired_axis] += rate * IMU_DT;
+    imuBoard.angle[desired_axis] += rate * imuBoard.dt;
 }
 
 float kalman_filter_update(imu_axis_t desired_axis){
@@ -112,18 +595,18 @@ float kalman_filter_update(imu_axis_t desired_axis){
     float p_cache[4] = {0, 0, 0, 0};
     //EQ 1 - A priori state estimate
     //ideal estimated angle
-    float temp_angle = imuBoard.angle[desired_axis] + rate * IMU_DT;
+    float temp_angle = imuBoard.angle[desired_axis] + rate * imuBoard.dt;
     //EQ 2 - A priori estimate covariance
     //p_{k}_{k-1} (estimate from past observations)
     p_cache[0] = QANGLE - imuBoard.p_k[desired_axis][0][1] -
-                        imuBoard.p_k[desired_axis][1][0] + IMU_DT * imuBoard.p_k[desired_axis][1][1];
+                        imuBoard.p_k[desired_axis][1][0] + imuBoard.dt * imuBoard.p_k[desired_axis][1][1];
     p_cache[1] = -1 * imuBoard.p_k[desired_axis][1][1];
     p_cache[2] = -1 * imuBoard.p_k[desired_axis][1][1];
     p_cache[3] = QGYRO;
-    imuBoard.p_k[desired_axis][0][0] += p_cache[0] * IMU_DT; // IMU_DT^2 << 0. Ignore.
-    imuBoard.p_k[desired_axis][0][1] += p_cache[1] * IMU_DT;
-    imuBoard.p_k[desired_axis][1][0] += p_cache[2] * IMU_DT;
-    imuBoard.p_k[desired_axis][1][1] += p_cache[3] * IMU_DT;
+    imuBoard.p_k[desired_axis][0][0] += p_cache[0] * imuBoard.dt; // dt^2 << 0. Ignore.
+    imuBoard.p_k[desired_axis][0][1] += p_cache[1] * imuBoard.dt;
+    imuBoard.p_k[desired_axis][1][0] += p_cache[2] * imuBoard.dt;
+    imuBoard.p_k[desired_axis][1][1] += p_cache[3] * imuBoard.dt;
     //EQ 3 - Optimal Kalman Gain
     float angle_err = (imuBoard.acc_angle[desired_axis] - imuBoard.init_acc_angle[desired_axis]) - temp_angle;
     float E = RANGLE + imuBoard.p_k[desired_axis][0][0];
@@ -138,19 +621,20 @@ float kalman_filter_update(imu_axis_t desired_axis){
     temp_angle += k_0 * angle_err;
     imuBoard.angle[desired_axis] = temp_angle;
     imuBoard.angle_zero_bias[desired_axis] += k_1 * angle_err;
+    return temp_angle;
 }
 
 void update_acc_angle(void){
     // assume update angle has already been called
-    imuBoard.acc_angle[IMU_X] = atan2(imuBoard.my_raw_imu.acce.y, imuBoard.my_raw_imu.acce.z) * RAD_2_DEG;
-    imuBoard.acc_angle[IMU_Y] = atan2(imuBoard.my_raw_imu.acce.x, imuBoard.my_raw_imu.acce.z) * RAD_2_DEG;
+    imuBoard.acc_angle[IMU_X] = atan2f(imuBoard.my_raw_imu.acce.y, imuBoard.my_raw_imu.acce.z) * RAD_2_DEG;
+    imuBoard.acc_angle[IMU_Y] = atan2f(imuBoard.my_raw_imu.acce.x, imuBoard.my_raw_imu.acce.z) * RAD_2_DEG;
 
     // REWRITE this function if mechanical design change and RM board is relocated
     if(0) {
-        float grav_scalar = sqrt(imuBoard.acc_angle[IMU_X] * imuBoard.acc_angle[IMU_X]
+        float grav_scalar = sqrtf(imuBoard.acc_angle[IMU_X] * imuBoard.acc_angle[IMU_X]
                 + imuBoard.acc_angle[IMU_Y] * imuBoard.acc_angle[IMU_Y]
                 + imuBoard.acc_angle[IMU_Z] * imuBoard.acc_angle[IMU_Z]);
-        imuBoard.acc_angle[IMU_Z] = acos(imuBoard.my_raw_imu.acce.z / grav_scalar) * RAD_2_DEG;
+        imuBoard.acc_angle[IMU_Z] = acosf(imuBoard.my_raw_imu.acce.z / grav_scalar) * RAD_2_DEG;
     } else {
         imuBoard.acc_angle[IMU_Z] = 0;
     }
@@ -21,6 +21,13 @@
 
 #include "lib_config.h"
 #include "bsp_imu.h"
+#include "ahrs.h"
+#include "imu_calib.h"
+#include "imu_heater.h"
+#include "mag_calib.h"
+#include "filter.h"
+#include "vibration.h"
+#include "imu_log.h"
 #include <math.h>
 
 /**
@@ -35,6 +42,30 @@
 #define STATIC_LIM  4       // if (all) gyro values are smaller than this lim, we assume it's static
 #define STATIC_TURN 20      // we only start to update zero bias if the robots are static in 10 measurements
 #define IMUSAMPLES  1000     // how many gyro samples to grab
+#define IMU_CALIB_SEM       0.01f   // gyro bias standard error (deg/s) at which calibration is fully trusted
+#define IMU_CALIB_POLL_MS   10      // polling period of onboard_imu_wait_calibrated
+#define IMU_CALIB_TIMEOUT_MS 5000   // onboard_imu_lib_init gives up and uses the stored or zero gyro bias
+#define IMU_CALIB_STORE     ON      // ON: warm start from the calibration record in flash
+#define IMU_CALIB_WARM_CONF 0.5f    // confidence reported while a stored bias is being refined
+#define IMU_CALIB_SAVE_DELTA 0.02f  // deg/s, a converged bias closer than this to the stored one is not written
+#define IMU_USE_HEATER      OFF     // ON: hold the imu at IMU_HEATER_TARGET with the board heater
+
+#define IMU_GYRO_FILTER     OFF     // ON: lowpass and notch the gyro before calibration and fusion
+#define IMU_GYRO_LPF_HZ     150.0f  // gyro lowpass cutoff, clamped below Nyquist
+#define IMU_GYRO_NOTCHES    2       // dynamic notches per axis, off until onboard_imu_vib_analyze finds peaks
+#define IMU_GYRO_NOTCH_Q    4.0f    // notch center frequency over bandwidth
+#define IMU_VIB_MIN_HZ      40.0f   // vibration search band, below it is robot motion
+#define IMU_VIB_MAX_HZ      450.0f
+#define IMU_VIB_SMOOTH      0.3f    // fraction a notch moves towards a new peak per analysis window
+
+#define IMU_DT_MAX_SCALE    5.0f    // longest gap integrated, in sample periods; longer gaps are clamped
+#define IMU_TIMING_ALPHA    0.01f   // smoothing of the sample period and jitter estimates
+#define IMU_TIMING_MISS     1.5f    // a gap this many periods long means samples were lost
+#define IMU_LOG             OFF     // ON: queue every raw sample into imuLog for imu_log_flush to drain
+
+#define IMU_USE_AHRS        OFF             // ON: quaternion AHRS replaces the per-axis kalman filters
+#define IMU_AHRS_ALGO       AHRS_MAHONY     // AHRS_MAHONY or AHRS_MADGWICK
+#define IMU_AHRS_USE_MAG    OFF             // ON: correct yaw with the IST8310 once the magnetometer is calibrated
 
 typedef enum{
     ROLL  = 0,
@@ -48,6 +79,18 @@ typedef enum{
     IMU_Z = 2
 } imu_axis_t;
 
+/* sample period statistics, all times in seconds */
+typedef struct{
+    uint32_t last_us;               // stamp of the previous sample
+    uint32_t samples;               // samples integrated
+    uint32_t missed;                // samples inferred lost from gaps in the stamps
+    uint32_t duplicate;             // samples seen twice, not integrated again
+    uint32_t clamped;               // gaps longer than IMU_DT_MAX_SCALE periods
+    float period;                   // smoothed sample period
+    float jitter_var;               // smoothed variance of the period
+    float max_jitter;               // largest deviation from period seen
+} imu_timing_t;
+
 /* angles are all in degrees */
 /* Counterclockwise direction: positive */
 typedef struct {
@@ -58,10 +101,42 @@ typedef struct {
     float p_k[3][2][2];             // Error Covariance matrix
     int   static_measurement_count; // Static measurement count
     int   total_measurement_count;  // Total samples used.
+    float dt;                       // integration step in seconds, measured from sample stamps
+    imu_timing_t timing;            // sample period, jitter and lost sample statistics
+    uint32_t batch_dropped;         // FIFO batches overwritten before onboard_imu_update_batch read them
     imu_t my_raw_imu;              // raw imu struct
+    ahrs_t ahrs;                    // quaternion estimator used when IMU_USE_AHRS is ON
+    float ahrs_zero[3];             // AHRS angles at init, subtracted so angles stay relative
+    volatile uint8_t calibrating;   // background bias calibration in progress
+    volatile float calib_confidence; // [0, 1], 1 once the bias estimate is trusted
+    int   calib_count;              // static samples in the running estimate
+    float calib_mean[3];            // running gyro mean (deg/s)
+    float calib_m2[3];              // running sum of squared deviations
+    volatile uint8_t refining;      // stored bias in use, refined while static
+    imu_calib_t calib;              // calibration record loaded from / saved to flash
+    volatile uint8_t calib_dirty;   // calib changed since it was last written by onboard_imu_calib_flush
+    imu_calib_fit_t fit;            // gyro bias vs temperature samples taken while warming up
+    uint8_t fitting;                // bias vs temperature fit still collecting
+    float thermal_temp;             // temperature the bias was last shifted to by the fit
+    uint8_t thermal_tracking;       // thermal_temp is valid
+    float thermal_min;              // temperature span the fit is applied over
+    float thermal_max;
+    mag_calib_t mag_fit;            // magnetometer ellipsoid fit in progress
+    volatile uint8_t mag_calibrating; // magnetometer samples are being collected
+    mag_disturb_t mag_gate;         // gates magnetometer updates out of the AHRS
+    biquad_cascade_t gyro_filter[3]; // per axis lowpass followed by IMU_GYRO_NOTCHES notches
+    float filter_fs;                // sample rate the gyro filters are designed for
+    float notch_hz[IMU_GYRO_NOTCHES]; // notch centers, 0 while bypassed
+    volatile uint8_t notch_pending; // notch_hz changed, sampling context redesigns the notches
+    volatile uint8_t filter_gen;    // bumped by every filter redesign in the sampling context
+    vib_analyzer_t vib;             // raw gyro window for vibration analysis
+    uint8_t vib_gen;                // filter_gen the vibration window was started under
 } imu_onboard_t;
 
 extern imu_onboard_t imuBoard;
+#if IMU_LOG == ON
+extern imu_log_t imuLog;
+#endif
 
 /**
  * debug helper function that writes out angles calculated
@@ -69,6 +144,12 @@ extern imu_onboard_t imuBoard;
  */
 void print_imu_data(void);
 
+/**
+ * debug helper function that writes out sample period, jitter and lost samples
+ * @brief
+ */
+void print_imu_timing(void);
+
 /**
  * Print accelerometer, gyroscope, temp data
  *
@@ -80,16 +161,95 @@ void print_mpu_data(imu_t* imu);
 
 /**
  * Initialize onboard imu. Call this before (regularly) updating values or weird things happen!
+ * Polls the imu from the calling task until the gyro bias is calibrated, at most
+ * IMU_CALIB_TIMEOUT_MS, after which the stored or zero bias is used and refined once static.
  * @brief
  */
 void onboard_imu_lib_init(void);
 
+/**
+ * Start bias calibration in the background. onboard_imu_update keeps
+ * feeding it and only starts estimating angles once it is complete;
+ * motion restarts the estimate.
+ * With IMU_CALIB_STORE a stored gyro bias is used from the first sample
+ * instead and refined whenever the robot is static; the record is
+ * marked for onboard_imu_calib_flush only once the refined bias has converged.
+ * Static samples taken while the temperature changes are fitted to a
+ * linear bias vs temperature model, which shifts the bias by the modelled
+ * drift within the fitted span until the temperature settles (IMU_USE_HEATER)
+ * and is stored with the record.
+ * @brief
+ */
+void onboard_imu_calib_start(void);
+
+/**
+ * Write the calibration record to flash if it changed since the last flush.
+ * Programming stalls the flash and a full sector is erased first, which takes
+ * seconds, so call it from a low priority task, never from the sampling context.
+ * @brief
+ * @return 1 if the record is stored or unchanged, 0 if writing failed
+ */
+uint8_t onboard_imu_calib_flush(void);
+
+/**
+ * Block the calling task until bias calibration is confident enough
+ * @brief
+ * @param  min_confidence required confidence in [0, 1]
+ * @param  timeout_ms     give up after this long
+ * @return 1 if confident, 0 on timeout
+ */
+uint8_t onboard_imu_wait_calibrated(float min_confidence, uint32_t timeout_ms);
+
+/**
+ * Start collecting magnetometer samples for hard / soft iron calibration.
+ * Spin the robot, ideally also tilting it, until onboard_imu_mag_calib_finish.
+ * @brief
+ */
+void onboard_imu_mag_calib_start(void);
+
+/**
+ * Stop collecting and solve the magnetometer calibration. The result is
+ * applied immediately and, with IMU_CALIB_STORE, marked for onboard_imu_calib_flush.
+ * @brief
+ * @return 1 if a plausible calibration was found, 0 otherwise
+ */
+uint8_t onboard_imu_mag_calib_finish(void);
+
+/**
+ * Gate magnetometer updates out of the AHRS whenever a motor current exceeds a limit,
+ * on top of the field magnitude and dip angle checks
+ * @brief
+ * @param  current function returning the current to watch, NULL for none
+ * @param  limit   current above which the field is considered disturbed
+ */
+void onboard_imu_mag_set_current_source(float (*current)(void), float limit);
+
+/**
+ * Find the dominant vibration peaks in the latest raw gyro window and move
+ * the gyro notches onto them. Call periodically from a low priority task.
+ * @brief
+ * The window is restarted here after the sample rate changed, never from
+ * the sampling context, and peaks from a window that spans a redesign are dropped.
+ * @return number of peaks found, 0 if no window was ready
+ */
+uint8_t onboard_imu_vib_analyze(void);
+
 /**
  * Update my imu struct at this very moment. Should be call RIGHT before updating any angle
  * @brief
  */
 void onboard_imu_update(void);
 
+/**
+ * Run every sample of the latest FIFO batch through the same update as
+ * onboard_imu_update. Use instead of onboard_imu_update once
+ * onboard_imu_start_fifo succeeded, typically after ONBOARD_IMU_SIGNAL.
+ * Batches overwritten since the last call are added to imuBoard.batch_dropped.
+ * @brief
+ * @return number of samples processed, 0 if no new batch
+ */
+uint16_t onboard_imu_update_batch(void);
+
 /**
  * Update zero bias with current gyroscope data and sampled size in struct. DOES NOT perform sanity check!
  * @brief
@@ -0,0 +1,232 @@
+/**************************************************************************
+ *  Copyright (C) 2018 
+ *  Illini RoboMaster @ University of Illinois at Urbana-Champaign.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#include "mag_calib.h"
+
+static void mag_rls_init(mag_rls_t *rls, uint8_t n) {
+    memset(rls, 0, sizeof(mag_rls_t));
+    rls->n = n;
+    for (int i = 0; i < n; ++i)
+        rls->p[i][i] = MAG_CALIB_RLS_INIT;
+}
+
+static void mag_rls_update(mag_rls_t *rls, const float *phi) {
+    float pphi[MAG_RLS_MAX];
+    float denom = 1.0f;
+    float err   = 1.0f;
+    for (int i = 0; i < rls->n; ++i) {
+        pphi[i] = 0;
+        for (int j = 0; j < rls->n; ++j)
+            pphi[i] += rls->p[i][j] * phi[j];
+        denom += phi[i] * pphi[i];
+        err   -= phi[i] * rls->theta[i];
+    }
+    /* p is symmetric, so phi' p is pphi' */
+    for (int i = 0; i < rls->n; ++i) {
+        rls->theta[i] += pphi[i] * err / denom;
+        for (int j = 0; j < rls->n; ++j)
+            rls->p[i][j] -= pphi[i] * pphi[j] / denom;
+    }
+}
+
+/* Cyclic Jacobi eigen decomposition of a symmetric 3x3, a is destroyed */
+static void mag_jacobi(float a[3][3], float v[3][3], float d[3]) {
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j)
+            v[i][j] = i == j;
+    for (int sweep = 0; sweep < 16; ++sweep) {
+        float off = fabsf(a[0][1]) + fabsf(a[0][2]) + fabsf(a[1][2]);
+        if (off < 1e-9f)
+            break;
+        for (int p = 0; p < 2; ++p) {
+            for (int q = p + 1; q < 3; ++q) {
+                if (fabsf(a[p][q]) < 1e-12f)
+                    continue;
+                float theta = (a[q][q] - a[p][p]) / (2.0f * a[p][q]);
+                float t = (theta >= 0 ? 1.0f : -1.0f) / (fabsf(theta) + sqrtf(theta * theta + 1.0f));
+                float c = 1.0f / sqrtf(t * t + 1.0f);
+                float s = t * c;
+                for (int k = 0; k < 3; ++k) {
+                    float akp = a[k][p], akq = a[k][q];
+                    a[k][p] = c * akp - s * akq;
+                    a[k][q] = s * akp + c * akq;
+                }
+                for (int k = 0; k < 3; ++k) {
+                    float apk = a[p][k], aqk = a[q][k];
+                    a[p][k] = c * apk - s * aqk;
+                    a[q][k] = s * apk + c * aqk;
+                }
+                for (int k = 0; k < 3; ++k) {
+                    float vkp = v[k][p], vkq = v[k][q];
+                    v[k][p] = c * vkp - s * vkq;
+                    v[k][q] = s * vkp + c * vkq;
+                }
+            }
+        }
+    }
+    for (int i = 0; i < 3; ++i)
+        d[i] = a[i][i];
+}
+
+/* Turn (u - center)' A (u - center) = 1 in scaled units into offset and matrix */
+static uint8_t mag_calib_finish(float a[3][3], const float center[3], imu_calib_t *out) {
+    float v[3][3], d[3];
+    mag_jacobi(a, v, d);
+    if (d[0] <= 0 || d[1] <= 0 || d[2] <= 0)
+        return 0;
+    float d_min = fminf(d[0], fminf(d[1], d[2]));
+    float d_max = fmaxf(d[0], fmaxf(d[1], d[2]));
+    /* radii are 1 / sqrt(d) */
+    if (d_max > MAG_CALIB_MAX_ANISO * MAG_CALIB_MAX_ANISO * d_min)
+        return 0;
+    /* W = V sqrt(D) V' scaled so det(W) = 1, the average radius is kept */
+    float radius = powf(d[0] * d[1] * d[2], -1.0f / 6.0f);
+    float w[3];
+    for (int i = 0; i < 3; ++i)
+        w[i] = radius * sqrtf(d[i]);
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j)
+            out->mag_matrix[i][j] = v[i][0] * w[0] * v[j][0] + v[i][1] * w[1] * v[j][1] + v[i][2] * w[2] * v[j][2];
+        out->mag_offset[i] = center[i] * MAG_CALIB_SCALE;
+    }
+    out->flags |= IMU_CALIB_MAG;
+    return 1;
+}
+
+static uint8_t mag_calib_solve_ellipsoid(const mag_rls_t *rls, imu_calib_t *out) {
+    const float *t = rls->theta;
+    float a[3][3] = {{t[0], t[3], t[4]},
+                     {t[3], t[1], t[5]},
+                     {t[4], t[5], t[2]}};
+    /* center = -A^-1 (g, h, i) by cofactors */
+    float c00 = a[1][1] * a[2][2] - a[1][2] * a[2][1];
+    float c01 = a[0][2] * a[2][1] - a[0][1] * a[2][2];
+    float c02 = a[0][1] * a[1][2] - a[0][2] * a[1][1];
+    float c11 = a[0][0] * a[2][2] - a[0][2] * a[2][0];
+    float c12 = a[0][2] * a[1][0] - a[0][0] * a[1][2];
+    float c22 = a[0][0] * a[1][1] - a[0][1] * a[1][0];
+    float det = a[0][0] * c00 + a[0][1] * (a[1][2] * a[2][0] - a[1][0] * a[2][2]) + a[0][2] * (a[1][0] * a[2][1] - a[1][1] * a[2][0]);
+    if (fabsf(det) < 1e-12f)
+        return 0;
+    float center[3] = {-(c00 * t[6] + c01 * t[7] + c02 * t[8]) / det,
+                       -(c01 * t[6] + c11 * t[7] + c12 * t[8]) / det,
+                       -(c02 * t[6] + c12 * t[7] + c22 * t[8]) / det};
+    float k = 1.0f;
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j)
+            k += center[i] * a[i][j] * center[j];
+    if (k <= 0)
+        return 0;
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j)
+            a[i][j] /= k;
+    return mag_calib_finish(a, center, out);
+}
+
+/* Yaw only: fit the xy ellipse, keep z as is with a scale that makes det 1 */
+static uint8_t mag_calib_solve_ellipse(const mag_rls_t *rls, imu_calib_t *out) {
+    const float *t = rls->theta;
+    float det = t[0] * t[1] - t[2] * t[2];
+    if (det <= 1e-12f)
+        return 0;
+    float center[3] = {-(t[1] * t[3] - t[2] * t[4]) / det,
+                       -(t[0] * t[4] - t[2] * t[3]) / det,
+                       0};
+    float k = 1.0f + t[0] * center[0] * center[0] + 2.0f * t[2] * center[0] * center[1] + t[1] * center[1] * center[1];
+    if (k <= 0)
+        return 0;
+    float a[3][3] = {{t[0] / k, t[2] / k, 0},
+                     {t[2] / k, t[1] / k, 0},
+                     {0, 0, sqrtf(det) / k}};
+    return mag_calib_finish(a, center, out);
+}
+
+void mag_calib_start(mag_calib_t *calib) {
+    mag_rls_init(&calib->ellipsoid, 9);
+    mag_rls_init(&calib->ellipse, 5);
+    calib->count = 0;
+}
+
+uint8_t mag_calib_add(mag_calib_t *calib, const float mag[3]) {
+    if (calib->count) {
+        float dx = mag[0] - calib->last[0], dy = mag[1] - calib->last[1], dz = mag[2] - calib->last[2];
+        /* clusters of near identical readings would outweigh the rest of the sphere */
+        if (dx * dx + dy * dy + dz * dz < MAG_CALIB_MIN_STEP * MAG_CALIB_MIN_STEP)
+            return 0;
+    }
+    for (int i = 0; i < 3; ++i) {
+        if (calib->count == 0 || mag[i] < calib->min[i])
+            calib->min[i] = mag[i];
+        if (calib->count == 0 || mag[i] > calib->max[i])
+            calib->max[i] = mag[i];
+        calib->last[i] = mag[i];
+    }
+    calib->count++;
+    float x = mag[0] / MAG_CALIB_SCALE, y = mag[1] / MAG_CALIB_SCALE, z = mag[2] / MAG_CALIB_SCALE;
+    float phi3[9] = {x * x, y * y, z * z, 2 * x * y, 2 * x * z, 2 * y * z, 2 * x, 2 * y, 2 * z};
+    float phi2[5] = {x * x, y * y, 2 * x * y, 2 * x, 2 * y};
+    mag_rls_update(&calib->ellipsoid, phi3);
+    mag_rls_update(&calib->ellipse, phi2);
+    return 1;
+}
+
+uint8_t mag_calib_solve(const mag_calib_t *calib, imu_calib_t *out) {
+    if (calib->count < MAG_CALIB_MIN_SAMPLES)
+        return 0;
+    float span_xy = fminf(calib->max[0] - calib->min[0], calib->max[1] - calib->min[1]);
+    float span_z  = calib->max[2] - calib->min[2];
+    if (span_z < MAG_CALIB_FLAT_RATIO * span_xy)
+        return mag_calib_solve_ellipse(&calib->ellipse, out);
+    return mag_calib_solve_ellipsoid(&calib->ellipsoid, out);
+}
+
+void mag_disturb_init(mag_disturb_t *gate, float (*current)(void), float current_lim) {
+    memset(gate, 0, sizeof(mag_disturb_t));
+    gate->current     = current;
+    gate->current_lim = current_lim;
+}
+
+uint8_t mag_disturb_update(mag_disturb_t *gate, const float mag[3], const float acce[3]) {
+    float norm   = sqrtf(mag[0] * mag[0] + mag[1] * mag[1] + mag[2] * mag[2]);
+    float a_norm = sqrtf(acce[0] * acce[0] + acce[1] * acce[1] + acce[2] * acce[2]);
+    uint8_t bad = norm < 1e-6f || a_norm < 1e-6f;
+    float dip = 0;
+    if (!bad) {
+        dip = asinf((mag[0] * acce[0] + mag[1] * acce[1] + mag[2] * acce[2]) / (norm * a_norm)) * RAD_2_DEG;
+        if (gate->norm_ref == 0) {
+            gate->norm_ref = norm;
+            gate->dip_ref  = dip;
+        }
+        bad = fabsf(norm - gate->norm_ref) > MAG_DISTURB_NORM * gate->norm_ref
+           || fabsf(dip - gate->dip_ref) > MAG_DISTURB_DIP;
+    }
+    if (gate->current && fabsf(gate->current()) > gate->current_lim)
+        bad = 1;
+    if (bad) {
+        gate->hold = MAG_DISTURB_HOLD;
+    } else if (gate->hold) {
+        gate->hold--;
+    } else {
+        gate->norm_ref += MAG_DISTURB_LEARN * (norm - gate->norm_ref);
+        gate->dip_ref  += MAG_DISTURB_LEARN * (dip - gate->dip_ref);
+    }
+    gate->disturbed = gate->hold > 0;
+    if (gate->disturbed)
+        gate->disturbed_count++;
+    return gate->disturbed;
+}
@@ -0,0 +1,139 @@
+/**************************************************************************
+ *  Copyright (C) 2018 
+ *  Illini RoboMaster @ University of Illinois at Urbana-Champaign.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#ifndef _MAG_CALIB_H_
+#define _MAG_CALIB_H_
+
+#include "imu_calib.h"
+#include <math.h>
+
+/**
+ * @ingroup library
+ * @defgroup mag_calib Magnetometer Calibration
+ * @{
+ */
+
+#define MAG_CALIB_SCALE         500.0f  // raw counts, samples are divided by this to keep the fit well conditioned
+#define MAG_CALIB_MIN_STEP      8.0f    // raw counts a sample must move away from the last one used
+#define MAG_CALIB_MIN_SAMPLES   200     // samples needed before solving
+#define MAG_CALIB_FLAT_RATIO    0.3f    // z span below this fraction of the xy span fits a planar ellipse instead
+#define MAG_CALIB_MAX_ANISO     3.0f    // largest over smallest fitted radius accepted
+#define MAG_CALIB_RLS_INIT      1000.0f // initial covariance diagonal
+#define MAG_RLS_MAX             9       // parameters of the full ellipsoid
+
+#define MAG_DISTURB_NORM        0.15f   // relative field magnitude change flagged as disturbance
+#define MAG_DISTURB_DIP         10.0f   // degrees of dip angle change flagged as disturbance
+#define MAG_DISTURB_HOLD        50      // samples a disturbance is held after it clears
+#define MAG_DISTURB_LEARN       0.002f  // rate the reference magnitude and dip follow an undisturbed field
+
+/**
+ * @struct mag_rls_t
+ * @brief recursive least squares fit of theta . phi = 1
+ * @var n       number of parameters in use
+ * @var theta   parameter estimate
+ * @var p       covariance
+ */
+typedef struct {
+    uint8_t     n;
+    float       theta[MAG_RLS_MAX];
+    float       p[MAG_RLS_MAX][MAG_RLS_MAX];
+}   mag_rls_t;
+
+/**
+ * @struct mag_calib_t
+ * @brief incremental hard / soft iron calibration with bounded memory
+ * @var ellipsoid   fit of a x^2 + b y^2 + c z^2 + 2d xy + 2e xz + 2f yz + 2g x + 2h y + 2i z = 1
+ * @var ellipse     fit of a x^2 + b y^2 + 2d xy + 2g x + 2h y = 1, used when only yaw was excited
+ * @var count       samples used
+ * @var min         smallest raw reading per axis
+ * @var max         largest raw reading per axis
+ * @var last        last raw reading used
+ */
+typedef struct {
+    mag_rls_t   ellipsoid;
+    mag_rls_t   ellipse;
+    uint32_t    count;
+    float       min[3];
+    float       max[3];
+    float       last[3];
+}   mag_calib_t;
+
+/**
+ * @struct mag_disturb_t
+ * @brief run time magnetic disturbance detector
+ * @var norm_ref        learned magnitude of the corrected field
+ * @var dip_ref         learned angle between the field and the horizontal plane in degrees
+ * @var hold            samples left before a cleared disturbance is released
+ * @var disturbed       1 while magnetometer updates should be gated out
+ * @var disturbed_count samples gated out so far
+ * @var current         optional motor current source, NULL for none
+ * @var current_lim     current above which the field is considered disturbed
+ */
+typedef struct {
+    float       norm_ref;
+    float       dip_ref;
+    uint32_t    hold;
+    uint8_t     disturbed;
+    uint32_t    disturbed_count;
+    float       (*current)(void);
+    float       current_lim;
+}   mag_disturb_t;
+
+/**
+ * @brief start a new calibration, dropping all samples
+ * @param calib calibration state
+ */
+void mag_calib_start(mag_calib_t *calib);
+
+/**
+ * @brief feed one raw magnetometer reading, spin the robot through as many orientations as possible
+ * @param calib calibration state
+ * @param mag   raw magnetometer reading in counts
+ * @return 1 if the sample was used, 0 if it was too close to the previous one
+ */
+uint8_t mag_calib_add(mag_calib_t *calib, const float mag[3]);
+
+/**
+ * @brief solve the fit into hard iron offset and soft iron matrix
+ * @param calib calibration state
+ * @param out   record receiving mag_offset and mag_matrix, IMU_CALIB_MAG is set on success
+ * @return 1 for a plausible ellipsoid, 0 otherwise
+ * @note  corrected readings keep the average magnitude of the raw ones
+ */
+uint8_t mag_calib_solve(const mag_calib_t *calib, imu_calib_t *out);
+
+/**
+ * @brief reset a disturbance detector
+ * @param gate          detector
+ * @param current       motor current source, NULL for none
+ * @param current_lim   current above which the field is considered disturbed
+ */
+void mag_disturb_init(mag_disturb_t *gate, float (*current)(void), float current_lim);
+
+/**
+ * @brief check a corrected reading against the learned field
+ * @param gate  detector
+ * @param mag   calibrated magnetometer reading
+ * @param acce  accelerometer reading, gives the vertical for the dip angle
+ * @return 1 if magnetometer updates should be skipped, 0 otherwise
+ */
+uint8_t mag_disturb_update(mag_disturb_t *gate, const float mag[3], const float acce[3]);
+
+/** @} */
+
+#endif
@@ -31,6 +31,9 @@ static void get_3508_data(motor_t* motor, uint8_t buf[CAN_DATA_SIZE]) {
         (int16_t)(buf[4] << 8 | buf[5]) * CURRENT_CRT_3508;;
     motor->as.m3508.temperature      = \
         (uint8_t)buf[6];
+    if (motor->speed_filter)
+        motor->as.m3508.speed_rpm = (int16_t)lrintf(
+            biquad_cascade_step(motor->speed_filter, motor->as.m3508.speed_rpm));
 }
 
 static void print_3508_data(motor_t* motor) {
@@ -80,6 +83,9 @@ static void get_2006_data(motor_t *motor, uint8_t buf[CAN_DATA_SIZE]) {
         (int16_t)(buf[2] << 8 | buf[3]) * SPEED_CRT_2006;
     motor->as.m2006.current_get     = \
         (int16_t)(buf[4] << 8 | buf[5]) * CURRENT_CRT_2006;
+    if (motor->speed_filter)
+        motor->as.m2006.speed_rpm = (int16_t)lrintf(
+            biquad_cascade_step(motor->speed_filter, motor->as.m2006.speed_rpm));
 }
 
 static void print_2006_data(motor_t* motor) {
@@ -150,6 +156,7 @@ motor_t *can_motor_init(motor_t *motor,
     motor->as.mdjican.rx_id                = rx_id;
     motor->out                  = 1;
     motor->target               = 0;
+    motor->speed_filter         = NULL;
     if (rx_id >= CAN_RX1_START &&
             rx_id < CAN_RX1_START + CAN_GROUP_SIZE)
         motor->as.mdjican.tx_id = CAN_TX1_ID;
@@ -175,6 +182,7 @@ motor_t *pwm_motor_init(motor_t *motor, motor_type_t type,
     motor->type     = type;
     motor->out      = 0;
     motor->target   = 0;
+    motor->speed_filter = NULL;
 
     motor->as.mpwm.pwm              = pwm;
     motor->as.mpwm.idle_throttle    = idle_throttle;
@@ -332,3 +340,9 @@ void set_pwm_motor_output(motor_t *motor) {
     output += motor->as.mpwm.idle_throttle;
     pwm_set_pulse_width(motor->as.mpwm.pwm, output);
 }
+
+void set_motor_speed_filter(motor_t *motor, biquad_cascade_t *filter) {
+    if (filter)
+        biquad_cascade_reset(filter);
+    motor->speed_filter = filter;
+}
@@ -38,6 +38,7 @@
 #include "bsp_pwm.h"
 #include "bsp_error_handler.h"
 #include "bsp_print.h"
+#include "filter.h"
 
 #define CAN1_ID 1
 #define CAN2_ID 2
@@ -244,12 +245,14 @@ typedef union {
  * @var as      a union structure motor interpretation
  * @var cur_idx current index to write into the cicular buffer
  * @var out     Motor output to be used; clockwise.
+ * @var speed_filter    optional filter applied to speed_rpm on every get_motor_data, NULL for none
  */
 typedef struct {
     motor_interp_t  as;
     motor_type_t    type;
     float           target;
     float           out;
+    biquad_cascade_t *speed_filter;
 }   motor_t;
 
 /**************************************************************************
@@ -419,6 +422,14 @@ uint8_t set_can_motor_output(motor_t *motor1, motor_t *motor2,
  */
 void set_pwm_motor_output(motor_t *motor);
 
+/**
+ * @brief filter the speed feedback of a motor, e.g. notch out flywheel vibration
+ * @param motor     motor instance
+ * @param filter    filter designed for the rate get_motor_data is called at, NULL to remove
+ * @return none
+ */
+void set_motor_speed_filter(motor_t *motor, biquad_cascade_t *filter);
+
 /**
  * @brief get the latest angle data from a motor
  * @param motor a motor variable
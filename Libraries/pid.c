@@ -22,6 +22,7 @@
 #include "rm_config.h"
 #include "utils.h"
 #include "referee.h"
+#include "bsp_trace.h"
 
 static int32_t get_prev_n_err(pid_ctl_t *pid, uint8_t n) {
     return pid->err[(pid->idx + HISTORY_DATA_SIZE - n) % HISTORY_DATA_SIZE];
@@ -167,23 +168,38 @@ int32_t pid_power_ctl_delta_speed(pid_ctl_t *pid, int32_t target_power) {
     else if (target_power - pid->high_lim > 0)
         target_power = pid->high_lim;
     /* set power error into the circular buffer */
+    referee_snapshot_t referee;
+    referee_snapshot(&referee);
     pid->idx = (++pid->idx) % HISTORY_DATA_SIZE;
-    pid->err[pid->idx] = target_power - referee_info.power_heat_data.chassis_power;
+    pid->err[pid->idx] = target_power - referee.chassis_power;
     /* calculate generic position pid */
     return position_pid_calc(pid);
 }
 
+static void trace_pid(motor_t *motor) {
+#if TRACE_ENABLE == ON
+    if (motor->type >= MDJICAN)
+        return;
+    uint16_t node = motor->as.mdjican.rx_id - CAN1_RX_ID_START;
+    if (node >= TRACE_CAN_NODES)
+        return;
+    TRACE_POINT((motor->as.mdjican.can_id == CAN1_ID ? TRACE_PID_CAN1 : TRACE_PID_CAN2) + node);
+#endif
+}
+
 int32_t pid_calc(pid_ctl_t *pid, int32_t target) {
     switch (pid->mode) {
         case GIMBAL_AUTO_SHOOT:
         case GIMBAL_MAN_SHOOT:
             get_motor_data(pid->motor);
+            trace_pid(pid->motor);
             return pid_angle_ctl_angle(pid, target) + \
                 pid->model(pid->model_args);
         case CHASSIS_ROTATE:
         case FLYWHEEL:
         case POKE:
             get_motor_data(pid->motor);
+            trace_pid(pid->motor);
             return pid_speed_ctl_speed(pid, target) + \
                 pid->model(pid->model_args);
         case MANUAL_ERR_INPUT:
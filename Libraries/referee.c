@@ -29,7 +29,16 @@
 data_process_t  *referee_process;
 referee_t       referee_info;
 
+/* Sequence counter of referee_target, odd while a message is being copied in */
+static referee_t            *referee_target;
+static volatile uint32_t    referee_seq;
+static volatile uint32_t    referee_power_heat_stamp;
+
 uint8_t referee_init(data_process_t* source) {
+    referee_target = source->source_struct;
+    /* Register rx messages, frames are size checked and copied by data process */
+    if (!data_process_register_table(source, source->source_struct, referee_protocol, REFEREE_PROTOCOL_MSGS))
+        return 0;
     /* Initialize REFEREE to IDLE interrupt */
     uart_port_init(source->huart);
     /* Enable DMA for RX */
@@ -38,49 +47,89 @@ uint8_t referee_init(data_process_t* source) {
     return uart_dma_multibuffer_it(source->huart->hdmarx, (uint32_t)&source->huart->Instance->DR, (uint32_t)(source->buff[0]), (uint32_t)(source->buff[1]), source->buff_size);
 }
 
-uint8_t referee_dispatcher(void* target_struct, data_process_t* process_struct) {
-    /* @todo Need to consider racing condition here */
+uint8_t referee_decode(void* target, const uint8_t* data, uint16_t length) {
+    /* Writers never interleave with each other or with a reader on a single core, so readers only retry */
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    referee_seq++;
+    __DMB();
+    memcpy(target, data, length);
+    if (referee_target != NULL && target == &referee_target->power_heat_data)
+        referee_power_heat_stamp = HAL_GetTick();
+    __DMB();
+    referee_seq++;
+    __set_PRIMASK(primask);
+    return 1;
+}
+
+uint8_t referee_snapshot(referee_snapshot_t* snapshot) {
+    if (referee_target == NULL) {
+        memset(snapshot, 0, sizeof(referee_snapshot_t));
+        return 0;
+    }
+    const referee_t *referee = referee_target;
+    uint32_t seq;
+    do {
+        seq = referee_seq;
+        __DMB();
+#if REFEREE_PROTOCOL == REFEREE_PROTOCOL_2018
+        snapshot->game_progress         = referee->game_robot_info.game_process;
+        snapshot->stage_remain_time     = referee->game_robot_info.stage_remain_time;
+        snapshot->robot_level           = referee->game_robot_info.robot_grade;
+        snapshot->remain_hp             = referee->game_robot_info.remain_hp;
+        snapshot->max_hp                = referee->game_robot_info.max_hp;
+        snapshot->chassis_volt          = referee->power_heat_data.chassis_volt;
+        snapshot->chassis_current       = referee->power_heat_data.chassis_current;
+        snapshot->chassis_power         = referee->power_heat_data.chassis_power;
+        snapshot->chassis_power_buffer  = referee->power_heat_data.chassis_pwr_buf;
+        snapshot->barrel_heat_17        = referee->power_heat_data.barrel_heat_17;
+        snapshot->barrel_heat_42        = referee->power_heat_data.barrel_heat_42;
+        snapshot->cooling_rate_17       = 0;
+        snapshot->cooling_limit_17      = 0;
+        snapshot->cooling_rate_42       = 0;
+        snapshot->cooling_limit_42      = 0;
+        snapshot->bullet_type           = referee->shoot_data.bullet_type;
+        snapshot->bullet_freq           = referee->shoot_data.bullet_freq;
+        snapshot->bullet_speed          = referee->shoot_data.bullet_spd;
+#elif REFEREE_PROTOCOL == REFEREE_PROTOCOL_2019
+        snapshot->game_progress         = referee->game_state.game_progress;
+        snapshot->stage_remain_time     = referee->game_state.stage_remain_time;
+        snapshot->robot_level           = referee->game_robot_state.robot_level;
+        snapshot->remain_hp             = referee->game_robot_state.remain_hp;
+        snapshot->max_hp                = referee->game_robot_state.max_hp;
+        snapshot->chassis_volt          = referee->power_heat_data.chassis_volt / 1000.0f;
+        snapshot->chassis_current       = referee->power_heat_data.chassis_current / 1000.0f;
+        snapshot->chassis_power         = referee->power_heat_data.chassis_power;
+        snapshot->chassis_power_buffer  = referee->power_heat_data.chassis_power_buffer;
+        snapshot->barrel_heat_17        = referee->power_heat_data.shooter_heat0;
+        snapshot->barrel_heat_42        = referee->power_heat_data.shooter_heat1;
+        snapshot->cooling_rate_17       = referee->game_robot_state.shooter_heat0_cooling_rate;
+        snapshot->cooling_limit_17      = referee->game_robot_state.shooter_heat0_cooling_limit;
+        snapshot->cooling_rate_42       = referee->game_robot_state.shooter_heat1_cooling_rate;
+        snapshot->cooling_limit_42      = referee->game_robot_state.shooter_heat1_cooling_limit;
+        snapshot->bullet_type           = referee->shoot_data.bullet_type;
+        snapshot->bullet_freq           = referee->shoot_data.bullet_freq;
+        snapshot->bullet_speed          = referee->shoot_data.bullet_speed;
+#endif
+        snapshot->power_heat_stamp_ms   = referee_power_heat_stamp;
+        __DMB();
+    } while ((seq & 1) || seq != referee_seq);
+    return snapshot->power_heat_stamp_ms != 0;
+}
+
+uint8_t referee_dispatcher(void* target_struct, data_process_t* process_struct, uint16_t cmdid, const uint8_t* data_addr, uint16_t data_length) {
 #ifdef DEBUG
     BSP_DEBUG;
     print("Enter referee dispatcher.\r\n");
 #endif
-    referee_t* referee     = target_struct;
-    data_process_t* source = process_struct;
-    uint16_t data_length   = source->data_len;
-    uint16_t cmdid         = *(uint16_t*)(source->frame_packet + DATA_PROCESS_HEADER_LEN);
-    uint8_t* data_addr     = source->frame_packet + DATA_PROCESS_HEADER_LEN + DATA_PROCESS_CMD_LEN;
-
-    /* @todo Add frame length check here */
-    switch (cmdid) {
-        case CMD_GAME_ROBOT_INFO:
-            memcpy(&(referee->game_robot_info), data_addr, data_length);
-            break;
-        case CMD_DAMAGE_DATA:
-            memcpy(&(referee->damage_data), data_addr, data_length);
-            break;
-        case CMD_SHOOT_DATA:
-            memcpy(&(referee->shoot_data), data_addr, data_length);
-            break;
-        case CMD_POWER_HEAT_DATA:
-            memcpy(&(referee->power_heat_data), data_addr, data_length);
-            break;
-        case CMD_RFID_DATA:
-            memcpy(&(referee->rfid_data), data_addr, data_length);
-            break;
-        case CMD_GAME_RESULT:
-            memcpy(&(referee->game_result), data_addr, data_length);
-            break;
-        case CMD_BUFF_DATA:
-            memcpy(&(referee->buff_data), data_addr, data_length);
-            break;
-        case CMD_ROBOT_POSITION:
-            memcpy(&(referee->robot_position), data_addr, data_length);
-            break;
-        default:
-            bsp_error_handler(__FUNCTION__, __LINE__, "Unknown CMDID.");
-            return 0;
-    }
-    return 1;
+    /* Known commands are registered in referee_init and never get here */
+    UNUSED(target_struct);
+    UNUSED(process_struct);
+    UNUSED(cmdid);
+    UNUSED(data_addr);
+    UNUSED(data_length);
+    bsp_error_handler(__FUNCTION__, __LINE__, "Unknown CMDID.");
+    return 0;
 }
 
 uint8_t referee_packer(void *target_struct, data_process_t *process_struct, uint16_t cmdid) {
@@ -90,17 +139,12 @@ uint8_t referee_packer(void *target_struct, data_process_t *process_struct, uint
 #endif
     referee_t *referee      = target_struct;
     data_process_t *source  = process_struct;
-    uint8_t *data_stream    = NULL;
     uint16_t data_length    = 0;
+    uint8_t *data_stream    = data_process_msg_payload(referee_protocol, REFEREE_PROTOCOL_MSGS, referee, cmdid, &data_length);
 
-    switch (cmdid) {
-        case CMD_CUSTOM_DATA:
-            data_stream = (uint8_t*)&referee->custom_data;
-            data_length = (uint16_t)sizeof(custom_data_t);
-            break;
-        default:
-            bsp_error_handler(__FUNCTION__, __LINE__, "Unknown CMDID.");
-            return 0;
+    if (data_stream == NULL) {
+        bsp_error_handler(__FUNCTION__, __LINE__, "Unknown CMDID.");
+        return 0;
     }
 
     data_to_fifo(cmdid, data_stream, data_length, source); // Put data into tx fifo
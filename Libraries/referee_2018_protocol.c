@@ -0,0 +1,56 @@
+/**************************************************************************
+ *  Copyright (C) 2018
+ *  Illini RoboMaster @ University of Illinois at Urbana-Champaign.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+/**
+ * @file    referee_2018_protocol.c
+ * @brief   Referee system messages, 2018 rule set. Generated from Tools/protocol/referee_2018.json by protogen.py, do not edit
+ */
+
+#include "referee.h"
+
+#if REFEREE_PROTOCOL == REFEREE_PROTOCOL_2018
+
+#include "referee_2018_protocol.h"
+#include <stddef.h>
+
+/* Structs must match the wire size from the schema, a mismatch fails to compile */
+#define REFEREE_SIZE_CHECK(type, size) typedef char type##_size_check[(sizeof(type) == (size)) ? 1 : -1]
+
+REFEREE_SIZE_CHECK(game_robot_info_t, 8);
+REFEREE_SIZE_CHECK(damage_data_t, 1);
+REFEREE_SIZE_CHECK(shoot_data_t, 6);
+REFEREE_SIZE_CHECK(power_heat_data_t, 20);
+REFEREE_SIZE_CHECK(rfid_data_t, 2);
+REFEREE_SIZE_CHECK(game_result_t, 1);
+REFEREE_SIZE_CHECK(buff_data_t, 2);
+REFEREE_SIZE_CHECK(robot_position_t, 16);
+REFEREE_SIZE_CHECK(custom_data_t, 13);
+
+const data_process_msg_t referee_protocol[REFEREE_PROTOCOL_MSGS] = {
+    {CMD_GAME_ROBOT_INFO, DATA_PROCESS_RX, offsetof(referee_t, game_robot_info), sizeof(game_robot_info_t), referee_decode},
+    {CMD_DAMAGE_DATA, DATA_PROCESS_RX, offsetof(referee_t, damage_data), sizeof(damage_data_t), referee_decode},
+    {CMD_SHOOT_DATA, DATA_PROCESS_RX, offsetof(referee_t, shoot_data), sizeof(shoot_data_t), referee_decode},
+    {CMD_POWER_HEAT_DATA, DATA_PROCESS_RX, offsetof(referee_t, power_heat_data), sizeof(power_heat_data_t), referee_decode},
+    {CMD_RFID_DATA, DATA_PROCESS_RX, offsetof(referee_t, rfid_data), sizeof(rfid_data_t), referee_decode},
+    {CMD_GAME_RESULT, DATA_PROCESS_RX, offsetof(referee_t, game_result), sizeof(game_result_t), referee_decode},
+    {CMD_BUFF_DATA, DATA_PROCESS_RX, offsetof(referee_t, buff_data), sizeof(buff_data_t), referee_decode},
+    {CMD_ROBOT_POSITION, DATA_PROCESS_RX, offsetof(referee_t, robot_position), sizeof(robot_position_t), referee_decode},
+    {CMD_CUSTOM_DATA, DATA_PROCESS_TX, offsetof(referee_t, custom_data), sizeof(custom_data_t), NULL},
+};
+
+#endif
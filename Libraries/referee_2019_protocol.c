@@ -0,0 +1,66 @@
+/**************************************************************************
+ *  Copyright (C) 2018
+ *  Illini RoboMaster @ University of Illinois at Urbana-Champaign.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+/**
+ * @file    referee_2019_protocol.c
+ * @brief   Referee system messages, 2019 rule set. Generated from Tools/protocol/referee_2019.json by protogen.py, do not edit
+ */
+
+#include "referee.h"
+
+#if REFEREE_PROTOCOL == REFEREE_PROTOCOL_2019
+
+#include "referee_2019_protocol.h"
+#include <stddef.h>
+
+/* Structs must match the wire size from the schema, a mismatch fails to compile */
+#define REFEREE_SIZE_CHECK(type, size) typedef char type##_size_check[(sizeof(type) == (size)) ? 1 : -1]
+
+REFEREE_SIZE_CHECK(game_state_t, 3);
+REFEREE_SIZE_CHECK(game_result_t, 1);
+REFEREE_SIZE_CHECK(game_robot_survivors_t, 2);
+REFEREE_SIZE_CHECK(event_data_t, 4);
+REFEREE_SIZE_CHECK(supply_projectile_action_t, 4);
+REFEREE_SIZE_CHECK(supply_projectile_booking_t, 3);
+REFEREE_SIZE_CHECK(game_robot_state_t, 15);
+REFEREE_SIZE_CHECK(power_heat_data_t, 14);
+REFEREE_SIZE_CHECK(game_robot_pos_t, 16);
+REFEREE_SIZE_CHECK(buff_musk_t, 1);
+REFEREE_SIZE_CHECK(aerial_robot_energy_t, 2);
+REFEREE_SIZE_CHECK(robot_hurt_t, 1);
+REFEREE_SIZE_CHECK(shoot_data_t, 6);
+REFEREE_SIZE_CHECK(student_interactive_t, 19);
+
+const data_process_msg_t referee_protocol[REFEREE_PROTOCOL_MSGS] = {
+    {CMD_GAME_STATE, DATA_PROCESS_RX, offsetof(referee_t, game_state), sizeof(game_state_t), referee_decode},
+    {CMD_GAME_RESULT, DATA_PROCESS_RX, offsetof(referee_t, game_result), sizeof(game_result_t), referee_decode},
+    {CMD_GAME_ROBOT_SURVIVORS, DATA_PROCESS_RX, offsetof(referee_t, game_robot_survivors), sizeof(game_robot_survivors_t), referee_decode},
+    {CMD_EVENT_DATA, DATA_PROCESS_RX, offsetof(referee_t, event_data), sizeof(event_data_t), referee_decode},
+    {CMD_SUPPLY_PROJECTILE_ACTION, DATA_PROCESS_RX, offsetof(referee_t, supply_projectile_action), sizeof(supply_projectile_action_t), referee_decode},
+    {CMD_SUPPLY_PROJECTILE_BOOKING, DATA_PROCESS_TX, offsetof(referee_t, supply_projectile_booking), sizeof(supply_projectile_booking_t), NULL},
+    {CMD_GAME_ROBOT_STATE, DATA_PROCESS_RX, offsetof(referee_t, game_robot_state), sizeof(game_robot_state_t), referee_decode},
+    {CMD_POWER_HEAT_DATA, DATA_PROCESS_RX, offsetof(referee_t, power_heat_data), sizeof(power_heat_data_t), referee_decode},
+    {CMD_GAME_ROBOT_POS, DATA_PROCESS_RX, offsetof(referee_t, game_robot_pos), sizeof(game_robot_pos_t), referee_decode},
+    {CMD_BUFF_MUSK, DATA_PROCESS_RX, offsetof(referee_t, buff_musk), sizeof(buff_musk_t), referee_decode},
+    {CMD_AERIAL_ROBOT_ENERGY, DATA_PROCESS_RX, offsetof(referee_t, aerial_robot_energy), sizeof(aerial_robot_energy_t), referee_decode},
+    {CMD_ROBOT_HURT, DATA_PROCESS_RX, offsetof(referee_t, robot_hurt), sizeof(robot_hurt_t), referee_decode},
+    {CMD_SHOOT_DATA, DATA_PROCESS_RX, offsetof(referee_t, shoot_data), sizeof(shoot_data_t), referee_decode},
+    {CMD_STUDENT_INTERACTIVE, DATA_PROCESS_RX | DATA_PROCESS_TX, offsetof(referee_t, student_interactive), sizeof(student_interactive_t), referee_decode},
+};
+
+#endif
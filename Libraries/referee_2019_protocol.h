@@ -0,0 +1,241 @@
+/**************************************************************************
+ *  Copyright (C) 2018
+ *  Illini RoboMaster @ University of Illinois at Urbana-Champaign.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+/**
+ * @file    referee_2019_protocol.h
+ * @brief   Referee system messages, 2019 rule set. Generated from Tools/protocol/referee_2019.json by protogen.py, do not edit
+ */
+
+#ifndef _REFEREE_2019_PROTOCOL_H_
+#define _REFEREE_2019_PROTOCOL_H_
+
+#include "data_process.h"
+
+/*
+ * Document version 2019/05/09 v2.0
+ */
+
+#define REFEREE_PROTOCOL_SOF    0xA5
+#define REFEREE_PROTOCOL_MSGS   14
+
+typedef enum {
+    CMD_GAME_STATE                      = 0x0001,
+    CMD_GAME_RESULT                     = 0x0002,
+    CMD_GAME_ROBOT_SURVIVORS            = 0x0003,
+    CMD_EVENT_DATA                      = 0x0101,
+    CMD_SUPPLY_PROJECTILE_ACTION        = 0x0102,
+    CMD_SUPPLY_PROJECTILE_BOOKING       = 0x0103,
+    CMD_GAME_ROBOT_STATE                = 0x0201,
+    CMD_POWER_HEAT_DATA                 = 0x0202,
+    CMD_GAME_ROBOT_POS                  = 0x0203,
+    CMD_BUFF_MUSK                       = 0x0204,
+    CMD_AERIAL_ROBOT_ENERGY             = 0x0205,
+    CMD_ROBOT_HURT                      = 0x0206,
+    CMD_SHOOT_DATA                      = 0x0207,
+    CMD_STUDENT_INTERACTIVE             = 0x0301,
+} referee_cmdid_t;
+
+/* ===== CMD_GAME_STATE 0x0001, rx 1 Hz ===== */
+typedef struct {
+    uint8_t     game_type:4;            // Competition type [game_type_t]
+    uint8_t     game_progress:4;        // Current stage [game_process_t]
+    uint16_t    stage_remain_time;      // Remaining time in the current stage (seconds)
+} __packed game_state_t;
+
+typedef enum {
+    GAME_TYPE_RMUC       = 1,       // RoboMaster robotics competition
+    GAME_TYPE_SINGLE     = 2,       // RoboMaster single item competition
+    GAME_TYPE_ICRA       = 3,       // ICRA RoboMaster AI challenge
+} game_type_t;
+
+typedef enum {
+    GAME_NOT_START   = 0,       // Pre-competition stage
+    GAME_PREP        = 1,       // Preparation stage
+    GAME_INIT        = 2,       // 15-second self check
+    GAME_5S_CNT      = 3,       // 5-second countdown
+    GAME_IN_GAME     = 4,       // In combat
+    GAME_RESULT      = 5,       // Calculating competition result
+} game_process_t;
+
+/* ===== CMD_GAME_RESULT 0x0002, rx on event ===== */
+typedef struct {
+    uint8_t winner;     // Competition result [result_t]
+} __packed game_result_t;
+
+typedef enum {
+    RESULT_DRAW  = 0,       // Draw
+    RESULT_RED   = 1,       // Red team win
+    RESULT_BLUE  = 2,       // Blue team win
+} result_t;
+
+/* ===== CMD_GAME_ROBOT_SURVIVORS 0x0003, rx 1 Hz ===== */
+typedef struct {
+    uint16_t    robot_legion;       // One bit per robot, set while it survives. Red 1-7 in bits 0-6, blue in bits 8-14
+} __packed game_robot_survivors_t;
+
+/* ===== CMD_EVENT_DATA 0x0101, rx on event ===== */
+typedef struct {
+    uint32_t    event_type;     // Field events of our side, see the rule manual for the bits
+} __packed event_data_t;
+
+/* ===== CMD_SUPPLY_PROJECTILE_ACTION 0x0102, rx on event ===== */
+typedef struct {
+    uint8_t supply_projectile_id;       // Supply outlet
+    uint8_t supply_robot_id;            // Robot being supplied, 0 if none [robot_id_t]
+    uint8_t supply_projectile_step;     // Outlet state [supply_step_t]
+    uint8_t supply_projectile_num;      // Projectiles supplied
+} __packed supply_projectile_action_t;
+
+typedef enum {
+    SUPPLY_CLOSED        = 0,       // Outlet closed
+    SUPPLY_PREPARING     = 1,       // Projectiles being prepared
+    SUPPLY_DROPPING      = 2,       // Projectiles dropping
+} supply_step_t;
+
+/* ===== CMD_SUPPLY_PROJECTILE_BOOKING 0x0103, tx 10 Hz ===== */
+typedef struct {
+    uint8_t supply_projectile_id;       // Supply outlet, 0 for the first free one
+    uint8_t supply_robot_id;            // Robot to supply [robot_id_t]
+    uint8_t supply_num;                 // Projectiles requested, multiples of 50
+} __packed supply_projectile_booking_t;
+
+/* ===== CMD_GAME_ROBOT_STATE 0x0201, rx 10 Hz ===== */
+typedef struct {
+    uint8_t     robot_id;                           // This robot [robot_id_t]
+    uint8_t     robot_level;                        // Robot's current level
+    uint16_t    remain_hp;                          // Robot's current HP
+    uint16_t    max_hp;                             // Robot's maximum HP
+    uint16_t    shooter_heat0_cooling_rate;         // 17mm barrel cooling per second
+    uint16_t    shooter_heat0_cooling_limit;        // 17mm barrel heat limit
+    uint16_t    shooter_heat1_cooling_rate;         // 42mm barrel cooling per second
+    uint16_t    shooter_heat1_cooling_limit;        // 42mm barrel heat limit
+    uint8_t     mains_power_gimbal_output:1;        // Gimbal supply on
+    uint8_t     mains_power_chassis_output:1;       // Chassis supply on
+    uint8_t     mains_power_shooter_output:1;       // Shooter supply on
+    uint8_t     mains_power_reserve:5;              // Reserved
+} __packed game_robot_state_t;
+
+typedef enum {
+    ROBOT_RED_HERO           = 1,
+    ROBOT_RED_ENGINEER       = 2,
+    ROBOT_RED_INFANTRY_1     = 3,
+    ROBOT_RED_INFANTRY_2     = 4,
+    ROBOT_RED_INFANTRY_3     = 5,
+    ROBOT_RED_AERIAL         = 6,
+    ROBOT_RED_SENTRY         = 7,
+    ROBOT_BLUE_HERO          = 11,
+    ROBOT_BLUE_ENGINEER      = 12,
+    ROBOT_BLUE_INFANTRY_1    = 13,
+    ROBOT_BLUE_INFANTRY_2    = 14,
+    ROBOT_BLUE_INFANTRY_3    = 15,
+    ROBOT_BLUE_AERIAL        = 16,
+    ROBOT_BLUE_SENTRY        = 17,
+} robot_id_t;
+
+/* ===== CMD_POWER_HEAT_DATA 0x0202, rx 50 Hz ===== */
+typedef struct {
+    uint16_t    chassis_volt;               // Chassis output voltage (millivolt)
+    uint16_t    chassis_current;            // Chassis output current (milliampere)
+    float       chassis_power;              // Chassis output power (watt)
+    uint16_t    chassis_power_buffer;       // Chassis power buffer (joule)
+    uint16_t    shooter_heat0;              // 17mm barrel heat
+    uint16_t    shooter_heat1;              // 42mm barrel heat
+} __packed power_heat_data_t;
+
+/* ===== CMD_GAME_ROBOT_POS 0x0203, rx 10 Hz ===== */
+typedef struct {
+    float   x;      // Position X (meter)
+    float   y;      // Position Y (meter)
+    float   z;      // Position Z (meter)
+    float   yaw;    // Barrel Yaw (degree)
+} __packed game_robot_pos_t;
+
+/* ===== CMD_BUFF_MUSK 0x0204, rx on event ===== */
+typedef struct {
+    uint8_t buff_heal:1;            // 0 HP regeneration
+    uint8_t buff_cool_down:1;       // 1 Barrel cooling doubled
+    uint8_t buff_defense:1;         // 2 Defense buff
+    uint8_t buff_attack:1;          // 3 Attack buff
+    uint8_t buff_reserve:4;         // 4:7 Reserved
+} __packed buff_musk_t;
+
+/* ===== CMD_AERIAL_ROBOT_ENERGY 0x0205, rx 10 Hz ===== */
+typedef struct {
+    uint8_t energy_point;       // Accumulated energy
+    uint8_t attack_time;        // Remaining attack time (seconds)
+} __packed aerial_robot_energy_t;
+
+/* ===== CMD_ROBOT_HURT 0x0206, rx on event ===== */
+typedef struct {
+    uint8_t armor_id:4;     // Armor hit if hurt type is armor damage
+    uint8_t hurt_type:4;    // Type of damage [hurt_type_t]
+} __packed robot_hurt_t;
+
+typedef enum {
+    HURT_ARMOR           = 0,       // Armor hit
+    HURT_MOD_OFFLINE     = 1,       // Module offline
+    HURT_OVER_HEAT       = 2,       // Barrel heat over limit
+    HURT_OVER_POWER      = 3,       // Chassis power over limit
+} hurt_type_t;
+
+/* ===== CMD_SHOOT_DATA 0x0207, rx on event ===== */
+typedef struct {
+    uint8_t bullet_type;        // Projectile type [bullet_type_t]
+    uint8_t bullet_freq;        // Projectile launching frequency (bullets per second)
+    float   bullet_speed;       // Projectile launching speed (meters per second)
+} __packed shoot_data_t;
+
+typedef enum {
+    BULLET_17MM  = 1,       // 17mm projectile
+    BULLET_42MM  = 2,       // 42mm projectile
+} bullet_type_t;
+
+/* ===== CMD_STUDENT_INTERACTIVE 0x0301, both 10 Hz ===== */
+typedef struct {
+    uint16_t    data_cmd_id;    // Content ID, 0xD180 for client custom data, 0x0200-0x02FF between robots
+    uint16_t    sender_id;      // Sending robot [robot_id_t]
+    uint16_t    receiver_id;    // Receiving robot, or client ID 0x0100 + robot ID
+    uint8_t     data[13];       // Content, three floats and a light mask for client custom data
+} __packed student_interactive_t;
+
+/* ============================== */
+
+typedef struct {
+    game_state_t                game_state;                     // 0x0001
+    game_result_t               game_result;                    // 0x0002
+    game_robot_survivors_t      game_robot_survivors;           // 0x0003
+    event_data_t                event_data;                     // 0x0101
+    supply_projectile_action_t  supply_projectile_action;       // 0x0102
+    supply_projectile_booking_t supply_projectile_booking;      // 0x0103
+    game_robot_state_t          game_robot_state;               // 0x0201
+    power_heat_data_t           power_heat_data;                // 0x0202
+    game_robot_pos_t            game_robot_pos;                 // 0x0203
+    buff_musk_t                 buff_musk;                      // 0x0204
+    aerial_robot_energy_t       aerial_robot_energy;            // 0x0205
+    robot_hurt_t                robot_hurt;                     // 0x0206
+    shoot_data_t                shoot_data;                     // 0x0207
+    student_interactive_t       student_interactive;            // 0x0301
+} referee_t;
+
+/* Every message of the link, offsets are into referee_t */
+extern const data_process_msg_t referee_protocol[REFEREE_PROTOCOL_MSGS];
+
+/* Decode callbacks named by the schema, implemented by hand */
+uint8_t referee_decode(void* target, const uint8_t* data, uint16_t length);
+
+#endif
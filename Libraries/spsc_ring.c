@@ -0,0 +1,89 @@
+/**************************************************************************
+ *  Copyright (C) 2018 
+ *  Illini RoboMaster @ University of Illinois at Urbana-Champaign.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#include "spsc_ring.h"
+
+/* Copy len bytes starting at ring position pos out of the ring, in at most two pieces */
+static void spsc_ring_copy_out(const spsc_ring_t *ring, uint32_t pos, uint8_t *dst, uint32_t len) {
+    uint32_t idx   = pos & ring->mask;
+    uint32_t first = ring->mask + 1 - idx;
+    if (first > len)
+        first = len;
+    memcpy(dst, ring->buf + idx, first);
+    memcpy(dst + first, ring->buf, len - first);
+}
+
+uint32_t spsc_ring_capacity(uint32_t size) {
+    uint32_t cap = 1;
+    while (cap < size)
+        cap <<= 1;
+    return cap;
+}
+
+uint8_t spsc_ring_init(spsc_ring_t *ring, uint8_t *buf, uint32_t size) {
+    if (buf == NULL || size == 0 || (size & (size - 1)) != 0)
+        return 0;
+    ring->buf  = buf;
+    ring->mask = size - 1;
+    ring->head = 0;
+    ring->tail = 0;
+    return 1;
+}
+
+uint32_t spsc_ring_put(spsc_ring_t *ring, const uint8_t *src, uint32_t len) {
+    uint32_t head = ring->head;
+    /* acquire pairs with the consumer's release, the bytes it freed are no longer read */
+    uint32_t free = ring->mask + 1 - (head - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE));
+    if (len > free)
+        len = free;
+    uint32_t idx   = head & ring->mask;
+    uint32_t first = ring->mask + 1 - idx;
+    if (first > len)
+        first = len;
+    memcpy(ring->buf + idx, src, first);
+    memcpy(ring->buf, src + first, len - first);
+    /* publish the bytes only after they are written */
+    __atomic_store_n(&ring->head, head + len, __ATOMIC_RELEASE);
+    return len;
+}
+
+uint32_t spsc_ring_get(spsc_ring_t *ring, uint8_t *dst, uint32_t len) {
+    uint32_t tail = ring->tail;
+    uint32_t used = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) - tail;
+    if (len > used)
+        len = used;
+    if (dst != NULL)
+        spsc_ring_copy_out(ring, tail, dst, len);
+    __atomic_store_n(&ring->tail, tail + len, __ATOMIC_RELEASE);
+    return len;
+}
+
+uint32_t spsc_ring_peek(const spsc_ring_t *ring, uint32_t offset, uint8_t *dst, uint32_t len) {
+    uint32_t tail = ring->tail;
+    uint32_t used = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) - tail;
+    if (offset >= used)
+        return 0;
+    if (len > used - offset)
+        len = used - offset;
+    spsc_ring_copy_out(ring, tail + offset, dst, len);
+    return len;
+}
+
+void spsc_ring_flush(spsc_ring_t *ring) {
+    __atomic_store_n(&ring->tail, __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE), __ATOMIC_RELEASE);
+}
@@ -0,0 +1,114 @@
+/**************************************************************************
+ *  Copyright (C) 2018 
+ *  Illini RoboMaster @ University of Illinois at Urbana-Champaign.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#ifndef _SPSC_RING_H_
+#define _SPSC_RING_H_
+
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * @ingroup library
+ * @defgroup spsc_ring SPSC Ring
+ * @{
+ */
+
+/**
+ * @struct spsc_ring_t
+ * @brief lock free byte ring for exactly one producer and one consumer
+ * @var buf     storage, capacity bytes
+ * @var mask    capacity - 1, capacity is a power of two
+ * @var head    bytes ever written, only stored by the producer
+ * @var tail    bytes ever read, only stored by the consumer
+ * @note head and tail run freely and wrap at 2^32, so used = head - tail holds
+ *       across the wrap. Either side may run in an ISR; no RTOS calls are made.
+ */
+typedef struct {
+    uint8_t             *buf;
+    uint32_t            mask;
+    volatile uint32_t   head;
+    volatile uint32_t   tail;
+} spsc_ring_t;
+
+/**
+ * @brief round a size up to the next valid ring capacity
+ * @param size  requested size in bytes
+ * @return the smallest power of two not below size
+ */
+uint32_t spsc_ring_capacity(uint32_t size);
+
+/**
+ * @brief attach storage to an empty ring
+ * @param ring  ring to initialize
+ * @param buf   storage of size bytes
+ * @param size  capacity, must be a power of two
+ * @return 1 for success, 0 if size is not a power of two
+ */
+uint8_t spsc_ring_init(spsc_ring_t *ring, uint8_t *buf, uint32_t size);
+
+/**
+ * @brief bytes available to the consumer
+ */
+static inline uint32_t spsc_ring_used(const spsc_ring_t *ring) {
+    return __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+}
+
+/**
+ * @brief bytes the producer can still put
+ */
+static inline uint32_t spsc_ring_free(const spsc_ring_t *ring) {
+    return ring->mask + 1 - spsc_ring_used(ring);
+}
+
+/**
+ * @brief producer side, copy in as many bytes as fit
+ * @param ring  ring
+ * @param src   bytes to put
+ * @param len   number of bytes
+ * @return bytes put, less than len only if the ring filled up
+ */
+uint32_t spsc_ring_put(spsc_ring_t *ring, const uint8_t *src, uint32_t len);
+
+/**
+ * @brief consumer side, copy out and remove bytes
+ * @param ring  ring
+ * @param dst   destination, may be NULL to only drop the bytes
+ * @param len   most bytes to get
+ * @return bytes got
+ */
+uint32_t spsc_ring_get(spsc_ring_t *ring, uint8_t *dst, uint32_t len);
+
+/**
+ * @brief consumer side, copy out bytes without removing them
+ * @param ring      ring
+ * @param offset    bytes to skip from the oldest one
+ * @param dst       destination
+ * @param len       most bytes to copy
+ * @return bytes copied
+ */
+uint32_t spsc_ring_peek(const spsc_ring_t *ring, uint32_t offset, uint8_t *dst, uint32_t len);
+
+/**
+ * @brief consumer side, drop everything currently queued
+ * @param ring  ring
+ */
+void spsc_ring_flush(spsc_ring_t *ring);
+
+/** @} */
+
+#endif
@@ -27,6 +27,9 @@
 #include "tx2.h"
 
 uint8_t tx2_init(data_process_t* source) {
+    /* Register rx messages, frames are size checked and copied by data process */
+    if (!data_process_register_table(source, source->source_struct, tx2_protocol, TX2_PROTOCOL_MSGS))
+        return 0;
     /* Initialize TX2 to IDLE interrupt */
     uart_port_init(source->huart);
     /* Enable DMA for RX */
@@ -35,28 +38,25 @@ uint8_t tx2_init(data_process_t* source) {
     return uart_dma_multibuffer_it(source->huart->hdmarx, (uint32_t)&source->huart->Instance->DR, (uint32_t)source->buff[0], (uint32_t)source->buff[1], source->buff_size);
 }
 
-uint8_t tx2_dispatcher(void *target_struct, data_process_t *process_struct) {
+uint8_t tx2_dispatcher(void *target_struct, data_process_t *process_struct, uint16_t cmdid, const uint8_t *data_addr, uint16_t data_length) {
 #ifdef DEBUG
     BSP_DEBUG;
     printf("Enter TX2 dispathcer.\r\n");
 #endif
-    tx2_t *tx2              = target_struct;
-    data_process_t *source  = process_struct;
-    uint16_t data_length    = source->data_len;
-    uint16_t cmdid          = *(uint16_t*)(source->frame_packet + DATA_PROCESS_HEADER_LEN);
-    uint8_t *data_addr      = source->frame_packet + DATA_PROCESS_HEADER_LEN + DATA_PROCESS_CMD_LEN;
+    /* Known commands are registered in tx2_init and never get here */
+    UNUSED(target_struct);
+    UNUSED(process_struct);
+    UNUSED(cmdid);
+    UNUSED(data_addr);
+    UNUSED(data_length);
+    bsp_error_handler(__FUNCTION__, __LINE__, "Unknown CMDID.");
+    return 0;
+}
 
-    switch (cmdid) {
-        case CMD_GIMBAL_CONTROL:
-            memcpy(&(tx2->gimbal_control), data_addr, data_length);
-            break;
-        case CMD_FOUR_INT16:
-            custum_int16_handle(tx2->custom_int16s);
-            break;
-        default:
-            bsp_error_handler(__FUNCTION__, __LINE__, "Unknown CMDID.");
-            return 0;
-    }
+uint8_t tx2_four_int16_decode(void *target, const uint8_t *data, uint16_t length) {
+    four_int16_t *vec4d = target;
+    memcpy(vec4d, data, length);
+    custum_int16_handle(*vec4d);
     return 1;
 }
 
@@ -67,21 +67,12 @@ uint8_t tx2_packer(void *target_struct, data_process_t *process_struct, uint16_t
 #endif
     tx2_t *tx2              = target_struct;
     data_process_t *source  = process_struct;
-    uint8_t *data_stream    = NULL;
     uint16_t data_length    = 0;
+    uint8_t *data_stream    = data_process_msg_payload(tx2_protocol, TX2_PROTOCOL_MSGS, tx2, cmdid, &data_length);
 
-    switch (cmdid) {
-        case CMD_AIM_REQUEST:
-            data_stream = (uint8_t*)&tx2->aim_request;
-            data_length = (uint16_t)sizeof(aim_request_t);
-            break;
-        case CMD_FOUR_INT16:
-            data_stream = (uint8_t*)&tx2->custom_int16s;
-            data_length = (uint16_t)sizeof(four_int16_t);
-            break;
-        default:
-            bsp_error_handler(__FUNCTION__, __LINE__, "Unknown CMDID.");
-            return 0;
+    if (data_stream == NULL) {
+        bsp_error_handler(__FUNCTION__, __LINE__, "Unknown CMDID.");
+        return 0;
     }
 
     data_to_fifo(cmdid, data_stream, data_length, source); // Put data into tx fifo
@@ -31,6 +31,7 @@
 #include "bsp_uart.h"
 #include "bsp_config.h"
 #include "data_process.h"
+#include "tx2_protocol.h"    // Messages, generated from Tools/protocol/tx2.json
 
 /**
  * @ingroup library
@@ -38,54 +39,15 @@
  * @{
  */
 
-#define TX2_SOF         0xA0
+#define TX2_SOF         TX2_PROTOCOL_SOF
 #define TX2_PORT        BSP_TX2_PORT
 #define TX2_FIFO_SIZE   BSP_TX2_MAX_LEN
 #define TX2_BUFF_SIZE   BSP_TX2_MAX_LEN
 
-typedef enum {
-    CMD_GIMBAL_CONTROL  = 0x00A1,
-    CMD_AIM_REQUEST     = 0x0012,
-    CMD_FOUR_INT16      = 0x00F0,
-} tx2_cmdid_t;
-
-/* ===== CMD_GIMBAL_CONTROL 0x00A1 ===== */
-typedef struct {
-    uint16_t    pitch_ref;
-    uint16_t    yaw_ref;
-} __packed gimbal_control_t;
-
-/* ===== CMD_AIM_REQUEST 0x0012 ===== */
-typedef struct {
-    uint8_t     aim_mode;
-} __packed aim_request_t;
-
-/* ===== CMD_FOUR_INT16 0x00F3 ===== */
-typedef struct {
-    int16_t x;
-    int16_t y;
-    int16_t z;
-    int16_t w;
-} __packed four_int16_t;
-
-typedef enum {
-    RUNE        = 0,
-    AUTOAIM     = 1,
-} aim_mode_t;
-
-/* ============================== */
-
-typedef struct {
-    gimbal_control_t    gimbal_control;     // 0x00A1
-    aim_request_t       aim_request;        // 0x0012
-
-    four_int16_t        custom_int16s;
-} tx2_t;
-
 /**
- * Initialize tx2 dma
+ * Register tx2 rx commands and initialize tx2 dma
  *
- * @param  source   A valid data process instance
+ * @param  source   A valid data process instance, its target struct is a tx2_t
  * @return 1 for success, 0 for error
  * @author Nickel_Liang
  * @date   2018-04-19
@@ -93,15 +55,18 @@ typedef struct {
 uint8_t tx2_init(data_process_t* source);
 
 /**
- * TX2 data dispatcher. Used by data process lib.
+ * TX2 data dispatcher. Used by data process lib for cmdids that are not registered.
  *
  * @param  target_struct  A valid tx2 structure
  * @param  process_struct A valid data process instance
+ * @param  cmdid          Command ID of the frame
+ * @param  data           Payload of the frame, only valid during the call
+ * @param  length         Length of payload
  * @return                1 for success, 0 for failed
  * @author Nickel_Liang
  * @date   2018-04-21
  */
-uint8_t tx2_dispatcher(void* target_struct, data_process_t* process_struct);
+uint8_t tx2_dispatcher(void* target_struct, data_process_t* process_struct, uint16_t cmdid, const uint8_t* data, uint16_t length);
 
 /**
  * TX2 data packer. Used by data process lib.
@@ -123,6 +88,16 @@ uint8_t tx2_packer(void *target_struct, data_process_t *process_struct, uint16_t
  */
 void custum_int16_handle(four_int16_t vec4d);
 
+/**
+ * Copy a CMD_FOUR_INT16 payload and hand it to custum_int16_handle. Decode callback named in tx2.json.
+ *
+ * @param  target     custom_int16s of a tx2 structure
+ * @param  data       Payload of the frame
+ * @param  length     Length of payload, already checked against four_int16_t
+ * @return            Always 1
+ */
+uint8_t tx2_four_int16_decode(void *target, const uint8_t *data, uint16_t length);
+
 /**
  * TX2 callback wrapper.
  *
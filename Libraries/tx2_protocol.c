@@ -0,0 +1,38 @@
+/**************************************************************************
+ *  Copyright (C) 2018
+ *  Illini RoboMaster @ University of Illinois at Urbana-Champaign.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+/**
+ * @file    tx2_protocol.c
+ * @brief   TX2 messages. Generated from Tools/protocol/tx2.json by protogen.py, do not edit
+ */
+
+#include "tx2_protocol.h"
+#include <stddef.h>
+
+/* Structs must match the wire size from the schema, a mismatch fails to compile */
+#define TX2_SIZE_CHECK(type, size) typedef char type##_size_check[(sizeof(type) == (size)) ? 1 : -1]
+
+TX2_SIZE_CHECK(gimbal_control_t, 4);
+TX2_SIZE_CHECK(aim_request_t, 1);
+TX2_SIZE_CHECK(four_int16_t, 8);
+
+const data_process_msg_t tx2_protocol[TX2_PROTOCOL_MSGS] = {
+    {CMD_GIMBAL_CONTROL, DATA_PROCESS_RX, offsetof(tx2_t, gimbal_control), sizeof(gimbal_control_t), NULL},
+    {CMD_AIM_REQUEST, DATA_PROCESS_TX, offsetof(tx2_t, aim_request), sizeof(aim_request_t), NULL},
+    {CMD_FOUR_INT16, DATA_PROCESS_RX | DATA_PROCESS_TX, offsetof(tx2_t, custom_int16s), sizeof(four_int16_t), tx2_four_int16_decode},
+};
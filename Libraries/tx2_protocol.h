@@ -0,0 +1,76 @@
+/**************************************************************************
+ *  Copyright (C) 2018
+ *  Illini RoboMaster @ University of Illinois at Urbana-Champaign.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+/**
+ * @file    tx2_protocol.h
+ * @brief   TX2 messages. Generated from Tools/protocol/tx2.json by protogen.py, do not edit
+ */
+
+#ifndef _TX2_PROTOCOL_H_
+#define _TX2_PROTOCOL_H_
+
+#include "data_process.h"
+
+#define TX2_PROTOCOL_SOF    0xA0
+#define TX2_PROTOCOL_MSGS   3
+
+typedef enum {
+    CMD_GIMBAL_CONTROL      = 0x00A1,
+    CMD_AIM_REQUEST         = 0x0012,
+    CMD_FOUR_INT16          = 0x00F0,
+} tx2_cmdid_t;
+
+/* ===== CMD_GIMBAL_CONTROL 0x00A1, rx on event ===== */
+typedef struct {
+    uint16_t    pitch_ref;
+    uint16_t    yaw_ref;
+} __packed gimbal_control_t;
+
+/* ===== CMD_AIM_REQUEST 0x0012, tx on event ===== */
+typedef struct {
+    uint8_t aim_mode;       // [aim_mode_t]
+} __packed aim_request_t;
+
+typedef enum {
+    RUNE     = 0,
+    AUTOAIM  = 1,
+} aim_mode_t;
+
+/* ===== CMD_FOUR_INT16 0x00F0, both on event ===== */
+typedef struct {
+    int16_t x;
+    int16_t y;
+    int16_t z;
+    int16_t w;
+} __packed four_int16_t;
+
+/* ============================== */
+
+typedef struct {
+    gimbal_control_t    gimbal_control;     // 0x00A1
+    aim_request_t       aim_request;        // 0x0012
+    four_int16_t        custom_int16s;      // 0x00F0
+} tx2_t;
+
+/* Every message of the link, offsets are into tx2_t */
+extern const data_process_msg_t tx2_protocol[TX2_PROTOCOL_MSGS];
+
+/* Decode callbacks named by the schema, implemented by hand */
+uint8_t tx2_four_int16_decode(void* target, const uint8_t* data, uint16_t length);
+
+#endif
@@ -0,0 +1,156 @@
+/**************************************************************************
+ *  Copyright (C) 2018 
+ *  Illini RoboMaster @ University of Illinois at Urbana-Champaign.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#include "vibration.h"
+
+#define VIB_PI  3.14159265f
+
+static float vib_re[VIB_FFT_SIZE];
+static float vib_im[VIB_FFT_SIZE];
+static float vib_mag[VIB_FFT_SIZE / 2];
+static float vib_cos[VIB_FFT_SIZE / 2];
+static float vib_sin[VIB_FFT_SIZE / 2];
+static float vib_window[VIB_FFT_SIZE];
+static uint8_t vib_tables_ready;
+
+static void vib_tables_init(void) {
+    for (int i = 0; i < VIB_FFT_SIZE / 2; ++i) {
+        vib_cos[i] = cosf(2.0f * VIB_PI * i / VIB_FFT_SIZE);
+        vib_sin[i] = -sinf(2.0f * VIB_PI * i / VIB_FFT_SIZE);
+    }
+    /* Hann window keeps leakage from hiding a weaker peak next to a strong one */
+    for (int i = 0; i < VIB_FFT_SIZE; ++i)
+        vib_window[i] = 0.5f - 0.5f * cosf(2.0f * VIB_PI * i / (VIB_FFT_SIZE - 1));
+    vib_tables_ready = 1;
+}
+
+/* In place iterative radix-2 decimation in time */
+static void vib_fft(float *re, float *im) {
+    for (int i = 1, j = 0; i < VIB_FFT_SIZE; ++i) {
+        int bit = VIB_FFT_SIZE >> 1;
+        for (; j & bit; bit >>= 1)
+            j ^= bit;
+        j ^= bit;
+        if (i < j) {
+            float t = re[i]; re[i] = re[j]; re[j] = t;
+            t = im[i]; im[i] = im[j]; im[j] = t;
+        }
+    }
+    for (int len = 2; len <= VIB_FFT_SIZE; len <<= 1) {
+        int half = len >> 1;
+        int step = VIB_FFT_SIZE / len;
+        for (int i = 0; i < VIB_FFT_SIZE; i += len) {
+            for (int k = 0; k < half; ++k) {
+                float wr = vib_cos[k * step], wi = vib_sin[k * step];
+                float *ar = &re[i + k], *ai = &im[i + k];
+                float *br = &re[i + k + half], *bi = &im[i + k + half];
+                float tr = *br * wr - *bi * wi;
+                float ti = *br * wi + *bi * wr;
+                *br = *ar - tr;
+                *bi = *ai - ti;
+                *ar += tr;
+                *ai += ti;
+            }
+        }
+    }
+}
+
+void vib_init(vib_analyzer_t *vib, float fs, uint8_t channels) {
+    memset(vib, 0, sizeof(vib_analyzer_t));
+    vib->fs       = fs;
+    vib->channels = channels < 1 ? 1 : channels > VIB_CHANNELS ? VIB_CHANNELS : channels;
+    if (!vib_tables_ready)
+        vib_tables_init();
+}
+
+uint8_t vib_add(vib_analyzer_t *vib, const float *x) {
+    if (vib->ready)
+        return 1;
+    for (int c = 0; c < vib->channels; ++c)
+        vib->buf[c][vib->idx] = x[c];
+    vib->idx++;
+    if (vib->idx == VIB_FFT_SIZE)
+        vib->ready = 1;
+    return vib->ready;
+}
+
+uint8_t vib_analyze(vib_analyzer_t *vib, float min_hz, float max_hz) {
+    if (!vib->ready)
+        return 0;
+    float bin_hz = vib->fs / VIB_FFT_SIZE;
+    int lo = (int)(min_hz / bin_hz);
+    int hi = (int)(max_hz / bin_hz);
+    if (lo < 1)
+        lo = 1;
+    if (hi > VIB_FFT_SIZE / 2 - 2)
+        hi = VIB_FFT_SIZE / 2 - 2;
+
+    /* magnitudes are summed over channels, one bin of margin on each side for the peak test */
+    for (int i = lo - 1; i <= hi + 1; ++i)
+        vib_mag[i] = 0;
+    for (int c = 0; c < vib->channels; ++c) {
+        float mean = 0;
+        for (int i = 0; i < VIB_FFT_SIZE; ++i)
+            mean += vib->buf[c][i];
+        mean /= VIB_FFT_SIZE;
+        for (int i = 0; i < VIB_FFT_SIZE; ++i) {
+            vib_re[i] = (vib->buf[c][i] - mean) * vib_window[i];
+            vib_im[i] = 0;
+        }
+        /* the last channel is copied out, sampling may continue */
+        if (c == vib->channels - 1) {
+            vib->idx   = 0;
+            vib->ready = 0;
+        }
+        vib_fft(vib_re, vib_im);
+        for (int i = lo - 1; i <= hi + 1; ++i)
+            vib_mag[i] += sqrtf(vib_re[i] * vib_re[i] + vib_im[i] * vib_im[i]);
+    }
+    float avg = 0;
+    for (int i = lo - 1; i <= hi + 1; ++i)
+        avg += vib_mag[i];
+    avg /= hi - lo + 3;
+
+    for (int p = 0; p < VIB_PEAKS; ++p)
+        vib->peak_hz[p] = vib->peak_mag[p] = 0;
+    uint8_t found = 0;
+    for (int i = lo; i <= hi; ++i) {
+        float m = vib_mag[i];
+        if (m < vib_mag[i - 1] || m <= vib_mag[i + 1] || m < VIB_PEAK_RATIO * avg)
+            continue;
+        /* parabolic interpolation between neighbouring bins */
+        float den = vib_mag[i - 1] - 2.0f * m + vib_mag[i + 1];
+        float off = den < 0 ? 0.5f * (vib_mag[i - 1] - vib_mag[i + 1]) / den : 0;
+        float hz  = (i + off) * bin_hz;
+        for (int p = 0; p < VIB_PEAKS; ++p) {
+            if (m <= vib->peak_mag[p])
+                continue;
+            for (int q = VIB_PEAKS - 1; q > p; --q) {
+                vib->peak_hz[q]  = vib->peak_hz[q - 1];
+                vib->peak_mag[q] = vib->peak_mag[q - 1];
+            }
+            vib->peak_hz[p]  = hz;
+            vib->peak_mag[p] = m;
+            break;
+        }
+    }
+    for (int p = 0; p < VIB_PEAKS; ++p)
+        found += vib->peak_hz[p] > 0;
+    vib->windows++;
+    return found;
+}
@@ -0,0 +1,89 @@
+/**************************************************************************
+ *  Copyright (C) 2018 
+ *  Illini RoboMaster @ University of Illinois at Urbana-Champaign.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#ifndef _VIBRATION_H_
+#define _VIBRATION_H_
+
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+/**
+ * @ingroup library
+ * @defgroup vibration Vibration Analysis
+ * @{
+ */
+
+#define VIB_FFT_SIZE    256     // samples per analysis window, power of 2
+#define VIB_PEAKS       2       // dominant peaks reported per window
+#define VIB_PEAK_RATIO  4.0f    // a peak must stand this far above the mean spectrum
+#define VIB_CHANNELS    3       // most channels per analyzer, e.g. one per gyro axis
+
+/**
+ * @struct vib_analyzer_t
+ * @brief windowed FFT peak finder. Channels are transformed separately and their
+ *        magnitude spectra summed, so vibration in antiphase on two axes does not cancel.
+ * @var fs          sample rate in Hz
+ * @var channels    channels in use
+ * @var buf         samples of the current window, per channel
+ * @var idx         samples collected
+ * @var ready       window full, samples are ignored until vib_analyze
+ * @var peak_hz     dominant peak frequencies, strongest first, 0 if none
+ * @var peak_mag    magnitudes of the peaks
+ * @var windows     windows analyzed so far
+ */
+typedef struct {
+    float               fs;
+    uint8_t             channels;
+    float               buf[VIB_CHANNELS][VIB_FFT_SIZE];
+    uint16_t            idx;
+    volatile uint8_t    ready;
+    float               peak_hz[VIB_PEAKS];
+    float               peak_mag[VIB_PEAKS];
+    uint32_t            windows;
+}   vib_analyzer_t;
+
+/**
+ * @brief reset an analyzer
+ * @param vib   analyzer
+ * @param fs        sample rate in Hz
+ * @param channels  channels per sample, 1 to VIB_CHANNELS
+ */
+void vib_init(vib_analyzer_t *vib, float fs, uint8_t channels);
+
+/**
+ * @brief collect one sample, cheap enough for the sampling context
+ * @param vib   analyzer
+ * @param x     one value per channel
+ * @return 1 once the window is full and waiting for vib_analyze
+ */
+uint8_t vib_add(vib_analyzer_t *vib, const float *x);
+
+/**
+ * @brief transform a full window and find its dominant peaks, then start a new window
+ * @param vib       analyzer
+ * @param min_hz    lowest frequency of interest
+ * @param max_hz    highest frequency of interest
+ * @return number of peaks found
+ * @note  runs a VIB_FFT_SIZE point FFT per channel, call from a low priority task rather than an interrupt
+ */
+uint8_t vib_analyze(vib_analyzer_t *vib, float min_hz, float max_hz);
+
+/** @} */
+
+#endif
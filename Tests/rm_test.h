@@ -37,6 +37,14 @@
 #include "test_oled_module.h"
 #include "test_bsp_tof.h"
 #include "test_shooter.h"
+#include "test_executive.h"
+#include "test_prof.h"
+#include "test_ahrs.h"
+#include "test_imu_heater.h"
+#include "test_imu_convert.h"
+#include "test_mag_calib.h"
+#include "test_filter.h"
+#include "test_gimbal_estimator.h"
 
 /* Test utility */
 #define PASS    1
@@ -73,6 +81,14 @@
 #define TEST_OLED_MODULE    OFF
 #define TEST_BSP_TOF        OFF
 #define TEST_SHOOTER        OFF
+#define TEST_EXECUTIVE      OFF
+#define TEST_PROF           OFF
+#define TEST_AHRS           OFF
+#define TEST_IMU_HEATER     OFF
+#define TEST_IMU_CONVERT    OFF
+#define TEST_MAG_CALIB      OFF
+#define TEST_FILTER         OFF
+#define TEST_GIMBAL_EST     OFF
 
 /* TODO: test case not finished yet */
 extern inline void run_all_tests() {
@@ -112,6 +128,22 @@ extern inline void run_all_tests() {
         test_bsp_tof();
     if (TEST_SHOOTER == ON)
         test_shooter();
+    if (TEST_EXECUTIVE == ON)
+        test_executive();
+    if (TEST_PROF == ON)
+        test_prof();
+    if (TEST_AHRS == ON)
+        test_ahrs();
+    if (TEST_IMU_HEATER == ON)
+        test_imu_heater();
+    if (TEST_IMU_CONVERT == ON)
+        TEST_OUTPUT("IMU CONVERT TEST", test_imu_convert());
+    if (TEST_MAG_CALIB == ON)
+        test_mag_calib();
+    if (TEST_FILTER == ON)
+        TEST_OUTPUT("FILTER TEST", test_filter());
+    if (TEST_GIMBAL_EST == ON)
+        TEST_OUTPUT("GIMBAL ESTIMATOR TEST", test_gimbal_estimator());
 }
 
 #endif
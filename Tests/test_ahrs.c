@@ -0,0 +1,58 @@
+/**************************************************************************
+ *  Copyright (C) 2018 
+ *  Illini RoboMaster @ University of Illinois at Urbana-Champaign.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#include "test_ahrs.h"
+#include "cmsis_os.h"
+
+static ahrs_t test_mahony;
+static ahrs_t test_madgwick;
+
+void test_ahrs(void) {
+    imu_t imu;
+    float gyro[3], acce[3], mag[3];
+    float mahony_angle[3], madgwick_angle[3];
+
+    dwt_init();
+    mpu6500_get_data(&imu);
+    acce[0] = imu.acce.x; acce[1] = imu.acce.y; acce[2] = imu.acce.z;
+    ahrs_init(&test_mahony, AHRS_MAHONY);
+    ahrs_init(&test_madgwick, AHRS_MADGWICK);
+    ahrs_align(&test_mahony, acce);
+    ahrs_align(&test_madgwick, acce);
+
+    for (uint32_t tick = 0; ; ++tick) {
+        mpu6500_get_data(&imu);
+        ist8310_get_data(&imu);
+        gyro[0] = imu.gyro.x * DEG_2_RAD; gyro[1] = imu.gyro.y * DEG_2_RAD; gyro[2] = imu.gyro.z * DEG_2_RAD;
+        acce[0] = imu.acce.x; acce[1] = imu.acce.y; acce[2] = imu.acce.z;
+        mag[0] = imu.mag.x; mag[1] = imu.mag.y; mag[2] = imu.mag.z;
+        ahrs_update(&test_mahony, gyro, acce, mag, IMU_DT);
+        ahrs_update(&test_madgwick, gyro, acce, mag, IMU_DT);
+        if (tick % AHRS_TEST_PRINT_MS == 0) {
+            ahrs_get_euler(&test_mahony, mahony_angle);
+            ahrs_get_euler(&test_madgwick, madgwick_angle);
+            print("Mahony   R %.2f P %.2f Y %.2f | bias z %.4f | %u cycles (max %u)\r\n",
+                    mahony_angle[ROLL], mahony_angle[PITCH], mahony_angle[YAW],
+                    test_mahony.bias[2], test_mahony.cycles_last, test_mahony.cycles_max);
+            print("Madgwick R %.2f P %.2f Y %.2f | bias z %.4f | %u cycles (max %u)\r\n",
+                    madgwick_angle[ROLL], madgwick_angle[PITCH], madgwick_angle[YAW],
+                    test_madgwick.bias[2], test_madgwick.cycles_last, test_madgwick.cycles_max);
+        }
+        osDelay(1);
+    }
+}
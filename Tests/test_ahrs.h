@@ -0,0 +1,33 @@
+/**************************************************************************
+ *  Copyright (C) 2018 
+ *  Illini RoboMaster @ University of Illinois at Urbana-Champaign.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#ifndef _TEST_AHRS_H_
+#define _TEST_AHRS_H_
+
+#include "ahrs.h"
+#include "imu_onboard.h"
+
+#define AHRS_TEST_PRINT_MS  100
+
+/**
+ * Run Mahony and Madgwick side by side on live onboard imu data and print
+ * their angles, estimated gyro bias and update cost
+ */
+void test_ahrs(void);
+
+#endif
@@ -0,0 +1,44 @@
+/**************************************************************************
+ *  Copyright (C) 2018 
+ *  Illini RoboMaster @ University of Illinois at Urbana-Champaign.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#include "test_executive.h"
+#include "cmsis_os.h"
+
+static void busy_job(void *arg) {
+    uint32_t cycles = dwt_us_to_cycles((uint32_t)arg);
+    uint32_t start  = dwt_get_cycles();
+    while (dwt_get_cycles() - start < cycles);
+}
+
+void test_executive(void) {
+    dwt_init();
+    executive_init(&EXEC_TEST_TIM, EXEC_MODE_RTOS);
+    /* Sense first, then control, then slow housekeeping */
+    executive_add_job("imu",     busy_job, (void*)80,  1000, 0);
+    executive_add_job("gimbal",  busy_job, (void*)60,  1000, 0);
+    executive_add_job("chassis", busy_job, (void*)120, 500,  1);
+    executive_add_job("referee", busy_job, (void*)200, 50,   3);
+    executive_add_job("oled",    busy_job, (void*)400, 10,   7);
+    executive_start();
+
+    for (int i = 0; i < EXEC_TEST_SECONDS; ++i) {
+        osDelay(1000);
+        executive_print_stats();
+    }
+    executive_stop();
+}
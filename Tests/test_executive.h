@@ -0,0 +1,35 @@
+/**************************************************************************
+ *  Copyright (C) 2018 
+ *  Illini RoboMaster @ University of Illinois at Urbana-Champaign.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#ifndef _TEST_EXECUTIVE_H_
+#define _TEST_EXECUTIVE_H_
+
+#include "executive.h"
+
+#define EXEC_TEST_TIM       htim6   // any basic timer configured to overflow at EXEC_TICK_HZ
+#define EXEC_TEST_SECONDS   10
+
+/**
+ * Run a set of dummy jobs at the rates used by the robot tasks and print
+ * their timing statistics every second.
+ *
+ * @note   executive_timer_callback must be called from HAL_TIM_PeriodElapsedCallback
+ */
+void test_executive(void);
+
+#endif
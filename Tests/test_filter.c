@@ -0,0 +1,88 @@
+/**************************************************************************
+ *  Copyright (C) 2018 
+ *  Illini RoboMaster @ University of Illinois at Urbana-Champaign.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#include "test_filter.h"
+
+static biquad_cascade_t     test_cascade;
+static biquad_cascade_q31_t test_cascade_q31;
+static vib_analyzer_t       test_vib;
+
+uint8_t test_filter(void) {
+    uint8_t result = 1;
+    uint32_t start, cycles_f32 = 0, cycles_q31 = 0, cycles_fft;
+    float out = 0, amp = 0, amp_q31 = 0;
+
+    dwt_init();
+    biquad_cascade_init(&test_cascade, 2);
+    biquad_lowpass(&test_cascade.stage[0], FILTER_TEST_FS, 150.0f, FILTER_Q_BUTTER);
+    biquad_notch(&test_cascade.stage[1], FILTER_TEST_FS, FILTER_TEST_TONE, 4.0f);
+    biquad_cascade_to_q31(&test_cascade, &test_cascade_q31);
+
+    for (int i = 0; i < 2000; ++i)
+        out = biquad_cascade_step(&test_cascade, 1.0f);
+    print("DC gain %f\r\n", out);
+    if (fabsf(out - 1.0f) > 1e-3f)
+        result = 0;
+
+    biquad_cascade_reset(&test_cascade);
+    for (int i = 0; i < 4000; ++i) {
+        float x = sinf(2.0f * 3.14159265f * FILTER_TEST_TONE * i / FILTER_TEST_FS);
+        start = dwt_get_cycles();
+        float y = biquad_cascade_step(&test_cascade, x);
+        cycles_f32 += dwt_get_cycles() - start;
+        start = dwt_get_cycles();
+        int32_t y_q31 = biquad_cascade_q31_step(&test_cascade_q31, (int32_t)(x * (1 << 28)));
+        cycles_q31 += dwt_get_cycles() - start;
+        if (i > 3000) {
+            amp     = fmaxf(amp, fabsf(y));
+            amp_q31 = fmaxf(amp_q31, fabsf(y_q31 / (float)(1 << 28)));
+        }
+    }
+    print("Tone left after notch: float %f q31 %f\r\n", amp, amp_q31);
+    if (amp > 0.01f || amp_q31 > 0.01f)
+        result = 0;
+
+    vib_init(&test_vib, FILTER_TEST_FS, 1);
+    for (int i = 0; i < VIB_FFT_SIZE; ++i) {
+        float x = 0.5f + sinf(2.0f * 3.14159265f * FILTER_TEST_TONE * i / FILTER_TEST_FS)
+                + 0.3f * sinf(2.0f * 3.14159265f * 61.0f * i / FILTER_TEST_FS);
+        vib_add(&test_vib, &x);
+    }
+    start = dwt_get_cycles();
+    uint8_t found = vib_analyze(&test_vib, 20.0f, 450.0f);
+    cycles_fft = dwt_get_cycles() - start;
+    print("Peaks %u: %.1f Hz %.1f Hz\r\n", found, test_vib.peak_hz[0], test_vib.peak_hz[1]);
+    if (found != 2 || fabsf(test_vib.peak_hz[0] - FILTER_TEST_TONE) > 2.0f || fabsf(test_vib.peak_hz[1] - 61.0f) > 2.0f)
+        result = 0;
+
+    /* the same tone in antiphase on two axes must not cancel */
+    vib_init(&test_vib, FILTER_TEST_FS, 2);
+    for (int i = 0; i < VIB_FFT_SIZE; ++i) {
+        float x = sinf(2.0f * 3.14159265f * FILTER_TEST_TONE * i / FILTER_TEST_FS);
+        float axes[2] = {x, -x};
+        vib_add(&test_vib, axes);
+    }
+    found = vib_analyze(&test_vib, 20.0f, 450.0f);
+    print("Antiphase peaks %u: %.1f Hz\r\n", found, test_vib.peak_hz[0]);
+    if (found != 1 || fabsf(test_vib.peak_hz[0] - FILTER_TEST_TONE) > 2.0f)
+        result = 0;
+
+    print("Cycles: float cascade %u, q31 cascade %u per sample, fft %u\r\n",
+          (unsigned)(cycles_f32 / 4000), (unsigned)(cycles_q31 / 4000), (unsigned)cycles_fft);
+    return result;
+}
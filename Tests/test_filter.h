@@ -0,0 +1,38 @@
+/**************************************************************************
+ *  Copyright (C) 2018 
+ *  Illini RoboMaster @ University of Illinois at Urbana-Champaign.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#ifndef _TEST_FILTER_H_
+#define _TEST_FILTER_H_
+
+#include "filter.h"
+#include "vibration.h"
+#include "bsp_dwt.h"
+#include "bsp_print.h"
+
+#define FILTER_TEST_FS      1000.0f
+#define FILTER_TEST_TONE    187.0f  // Hz, a typical flywheel line
+
+/**
+ * Check lowpass DC gain, notch rejection, Q31 against float and FFT peak
+ * finding on synthetic signals, and print the cost of each with DWT cycles
+ *
+ * @return            1 if all checks pass, 0 otherwise
+ */
+uint8_t test_filter(void);
+
+#endif
@@ -0,0 +1,64 @@
+/**************************************************************************
+ *  Copyright (C) 2018 
+ *  Illini RoboMaster @ University of Illinois at Urbana-Champaign.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#include "test_gimbal_estimator.h"
+
+static gimbal_est_t test_est;
+
+static int16_t test_gimbal_encoder(float angle, int16_t zero) {
+    int32_t raw = zero + (int32_t)lroundf(angle / MOTOR_2_RAD);
+    raw %= ANGLE_RANGE_DJI;
+    return raw < 0 ? raw + ANGLE_RANGE_DJI : raw;
+}
+
+uint8_t test_gimbal_estimator(void) {
+    uint8_t result = 1;
+    const float heading = 30.0f;
+    float euler[3] = {0, 0, 0}, q[4], gyro[3] = {0, 0, GIMBAL_EST_TEST_SPIN};
+    float max_err = 0, max_rate = 0;
+
+    gimbal_est_init(&test_est, 4000, 6000);
+    for (int i = 0; i < 2000; ++i) {
+        float chassis = GIMBAL_EST_TEST_SPIN * i * GIMBAL_EST_TEST_DT;
+        euler[2] = chassis * 57.29578f;
+        gimbal_est_euler_to_quat(euler, q);
+        float joint = heading * 0.01745329f - chassis;
+        gimbal_est_update(&test_est, q, gyro, test_gimbal_encoder(joint, 4000), 6000, GIMBAL_EST_TEST_DT);
+        if (i > 500) {
+            float err = fmodf(fabsf(test_est.euler[2] - heading), 360.0f);
+            max_err  = fmaxf(max_err, fminf(err, 360.0f - err));
+            max_rate = fmaxf(max_rate, fabsf(test_est.rate_world[2]));
+        }
+    }
+    print("Spin: heading error %.3f deg, world rate %.3f rad/s, %u ticks\r\n",
+          max_err, max_rate, (unsigned)test_est.cycles);
+    if (max_err > 1.0f || max_rate > 0.3f)
+        result = 0;
+
+    gimbal_est_init(&test_est, 4000, 6000);
+    euler[1] = 10.0f;
+    euler[2] = 0;
+    gimbal_est_euler_to_quat(euler, q);
+    gyro[2] = 0;
+    for (int i = 0; i < 200; ++i)
+        gimbal_est_update(&test_est, q, gyro, 4000, test_gimbal_encoder(-10.0f * 0.01745329f, 6000), GIMBAL_EST_TEST_DT);
+    print("Tilt: roll %.3f pitch %.3f yaw %.3f deg\r\n", test_est.euler[0], test_est.euler[1], test_est.euler[2]);
+    if (fabsf(test_est.euler[0]) > 0.1f || fabsf(test_est.euler[1]) > 0.1f || fabsf(test_est.euler[2]) > 0.1f)
+        result = 0;
+    return result;
+}
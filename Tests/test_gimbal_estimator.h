@@ -0,0 +1,37 @@
+/**************************************************************************
+ *  Copyright (C) 2018 
+ *  Illini RoboMaster @ University of Illinois at Urbana-Champaign.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#ifndef _TEST_GIMBAL_ESTIMATOR_H_
+#define _TEST_GIMBAL_ESTIMATOR_H_
+
+#include "gimbal_estimator.h"
+#include "bsp_print.h"
+
+#define GIMBAL_EST_TEST_DT      0.001f
+#define GIMBAL_EST_TEST_SPIN    6.0f    // rad/s, chassis spinning while the gimbal holds heading
+
+/**
+ * Spin the chassis under a gimbal that counter-rotates to hold its heading,
+ * then tilt the chassis under a level gimbal, and check the world frame
+ * attitude and rate stay put despite encoder quantization
+ *
+ * @return            1 if all checks pass, 0 otherwise
+ */
+uint8_t test_gimbal_estimator(void);
+
+#endif
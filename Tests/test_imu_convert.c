@@ -0,0 +1,107 @@
+/**************************************************************************
+ *  Copyright (C) 2018 
+ *  Illini RoboMaster @ University of Illinois at Urbana-Champaign.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#include "test_imu_convert.h"
+#include <math.h>
+#include <stdlib.h>
+
+static uint8_t     test_records[IMU_CONVERT_TEST_SAMPLES * ONBOARD_IMU_BUFFER];
+static imu_t       test_old[IMU_CONVERT_TEST_SAMPLES];
+static imu_t       test_new[IMU_CONVERT_TEST_SAMPLES];
+static imu_fixed_t test_fixed[IMU_CONVERT_TEST_SAMPLES];
+static volatile float test_sink;
+
+/* Conversion as it was before the reciprocal constants, kept as reference */
+static void test_decode_div(const uint8_t* buff, imu_t* imu) {
+    int16_t acce_x = (int16_t)(buff[0] << 8 | buff[1]);
+    int16_t acce_y = (int16_t)(buff[2] << 8 | buff[3]);
+    int16_t acce_z = (int16_t)(buff[4] << 8 | buff[5]);
+    int16_t temp   = (int16_t)(buff[6] << 8 | buff[7]);
+    int16_t gyro_x = (int16_t)(buff[8] << 8 | buff[9]);
+    int16_t gyro_y = (int16_t)(buff[10] << 8 | buff[11]);
+    int16_t gyro_z = (int16_t)(buff[12] << 8 | buff[13]);
+    imu->acce.x = (float)(acce_x / ONBOARD_ACCE_FACTOR);
+    imu->acce.y = (float)(acce_y / ONBOARD_ACCE_FACTOR);
+    imu->acce.z = (float)(acce_z / ONBOARD_ACCE_FACTOR);
+    imu->temp   = (float)(((temp - ONBOARD_TEMP_OFFSET) / ONBOARD_TEMP_FACTOR) + ONBOARD_TEMP_ROOM);
+    imu->gyro.x = (float)(gyro_x / ONBOARD_GYRO_FACTOR);
+    imu->gyro.y = (float)(gyro_y / ONBOARD_GYRO_FACTOR);
+    imu->gyro.z = (float)(gyro_z / ONBOARD_GYRO_FACTOR);
+}
+
+static uint8_t test_close(float a, float b) {
+    return fabsf(a - b) <= 1e-6f * (fabsf(a) + 1.0f);
+}
+
+uint8_t test_imu_convert(void) {
+    uint32_t start, cycles_div = 0, cycles_mul = 0, cycles_fixed = 0, cycles_atan2 = 0, cycles_atan2f = 0;
+    uint8_t result = 1;
+
+    dwt_init();
+    srand(HAL_GetTick());
+    for (uint32_t i = 0; i < sizeof(test_records); ++i)
+        test_records[i] = rand();
+
+    for (int round = 0; round < IMU_CONVERT_TEST_ROUNDS; ++round) {
+        start = dwt_get_cycles();
+        for (int i = 0; i < IMU_CONVERT_TEST_SAMPLES; ++i)
+            test_decode_div(test_records + i * ONBOARD_IMU_BUFFER, &test_old[i]);
+        cycles_div += dwt_get_cycles() - start;
+
+        start = dwt_get_cycles();
+        mpu6500_convert(test_records, IMU_CONVERT_TEST_SAMPLES, test_new);
+        cycles_mul += dwt_get_cycles() - start;
+
+        start = dwt_get_cycles();
+        mpu6500_convert_fixed(test_records, IMU_CONVERT_TEST_SAMPLES, test_fixed);
+        cycles_fixed += dwt_get_cycles() - start;
+
+        /* update_acc_angle before and after: double atan2 and literal vs atan2f */
+        start = dwt_get_cycles();
+        for (int i = 0; i < IMU_CONVERT_TEST_SAMPLES; ++i)
+            test_sink = atan2(test_old[i].acce.y, test_old[i].acce.z) * 57.29578;
+        cycles_atan2 += dwt_get_cycles() - start;
+
+        start = dwt_get_cycles();
+        for (int i = 0; i < IMU_CONVERT_TEST_SAMPLES; ++i)
+            test_sink = atan2f(test_new[i].acce.y, test_new[i].acce.z) * RAD_2_DEG;
+        cycles_atan2f += dwt_get_cycles() - start;
+    }
+
+    for (int i = 0; i < IMU_CONVERT_TEST_SAMPLES; ++i) {
+        const uint8_t* buff = test_records + i * ONBOARD_IMU_BUFFER;
+        if (!test_close(test_old[i].acce.x, test_new[i].acce.x) || !test_close(test_old[i].acce.y, test_new[i].acce.y)
+                || !test_close(test_old[i].acce.z, test_new[i].acce.z) || !test_close(test_old[i].temp, test_new[i].temp)
+                || !test_close(test_old[i].gyro.x, test_new[i].gyro.x) || !test_close(test_old[i].gyro.y, test_new[i].gyro.y)
+                || !test_close(test_old[i].gyro.z, test_new[i].gyro.z))
+            result = 0;
+        if (test_fixed[i].acce[0] != (int16_t)(buff[0] << 8 | buff[1])
+                || test_fixed[i].temp != (int16_t)(buff[6] << 8 | buff[7])
+                || test_fixed[i].gyro[2] != (int16_t)(buff[12] << 8 | buff[13]))
+            result = 0;
+    }
+
+    uint32_t samples = IMU_CONVERT_TEST_SAMPLES * IMU_CONVERT_TEST_ROUNDS;
+    print("Cycles per sample\r\n");
+    print("  divide   %u\r\n", (unsigned)(cycles_div / samples));
+    print("  multiply %u\r\n", (unsigned)(cycles_mul / samples));
+    print("  fixed    %u\r\n", (unsigned)(cycles_fixed / samples));
+    print("  atan2    %u\r\n", (unsigned)(cycles_atan2 / samples));
+    print("  atan2f   %u\r\n", (unsigned)(cycles_atan2f / samples));
+    return result;
+}
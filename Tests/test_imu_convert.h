@@ -0,0 +1,38 @@
+/**************************************************************************
+ *  Copyright (C) 2018 
+ *  Illini RoboMaster @ University of Illinois at Urbana-Champaign.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#ifndef _TEST_IMU_CONVERT_H_
+#define _TEST_IMU_CONVERT_H_
+
+#include "bsp_imu.h"
+#include "bsp_dwt.h"
+#include "bsp_print.h"
+
+#define IMU_CONVERT_TEST_SAMPLES    ONBOARD_FIFO_BATCH
+#define IMU_CONVERT_TEST_ROUNDS     100
+
+/**
+ * Benchmark raw MPU6500 conversion: the old per-field division and double
+ * precision atan2 against the reciprocal multiply, fixed point and
+ * single precision paths, and check they agree
+ *
+ * @return            1 if every converted value matches the old path, 0 otherwise
+ */
+uint8_t test_imu_convert(void);
+
+#endif
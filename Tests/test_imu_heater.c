@@ -0,0 +1,56 @@
+/**************************************************************************
+ *  Copyright (C) 2018 
+ *  Illini RoboMaster @ University of Illinois at Urbana-Champaign.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#include "test_imu_heater.h"
+#include "cmsis_os.h"
+
+static imu_calib_fit_t test_fit;
+static imu_calib_t     test_calib;
+
+void test_imu_heater(void) {
+    imu_t imu;
+    uint8_t fitted = 0;
+
+    imu_heater_init(IMU_HEATER_TARGET);
+    imu_calib_fit_reset(&test_fit);
+    imu_calib_default(&test_calib);
+    print("Keep the board still while it warms up\r\n");
+
+    for (uint32_t tick = 0; ; ++tick) {
+        mpu6500_get_data(&imu);
+        imu_heater_update(imu.temp);
+        if (!fitted)
+            imu_calib_fit_add(&test_fit, imu.temp, (float*)(&imu.gyro.x));
+        if (!fitted && imu_heater_is_stable()) {
+            fitted = 1;
+            if (imu_calib_fit_solve(&test_fit, &test_calib)) {
+                print("Bias at %.2f C: %.4f %.4f %.4f deg/s\r\n", test_calib.gyro_ref_temp,
+                      test_calib.gyro_bias[0], test_calib.gyro_bias[1], test_calib.gyro_bias[2]);
+                print("Slope: %.5f %.5f %.5f deg/s/C\r\n",
+                      test_calib.gyro_slope[0], test_calib.gyro_slope[1], test_calib.gyro_slope[2]);
+            } else {
+                print("Temperature span %.1f C too small to fit\r\n", test_fit.t_max - test_fit.t_min);
+            }
+        }
+        if (tick % IMU_HEATER_TEST_PRINT_MS == 0) {
+            print("Temp %.2f \tDuty %.0f \tState %d \t| ", imu.temp, imuHeater.duty, imuHeater.state);
+            print("Gyro X %.3f \tY %.3f \tZ %.3f\r\n", imu.gyro.x, imu.gyro.y, imu.gyro.z);
+        }
+        osDelay(1);
+    }
+}
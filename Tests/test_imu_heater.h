@@ -0,0 +1,34 @@
+/**************************************************************************
+ *  Copyright (C) 2018 
+ *  Illini RoboMaster @ University of Illinois at Urbana-Champaign.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#ifndef _TEST_IMU_HEATER_H_
+#define _TEST_IMU_HEATER_H_
+
+#include "imu_heater.h"
+#include "imu_calib.h"
+#include "bsp_imu.h"
+
+#define IMU_HEATER_TEST_PRINT_MS    200
+
+/**
+ * Hold the onboard imu at IMU_HEATER_TARGET, print temperature, duty and
+ * gyro readings while warming, then the fitted bias vs temperature model
+ */
+void test_imu_heater(void);
+
+#endif
@@ -0,0 +1,62 @@
+/**************************************************************************
+ *  Copyright (C) 2018 
+ *  Illini RoboMaster @ University of Illinois at Urbana-Champaign.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#include "test_mag_calib.h"
+#include "cmsis_os.h"
+
+static mag_calib_t   test_fit;
+static mag_disturb_t test_gate;
+static imu_calib_t   test_calib;
+
+void test_mag_calib(void) {
+    imu_t imu;
+    float raw[3], mag[3], acce[3];
+
+    imu_calib_default(&test_calib);
+    mag_calib_start(&test_fit);
+    print("Spin and tilt the robot for %d seconds\r\n", MAG_CALIB_TEST_SECONDS);
+    for (uint32_t ms = 0; ms < MAG_CALIB_TEST_SECONDS * 1000; ms += 10) {
+        ist8310_get_data(&imu);
+        raw[0] = imu.mag.x; raw[1] = imu.mag.y; raw[2] = imu.mag.z;
+        mag_calib_add(&test_fit, raw);
+        osDelay(10);
+    }
+    if (!mag_calib_solve(&test_fit, &test_calib)) {
+        print("Calibration failed with %u samples\r\n", (unsigned)test_fit.count);
+        return;
+    }
+    print("Samples %u\r\n", (unsigned)test_fit.count);
+    print("Offset %.1f %.1f %.1f\r\n", test_calib.mag_offset[0], test_calib.mag_offset[1], test_calib.mag_offset[2]);
+    for (int i = 0; i < 3; ++i)
+        print("Matrix %.4f %.4f %.4f\r\n", test_calib.mag_matrix[i][0], test_calib.mag_matrix[i][1], test_calib.mag_matrix[i][2]);
+
+    mag_disturb_init(&test_gate, NULL, 0);
+    for (uint32_t tick = 0; ; ++tick) {
+        mpu6500_get_data(&imu);
+        ist8310_get_data(&imu);
+        imu_calib_apply_mag(&test_calib, &imu, mag);
+        acce[0] = imu.acce.x; acce[1] = imu.acce.y; acce[2] = imu.acce.z;
+        mag_disturb_update(&test_gate, mag, acce);
+        if (tick % (MAG_CALIB_TEST_PRINT_MS / 10) == 0) {
+            print("Norm %.1f \tRef %.1f \tDip %.1f \t", sqrtf(mag[0] * mag[0] + mag[1] * mag[1] + mag[2] * mag[2]),
+                  test_gate.norm_ref, test_gate.dip_ref);
+            print("Disturbed %d \tCount %u\r\n", test_gate.disturbed, (unsigned)test_gate.disturbed_count);
+        }
+        osDelay(10);
+    }
+}
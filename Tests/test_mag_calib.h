@@ -0,0 +1,35 @@
+/**************************************************************************
+ *  Copyright (C) 2018 
+ *  Illini RoboMaster @ University of Illinois at Urbana-Champaign.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#ifndef _TEST_MAG_CALIB_H_
+#define _TEST_MAG_CALIB_H_
+
+#include "mag_calib.h"
+#include "bsp_imu.h"
+
+#define MAG_CALIB_TEST_SECONDS  30
+#define MAG_CALIB_TEST_PRINT_MS 200
+
+/**
+ * Collect magnetometer samples while the robot is spun by hand, print the
+ * fitted offset and soft iron matrix, then the corrected field magnitude
+ * and disturbance flag
+ */
+void test_mag_calib(void);
+
+#endif
@@ -0,0 +1,46 @@
+/**************************************************************************
+ *  Copyright (C) 2018 
+ *  Illini RoboMaster @ University of Illinois at Urbana-Champaign.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#include "test_prof.h"
+#include "cmsis_os.h"
+#include <math.h>
+
+PROF_ZONE_DEFINE(sqrt_loop);
+PROF_ZONE_DEFINE(atan2_loop);
+
+static volatile float prof_sink;
+
+void test_prof(void) {
+    dwt_init();
+    for (int sec = 0; sec < PROF_TEST_SECONDS; ++sec) {
+        for (int i = 0; i < 100; ++i) {
+            PROF_ZONE_BEGIN(sqrt_loop);
+            for (int j = 1; j <= 64; ++j)
+                prof_sink = sqrtf((float)j);
+            PROF_ZONE_END(sqrt_loop);
+
+            PROF_ZONE_BEGIN(atan2_loop);
+            for (int j = 1; j <= 64; ++j)
+                prof_sink = atan2f((float)j, 3.0f);
+            PROF_ZONE_END(atan2_loop);
+            osDelay(10);
+        }
+        prof_print_report();
+        prof_reset();
+    }
+}
@@ -0,0 +1,34 @@
+/**************************************************************************
+ *  Copyright (C) 2018 
+ *  Illini RoboMaster @ University of Illinois at Urbana-Champaign.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#ifndef _TEST_PROF_H_
+#define _TEST_PROF_H_
+
+#include "bsp_prof.h"
+
+#define PROF_TEST_SECONDS   5
+
+/**
+ * Profile a few float kernels and print the zone and task report every second
+ *
+ * @note   Zones are timed only with PROF_ENABLE set to ON
+ * @note   Per-task usage requires the trace hooks described in bsp_prof.h
+ */
+void test_prof(void);
+
+#endif
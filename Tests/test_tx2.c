@@ -25,5 +25,8 @@ void test_tx2(void) {
     while (1) {
         tx2_info.aim_request.aim_mode = AUTOAIM;
         tx2_packer(&tx2_info, tx2_process, CMD_AIM_REQUEST);
+        if (data_process_is_updated(tx2_process, CMD_GIMBAL_CONTROL))
+            print("Gimbal control %u %u at %u ms\r\n", tx2_info.gimbal_control.pitch_ref, tx2_info.gimbal_control.yaw_ref,
+                  (unsigned)data_process_stamp(tx2_process, CMD_GIMBAL_CONTROL));
     }
 }
@@ -27,6 +27,39 @@
 
 #include "stm32f4xx_hal.h"
 
+/* Bytes consumed per table step, 1, 4 or 8. Each extra slice costs 256B of flash for CRC8 and 512B for CRC16 */
+#ifndef CRC_SLICES
+#define CRC_SLICES      8
+#endif
+
+/* Shorter messages skip the sliced loop, its setup costs more than it saves on a few bytes */
+#ifndef CRC_SLICE_MIN
+#define CRC_SLICE_MIN   16
+#endif
+
+#define CRC8_INIT_VALUE     0xff
+#define CRC16_INIT_VALUE    0xffff
+
+/**
+ * Continue a CRC8 over more bytes. Start from CRC8_INIT_VALUE, so a message may be checked as it arrives
+ *
+ * @param  crc        CRC8 of the bytes so far
+ * @param  data       Next bytes of the message
+ * @param  length     Number of bytes
+ * @return            CRC8 including data
+ */
+uint8_t crc8_update(uint8_t crc, const uint8_t* data, uint32_t length);
+
+/**
+ * Continue a CRC16 over more bytes. Start from CRC16_INIT_VALUE, so a message may be checked as it arrives
+ *
+ * @param  crc        CRC16 of the bytes so far
+ * @param  data       Next bytes of the message
+ * @param  length     Number of bytes
+ * @return            CRC16 including data
+ */
+uint16_t crc16_update(uint16_t crc, const uint8_t* data, uint32_t length);
+
 /**
  * CRC8 checksum calculation
  *
@@ -135,13 +135,13 @@ uint8_t fifo_s_get(fifo_s_t* pfifo) {
     return retval;
 }
 
-uint16_t fifo_s_gets(fifo_s_t* pfifo, uint8_t* source, uint8_t len) {
-    uint8_t   retval = 0;
+uint32_t fifo_s_gets(fifo_s_t* pfifo, uint8_t* source, uint32_t len) {
+    uint32_t  retval = 0;
     //! Check input parameters.
     ASSERT(NULL != pfifo);
     //! Update FIFO structure
     MUTEX_WAIT();
-    for (int i = 0; (i < len) && (pfifo->used > 0); i++) {
+    for (uint32_t i = 0; (i < len) && (pfifo->used > 0); i++) {
         source[i] = pfifo->start_addr[pfifo->read_index++];
         pfifo->read_index %= pfifo->buf_size;
         pfifo->free++;
@@ -152,11 +152,11 @@ uint16_t fifo_s_gets(fifo_s_t* pfifo, uint8_t* source, uint8_t len) {
     return retval;
 }
 
-uint8_t fifo_s_peek(fifo_s_t* pfifo, uint8_t offset) {
+uint8_t fifo_s_peek(fifo_s_t* pfifo, uint32_t offset) {
     uint32_t index;
     //! Check input parameters.
     ASSERT(NULL != pfifo);
-    if(offset > pfifo->used) {
+    if(offset >= pfifo->used) {
         return 0x00;
     }
     else {
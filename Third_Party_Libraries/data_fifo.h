@@ -50,8 +50,8 @@ typedef struct {
     uint32_t  free;             // The capacity of FIFO
     uint32_t  buf_size;         // Buffer size
     uint32_t  used;             // The number of elements in FIFO
-    uint8_t   read_index;       // Read Index Pointer
-    uint8_t   write_index;      // Write Index Pointer
+    uint32_t  read_index;       // Read Index Pointer
+    uint32_t  write_index;      // Write Index Pointer
     osMutexId mutex;
 } fifo_s_t;
 
@@ -117,7 +117,7 @@ uint8_t fifo_s_get(fifo_s_t* pfifo);
  * @param  len        How many elements to retrive
  * @return            Actual number of elements retrived
  */
-uint16_t fifo_s_gets(fifo_s_t* pfifo, uint8_t* source, uint8_t len);
+uint32_t fifo_s_gets(fifo_s_t* pfifo, uint8_t* source, uint32_t len);
 
 /**
  * Peek an element value at specific location
@@ -126,7 +126,7 @@ uint16_t fifo_s_gets(fifo_s_t* pfifo, uint8_t* source, uint8_t len);
  * @param  offset     Offset from current pointer
  * @return            Data at offset location
  */
-uint8_t fifo_s_peek(fifo_s_t* pfifo, uint8_t offset);
+uint8_t fifo_s_peek(fifo_s_t* pfifo, uint32_t offset);
 
 /**
  * Check if FIFO is empty
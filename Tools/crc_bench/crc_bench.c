@@ -0,0 +1,151 @@
+/**************************************************************************
+ *  Copyright (C) 2018 
+ *  Illini RoboMaster @ University of Illinois at Urbana-Champaign.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+/*
+ * Host equivalence test and benchmark of crc_check against the byte at a time loops it replaced.
+ *
+ *   crc_bench_<slices>
+ *
+ * Built once per CRC_SLICES setting. Exits with 1 if any checksum differs.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_UNIT      "cycle"
+#define bench_now()     __rdtsc()
+#else
+#define BENCH_UNIT      "ns"
+static uint64_t bench_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+#endif
+#include "crc_check.h"
+
+extern const uint8_t  CRC8_TAB[256];
+extern const uint16_t wCRC_Table[256];
+
+__attribute__((noinline)) static uint8_t ref_crc8(uint8_t crc, const uint8_t *data, uint32_t length) {
+    while (length--)
+        crc = CRC8_TAB[crc ^ *data++];
+    return crc;
+}
+
+__attribute__((noinline)) static uint16_t ref_crc16(uint16_t crc, const uint8_t *data, uint32_t length) {
+    while (length--)
+        crc = (crc >> 8) ^ wCRC_Table[(crc ^ *data++) & 0xff];
+    return crc;
+}
+
+static uint32_t bench_failures;
+
+static void bench_expect(int ok, const char *what, uint32_t a, uint32_t b) {
+    if (!ok && bench_failures++ < 10)
+        printf("mismatch in %s (%u, %u)\n", what, a, b);
+}
+
+static void bench_equivalence(void) {
+    static uint8_t data[4096 + 8];
+    uint8_t byte[2];
+    for (uint32_t i = 0; i < sizeof(data); ++i)
+        data[i] = rand();
+
+    /* Every seed against every byte, and every two byte message from the standard seed */
+    for (uint32_t seed = 0; seed < 256; ++seed)
+        for (uint32_t b = 0; b < 256; ++b) {
+            byte[0] = b;
+            bench_expect(crc8_update(seed, byte, 1) == ref_crc8(seed, byte, 1), "crc8 byte", seed, b);
+        }
+    for (uint32_t seed = 0; seed < 65536; seed += 257)
+        for (uint32_t b = 0; b < 256; ++b) {
+            byte[0] = b;
+            bench_expect(crc16_update(seed, byte, 1) == ref_crc16(seed, byte, 1), "crc16 byte", seed, b);
+        }
+    for (uint32_t m = 0; m < 65536; ++m) {
+        byte[0] = m;
+        byte[1] = m >> 8;
+        bench_expect(crc8_update(CRC8_INIT_VALUE, byte, 2) == ref_crc8(CRC8_INIT_VALUE, byte, 2), "crc8 pair", m, 0);
+        bench_expect(crc16_update(CRC16_INIT_VALUE, byte, 2) == ref_crc16(CRC16_INIT_VALUE, byte, 2), "crc16 pair", m, 0);
+    }
+
+    /* Every length and alignment, so each tail and block path is hit */
+    for (uint32_t offset = 0; offset < 8; ++offset)
+        for (uint32_t length = 0; length <= 1024; ++length) {
+            bench_expect(crc8_update(CRC8_INIT_VALUE, data + offset, length) == ref_crc8(CRC8_INIT_VALUE, data + offset, length),
+                         "crc8 length", offset, length);
+            bench_expect(crc16_update(CRC16_INIT_VALUE, data + offset, length) == ref_crc16(CRC16_INIT_VALUE, data + offset, length),
+                         "crc16 length", offset, length);
+        }
+
+    /* Streaming: a message split at every point gives the same checksum */
+    for (uint32_t length = 0; length <= 300; ++length)
+        for (uint32_t split = 0; split <= length; ++split) {
+            uint8_t  crc8  = crc8_update(crc8_update(CRC8_INIT_VALUE, data, split), data + split, length - split);
+            uint16_t crc16 = crc16_update(crc16_update(CRC16_INIT_VALUE, data, split), data + split, length - split);
+            bench_expect(crc8 == ref_crc8(CRC8_INIT_VALUE, data, length), "crc8 split", length, split);
+            bench_expect(crc16 == ref_crc16(CRC16_INIT_VALUE, data, length), "crc16 split", length, split);
+        }
+
+    /* Protocol helpers round trip, and catch a flipped bit */
+    for (uint32_t length = 3; length <= 256; ++length) {
+        append_crc8_check_sum(data, length);
+        append_crc16_check_sum(data + 8, length);
+        bench_expect(verify_crc8_check_sum(data, length) && verify_crc16_check_sum(data + 8, length), "append", length, 0);
+        data[8 + length / 2] ^= 0x10;
+        bench_expect(!verify_crc16_check_sum(data + 8, length), "bit flip", length, 0);
+        data[8 + length / 2] ^= 0x10;
+    }
+}
+
+static volatile uint32_t bench_sink;
+
+static void bench_speed(void) {
+    static uint8_t data[4096];
+    const uint32_t sizes[] = {5, 16, 64, 256, 4096};
+    for (uint32_t i = 0; i < sizeof(data); ++i)
+        data[i] = rand();
+    printf("%-6s %-8s %10s %10s %8s\n", "crc", "bytes", "ref B/" BENCH_UNIT, "new B/" BENCH_UNIT, "speedup");
+    for (uint8_t width = 8; width <= 16; width += 8)
+        for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); ++s) {
+            uint32_t size = sizes[s], rounds = (16u << 20) / size;
+            uint64_t start = bench_now();
+            for (uint32_t r = 0; r < rounds; ++r)
+                bench_sink += width == 8 ? ref_crc8(CRC8_INIT_VALUE, data, size) : ref_crc16(CRC16_INIT_VALUE, data, size);
+            uint64_t ref = bench_now() - start;
+            start = bench_now();
+            for (uint32_t r = 0; r < rounds; ++r)
+                bench_sink += width == 8 ? crc8_update(CRC8_INIT_VALUE, data, size) : crc16_update(CRC16_INIT_VALUE, data, size);
+            uint64_t opt = bench_now() - start;
+            double bytes = (double)size * rounds;
+            printf("crc%-3u %-8u %10.3f %10.3f %7.2fx\n", width, size, bytes / ref, bytes / opt, (double)ref / opt);
+        }
+}
+
+int main(void) {
+    printf("CRC_SLICES %d\n", CRC_SLICES);
+    srand(1);
+    bench_equivalence();
+    printf("equivalence: %s (%u mismatches)\n", bench_failures ? "FAIL" : "pass", bench_failures);
+    bench_speed();
+    return bench_failures ? 1 : 0;
+}
@@ -0,0 +1,19 @@
+/* Host configuration for the replay build */
+#ifndef _HOST_BSP_CONFIG_H_
+#define _HOST_BSP_CONFIG_H_
+
+#include "usart.h"
+
+#define ON      1
+#define OFF     0
+#define BSP_PRINT_PORT  huart8
+
+#define BSP_DBUS_PORT           huart1
+#define BSP_DBUS_MAX_LEN        50
+#define BSP_REFEREE_PORT        huart6
+#define BSP_REFEREE_MAX_LEN     256
+#define BSP_TX2_PORT            huart7
+#define BSP_TX2_MAX_LEN         256
+#define UART_TX_BLOCKING_TIMEOUT    10
+
+#endif
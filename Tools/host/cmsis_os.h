@@ -0,0 +1,29 @@
+/* Host stand-in for CMSIS-RTOS on top of pthreads */
+#ifndef _HOST_CMSIS_OS_H_
+#define _HOST_CMSIS_OS_H_
+
+#include "stm32f4xx_hal.h"
+
+#define osWaitForever   0xFFFFFFFF
+
+typedef void *osThreadId;
+typedef void *osMutexId;
+typedef enum { osOK = 0, osErrorOS = 0xFF } osStatus;
+
+osStatus osDelay(uint32_t millisec);
+int32_t osSignalSet(osThreadId thread_id, int32_t signal);
+
+/**
+ * Create a mutex, host only; targets use osMutexCreate with a definition
+ *
+ * @return            A new mutex, NULL if failed
+ */
+osMutexId host_mutex_create(void);
+osStatus osMutexWait(osMutexId mutex_id, uint32_t millisec);
+osStatus osMutexRelease(osMutexId mutex_id);
+osStatus osMutexDelete(osMutexId mutex_id);
+
+void *pvPortMalloc(size_t size);
+void vPortFree(void *ptr);
+
+#endif
@@ -0,0 +1,2 @@
+/* Host stand-in, DMA streams are part of the UART handles */
+#include "stm32f4xx_hal.h"
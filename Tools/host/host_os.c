@@ -0,0 +1,76 @@
+/**************************************************************************
+ *  Copyright (C) 2018 
+ *  Illini RoboMaster @ University of Illinois at Urbana-Champaign.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+/* CMSIS-RTOS calls used by the libraries, mapped onto pthreads and libc */
+
+#include <stdlib.h>
+#include <pthread.h>
+#include <time.h>
+#include "cmsis_os.h"
+
+__weak uint32_t HAL_GetTick(void) {
+    static struct timespec start;
+    struct timespec now;
+    if (start.tv_sec == 0 && start.tv_nsec == 0)
+        clock_gettime(CLOCK_MONOTONIC, &start);
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    /* Start at 1 so that a zero stamp still means never */
+    return 1 + (uint32_t)((now.tv_sec - start.tv_sec) * 1000 + (now.tv_nsec - start.tv_nsec) / 1000000);
+}
+
+osStatus osDelay(uint32_t millisec) {
+    struct timespec ts = {millisec / 1000, (millisec % 1000) * 1000000L};
+    nanosleep(&ts, NULL);
+    return osOK;
+}
+
+int32_t osSignalSet(osThreadId thread_id, int32_t signal) {
+    UNUSED(thread_id);
+    UNUSED(signal);
+    return 0;
+}
+
+osMutexId host_mutex_create(void) {
+    pthread_mutex_t *mutex = malloc(sizeof(pthread_mutex_t));
+    if (mutex != NULL)
+        pthread_mutex_init(mutex, NULL);
+    return mutex;
+}
+
+osStatus osMutexWait(osMutexId mutex_id, uint32_t millisec) {
+    UNUSED(millisec);
+    return pthread_mutex_lock(mutex_id) == 0 ? osOK : osErrorOS;
+}
+
+osStatus osMutexRelease(osMutexId mutex_id) {
+    return pthread_mutex_unlock(mutex_id) == 0 ? osOK : osErrorOS;
+}
+
+osStatus osMutexDelete(osMutexId mutex_id) {
+    pthread_mutex_destroy(mutex_id);
+    free(mutex_id);
+    return osOK;
+}
+
+void *pvPortMalloc(size_t size) {
+    return malloc(size);
+}
+
+void vPortFree(void *ptr) {
+    free(ptr);
+}
@@ -0,0 +1,9 @@
+/* Host configuration for the replay build */
+#ifndef _HOST_LIB_CONFIG_H_
+#define _HOST_LIB_CONFIG_H_
+
+#define ON      1
+#define OFF     0
+#define IMU_DT  0.001f
+
+#endif
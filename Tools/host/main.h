@@ -0,0 +1,2 @@
+/* Host stand-in, peripherals are not used by the replay */
+#include "stm32f4xx_hal.h"
@@ -0,0 +1,3 @@
+/* Host stand-in, peripherals are not used by the replay */
+#include "stm32f4xx_hal.h"
+extern SPI_HandleTypeDef hspi5;
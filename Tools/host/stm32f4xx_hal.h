@@ -0,0 +1,85 @@
+/* Host stand-in for the parts of the HAL the imu, uart and data process libraries touch */
+#ifndef _HOST_STM32F4XX_HAL_H_
+#define _HOST_STM32F4XX_HAL_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+#define __packed    __attribute__((packed))
+#define __weak      __attribute__((weak))
+#define UNUSED(x)   ((void)(x))
+
+typedef enum { HAL_OK = 0, HAL_ERROR, HAL_BUSY, HAL_TIMEOUT } HAL_StatusTypeDef;
+
+typedef struct { int unused; } GPIO_TypeDef;
+typedef struct { int unused; } SPI_HandleTypeDef;
+typedef struct { int unused; } TIM_TypeDef;
+typedef struct { TIM_TypeDef *Instance; } TIM_HandleTypeDef;
+typedef struct { volatile uint32_t CR, NDTR, PAR, M0AR, M1AR; } DMA_Stream_TypeDef;
+typedef struct { uint32_t Direction; } DMA_InitTypeDef;
+typedef struct __DMA_HandleTypeDef {
+    DMA_Stream_TypeDef  *Instance;
+    DMA_InitTypeDef     Init;
+    void                (*XferCpltCallback)(struct __DMA_HandleTypeDef *hdma);
+    void                (*XferM1CpltCallback)(struct __DMA_HandleTypeDef *hdma);
+    volatile uint32_t   State;
+    volatile uint32_t   ErrorCode;
+} DMA_HandleTypeDef;
+typedef struct { volatile uint32_t DR, CR3; } USART_TypeDef;
+typedef struct {
+    USART_TypeDef       *Instance;
+    DMA_HandleTypeDef   *hdmarx, *hdmatx;
+    uint8_t             *pRxBuffPtr;
+    uint16_t            RxXferSize;
+    volatile uint32_t   gState, RxState, ErrorCode;
+} UART_HandleTypeDef;
+
+#define DMA_PERIPH_TO_MEMORY        0
+#define DMA_MEMORY_TO_PERIPH        1
+#define DMA_MEMORY_TO_MEMORY        2
+#define DMA_SxCR_DBM                (1u << 18)
+#define DMA_SxCR_CT                 (1u << 19)
+#define DMA_IT_TC                   (1u << 4)
+#define HAL_DMA_STATE_READY         1
+#define HAL_DMA_STATE_BUSY          2
+#define HAL_DMA_ERROR_NONE          0
+#define HAL_DMA_ERROR_PARAM         0x40
+#define HAL_DMA_ERROR_NOT_SUPPORTED 0x80
+#define HAL_UART_STATE_READY        0x20
+#define HAL_UART_STATE_BUSY_TX      0x21
+#define HAL_UART_ERROR_NONE         0
+#define USART_CR3_DMAR              (1u << 6)
+#define UART_IT_IDLE                0
+
+#define SET_BIT(reg, bit)                   ((reg) |= (bit))
+#define __HAL_LOCK(handle)                  UNUSED(handle)
+#define __HAL_UNLOCK(handle)                UNUSED(handle)
+#define __HAL_DMA_ENABLE(hdma)              UNUSED(hdma)
+#define __HAL_DMA_CLEAR_FLAG(hdma, flag)    UNUSED(hdma)
+#define __HAL_DMA_GET_TC_FLAG_INDEX(hdma)   0
+#define __HAL_UART_CLEAR_IDLEFLAG(huart)    UNUSED(huart)
+#define __HAL_UART_ENABLE_IT(huart, it)     UNUSED(huart)
+
+/* Provided by whichever harness plays the other end of the UART */
+HAL_StatusTypeDef HAL_DMA_Start(DMA_HandleTypeDef *hdma, uint32_t SrcAddress, uint32_t DstAddress, uint32_t DataLength);
+HAL_StatusTypeDef HAL_UART_Transmit(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size, uint32_t Timeout);
+HAL_StatusTypeDef HAL_UART_Transmit_IT(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size);
+HAL_StatusTypeDef HAL_UART_Transmit_DMA(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size);
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart);    // Defined in bsp_uart.c
+
+typedef struct { volatile uint32_t CYCCNT; } DWT_Type;
+extern DWT_Type *DWT;
+
+#define FLASH_SECTOR_11 11
+
+static inline void __DMB(void) { __sync_synchronize(); }
+static inline uint32_t __REV16(uint32_t x) { return ((x & 0xff00ff00u) >> 8) | ((x & 0x00ff00ffu) << 8); }
+static inline int32_t __REVSH(int32_t x) { return (int16_t)(((x & 0xff) << 8) | ((x >> 8) & 0xff)); }
+static inline uint32_t __get_PRIMASK(void) { return 0; }
+static inline void __set_PRIMASK(uint32_t x) { (void)x; }
+static inline void __disable_irq(void) {}
+
+uint32_t HAL_GetTick(void);     // Milliseconds since the first call, in host_os.c. Weak, as in the HAL
+
+#endif
@@ -0,0 +1,3 @@
+/* Host stand-in, handles are defined by the harness that drives them */
+#include "stm32f4xx_hal.h"
+extern UART_HandleTypeDef huart1, huart6, huart7, huart8;
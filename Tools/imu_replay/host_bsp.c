@@ -0,0 +1,109 @@
+/**************************************************************************
+ *  Copyright (C) 2018 
+ *  Illini RoboMaster @ University of Illinois at Urbana-Champaign.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+/* BSP functions the imu libraries call, backed by the replayed log */
+
+#include <stdio.h>
+#include <stdarg.h>
+#include <sys/mman.h>
+#include "host_bsp.h"
+#include "bsp_flash.h"
+
+static DWT_Type host_dwt;
+DWT_Type *DWT = &host_dwt;
+
+static imu_t    host_imu;
+static uint8_t *host_flash;
+
+uint8_t host_flash_init(void) {
+    void *addr = (void*)(uintptr_t)BSP_FLASH_DATA_ADDR;
+    host_flash = mmap(addr, BSP_FLASH_DATA_SIZE, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED_NOREPLACE, -1, 0);
+    if (host_flash != addr) {
+        host_flash = NULL;
+        return 0;
+    }
+    host_flash_reset();
+    return 1;
+}
+
+void host_flash_reset(void) {
+    memset(host_flash, 0xFF, BSP_FLASH_DATA_SIZE);
+}
+
+void host_imu_feed(const imu_t* imu) {
+    host_imu = *imu;
+}
+
+void print(const char *fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    vfprintf(stderr, fmt, args);
+    va_end(args);
+}
+
+void bsp_error_handler(const char* func, int line, char* msg) {
+    fprintf(stderr, "[ERROR] %s:%d %s\n", func, line, msg);
+}
+
+uint32_t dwt_get_us(void) {
+    return host_imu.stamp_us;
+}
+
+void mpu6500_get_data(imu_t* imu) {
+    imu->acce     = host_imu.acce;
+    imu->temp     = host_imu.temp;
+    imu->gyro     = host_imu.gyro;
+    imu->stamp_us = host_imu.stamp_us;
+}
+
+void ist8310_get_data(imu_t* imu) {
+    imu->mag = host_imu.mag;
+}
+
+uint32_t onboard_imu_read_batch(imu_batch_t* batch) {
+    batch->count = 0;
+    return 0;
+}
+
+uint8_t flash_erase_sector(uint32_t sector) {
+    UNUSED(sector);
+    host_flash_reset();
+    return 1;
+}
+
+uint8_t flash_write(uint32_t addr, const void* data, uint32_t len) {
+    const uint8_t *src = data;
+    uint8_t *dst = (uint8_t*)(uintptr_t)addr;
+    /* flash programming only clears bits */
+    for (uint32_t i = 0; i < len; ++i)
+        dst[i] &= src[i];
+    return memcmp(dst, data, len) == 0;
+}
+
+void flash_read(uint32_t addr, void* data, uint32_t len) {
+    memcpy(data, (const void*)(uintptr_t)addr, len);
+}
+
+uint8_t flash_is_erased(uint32_t addr, uint32_t len) {
+    const uint8_t *p = (const uint8_t*)(uintptr_t)addr;
+    for (uint32_t i = 0; i < len; ++i)
+        if (p[i] != 0xFF)
+            return 0;
+    return 1;
+}
@@ -0,0 +1,44 @@
+/**************************************************************************
+ *  Copyright (C) 2018 
+ *  Illini RoboMaster @ University of Illinois at Urbana-Champaign.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#ifndef _HOST_BSP_H_
+#define _HOST_BSP_H_
+
+#include "bsp_imu.h"
+
+/**
+ * Map the emulated flash data sector at its target address and erase it.
+ * Library code reads flash through plain pointers, so it has to live there.
+ *
+ * @return            1 for success, 0 if the address range is taken
+ */
+uint8_t host_flash_init(void);
+
+/**
+ * Erase the emulated flash data sector, e.g. between estimator runs
+ */
+void host_flash_reset(void);
+
+/**
+ * Set the sample returned by the next mpu6500_get_data / ist8310_get_data
+ *
+ * @param  imu        Decoded sample
+ */
+void host_imu_feed(const imu_t* imu);
+
+#endif
@@ -0,0 +1,327 @@
+/**************************************************************************
+ *  Copyright (C) 2018 
+ *  Illini RoboMaster @ University of Illinois at Urbana-Champaign.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+/*
+ * Record and replay harness for onboard imu fusion.
+ *
+ *   imu_replay synth <log> <ref.csv> [options]   write a synthetic log and its true attitude
+ *   imu_replay run <log> [ref.csv] [--only name] replay a log through every registered estimator
+ *
+ * Logs are imu_log_header_t followed by imu_log_record_t, as imu_log_flush
+ * writes them on the robot. The reference is "stamp_us,roll,pitch,yaw" lines
+ * in degrees, interpolated at each record stamp. Without a reference only the
+ * update cost is reported. Angles are compared relative to their values when
+ * each estimator becomes ready, the same way imuBoard.angle starts from zero.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "imu_onboard.h"
+#include "imu_log.h"
+#include "host_bsp.h"
+#include "synth.h"
+
+#define REPLAY_AHRS_WARMUP  IMUSAMPLES  // samples before an AHRS counts as ready
+
+typedef struct {
+    const char  *name;
+    void        (*init)(void);
+    void        (*update)(const imu_t *imu);
+    uint8_t     (*ready)(void);
+    void        (*angles)(float angle[3]);
+} replay_estimator_t;
+
+typedef struct {
+    uint32_t    *stamp;
+    float       (*angle)[3];
+    uint32_t    count;
+    uint32_t    cursor;
+} replay_ref_t;
+
+/* Per-axis kalman: the onboard pipeline as configured in imu_onboard.h */
+
+static void kalman_init(void) {
+    memset(&imuBoard, 0, sizeof(imuBoard));
+    onboard_imu_calib_start();
+}
+
+static void kalman_update(const imu_t *imu) {
+    host_imu_feed(imu);
+    onboard_imu_update();
+}
+
+static uint8_t kalman_ready(void) {
+    return !imuBoard.calibrating;
+}
+
+static void kalman_angles(float angle[3]) {
+    memcpy(angle, imuBoard.angle, sizeof(imuBoard.angle));
+}
+
+/* AHRS on raw samples, learning the gyro bias itself */
+
+static ahrs_t   replay_ahrs;
+static uint32_t replay_ahrs_count;
+static uint32_t replay_ahrs_last;
+
+static void ahrs_update_raw(const imu_t *imu) {
+    float acce[3] = {imu->acce.x, imu->acce.y, imu->acce.z};
+    if (replay_ahrs_count++ == 0) {
+        ahrs_align(&replay_ahrs, acce);
+        replay_ahrs_last = imu->stamp_us;
+        return;
+    }
+    uint32_t delta_us = imu->stamp_us - replay_ahrs_last;
+    if (delta_us == 0)
+        return;
+    replay_ahrs_last = imu->stamp_us;
+    float gyro[3] = {imu->gyro.x * DEG_2_RAD, imu->gyro.y * DEG_2_RAD, imu->gyro.z * DEG_2_RAD};
+    ahrs_update(&replay_ahrs, gyro, acce, NULL, delta_us * 1e-6f);
+}
+
+static void mahony_init(void) {
+    ahrs_init(&replay_ahrs, AHRS_MAHONY);
+    replay_ahrs_count = 0;
+}
+
+static void madgwick_init(void) {
+    ahrs_init(&replay_ahrs, AHRS_MADGWICK);
+    replay_ahrs_count = 0;
+}
+
+static uint8_t ahrs_ready(void) {
+    return replay_ahrs_count > REPLAY_AHRS_WARMUP;
+}
+
+static void ahrs_angles(float angle[3]) {
+    ahrs_get_euler(&replay_ahrs, angle);
+}
+
+/* Register new estimators here */
+static const replay_estimator_t replay_estimators[] = {
+    {"kalman",   kalman_init,   kalman_update,   kalman_ready, kalman_angles},
+    {"mahony",   mahony_init,   ahrs_update_raw, ahrs_ready,   ahrs_angles},
+    {"madgwick", madgwick_init, ahrs_update_raw, ahrs_ready,   ahrs_angles},
+};
+
+static uint64_t replay_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+static float replay_wrap(float deg) {
+    deg = fmodf(deg, 360.0f);
+    if (deg > 180.0f)
+        deg -= 360.0f;
+    else if (deg < -180.0f)
+        deg += 360.0f;
+    return deg;
+}
+
+static uint8_t replay_ref_load(const char *path, replay_ref_t *ref) {
+    FILE *file = fopen(path, "r");
+    if (!file)
+        return 0;
+    uint32_t cap = 1024, stamp;
+    float roll, pitch, yaw;
+    ref->count  = 0;
+    ref->cursor = 0;
+    ref->stamp  = malloc(cap * sizeof(*ref->stamp));
+    ref->angle  = malloc(cap * sizeof(*ref->angle));
+    while (fscanf(file, "%u,%f,%f,%f", &stamp, &roll, &pitch, &yaw) == 4) {
+        if (ref->count == cap) {
+            cap *= 2;
+            ref->stamp = realloc(ref->stamp, cap * sizeof(*ref->stamp));
+            ref->angle = realloc(ref->angle, cap * sizeof(*ref->angle));
+        }
+        ref->stamp[ref->count]    = stamp;
+        ref->angle[ref->count][0] = roll;
+        ref->angle[ref->count][1] = pitch;
+        ref->angle[ref->count][2] = yaw;
+        ref->count++;
+    }
+    fclose(file);
+    return ref->count > 1;
+}
+
+/* Reference at a stamp, for stamps that only move forward */
+static uint8_t replay_ref_at(replay_ref_t *ref, uint32_t stamp, float angle[3]) {
+    while (ref->cursor + 1 < ref->count && (int32_t)(ref->stamp[ref->cursor + 1] - stamp) <= 0)
+        ref->cursor++;
+    if (ref->cursor + 1 >= ref->count || (int32_t)(stamp - ref->stamp[ref->cursor]) < 0)
+        return 0;
+    uint32_t i = ref->cursor;
+    float frac = (float)(stamp - ref->stamp[i]) / (float)(ref->stamp[i + 1] - ref->stamp[i]);
+    for (int axis = 0; axis < 3; ++axis)
+        angle[axis] = ref->angle[i][axis] + frac * (ref->angle[i + 1][axis] - ref->angle[i][axis]);
+    return 1;
+}
+
+static void replay_run(const replay_estimator_t *est, const imu_log_header_t *header,
+                       const imu_log_record_t *records, uint32_t count, replay_ref_t *ref) {
+    double sq[3] = {0, 0, 0};
+    float max[3] = {0, 0, 0}, last[3] = {0, 0, 0}, est0[3], ref0[3];
+    uint32_t scored = 0, first = 0;
+    uint64_t busy = 0;
+    imu_t imu;
+
+    host_flash_reset();
+    est->init();
+    if (ref)
+        ref->cursor = 0;
+    for (uint32_t i = 0; i < count; ++i) {
+        imu_log_decode(header, &records[i], &imu);
+        uint64_t start = replay_now_ns();
+        est->update(&imu);
+        busy += replay_now_ns() - start;
+
+        float angle[3], truth[3];
+        if (!ref || !est->ready() || !replay_ref_at(ref, imu.stamp_us, truth))
+            continue;
+        est->angles(angle);
+        if (!first) {
+            memcpy(est0, angle, sizeof(est0));
+            memcpy(ref0, truth, sizeof(ref0));
+            first = 1;
+        }
+        for (int axis = 0; axis < 3; ++axis) {
+            float err = replay_wrap((angle[axis] - est0[axis]) - (truth[axis] - ref0[axis]));
+            sq[axis] += err * err;
+            if (fabsf(err) > max[axis])
+                max[axis] = fabsf(err);
+            last[axis] = err;
+        }
+        scored++;
+    }
+    printf("%-10s %8u", est->name, scored);
+    for (int axis = 0; axis < 3; ++axis)
+        printf(" %7.3f %7.3f", scored ? sqrt(sq[axis] / scored) : 0.0, max[axis]);
+    printf(" %8.3f %9.1f\n", last[YAW], count ? (double)busy / count : 0.0);
+}
+
+static int replay_cmd_run(int argc, char **argv) {
+    const char *only = NULL, *ref_path = NULL;
+    for (int i = 3; i < argc; ++i) {
+        if (!strcmp(argv[i], "--only") && i + 1 < argc)
+            only = argv[++i];
+        else
+            ref_path = argv[i];
+    }
+    FILE *file = fopen(argv[2], "rb");
+    if (!file) {
+        fprintf(stderr, "cannot open %s\n", argv[2]);
+        return 1;
+    }
+    imu_log_header_t header;
+    if (fread(&header, sizeof(header), 1, file) != 1 || header.magic != IMU_LOG_MAGIC
+            || header.version != IMU_LOG_VERSION || header.record_size != sizeof(imu_log_record_t)) {
+        fprintf(stderr, "%s is not a version %d imu log\n", argv[2], IMU_LOG_VERSION);
+        fclose(file);
+        return 1;
+    }
+    fseek(file, 0, SEEK_END);
+    uint32_t count = (ftell(file) - sizeof(header)) / sizeof(imu_log_record_t);
+    fseek(file, sizeof(header), SEEK_SET);
+    imu_log_record_t *records = malloc(count * sizeof(imu_log_record_t));
+    count = fread(records, sizeof(imu_log_record_t), count, file);
+    fclose(file);
+
+    replay_ref_t ref;
+    uint8_t has_ref = ref_path && replay_ref_load(ref_path, &ref);
+    if (ref_path && !has_ref)
+        fprintf(stderr, "cannot read reference %s, reporting cost only\n", ref_path);
+
+    printf("%u records, %.1f s\n", count, count > 1 ? (records[count - 1].stamp_us - records[0].stamp_us) * 1e-6 : 0.0);
+    printf("%-10s %8s %7s %7s %7s %7s %7s %7s %8s %9s\n", "estimator", "scored",
+           "roll", "max", "pitch", "max", "yaw", "max", "yaw end", "ns/update");
+    for (size_t i = 0; i < sizeof(replay_estimators) / sizeof(replay_estimators[0]); ++i)
+        if (!only || !strcmp(only, replay_estimators[i].name))
+            replay_run(&replay_estimators[i], &header, records, count, has_ref ? &ref : NULL);
+    printf("errors are RMS and max in degrees\n");
+    free(records);
+    return 0;
+}
+
+static int replay_cmd_synth(int argc, char **argv) {
+    synth_cfg_t cfg;
+    synth_default(&cfg);
+    for (int i = 4; i + 1 < argc; i += 2) {
+        const char *opt = argv[i];
+        float val = atof(argv[i + 1]);
+        if (!strcmp(opt, "--seconds"))          cfg.seconds = val;
+        else if (!strcmp(opt, "--still"))       cfg.still = val;
+        else if (!strcmp(opt, "--rate"))        cfg.rate_hz = val;
+        else if (!strcmp(opt, "--gyro-noise"))  cfg.gyro_noise = val;
+        else if (!strcmp(opt, "--gyro-bias"))   cfg.gyro_bias = val;
+        else if (!strcmp(opt, "--bias-walk"))   cfg.bias_walk = val;
+        else if (!strcmp(opt, "--acce-noise"))  cfg.acce_noise = val;
+        else if (!strcmp(opt, "--vib-hz"))      cfg.vib_hz = val;
+        else if (!strcmp(opt, "--vib-amp"))     cfg.vib_amp = val;
+        else if (!strcmp(opt, "--spin"))        cfg.spin = val;
+        else if (!strcmp(opt, "--jitter"))      cfg.jitter_us = val;
+        else if (!strcmp(opt, "--drop"))        cfg.drop = val;
+        else if (!strcmp(opt, "--temp"))        cfg.temp = val;
+        else if (!strcmp(opt, "--seed"))        cfg.seed = (uint32_t)val;
+        else {
+            fprintf(stderr, "unknown option %s\n", opt);
+            return 1;
+        }
+    }
+    FILE *log = fopen(argv[2], "wb");
+    FILE *ref = fopen(argv[3], "w");
+    if (!log || !ref) {
+        fprintf(stderr, "cannot write %s or %s\n", argv[2], argv[3]);
+        return 1;
+    }
+    imu_log_header_t header;
+    imu_log_header(&header);
+    fwrite(&header, sizeof(header), 1, log);
+
+    synth_t synth;
+    imu_t imu;
+    imu_log_record_t record;
+    float truth[3];
+    uint32_t count = 0;
+    synth_start(&synth, &cfg);
+    while (synth_next(&synth, &imu, truth)) {
+        imu_log_encode(&imu, &record);
+        fwrite(&record, sizeof(record), 1, log);
+        fprintf(ref, "%u,%.5f,%.5f,%.5f\n", imu.stamp_us, truth[0], truth[1], truth[2]);
+        count++;
+    }
+    fclose(log);
+    fclose(ref);
+    printf("%u records written\n", count);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    if (argc >= 4 && !strcmp(argv[1], "synth"))
+        return replay_cmd_synth(argc, argv);
+    if (!host_flash_init()) {
+        fprintf(stderr, "cannot map emulated flash at 0x%08X\n", BSP_FLASH_DATA_ADDR);
+        return 1;
+    }
+    if (argc >= 3 && !strcmp(argv[1], "run"))
+        return replay_cmd_run(argc, argv);
+    fprintf(stderr, "usage: %s synth <log> <ref.csv> [--seconds s --gyro-noise dps --gyro-bias dps ...]\n"
+                    "       %s run <log> [ref.csv] [--only name]\n", argv[0], argv[0]);
+    return 1;
+}
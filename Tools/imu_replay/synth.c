@@ -0,0 +1,148 @@
+/**************************************************************************
+ *  Copyright (C) 2018 
+ *  Illini RoboMaster @ University of Illinois at Urbana-Champaign.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#include <math.h>
+#include "synth.h"
+
+#define SYNTH_PI        3.14159265358979
+#define SYNTH_D2R       (SYNTH_PI / 180.0)
+#define SYNTH_MAG       400.0   // field strength in IST8310 counts
+#define SYNTH_MAG_DIP   60.0    // degrees below the horizon
+#define SYNTH_T0_US     1000000 // stamp of the first sample, keeps jitter from wrapping
+
+static float synth_uniform(synth_t *synth) {
+    /* xorshift32 */
+    uint32_t x = synth->rng;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    synth->rng = x;
+    return (x >> 8) * (1.0f / 16777216.0f);
+}
+
+static float synth_gauss(synth_t *synth) {
+    float u = synth_uniform(synth) + 1e-7f;
+    float v = synth_uniform(synth);
+    return sqrtf(-2.0f * logf(u)) * cosf(2.0f * (float)SYNTH_PI * v);
+}
+
+static double synth_smoothstep(double x) {
+    if (x <= 0)
+        return 0;
+    if (x >= 1)
+        return 1;
+    return x * x * (3 - 2 * x);
+}
+
+/* Integral of synth_smoothstep */
+static double synth_smoothramp(double x) {
+    if (x <= 0)
+        return 0;
+    if (x >= 1)
+        return x - 0.5;
+    return x * x * x - 0.5 * x * x * x * x;
+}
+
+/* Roll, pitch, yaw in radians, z y x order with pitch about +y */
+static void synth_attitude(const synth_cfg_t *cfg, double t, double euler[3]) {
+    double tau = t - cfg->still;
+    double motion = cfg->seconds - cfg->still;
+    if (tau < 0)
+        tau = 0;
+    double ramp = synth_smoothstep(tau);
+    euler[0] = ramp * 12.0 * SYNTH_D2R * sin(2 * SYNTH_PI * 0.4 * tau);
+    euler[1] = ramp * 8.0 * SYNTH_D2R * sin(2 * SYNTH_PI * 0.25 * tau + 1.0);
+    euler[2] = ramp * 90.0 * SYNTH_D2R * sin(2 * SYNTH_PI * 0.1 * tau)
+             + cfg->spin * SYNTH_D2R * (synth_smoothramp(tau - motion / 3) - synth_smoothramp(tau - 2 * motion / 3));
+}
+
+void synth_default(synth_cfg_t *cfg) {
+    cfg->seconds    = 33.0f;
+    cfg->still      = 3.0f;
+    cfg->rate_hz    = 1000.0f;
+    cfg->gyro_noise = 0.1f;
+    cfg->gyro_bias  = 0.5f;
+    cfg->bias_walk  = 0.002f;
+    cfg->acce_noise = 0.005f;
+    cfg->vib_hz     = 0;
+    cfg->vib_amp    = 0;
+    cfg->spin       = 360.0f;
+    cfg->jitter_us  = 20.0f;
+    cfg->drop       = 0;
+    cfg->temp       = 40.0f;
+    cfg->seed       = 1;
+}
+
+void synth_start(synth_t *synth, const synth_cfg_t *cfg) {
+    synth->cfg   = *cfg;
+    synth->index = 0;
+    synth->rng   = cfg->seed ? cfg->seed : 1;
+    for (int axis = 0; axis < 3; ++axis)
+        synth->bias[axis] = cfg->gyro_bias * (synth_uniform(synth) < 0.5f ? -1.0f : 1.0f);
+}
+
+uint8_t synth_next(synth_t *synth, imu_t *imu, float truth[3]) {
+    const synth_cfg_t *cfg = &synth->cfg;
+    double period = 1.0 / cfg->rate_hz;
+    float walk = cfg->bias_walk * sqrtf((float)period);
+    double t;
+    do {
+        if (synth->index >= (uint32_t)(cfg->seconds * cfg->rate_hz))
+            return 0;
+        t = synth->index++ * period;
+        for (int axis = 0; axis < 3; ++axis)
+            synth->bias[axis] += walk * synth_gauss(synth);
+    } while (cfg->drop > 0 && synth_uniform(synth) < cfg->drop);
+
+    double e[3], ep[3], em[3], h = 1e-4;
+    synth_attitude(cfg, t, e);
+    synth_attitude(cfg, t + h, ep);
+    synth_attitude(cfg, t - h, em);
+    double dr = (ep[0] - em[0]) / (2 * h), dp = (ep[1] - em[1]) / (2 * h), dy = (ep[2] - em[2]) / (2 * h);
+    double sr = sin(e[0]), cr = cos(e[0]), sp = sin(e[1]), cp = cos(e[1]), sy = sin(e[2]), cy = cos(e[2]);
+
+    /* body rates from euler rates */
+    double rate[3] = {dr - dy * sp, dp * cr + dy * cp * sr, -dp * sr + dy * cp * cr};
+    float vib = cfg->vib_amp * sinf(2.0f * (float)SYNTH_PI * cfg->vib_hz * (float)t);
+    imu->gyro.x = rate[0] / SYNTH_D2R + synth->bias[0] + cfg->gyro_noise * synth_gauss(synth) + vib;
+    imu->gyro.y = rate[1] / SYNTH_D2R + synth->bias[1] + cfg->gyro_noise * synth_gauss(synth) + 0.5f * vib;
+    imu->gyro.z = rate[2] / SYNTH_D2R + synth->bias[2] + cfg->gyro_noise * synth_gauss(synth) + 0.2f * vib;
+
+    /* at rest the accelerometer reads gravity reaction, i.e. world +z in the body frame */
+    imu->acce.x = -sp + cfg->acce_noise * synth_gauss(synth);
+    imu->acce.y = cp * sr + cfg->acce_noise * synth_gauss(synth);
+    imu->acce.z = cp * cr + cfg->acce_noise * synth_gauss(synth);
+
+    /* body = Rx' Ry' Rz' world */
+    double mw[3] = {SYNTH_MAG * cos(SYNTH_MAG_DIP * SYNTH_D2R), 0, -SYNTH_MAG * sin(SYNTH_MAG_DIP * SYNTH_D2R)};
+    double m1[3] = {cy * mw[0] + sy * mw[1], -sy * mw[0] + cy * mw[1], mw[2]};
+    double m2[3] = {cp * m1[0] - sp * m1[2], m1[1], sp * m1[0] + cp * m1[2]};
+    double m3[3] = {m2[0], cr * m2[1] + sr * m2[2], -sr * m2[1] + cr * m2[2]};
+    imu->mag.x = (int16_t)lround(m3[0]);
+    imu->mag.y = (int16_t)lround(m3[1]);
+    imu->mag.z = (int16_t)lround(m3[2]);
+
+    imu->temp     = cfg->temp;
+    imu->stamp_us = (uint32_t)(SYNTH_T0_US + t * 1e6 + cfg->jitter_us * (2.0f * synth_uniform(synth) - 1.0f));
+
+    /* the libraries report pitch with the opposite sign */
+    truth[0] = e[0] / SYNTH_D2R;
+    truth[1] = -e[1] / SYNTH_D2R;
+    truth[2] = e[2] / SYNTH_D2R;
+    return 1;
+}
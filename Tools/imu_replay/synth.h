@@ -0,0 +1,92 @@
+/**************************************************************************
+ *  Copyright (C) 2018 
+ *  Illini RoboMaster @ University of Illinois at Urbana-Champaign.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#ifndef _SYNTH_H_
+#define _SYNTH_H_
+
+#include "bsp_imu.h"
+
+/**
+ * @struct synth_cfg_t
+ * @brief synthetic trajectory and sensor error model
+ * @var seconds     log length
+ * @var still       seconds at rest before moving, long enough for gyro calibration
+ * @var rate_hz     sample rate
+ * @var gyro_noise  gyro white noise, deg/s RMS per sample
+ * @var gyro_bias   initial gyro bias magnitude per axis, deg/s
+ * @var bias_walk   gyro bias random walk, deg/s per sqrt(s)
+ * @var acce_noise  accelerometer white noise, g RMS per sample
+ * @var vib_hz      frequency of a vibration tone on the gyro, 0 for none
+ * @var vib_amp     amplitude of the vibration tone, deg/s
+ * @var spin        chassis spin rate in the middle third of the motion, deg/s
+ * @var jitter_us   uniform sample time jitter, +/- microseconds
+ * @var drop        probability a sample is lost
+ * @var temp        sensor temperature, celsius
+ * @var seed        random seed
+ */
+typedef struct {
+    float       seconds;
+    float       still;
+    float       rate_hz;
+    float       gyro_noise;
+    float       gyro_bias;
+    float       bias_walk;
+    float       acce_noise;
+    float       vib_hz;
+    float       vib_amp;
+    float       spin;
+    float       jitter_us;
+    float       drop;
+    float       temp;
+    uint32_t    seed;
+} synth_cfg_t;
+
+typedef struct {
+    synth_cfg_t cfg;
+    uint32_t    index;
+    uint32_t    rng;
+    float       bias[3];
+} synth_t;
+
+/**
+ * Fill a configuration with a mildly noisy robot: 3s still, then 30s of
+ * roll/pitch sway, yaw swings and a chassis spin
+ *
+ * @param  cfg        Configuration to fill
+ */
+void synth_default(synth_cfg_t *cfg);
+
+/**
+ * Start generating samples
+ *
+ * @param  synth      Generator state
+ * @param  cfg        Configuration, copied
+ */
+void synth_start(synth_t *synth, const synth_cfg_t *cfg);
+
+/**
+ * Generate the next sample that was not dropped
+ *
+ * @param  synth      Generator state
+ * @param  imu        Output sample as the sensor path would decode it
+ * @param  truth      Output roll, pitch, yaw in degrees, in the convention of imuBoard.angle
+ * @return            1 for a sample, 0 once the log is complete
+ */
+uint8_t synth_next(synth_t *synth, imu_t *imu, float truth[3]);
+
+#endif
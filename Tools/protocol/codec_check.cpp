@@ -0,0 +1,127 @@
+// Host check of the generated protocol code. Exits with 1 on any mismatch.
+//  1. The codec CRCs agree with crc_check.c
+//  2. Every message decodes and encodes back to the same bytes, alone and inside a frame
+//  3. Firmware structs and codec structs read the same fields out of random payloads
+//  4. A stream of frames with garbage and corrupted frames in between parses to exactly the good frames
+
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "referee_2018_codec.hpp"
+#include "referee_2019_codec.hpp"
+#include "tx2_codec.hpp"
+
+extern "C" {
+uint8_t  crc8_update(uint8_t crc, const uint8_t* data, uint32_t length);
+uint16_t crc16_update(uint16_t crc, const uint8_t* data, uint32_t length);
+}
+
+static int failures;
+static std::mt19937 rng(1);
+
+#define CHECK(cond, ...) do { if (!(cond)) { failures++; printf("FAIL: " __VA_ARGS__); printf("\n"); } } while (0)
+
+static void fill(uint8_t* data, size_t length) {
+    for (size_t i = 0; i < length; ++i)
+        data[i] = static_cast<uint8_t>(rng());
+}
+
+static void check_crc() {
+    uint8_t data[300] = {};
+    for (size_t length = 0; length <= sizeof(data); ++length) {
+        fill(data, length);
+        CHECK(protocol::crc8(data, length) == crc8_update(0xff, data, length), "crc8 length %zu", length);
+        CHECK(protocol::crc16(data, length) == crc16_update(0xffff, data, length), "crc16 length %zu", length);
+    }
+}
+
+template <typename Msg>
+static void round_trip(const char* link, uint8_t sof) {
+    uint8_t data[Msg::size], again[Msg::size];
+    for (int n = 0; n < 100; ++n) {
+        fill(data, Msg::size);
+        Msg msg;
+        CHECK(msg.decode(data, Msg::size), "%s 0x%04X decode", link, Msg::cmdid);
+        CHECK(!msg.decode(data, Msg::size + 1), "%s 0x%04X accepts a longer payload", link, Msg::cmdid);
+        msg.encode(again);
+        CHECK(memcmp(data, again, Msg::size) == 0, "%s 0x%04X encode", link, Msg::cmdid);
+
+        std::vector<uint8_t> stream;
+        protocol::encode_frame(sof, static_cast<uint8_t>(n), msg, stream);
+        protocol::frame_t frame;
+        bool found;
+        size_t used = protocol::parse_frame(sof, stream.data(), stream.size(), frame, found);
+        CHECK(found && used == stream.size() && frame.seq == n && frame.cmdid == Msg::cmdid && frame.length == Msg::size &&
+              memcmp(frame.data, data, Msg::size) == 0, "%s 0x%04X frame", link, Msg::cmdid);
+    }
+}
+
+static void check_messages() {
+    referee_2018::for_each_message([](auto msg) { round_trip<decltype(msg)>("referee 2018", referee_2018::sof); });
+    referee_2019::for_each_message([](auto msg) { round_trip<decltype(msg)>("referee 2019", referee_2019::sof); });
+    tx2::for_each_message([](auto msg) { round_trip<decltype(msg)>("tx2", tx2::sof); });
+}
+
+static void check_layout() {
+    uint8_t data[64];
+    for (int n = 0; n < 1000; ++n) {
+        fill(data, sizeof(data));
+        CHECK(referee_2018::layout_check(data) == 0, "referee 2018 firmware structs differ from the codec");
+        CHECK(referee_2019::layout_check(data) == 0, "referee 2019 firmware structs differ from the codec");
+        CHECK(tx2::layout_check(data) == 0, "tx2 firmware structs differ from the codec");
+    }
+}
+
+static void check_stream() {
+    std::vector<uint8_t> stream;
+    std::vector<uint16_t> expected;
+    uint8_t seq = 0;
+    int corrupted = 0;
+    for (int n = 0; n < 200; ++n) {
+        referee_2019::for_each_message([&](auto msg) {
+            uint8_t data[decltype(msg)::size];
+            fill(data, sizeof(data));
+            msg.decode(data, sizeof(data));
+            size_t start = stream.size();
+            protocol::encode_frame(referee_2019::sof, seq++, msg, stream);
+            if (rng() % 10 == 0) {
+                stream[start + 1 + rng() % (stream.size() - start - 1)] ^= 1 << (rng() % 8);
+                corrupted++;
+            }
+            else
+                expected.push_back(decltype(msg)::cmdid);
+            for (unsigned garbage = rng() % 4; garbage > 0; --garbage)
+                stream.push_back(rng() % 3 ? static_cast<uint8_t>(rng()) : referee_2019::sof);
+        });
+    }
+
+    std::vector<uint16_t> parsed;
+    int decoded = 0;
+    size_t offset = 0;
+    while (offset < stream.size()) {
+        protocol::frame_t frame;
+        bool found;
+        size_t used = protocol::parse_frame(referee_2019::sof, stream.data() + offset, stream.size() - offset, frame, found);
+        offset += used;
+        if (!found) {
+            // The stream has ended, so a header that still waits for its payload was garbage
+            offset++;
+            continue;
+        }
+        parsed.push_back(frame.cmdid);
+        decoded += referee_2019::dispatch(frame.cmdid, frame.data, frame.length, [](const auto&) {});
+    }
+    CHECK(parsed == expected, "stream parsed %zu frames, expected %zu", parsed.size(), expected.size());
+    CHECK(decoded == static_cast<int>(expected.size()), "stream dispatched %d frames", decoded);
+    printf("Stream: %zu frames, %d corrupted, %zu parsed\n", expected.size() + corrupted, corrupted, parsed.size());
+}
+
+int main() {
+    check_crc();
+    check_messages();
+    check_layout();
+    check_stream();
+    printf("%s\n", failures ? "FAILED" : "All protocol checks passed");
+    return failures ? 1 : 0;
+}
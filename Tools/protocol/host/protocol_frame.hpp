@@ -0,0 +1,121 @@
+// Frame layer shared by the generated codecs. Matches data_process and crc_check on the robot:
+//  FrameHeader 5B [SOF 1B + Data Length 2B + SEQ 1B + CRC8 1B]
+//  CmdID       2B
+//  Data        nB
+//  FrameTail   2B CRC16
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "fields are read in host order, which must match the robot");
+
+namespace protocol {
+
+enum direction_t { RX = 1, TX = 2, BOTH = 3 };  // Seen from the robot
+
+constexpr size_t header_len = 5;
+constexpr size_t cmd_len    = 2;
+constexpr size_t crc16_len  = 2;
+constexpr size_t overhead   = header_len + cmd_len + crc16_len;
+constexpr size_t max_frame  = 256;  // DATA_PROCESS_MAX_FRAME_LEN, longer headers are rejected like on the robot
+
+template <typename T>
+inline T get(const uint8_t* data) {
+    T value;
+    memcpy(&value, data, sizeof(T));
+    return value;
+}
+
+template <typename T>
+inline void put(uint8_t* data, T value) {
+    memcpy(data, &value, sizeof(T));
+}
+
+template <typename T>
+inline T get_bits(const uint8_t* data, unsigned shift, unsigned bits) {
+    return static_cast<T>((get<T>(data) >> shift) & ((1u << bits) - 1));
+}
+
+template <typename T>
+inline void put_bits(uint8_t* data, unsigned shift, unsigned bits, T value) {
+    T mask = static_cast<T>(((1u << bits) - 1) << shift);
+    put<T>(data, static_cast<T>((get<T>(data) & ~mask) | ((value << shift) & mask)));
+}
+
+// Reflected CRC8 (x8+x5+x4+1) and CRC16 (x16+x12+x5+1), same seeds as crc_check.c
+inline uint8_t crc8(const uint8_t* data, size_t length, uint8_t crc = 0xff) {
+    while (length--) {
+        crc ^= *data++;
+        for (int i = 0; i < 8; ++i)
+            crc = (crc & 1) ? (crc >> 1) ^ 0x8c : crc >> 1;
+    }
+    return crc;
+}
+
+inline uint16_t crc16(const uint8_t* data, size_t length, uint16_t crc = 0xffff) {
+    while (length--) {
+        crc ^= *data++;
+        for (int i = 0; i < 8; ++i)
+            crc = (crc & 1) ? (crc >> 1) ^ 0x8408 : crc >> 1;
+    }
+    return crc;
+}
+
+struct frame_t {
+    uint8_t         seq;
+    uint16_t        cmdid;
+    const uint8_t*  data;   // Points into the parsed buffer
+    uint16_t        length;
+};
+
+// Append a frame carrying msg to out
+template <typename Msg>
+void encode_frame(uint8_t sof, uint8_t seq, const Msg& msg, std::vector<uint8_t>& out) {
+    size_t start = out.size();
+    out.resize(start + overhead + Msg::size);
+    uint8_t* frame = &out[start];
+    frame[0] = sof;
+    put<uint16_t>(frame + 1, Msg::size);
+    frame[3] = seq;
+    frame[4] = crc8(frame, header_len - 1);
+    put<uint16_t>(frame + header_len, Msg::cmdid);
+    msg.encode(frame + header_len + cmd_len);
+    put<uint16_t>(frame + header_len + cmd_len + Msg::size, crc16(frame, header_len + cmd_len + Msg::size));
+}
+
+// Find the first good frame in data. Returns the bytes consumed up to the end of that frame, or the bytes
+// that can never start a frame if there is none yet. found tells the two apart. Without a frame, data from
+// the returned offset on is a frame that is not complete yet
+inline size_t parse_frame(uint8_t sof, const uint8_t* data, size_t length, frame_t& frame, bool& found) {
+    found = false;
+    for (size_t start = 0; start < length; ++start) {
+        if (data[start] != sof)
+            continue;
+        const uint8_t* p = data + start;
+        size_t left = length - start;
+        if (left < header_len)
+            return start;
+        if (crc8(p, header_len - 1) != p[header_len - 1])
+            continue;
+        uint16_t data_len = get<uint16_t>(p + 1);
+        if (data_len > max_frame - overhead)
+            continue;
+        if (left < overhead + data_len)
+            return start;
+        if (crc16(p, header_len + cmd_len + data_len) != get<uint16_t>(p + header_len + cmd_len + data_len))
+            continue;
+        frame.seq    = p[3];
+        frame.cmdid  = get<uint16_t>(p + header_len);
+        frame.data   = p + header_len + cmd_len;
+        frame.length = data_len;
+        found = true;
+        return start + overhead + data_len;
+    }
+    return length;
+}
+
+}  // namespace protocol
@@ -0,0 +1,534 @@
+// Referee system messages, 2018 rule set. Generated from Tools/protocol/referee_2018.json by protogen.py, do not edit
+// Structs mirror the firmware ones. Fields are decoded one by one, so this does not rely on host struct layout.
+
+#pragma once
+
+#include "protocol_frame.hpp"
+
+namespace referee_2018 {
+
+constexpr uint8_t sof = 0xA5;
+
+enum cmdid_t : uint16_t {
+    CMD_GAME_ROBOT_INFO = 0x0001,
+    CMD_DAMAGE_DATA = 0x0002,
+    CMD_SHOOT_DATA = 0x0003,
+    CMD_POWER_HEAT_DATA = 0x0004,
+    CMD_RFID_DATA = 0x0005,
+    CMD_GAME_RESULT = 0x0006,
+    CMD_BUFF_DATA = 0x0007,
+    CMD_ROBOT_POSITION = 0x0008,
+    CMD_CUSTOM_DATA = 0x0100,
+};
+
+enum game_process_t {
+    GAME_NOT_START = 0,
+    GAME_PREP = 1,
+    GAME_INIT = 2,
+    GAME_5S_CNT = 3,
+    GAME_IN_GAME = 4,
+    GAME_RESULT = 5,
+};
+
+// CMD_GAME_ROBOT_INFO 0x0001, rx 10 Hz
+struct game_robot_info_t {
+    static constexpr uint16_t cmdid = 0x0001;
+    static constexpr uint16_t size = 8;
+    static constexpr protocol::direction_t direction = protocol::RX;
+    static constexpr uint16_t rate_hz = 10;
+
+    uint16_t stage_remain_time = 0;  // Remaining time in the current round (seconds)
+    uint8_t game_process = 0;  // Current stage [game_process_t]
+    uint8_t robot_grade = 0;  // Robot's current grade
+    uint16_t remain_hp = 0;  // Robot's current HP
+    uint16_t max_hp = 0;  // Robot's maximum HP
+
+    bool decode(const uint8_t* payload, size_t length) {
+        if (length != size)
+            return false;
+        stage_remain_time = protocol::get<uint16_t>(payload + 0);
+        game_process = protocol::get<uint8_t>(payload + 2);
+        robot_grade = protocol::get<uint8_t>(payload + 3);
+        remain_hp = protocol::get<uint16_t>(payload + 4);
+        max_hp = protocol::get<uint16_t>(payload + 6);
+        return true;
+    }
+
+    void encode(uint8_t* payload) const {
+        memset(payload, 0, size);
+        protocol::put<uint16_t>(payload + 0, stage_remain_time);
+        protocol::put<uint8_t>(payload + 2, game_process);
+        protocol::put<uint8_t>(payload + 3, robot_grade);
+        protocol::put<uint16_t>(payload + 4, remain_hp);
+        protocol::put<uint16_t>(payload + 6, max_hp);
+    }
+
+    template <typename Visitor>
+    void visit(Visitor&& visitor) const {
+        visitor("stage_remain_time", stage_remain_time);
+        visitor("game_process", game_process);
+        visitor("robot_grade", robot_grade);
+        visitor("remain_hp", remain_hp);
+        visitor("max_hp", max_hp);
+    }
+};
+
+enum armor_damage_t {
+    ARMOR_DAMAGE_FRONT = 0,
+    ARMOR_DAMAGE_LEFT = 1,
+    ARMOR_DAMAGE_REAR = 2,
+    ARMOR_DAMAGE_RIGHT = 3,
+    ARMOR_DAMAGE_TOP_1 = 4,
+    ARMOR_DAMAGE_TOP_2 = 5,
+};
+
+enum damage_type_t {
+    DAMAGE_ARMOR = 0,
+    DAMAGE_MOD_OFFLINE = 1,
+};
+
+// CMD_DAMAGE_DATA 0x0002, rx on event
+struct damage_data_t {
+    static constexpr uint16_t cmdid = 0x0002;
+    static constexpr uint16_t size = 1;
+    static constexpr protocol::direction_t direction = protocol::RX;
+    static constexpr uint16_t rate_hz = 0;
+
+    uint8_t armor_damage = 0;  // Indicate armor ID if damage type is armor damage [armor_damage_t]
+    uint8_t damage_type = 0;  // Type of damage [damage_type_t]
+
+    bool decode(const uint8_t* payload, size_t length) {
+        if (length != size)
+            return false;
+        armor_damage = protocol::get_bits<uint8_t>(payload + 0, 0, 4);
+        damage_type = protocol::get_bits<uint8_t>(payload + 0, 4, 4);
+        return true;
+    }
+
+    void encode(uint8_t* payload) const {
+        memset(payload, 0, size);
+        protocol::put_bits<uint8_t>(payload + 0, 0, 4, armor_damage);
+        protocol::put_bits<uint8_t>(payload + 0, 4, 4, damage_type);
+    }
+
+    template <typename Visitor>
+    void visit(Visitor&& visitor) const {
+        visitor("armor_damage", armor_damage);
+        visitor("damage_type", damage_type);
+    }
+};
+
+enum bullet_type_t {
+    BULLET_17MM = 1,
+    BULLET_42MM = 2,
+};
+
+// CMD_SHOOT_DATA 0x0003, rx on event
+struct shoot_data_t {
+    static constexpr uint16_t cmdid = 0x0003;
+    static constexpr uint16_t size = 6;
+    static constexpr protocol::direction_t direction = protocol::RX;
+    static constexpr uint16_t rate_hz = 0;
+
+    uint8_t bullet_type = 0;  // Projectile type [bullet_type_t]
+    uint8_t bullet_freq = 0;  // Projectile launching frequency (bullets per second)
+    float bullet_spd = 0;  // Projectile launching speed (meters per second)
+
+    bool decode(const uint8_t* payload, size_t length) {
+        if (length != size)
+            return false;
+        bullet_type = protocol::get<uint8_t>(payload + 0);
+        bullet_freq = protocol::get<uint8_t>(payload + 1);
+        bullet_spd = protocol::get<float>(payload + 2);
+        return true;
+    }
+
+    void encode(uint8_t* payload) const {
+        memset(payload, 0, size);
+        protocol::put<uint8_t>(payload + 0, bullet_type);
+        protocol::put<uint8_t>(payload + 1, bullet_freq);
+        protocol::put<float>(payload + 2, bullet_spd);
+    }
+
+    template <typename Visitor>
+    void visit(Visitor&& visitor) const {
+        visitor("bullet_type", bullet_type);
+        visitor("bullet_freq", bullet_freq);
+        visitor("bullet_spd", bullet_spd);
+    }
+};
+
+// CMD_POWER_HEAT_DATA 0x0004, rx 50 Hz
+struct power_heat_data_t {
+    static constexpr uint16_t cmdid = 0x0004;
+    static constexpr uint16_t size = 20;
+    static constexpr protocol::direction_t direction = protocol::RX;
+    static constexpr uint16_t rate_hz = 50;
+
+    float chassis_volt = 0;  // Chassis output voltage (volt)
+    float chassis_current = 0;  // Chassis output current (ampere)
+    float chassis_power = 0;  // Chassis output power (watt)
+    float chassis_pwr_buf = 0;  // Chassis power buffer (joule)
+    uint16_t barrel_heat_17 = 0;  // 17mm barrel heat
+    uint16_t barrel_heat_42 = 0;  // 42mm barrel heat
+
+    bool decode(const uint8_t* payload, size_t length) {
+        if (length != size)
+            return false;
+        chassis_volt = protocol::get<float>(payload + 0);
+        chassis_current = protocol::get<float>(payload + 4);
+        chassis_power = protocol::get<float>(payload + 8);
+        chassis_pwr_buf = protocol::get<float>(payload + 12);
+        barrel_heat_17 = protocol::get<uint16_t>(payload + 16);
+        barrel_heat_42 = protocol::get<uint16_t>(payload + 18);
+        return true;
+    }
+
+    void encode(uint8_t* payload) const {
+        memset(payload, 0, size);
+        protocol::put<float>(payload + 0, chassis_volt);
+        protocol::put<float>(payload + 4, chassis_current);
+        protocol::put<float>(payload + 8, chassis_power);
+        protocol::put<float>(payload + 12, chassis_pwr_buf);
+        protocol::put<uint16_t>(payload + 16, barrel_heat_17);
+        protocol::put<uint16_t>(payload + 18, barrel_heat_42);
+    }
+
+    template <typename Visitor>
+    void visit(Visitor&& visitor) const {
+        visitor("chassis_volt", chassis_volt);
+        visitor("chassis_current", chassis_current);
+        visitor("chassis_power", chassis_power);
+        visitor("chassis_pwr_buf", chassis_pwr_buf);
+        visitor("barrel_heat_17", barrel_heat_17);
+        visitor("barrel_heat_42", barrel_heat_42);
+    }
+};
+
+enum card_type_t {
+    CARD_ATTACK_BUFF = 0,
+    CARD_DEFENSE_BUFF = 1,
+    CARD_RED_HEAL = 2,
+    CARD_BLUE_HEAL = 3,
+    CARD_RED_CURE = 4,
+    CARD_BLUE_CURE = 5,
+    CARD_RED_COOL_DOWN = 6,
+    CARD_BLUE_COOL_DOWN = 7,
+    CARD_FORT = 8,
+    CARD_RESERVE = 9,
+    CARD_RESOURCE = 10,
+    CARD_ICRA = 11,
+};
+
+// CMD_RFID_DATA 0x0005, rx on event
+struct rfid_data_t {
+    static constexpr uint16_t cmdid = 0x0005;
+    static constexpr uint16_t size = 2;
+    static constexpr protocol::direction_t direction = protocol::RX;
+    static constexpr uint16_t rate_hz = 0;
+
+    uint8_t card_type = 0;  // Card type [card_type_t]
+    uint8_t card_idx = 0;  // Card index number; used to distinguish different sections
+
+    bool decode(const uint8_t* payload, size_t length) {
+        if (length != size)
+            return false;
+        card_type = protocol::get<uint8_t>(payload + 0);
+        card_idx = protocol::get<uint8_t>(payload + 1);
+        return true;
+    }
+
+    void encode(uint8_t* payload) const {
+        memset(payload, 0, size);
+        protocol::put<uint8_t>(payload + 0, card_type);
+        protocol::put<uint8_t>(payload + 1, card_idx);
+    }
+
+    template <typename Visitor>
+    void visit(Visitor&& visitor) const {
+        visitor("card_type", card_type);
+        visitor("card_idx", card_idx);
+    }
+};
+
+enum result_t {
+    RESULT_DRAW = 0,
+    RESULT_RED = 1,
+    RESULT_BLUE = 2,
+};
+
+// CMD_GAME_RESULT 0x0006, rx on event
+struct game_result_t {
+    static constexpr uint16_t cmdid = 0x0006;
+    static constexpr uint16_t size = 1;
+    static constexpr protocol::direction_t direction = protocol::RX;
+    static constexpr uint16_t rate_hz = 0;
+
+    uint8_t result = 0;  // Competition result [result_t]
+
+    bool decode(const uint8_t* payload, size_t length) {
+        if (length != size)
+            return false;
+        result = protocol::get<uint8_t>(payload + 0);
+        return true;
+    }
+
+    void encode(uint8_t* payload) const {
+        memset(payload, 0, size);
+        protocol::put<uint8_t>(payload + 0, result);
+    }
+
+    template <typename Visitor>
+    void visit(Visitor&& visitor) const {
+        visitor("result", result);
+    }
+};
+
+// CMD_BUFF_DATA 0x0007, rx on event
+struct buff_data_t {
+    static constexpr uint16_t cmdid = 0x0007;
+    static constexpr uint16_t size = 2;
+    static constexpr protocol::direction_t direction = protocol::RX;
+    static constexpr uint16_t rate_hz = 0;
+
+    uint16_t buff_heal = 0;  // 00 Heal by heal point
+    uint16_t buff_engineer = 0;  // 01 Heal by engineer robot
+    uint16_t buff_cure = 0;  // 02 Heal by cure card
+    uint16_t buff_res_defense = 0;  // 03 Defense buff by resource island
+    uint16_t buff_l_rune_friendly = 0;  // 04 Our team activated large rune
+    uint16_t buff_l_rune_enemy = 0;  // 05 Enemy team activated large rune
+    uint16_t buff_s_rune_friendly = 0;  // 06 Our team activated small rune
+    uint16_t buff_s_rune_enemy = 0;  // 07 Enemy team activated small rune
+    uint16_t buff_cool_down = 0;  // 08 Cool down accelerated
+    uint16_t buff_fort_defense = 0;  // 09 Defense buff by fort
+    uint16_t buff_full_defense = 0;  // 10 100% Defense
+    uint16_t buff_base_defense_off = 0;  // 11 Base defense without sentry
+    uint16_t buff_base_defense_on = 0;  // 12 Base defense with sentry
+    uint16_t buff_reserve = 0;  // 13:15 Reserved
+
+    bool decode(const uint8_t* payload, size_t length) {
+        if (length != size)
+            return false;
+        buff_heal = protocol::get_bits<uint16_t>(payload + 0, 0, 1);
+        buff_engineer = protocol::get_bits<uint16_t>(payload + 0, 1, 1);
+        buff_cure = protocol::get_bits<uint16_t>(payload + 0, 2, 1);
+        buff_res_defense = protocol::get_bits<uint16_t>(payload + 0, 3, 1);
+        buff_l_rune_friendly = protocol::get_bits<uint16_t>(payload + 0, 4, 1);
+        buff_l_rune_enemy = protocol::get_bits<uint16_t>(payload + 0, 5, 1);
+        buff_s_rune_friendly = protocol::get_bits<uint16_t>(payload + 0, 6, 1);
+        buff_s_rune_enemy = protocol::get_bits<uint16_t>(payload + 0, 7, 1);
+        buff_cool_down = protocol::get_bits<uint16_t>(payload + 0, 8, 1);
+        buff_fort_defense = protocol::get_bits<uint16_t>(payload + 0, 9, 1);
+        buff_full_defense = protocol::get_bits<uint16_t>(payload + 0, 10, 1);
+        buff_base_defense_off = protocol::get_bits<uint16_t>(payload + 0, 11, 1);
+        buff_base_defense_on = protocol::get_bits<uint16_t>(payload + 0, 12, 1);
+        buff_reserve = protocol::get_bits<uint16_t>(payload + 0, 13, 3);
+        return true;
+    }
+
+    void encode(uint8_t* payload) const {
+        memset(payload, 0, size);
+        protocol::put_bits<uint16_t>(payload + 0, 0, 1, buff_heal);
+        protocol::put_bits<uint16_t>(payload + 0, 1, 1, buff_engineer);
+        protocol::put_bits<uint16_t>(payload + 0, 2, 1, buff_cure);
+        protocol::put_bits<uint16_t>(payload + 0, 3, 1, buff_res_defense);
+        protocol::put_bits<uint16_t>(payload + 0, 4, 1, buff_l_rune_friendly);
+        protocol::put_bits<uint16_t>(payload + 0, 5, 1, buff_l_rune_enemy);
+        protocol::put_bits<uint16_t>(payload + 0, 6, 1, buff_s_rune_friendly);
+        protocol::put_bits<uint16_t>(payload + 0, 7, 1, buff_s_rune_enemy);
+        protocol::put_bits<uint16_t>(payload + 0, 8, 1, buff_cool_down);
+        protocol::put_bits<uint16_t>(payload + 0, 9, 1, buff_fort_defense);
+        protocol::put_bits<uint16_t>(payload + 0, 10, 1, buff_full_defense);
+        protocol::put_bits<uint16_t>(payload + 0, 11, 1, buff_base_defense_off);
+        protocol::put_bits<uint16_t>(payload + 0, 12, 1, buff_base_defense_on);
+        protocol::put_bits<uint16_t>(payload + 0, 13, 3, buff_reserve);
+    }
+
+    template <typename Visitor>
+    void visit(Visitor&& visitor) const {
+        visitor("buff_heal", buff_heal);
+        visitor("buff_engineer", buff_engineer);
+        visitor("buff_cure", buff_cure);
+        visitor("buff_res_defense", buff_res_defense);
+        visitor("buff_l_rune_friendly", buff_l_rune_friendly);
+        visitor("buff_l_rune_enemy", buff_l_rune_enemy);
+        visitor("buff_s_rune_friendly", buff_s_rune_friendly);
+        visitor("buff_s_rune_enemy", buff_s_rune_enemy);
+        visitor("buff_cool_down", buff_cool_down);
+        visitor("buff_fort_defense", buff_fort_defense);
+        visitor("buff_full_defense", buff_full_defense);
+        visitor("buff_base_defense_off", buff_base_defense_off);
+        visitor("buff_base_defense_on", buff_base_defense_on);
+        visitor("buff_reserve", buff_reserve);
+    }
+};
+
+// CMD_ROBOT_POSITION 0x0008, rx 50 Hz
+struct robot_position_t {
+    static constexpr uint16_t cmdid = 0x0008;
+    static constexpr uint16_t size = 16;
+    static constexpr protocol::direction_t direction = protocol::RX;
+    static constexpr uint16_t rate_hz = 50;
+
+    float position_x = 0;  // Position X (meter)
+    float position_y = 0;  // Position Y (meter)
+    float position_z = 0;  // Position Z (meter)
+    float barrel_yaw = 0;  // Barrel Yaw (degree)
+
+    bool decode(const uint8_t* payload, size_t length) {
+        if (length != size)
+            return false;
+        position_x = protocol::get<float>(payload + 0);
+        position_y = protocol::get<float>(payload + 4);
+        position_z = protocol::get<float>(payload + 8);
+        barrel_yaw = protocol::get<float>(payload + 12);
+        return true;
+    }
+
+    void encode(uint8_t* payload) const {
+        memset(payload, 0, size);
+        protocol::put<float>(payload + 0, position_x);
+        protocol::put<float>(payload + 4, position_y);
+        protocol::put<float>(payload + 8, position_z);
+        protocol::put<float>(payload + 12, barrel_yaw);
+    }
+
+    template <typename Visitor>
+    void visit(Visitor&& visitor) const {
+        visitor("position_x", position_x);
+        visitor("position_y", position_y);
+        visitor("position_z", position_z);
+        visitor("barrel_yaw", barrel_yaw);
+    }
+};
+
+// CMD_CUSTOM_DATA 0x0100, tx 10 Hz
+struct custom_data_t {
+    static constexpr uint16_t cmdid = 0x0100;
+    static constexpr uint16_t size = 13;
+    static constexpr protocol::direction_t direction = protocol::TX;
+    static constexpr uint16_t rate_hz = 10;
+
+    float data1 = 0;  // Custom data 1
+    float data2 = 0;  // Custom data 2
+    float data3 = 0;  // Custom data 3
+    uint8_t data4 = 0;  // Custom data 4
+
+    bool decode(const uint8_t* payload, size_t length) {
+        if (length != size)
+            return false;
+        data1 = protocol::get<float>(payload + 0);
+        data2 = protocol::get<float>(payload + 4);
+        data3 = protocol::get<float>(payload + 8);
+        data4 = protocol::get<uint8_t>(payload + 12);
+        return true;
+    }
+
+    void encode(uint8_t* payload) const {
+        memset(payload, 0, size);
+        protocol::put<float>(payload + 0, data1);
+        protocol::put<float>(payload + 4, data2);
+        protocol::put<float>(payload + 8, data3);
+        protocol::put<uint8_t>(payload + 12, data4);
+    }
+
+    template <typename Visitor>
+    void visit(Visitor&& visitor) const {
+        visitor("data1", data1);
+        visitor("data2", data2);
+        visitor("data3", data3);
+        visitor("data4", data4);
+    }
+};
+
+// Call f(msg) with a default constructed instance of every message
+template <typename F>
+void for_each_message(F&& f) {
+    f(game_robot_info_t());
+    f(damage_data_t());
+    f(shoot_data_t());
+    f(power_heat_data_t());
+    f(rfid_data_t());
+    f(game_result_t());
+    f(buff_data_t());
+    f(robot_position_t());
+    f(custom_data_t());
+}
+
+// Decode data with the firmware struct and with the codec, return the number of fields that differ.
+// Defined in referee_2018_layout.cpp, which builds against the firmware headers
+int layout_check(const uint8_t* data);
+
+// Decode a frame payload and pass the message to handler(msg). False for unknown cmdids and bad sizes
+template <typename Handler>
+bool dispatch(uint16_t cmdid, const uint8_t* data, size_t length, Handler&& handler) {
+    switch (cmdid) {
+        case CMD_GAME_ROBOT_INFO: {
+            game_robot_info_t msg;
+            if (!msg.decode(data, length))
+                return false;
+            handler(msg);
+            return true;
+        }
+        case CMD_DAMAGE_DATA: {
+            damage_data_t msg;
+            if (!msg.decode(data, length))
+                return false;
+            handler(msg);
+            return true;
+        }
+        case CMD_SHOOT_DATA: {
+            shoot_data_t msg;
+            if (!msg.decode(data, length))
+                return false;
+            handler(msg);
+            return true;
+        }
+        case CMD_POWER_HEAT_DATA: {
+            power_heat_data_t msg;
+            if (!msg.decode(data, length))
+                return false;
+            handler(msg);
+            return true;
+        }
+        case CMD_RFID_DATA: {
+            rfid_data_t msg;
+            if (!msg.decode(data, length))
+                return false;
+            handler(msg);
+            return true;
+        }
+        case CMD_GAME_RESULT: {
+            game_result_t msg;
+            if (!msg.decode(data, length))
+                return false;
+            handler(msg);
+            return true;
+        }
+        case CMD_BUFF_DATA: {
+            buff_data_t msg;
+            if (!msg.decode(data, length))
+                return false;
+            handler(msg);
+            return true;
+        }
+        case CMD_ROBOT_POSITION: {
+            robot_position_t msg;
+            if (!msg.decode(data, length))
+                return false;
+            handler(msg);
+            return true;
+        }
+        case CMD_CUSTOM_DATA: {
+            custom_data_t msg;
+            if (!msg.decode(data, length))
+                return false;
+            handler(msg);
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+}  // namespace referee_2018
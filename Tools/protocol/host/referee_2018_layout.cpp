@@ -0,0 +1,195 @@
+// Firmware struct layout check. Generated from Tools/protocol/referee_2018.json by protogen.py, do not edit
+
+#include "referee_2018_codec.hpp"
+
+extern "C" {
+#include "referee_2018_protocol.h"
+}
+
+namespace referee_2018 {
+
+int layout_check(const uint8_t* data) {
+    int mismatch = 0;
+    {
+        ::game_robot_info_t firmware;
+        referee_2018::game_robot_info_t host;
+        static_assert(sizeof(firmware) == referee_2018::game_robot_info_t::size, "game_robot_info_t size");
+        memcpy(&firmware, data, sizeof(firmware));
+        host.decode(data, sizeof(firmware));
+        {
+            uint16_t value = firmware.stage_remain_time;
+            mismatch += memcmp(&value, &host.stage_remain_time, sizeof(value)) != 0;
+        }
+        {
+            uint8_t value = firmware.game_process;
+            mismatch += memcmp(&value, &host.game_process, sizeof(value)) != 0;
+        }
+        {
+            uint8_t value = firmware.robot_grade;
+            mismatch += memcmp(&value, &host.robot_grade, sizeof(value)) != 0;
+        }
+        {
+            uint16_t value = firmware.remain_hp;
+            mismatch += memcmp(&value, &host.remain_hp, sizeof(value)) != 0;
+        }
+        {
+            uint16_t value = firmware.max_hp;
+            mismatch += memcmp(&value, &host.max_hp, sizeof(value)) != 0;
+        }
+    }
+    {
+        ::damage_data_t firmware;
+        referee_2018::damage_data_t host;
+        static_assert(sizeof(firmware) == referee_2018::damage_data_t::size, "damage_data_t size");
+        memcpy(&firmware, data, sizeof(firmware));
+        host.decode(data, sizeof(firmware));
+        mismatch += firmware.armor_damage != host.armor_damage;
+        mismatch += firmware.damage_type != host.damage_type;
+    }
+    {
+        ::shoot_data_t firmware;
+        referee_2018::shoot_data_t host;
+        static_assert(sizeof(firmware) == referee_2018::shoot_data_t::size, "shoot_data_t size");
+        memcpy(&firmware, data, sizeof(firmware));
+        host.decode(data, sizeof(firmware));
+        {
+            uint8_t value = firmware.bullet_type;
+            mismatch += memcmp(&value, &host.bullet_type, sizeof(value)) != 0;
+        }
+        {
+            uint8_t value = firmware.bullet_freq;
+            mismatch += memcmp(&value, &host.bullet_freq, sizeof(value)) != 0;
+        }
+        {
+            float value = firmware.bullet_spd;
+            mismatch += memcmp(&value, &host.bullet_spd, sizeof(value)) != 0;
+        }
+    }
+    {
+        ::power_heat_data_t firmware;
+        referee_2018::power_heat_data_t host;
+        static_assert(sizeof(firmware) == referee_2018::power_heat_data_t::size, "power_heat_data_t size");
+        memcpy(&firmware, data, sizeof(firmware));
+        host.decode(data, sizeof(firmware));
+        {
+            float value = firmware.chassis_volt;
+            mismatch += memcmp(&value, &host.chassis_volt, sizeof(value)) != 0;
+        }
+        {
+            float value = firmware.chassis_current;
+            mismatch += memcmp(&value, &host.chassis_current, sizeof(value)) != 0;
+        }
+        {
+            float value = firmware.chassis_power;
+            mismatch += memcmp(&value, &host.chassis_power, sizeof(value)) != 0;
+        }
+        {
+            float value = firmware.chassis_pwr_buf;
+            mismatch += memcmp(&value, &host.chassis_pwr_buf, sizeof(value)) != 0;
+        }
+        {
+            uint16_t value = firmware.barrel_heat_17;
+            mismatch += memcmp(&value, &host.barrel_heat_17, sizeof(value)) != 0;
+        }
+        {
+            uint16_t value = firmware.barrel_heat_42;
+            mismatch += memcmp(&value, &host.barrel_heat_42, sizeof(value)) != 0;
+        }
+    }
+    {
+        ::rfid_data_t firmware;
+        referee_2018::rfid_data_t host;
+        static_assert(sizeof(firmware) == referee_2018::rfid_data_t::size, "rfid_data_t size");
+        memcpy(&firmware, data, sizeof(firmware));
+        host.decode(data, sizeof(firmware));
+        {
+            uint8_t value = firmware.card_type;
+            mismatch += memcmp(&value, &host.card_type, sizeof(value)) != 0;
+        }
+        {
+            uint8_t value = firmware.card_idx;
+            mismatch += memcmp(&value, &host.card_idx, sizeof(value)) != 0;
+        }
+    }
+    {
+        ::game_result_t firmware;
+        referee_2018::game_result_t host;
+        static_assert(sizeof(firmware) == referee_2018::game_result_t::size, "game_result_t size");
+        memcpy(&firmware, data, sizeof(firmware));
+        host.decode(data, sizeof(firmware));
+        {
+            uint8_t value = firmware.result;
+            mismatch += memcmp(&value, &host.result, sizeof(value)) != 0;
+        }
+    }
+    {
+        ::buff_data_t firmware;
+        referee_2018::buff_data_t host;
+        static_assert(sizeof(firmware) == referee_2018::buff_data_t::size, "buff_data_t size");
+        memcpy(&firmware, data, sizeof(firmware));
+        host.decode(data, sizeof(firmware));
+        mismatch += firmware.buff_heal != host.buff_heal;
+        mismatch += firmware.buff_engineer != host.buff_engineer;
+        mismatch += firmware.buff_cure != host.buff_cure;
+        mismatch += firmware.buff_res_defense != host.buff_res_defense;
+        mismatch += firmware.buff_l_rune_friendly != host.buff_l_rune_friendly;
+        mismatch += firmware.buff_l_rune_enemy != host.buff_l_rune_enemy;
+        mismatch += firmware.buff_s_rune_friendly != host.buff_s_rune_friendly;
+        mismatch += firmware.buff_s_rune_enemy != host.buff_s_rune_enemy;
+        mismatch += firmware.buff_cool_down != host.buff_cool_down;
+        mismatch += firmware.buff_fort_defense != host.buff_fort_defense;
+        mismatch += firmware.buff_full_defense != host.buff_full_defense;
+        mismatch += firmware.buff_base_defense_off != host.buff_base_defense_off;
+        mismatch += firmware.buff_base_defense_on != host.buff_base_defense_on;
+        mismatch += firmware.buff_reserve != host.buff_reserve;
+    }
+    {
+        ::robot_position_t firmware;
+        referee_2018::robot_position_t host;
+        static_assert(sizeof(firmware) == referee_2018::robot_position_t::size, "robot_position_t size");
+        memcpy(&firmware, data, sizeof(firmware));
+        host.decode(data, sizeof(firmware));
+        {
+            float value = firmware.position_x;
+            mismatch += memcmp(&value, &host.position_x, sizeof(value)) != 0;
+        }
+        {
+            float value = firmware.position_y;
+            mismatch += memcmp(&value, &host.position_y, sizeof(value)) != 0;
+        }
+        {
+            float value = firmware.position_z;
+            mismatch += memcmp(&value, &host.position_z, sizeof(value)) != 0;
+        }
+        {
+            float value = firmware.barrel_yaw;
+            mismatch += memcmp(&value, &host.barrel_yaw, sizeof(value)) != 0;
+        }
+    }
+    {
+        ::custom_data_t firmware;
+        referee_2018::custom_data_t host;
+        static_assert(sizeof(firmware) == referee_2018::custom_data_t::size, "custom_data_t size");
+        memcpy(&firmware, data, sizeof(firmware));
+        host.decode(data, sizeof(firmware));
+        {
+            float value = firmware.data1;
+            mismatch += memcmp(&value, &host.data1, sizeof(value)) != 0;
+        }
+        {
+            float value = firmware.data2;
+            mismatch += memcmp(&value, &host.data2, sizeof(value)) != 0;
+        }
+        {
+            float value = firmware.data3;
+            mismatch += memcmp(&value, &host.data3, sizeof(value)) != 0;
+        }
+        {
+            uint8_t value = firmware.data4;
+            mismatch += memcmp(&value, &host.data4, sizeof(value)) != 0;
+        }
+    }
+    return mismatch;
+}
+
+}  // namespace referee_2018
@@ -0,0 +1,743 @@
+// Referee system messages, 2019 rule set. Generated from Tools/protocol/referee_2019.json by protogen.py, do not edit
+// Structs mirror the firmware ones. Fields are decoded one by one, so this does not rely on host struct layout.
+
+#pragma once
+
+#include "protocol_frame.hpp"
+
+namespace referee_2019 {
+
+constexpr uint8_t sof = 0xA5;
+
+enum cmdid_t : uint16_t {
+    CMD_GAME_STATE = 0x0001,
+    CMD_GAME_RESULT = 0x0002,
+    CMD_GAME_ROBOT_SURVIVORS = 0x0003,
+    CMD_EVENT_DATA = 0x0101,
+    CMD_SUPPLY_PROJECTILE_ACTION = 0x0102,
+    CMD_SUPPLY_PROJECTILE_BOOKING = 0x0103,
+    CMD_GAME_ROBOT_STATE = 0x0201,
+    CMD_POWER_HEAT_DATA = 0x0202,
+    CMD_GAME_ROBOT_POS = 0x0203,
+    CMD_BUFF_MUSK = 0x0204,
+    CMD_AERIAL_ROBOT_ENERGY = 0x0205,
+    CMD_ROBOT_HURT = 0x0206,
+    CMD_SHOOT_DATA = 0x0207,
+    CMD_STUDENT_INTERACTIVE = 0x0301,
+};
+
+enum game_type_t {
+    GAME_TYPE_RMUC = 1,
+    GAME_TYPE_SINGLE = 2,
+    GAME_TYPE_ICRA = 3,
+};
+
+enum game_process_t {
+    GAME_NOT_START = 0,
+    GAME_PREP = 1,
+    GAME_INIT = 2,
+    GAME_5S_CNT = 3,
+    GAME_IN_GAME = 4,
+    GAME_RESULT = 5,
+};
+
+// CMD_GAME_STATE 0x0001, rx 1 Hz
+struct game_state_t {
+    static constexpr uint16_t cmdid = 0x0001;
+    static constexpr uint16_t size = 3;
+    static constexpr protocol::direction_t direction = protocol::RX;
+    static constexpr uint16_t rate_hz = 1;
+
+    uint8_t game_type = 0;  // Competition type [game_type_t]
+    uint8_t game_progress = 0;  // Current stage [game_process_t]
+    uint16_t stage_remain_time = 0;  // Remaining time in the current stage (seconds)
+
+    bool decode(const uint8_t* payload, size_t length) {
+        if (length != size)
+            return false;
+        game_type = protocol::get_bits<uint8_t>(payload + 0, 0, 4);
+        game_progress = protocol::get_bits<uint8_t>(payload + 0, 4, 4);
+        stage_remain_time = protocol::get<uint16_t>(payload + 1);
+        return true;
+    }
+
+    void encode(uint8_t* payload) const {
+        memset(payload, 0, size);
+        protocol::put_bits<uint8_t>(payload + 0, 0, 4, game_type);
+        protocol::put_bits<uint8_t>(payload + 0, 4, 4, game_progress);
+        protocol::put<uint16_t>(payload + 1, stage_remain_time);
+    }
+
+    template <typename Visitor>
+    void visit(Visitor&& visitor) const {
+        visitor("game_type", game_type);
+        visitor("game_progress", game_progress);
+        visitor("stage_remain_time", stage_remain_time);
+    }
+};
+
+enum result_t {
+    RESULT_DRAW = 0,
+    RESULT_RED = 1,
+    RESULT_BLUE = 2,
+};
+
+// CMD_GAME_RESULT 0x0002, rx on event
+struct game_result_t {
+    static constexpr uint16_t cmdid = 0x0002;
+    static constexpr uint16_t size = 1;
+    static constexpr protocol::direction_t direction = protocol::RX;
+    static constexpr uint16_t rate_hz = 0;
+
+    uint8_t winner = 0;  // Competition result [result_t]
+
+    bool decode(const uint8_t* payload, size_t length) {
+        if (length != size)
+            return false;
+        winner = protocol::get<uint8_t>(payload + 0);
+        return true;
+    }
+
+    void encode(uint8_t* payload) const {
+        memset(payload, 0, size);
+        protocol::put<uint8_t>(payload + 0, winner);
+    }
+
+    template <typename Visitor>
+    void visit(Visitor&& visitor) const {
+        visitor("winner", winner);
+    }
+};
+
+// CMD_GAME_ROBOT_SURVIVORS 0x0003, rx 1 Hz
+struct game_robot_survivors_t {
+    static constexpr uint16_t cmdid = 0x0003;
+    static constexpr uint16_t size = 2;
+    static constexpr protocol::direction_t direction = protocol::RX;
+    static constexpr uint16_t rate_hz = 1;
+
+    uint16_t robot_legion = 0;  // One bit per robot, set while it survives. Red 1-7 in bits 0-6, blue in bits 8-14
+
+    bool decode(const uint8_t* payload, size_t length) {
+        if (length != size)
+            return false;
+        robot_legion = protocol::get<uint16_t>(payload + 0);
+        return true;
+    }
+
+    void encode(uint8_t* payload) const {
+        memset(payload, 0, size);
+        protocol::put<uint16_t>(payload + 0, robot_legion);
+    }
+
+    template <typename Visitor>
+    void visit(Visitor&& visitor) const {
+        visitor("robot_legion", robot_legion);
+    }
+};
+
+// CMD_EVENT_DATA 0x0101, rx on event
+struct event_data_t {
+    static constexpr uint16_t cmdid = 0x0101;
+    static constexpr uint16_t size = 4;
+    static constexpr protocol::direction_t direction = protocol::RX;
+    static constexpr uint16_t rate_hz = 0;
+
+    uint32_t event_type = 0;  // Field events of our side, see the rule manual for the bits
+
+    bool decode(const uint8_t* payload, size_t length) {
+        if (length != size)
+            return false;
+        event_type = protocol::get<uint32_t>(payload + 0);
+        return true;
+    }
+
+    void encode(uint8_t* payload) const {
+        memset(payload, 0, size);
+        protocol::put<uint32_t>(payload + 0, event_type);
+    }
+
+    template <typename Visitor>
+    void visit(Visitor&& visitor) const {
+        visitor("event_type", event_type);
+    }
+};
+
+enum supply_step_t {
+    SUPPLY_CLOSED = 0,
+    SUPPLY_PREPARING = 1,
+    SUPPLY_DROPPING = 2,
+};
+
+// CMD_SUPPLY_PROJECTILE_ACTION 0x0102, rx on event
+struct supply_projectile_action_t {
+    static constexpr uint16_t cmdid = 0x0102;
+    static constexpr uint16_t size = 4;
+    static constexpr protocol::direction_t direction = protocol::RX;
+    static constexpr uint16_t rate_hz = 0;
+
+    uint8_t supply_projectile_id = 0;  // Supply outlet
+    uint8_t supply_robot_id = 0;  // Robot being supplied, 0 if none [robot_id_t]
+    uint8_t supply_projectile_step = 0;  // Outlet state [supply_step_t]
+    uint8_t supply_projectile_num = 0;  // Projectiles supplied
+
+    bool decode(const uint8_t* payload, size_t length) {
+        if (length != size)
+            return false;
+        supply_projectile_id = protocol::get<uint8_t>(payload + 0);
+        supply_robot_id = protocol::get<uint8_t>(payload + 1);
+        supply_projectile_step = protocol::get<uint8_t>(payload + 2);
+        supply_projectile_num = protocol::get<uint8_t>(payload + 3);
+        return true;
+    }
+
+    void encode(uint8_t* payload) const {
+        memset(payload, 0, size);
+        protocol::put<uint8_t>(payload + 0, supply_projectile_id);
+        protocol::put<uint8_t>(payload + 1, supply_robot_id);
+        protocol::put<uint8_t>(payload + 2, supply_projectile_step);
+        protocol::put<uint8_t>(payload + 3, supply_projectile_num);
+    }
+
+    template <typename Visitor>
+    void visit(Visitor&& visitor) const {
+        visitor("supply_projectile_id", supply_projectile_id);
+        visitor("supply_robot_id", supply_robot_id);
+        visitor("supply_projectile_step", supply_projectile_step);
+        visitor("supply_projectile_num", supply_projectile_num);
+    }
+};
+
+// CMD_SUPPLY_PROJECTILE_BOOKING 0x0103, tx 10 Hz
+struct supply_projectile_booking_t {
+    static constexpr uint16_t cmdid = 0x0103;
+    static constexpr uint16_t size = 3;
+    static constexpr protocol::direction_t direction = protocol::TX;
+    static constexpr uint16_t rate_hz = 10;
+
+    uint8_t supply_projectile_id = 0;  // Supply outlet, 0 for the first free one
+    uint8_t supply_robot_id = 0;  // Robot to supply [robot_id_t]
+    uint8_t supply_num = 0;  // Projectiles requested, multiples of 50
+
+    bool decode(const uint8_t* payload, size_t length) {
+        if (length != size)
+            return false;
+        supply_projectile_id = protocol::get<uint8_t>(payload + 0);
+        supply_robot_id = protocol::get<uint8_t>(payload + 1);
+        supply_num = protocol::get<uint8_t>(payload + 2);
+        return true;
+    }
+
+    void encode(uint8_t* payload) const {
+        memset(payload, 0, size);
+        protocol::put<uint8_t>(payload + 0, supply_projectile_id);
+        protocol::put<uint8_t>(payload + 1, supply_robot_id);
+        protocol::put<uint8_t>(payload + 2, supply_num);
+    }
+
+    template <typename Visitor>
+    void visit(Visitor&& visitor) const {
+        visitor("supply_projectile_id", supply_projectile_id);
+        visitor("supply_robot_id", supply_robot_id);
+        visitor("supply_num", supply_num);
+    }
+};
+
+enum robot_id_t {
+    ROBOT_RED_HERO = 1,
+    ROBOT_RED_ENGINEER = 2,
+    ROBOT_RED_INFANTRY_1 = 3,
+    ROBOT_RED_INFANTRY_2 = 4,
+    ROBOT_RED_INFANTRY_3 = 5,
+    ROBOT_RED_AERIAL = 6,
+    ROBOT_RED_SENTRY = 7,
+    ROBOT_BLUE_HERO = 11,
+    ROBOT_BLUE_ENGINEER = 12,
+    ROBOT_BLUE_INFANTRY_1 = 13,
+    ROBOT_BLUE_INFANTRY_2 = 14,
+    ROBOT_BLUE_INFANTRY_3 = 15,
+    ROBOT_BLUE_AERIAL = 16,
+    ROBOT_BLUE_SENTRY = 17,
+};
+
+// CMD_GAME_ROBOT_STATE 0x0201, rx 10 Hz
+struct game_robot_state_t {
+    static constexpr uint16_t cmdid = 0x0201;
+    static constexpr uint16_t size = 15;
+    static constexpr protocol::direction_t direction = protocol::RX;
+    static constexpr uint16_t rate_hz = 10;
+
+    uint8_t robot_id = 0;  // This robot [robot_id_t]
+    uint8_t robot_level = 0;  // Robot's current level
+    uint16_t remain_hp = 0;  // Robot's current HP
+    uint16_t max_hp = 0;  // Robot's maximum HP
+    uint16_t shooter_heat0_cooling_rate = 0;  // 17mm barrel cooling per second
+    uint16_t shooter_heat0_cooling_limit = 0;  // 17mm barrel heat limit
+    uint16_t shooter_heat1_cooling_rate = 0;  // 42mm barrel cooling per second
+    uint16_t shooter_heat1_cooling_limit = 0;  // 42mm barrel heat limit
+    uint8_t mains_power_gimbal_output = 0;  // Gimbal supply on
+    uint8_t mains_power_chassis_output = 0;  // Chassis supply on
+    uint8_t mains_power_shooter_output = 0;  // Shooter supply on
+    uint8_t mains_power_reserve = 0;  // Reserved
+
+    bool decode(const uint8_t* payload, size_t length) {
+        if (length != size)
+            return false;
+        robot_id = protocol::get<uint8_t>(payload + 0);
+        robot_level = protocol::get<uint8_t>(payload + 1);
+        remain_hp = protocol::get<uint16_t>(payload + 2);
+        max_hp = protocol::get<uint16_t>(payload + 4);
+        shooter_heat0_cooling_rate = protocol::get<uint16_t>(payload + 6);
+        shooter_heat0_cooling_limit = protocol::get<uint16_t>(payload + 8);
+        shooter_heat1_cooling_rate = protocol::get<uint16_t>(payload + 10);
+        shooter_heat1_cooling_limit = protocol::get<uint16_t>(payload + 12);
+        mains_power_gimbal_output = protocol::get_bits<uint8_t>(payload + 14, 0, 1);
+        mains_power_chassis_output = protocol::get_bits<uint8_t>(payload + 14, 1, 1);
+        mains_power_shooter_output = protocol::get_bits<uint8_t>(payload + 14, 2, 1);
+        mains_power_reserve = protocol::get_bits<uint8_t>(payload + 14, 3, 5);
+        return true;
+    }
+
+    void encode(uint8_t* payload) const {
+        memset(payload, 0, size);
+        protocol::put<uint8_t>(payload + 0, robot_id);
+        protocol::put<uint8_t>(payload + 1, robot_level);
+        protocol::put<uint16_t>(payload + 2, remain_hp);
+        protocol::put<uint16_t>(payload + 4, max_hp);
+        protocol::put<uint16_t>(payload + 6, shooter_heat0_cooling_rate);
+        protocol::put<uint16_t>(payload + 8, shooter_heat0_cooling_limit);
+        protocol::put<uint16_t>(payload + 10, shooter_heat1_cooling_rate);
+        protocol::put<uint16_t>(payload + 12, shooter_heat1_cooling_limit);
+        protocol::put_bits<uint8_t>(payload + 14, 0, 1, mains_power_gimbal_output);
+        protocol::put_bits<uint8_t>(payload + 14, 1, 1, mains_power_chassis_output);
+        protocol::put_bits<uint8_t>(payload + 14, 2, 1, mains_power_shooter_output);
+        protocol::put_bits<uint8_t>(payload + 14, 3, 5, mains_power_reserve);
+    }
+
+    template <typename Visitor>
+    void visit(Visitor&& visitor) const {
+        visitor("robot_id", robot_id);
+        visitor("robot_level", robot_level);
+        visitor("remain_hp", remain_hp);
+        visitor("max_hp", max_hp);
+        visitor("shooter_heat0_cooling_rate", shooter_heat0_cooling_rate);
+        visitor("shooter_heat0_cooling_limit", shooter_heat0_cooling_limit);
+        visitor("shooter_heat1_cooling_rate", shooter_heat1_cooling_rate);
+        visitor("shooter_heat1_cooling_limit", shooter_heat1_cooling_limit);
+        visitor("mains_power_gimbal_output", mains_power_gimbal_output);
+        visitor("mains_power_chassis_output", mains_power_chassis_output);
+        visitor("mains_power_shooter_output", mains_power_shooter_output);
+        visitor("mains_power_reserve", mains_power_reserve);
+    }
+};
+
+// CMD_POWER_HEAT_DATA 0x0202, rx 50 Hz
+struct power_heat_data_t {
+    static constexpr uint16_t cmdid = 0x0202;
+    static constexpr uint16_t size = 14;
+    static constexpr protocol::direction_t direction = protocol::RX;
+    static constexpr uint16_t rate_hz = 50;
+
+    uint16_t chassis_volt = 0;  // Chassis output voltage (millivolt)
+    uint16_t chassis_current = 0;  // Chassis output current (milliampere)
+    float chassis_power = 0;  // Chassis output power (watt)
+    uint16_t chassis_power_buffer = 0;  // Chassis power buffer (joule)
+    uint16_t shooter_heat0 = 0;  // 17mm barrel heat
+    uint16_t shooter_heat1 = 0;  // 42mm barrel heat
+
+    bool decode(const uint8_t* payload, size_t length) {
+        if (length != size)
+            return false;
+        chassis_volt = protocol::get<uint16_t>(payload + 0);
+        chassis_current = protocol::get<uint16_t>(payload + 2);
+        chassis_power = protocol::get<float>(payload + 4);
+        chassis_power_buffer = protocol::get<uint16_t>(payload + 8);
+        shooter_heat0 = protocol::get<uint16_t>(payload + 10);
+        shooter_heat1 = protocol::get<uint16_t>(payload + 12);
+        return true;
+    }
+
+    void encode(uint8_t* payload) const {
+        memset(payload, 0, size);
+        protocol::put<uint16_t>(payload + 0, chassis_volt);
+        protocol::put<uint16_t>(payload + 2, chassis_current);
+        protocol::put<float>(payload + 4, chassis_power);
+        protocol::put<uint16_t>(payload + 8, chassis_power_buffer);
+        protocol::put<uint16_t>(payload + 10, shooter_heat0);
+        protocol::put<uint16_t>(payload + 12, shooter_heat1);
+    }
+
+    template <typename Visitor>
+    void visit(Visitor&& visitor) const {
+        visitor("chassis_volt", chassis_volt);
+        visitor("chassis_current", chassis_current);
+        visitor("chassis_power", chassis_power);
+        visitor("chassis_power_buffer", chassis_power_buffer);
+        visitor("shooter_heat0", shooter_heat0);
+        visitor("shooter_heat1", shooter_heat1);
+    }
+};
+
+// CMD_GAME_ROBOT_POS 0x0203, rx 10 Hz
+struct game_robot_pos_t {
+    static constexpr uint16_t cmdid = 0x0203;
+    static constexpr uint16_t size = 16;
+    static constexpr protocol::direction_t direction = protocol::RX;
+    static constexpr uint16_t rate_hz = 10;
+
+    float x = 0;  // Position X (meter)
+    float y = 0;  // Position Y (meter)
+    float z = 0;  // Position Z (meter)
+    float yaw = 0;  // Barrel Yaw (degree)
+
+    bool decode(const uint8_t* payload, size_t length) {
+        if (length != size)
+            return false;
+        x = protocol::get<float>(payload + 0);
+        y = protocol::get<float>(payload + 4);
+        z = protocol::get<float>(payload + 8);
+        yaw = protocol::get<float>(payload + 12);
+        return true;
+    }
+
+    void encode(uint8_t* payload) const {
+        memset(payload, 0, size);
+        protocol::put<float>(payload + 0, x);
+        protocol::put<float>(payload + 4, y);
+        protocol::put<float>(payload + 8, z);
+        protocol::put<float>(payload + 12, yaw);
+    }
+
+    template <typename Visitor>
+    void visit(Visitor&& visitor) const {
+        visitor("x", x);
+        visitor("y", y);
+        visitor("z", z);
+        visitor("yaw", yaw);
+    }
+};
+
+// CMD_BUFF_MUSK 0x0204, rx on event
+struct buff_musk_t {
+    static constexpr uint16_t cmdid = 0x0204;
+    static constexpr uint16_t size = 1;
+    static constexpr protocol::direction_t direction = protocol::RX;
+    static constexpr uint16_t rate_hz = 0;
+
+    uint8_t buff_heal = 0;  // 0 HP regeneration
+    uint8_t buff_cool_down = 0;  // 1 Barrel cooling doubled
+    uint8_t buff_defense = 0;  // 2 Defense buff
+    uint8_t buff_attack = 0;  // 3 Attack buff
+    uint8_t buff_reserve = 0;  // 4:7 Reserved
+
+    bool decode(const uint8_t* payload, size_t length) {
+        if (length != size)
+            return false;
+        buff_heal = protocol::get_bits<uint8_t>(payload + 0, 0, 1);
+        buff_cool_down = protocol::get_bits<uint8_t>(payload + 0, 1, 1);
+        buff_defense = protocol::get_bits<uint8_t>(payload + 0, 2, 1);
+        buff_attack = protocol::get_bits<uint8_t>(payload + 0, 3, 1);
+        buff_reserve = protocol::get_bits<uint8_t>(payload + 0, 4, 4);
+        return true;
+    }
+
+    void encode(uint8_t* payload) const {
+        memset(payload, 0, size);
+        protocol::put_bits<uint8_t>(payload + 0, 0, 1, buff_heal);
+        protocol::put_bits<uint8_t>(payload + 0, 1, 1, buff_cool_down);
+        protocol::put_bits<uint8_t>(payload + 0, 2, 1, buff_defense);
+        protocol::put_bits<uint8_t>(payload + 0, 3, 1, buff_attack);
+        protocol::put_bits<uint8_t>(payload + 0, 4, 4, buff_reserve);
+    }
+
+    template <typename Visitor>
+    void visit(Visitor&& visitor) const {
+        visitor("buff_heal", buff_heal);
+        visitor("buff_cool_down", buff_cool_down);
+        visitor("buff_defense", buff_defense);
+        visitor("buff_attack", buff_attack);
+        visitor("buff_reserve", buff_reserve);
+    }
+};
+
+// CMD_AERIAL_ROBOT_ENERGY 0x0205, rx 10 Hz
+struct aerial_robot_energy_t {
+    static constexpr uint16_t cmdid = 0x0205;
+    static constexpr uint16_t size = 2;
+    static constexpr protocol::direction_t direction = protocol::RX;
+    static constexpr uint16_t rate_hz = 10;
+
+    uint8_t energy_point = 0;  // Accumulated energy
+    uint8_t attack_time = 0;  // Remaining attack time (seconds)
+
+    bool decode(const uint8_t* payload, size_t length) {
+        if (length != size)
+            return false;
+        energy_point = protocol::get<uint8_t>(payload + 0);
+        attack_time = protocol::get<uint8_t>(payload + 1);
+        return true;
+    }
+
+    void encode(uint8_t* payload) const {
+        memset(payload, 0, size);
+        protocol::put<uint8_t>(payload + 0, energy_point);
+        protocol::put<uint8_t>(payload + 1, attack_time);
+    }
+
+    template <typename Visitor>
+    void visit(Visitor&& visitor) const {
+        visitor("energy_point", energy_point);
+        visitor("attack_time", attack_time);
+    }
+};
+
+enum hurt_type_t {
+    HURT_ARMOR = 0,
+    HURT_MOD_OFFLINE = 1,
+    HURT_OVER_HEAT = 2,
+    HURT_OVER_POWER = 3,
+};
+
+// CMD_ROBOT_HURT 0x0206, rx on event
+struct robot_hurt_t {
+    static constexpr uint16_t cmdid = 0x0206;
+    static constexpr uint16_t size = 1;
+    static constexpr protocol::direction_t direction = protocol::RX;
+    static constexpr uint16_t rate_hz = 0;
+
+    uint8_t armor_id = 0;  // Armor hit if hurt type is armor damage
+    uint8_t hurt_type = 0;  // Type of damage [hurt_type_t]
+
+    bool decode(const uint8_t* payload, size_t length) {
+        if (length != size)
+            return false;
+        armor_id = protocol::get_bits<uint8_t>(payload + 0, 0, 4);
+        hurt_type = protocol::get_bits<uint8_t>(payload + 0, 4, 4);
+        return true;
+    }
+
+    void encode(uint8_t* payload) const {
+        memset(payload, 0, size);
+        protocol::put_bits<uint8_t>(payload + 0, 0, 4, armor_id);
+        protocol::put_bits<uint8_t>(payload + 0, 4, 4, hurt_type);
+    }
+
+    template <typename Visitor>
+    void visit(Visitor&& visitor) const {
+        visitor("armor_id", armor_id);
+        visitor("hurt_type", hurt_type);
+    }
+};
+
+enum bullet_type_t {
+    BULLET_17MM = 1,
+    BULLET_42MM = 2,
+};
+
+// CMD_SHOOT_DATA 0x0207, rx on event
+struct shoot_data_t {
+    static constexpr uint16_t cmdid = 0x0207;
+    static constexpr uint16_t size = 6;
+    static constexpr protocol::direction_t direction = protocol::RX;
+    static constexpr uint16_t rate_hz = 0;
+
+    uint8_t bullet_type = 0;  // Projectile type [bullet_type_t]
+    uint8_t bullet_freq = 0;  // Projectile launching frequency (bullets per second)
+    float bullet_speed = 0;  // Projectile launching speed (meters per second)
+
+    bool decode(const uint8_t* payload, size_t length) {
+        if (length != size)
+            return false;
+        bullet_type = protocol::get<uint8_t>(payload + 0);
+        bullet_freq = protocol::get<uint8_t>(payload + 1);
+        bullet_speed = protocol::get<float>(payload + 2);
+        return true;
+    }
+
+    void encode(uint8_t* payload) const {
+        memset(payload, 0, size);
+        protocol::put<uint8_t>(payload + 0, bullet_type);
+        protocol::put<uint8_t>(payload + 1, bullet_freq);
+        protocol::put<float>(payload + 2, bullet_speed);
+    }
+
+    template <typename Visitor>
+    void visit(Visitor&& visitor) const {
+        visitor("bullet_type", bullet_type);
+        visitor("bullet_freq", bullet_freq);
+        visitor("bullet_speed", bullet_speed);
+    }
+};
+
+// CMD_STUDENT_INTERACTIVE 0x0301, both 10 Hz
+struct student_interactive_t {
+    static constexpr uint16_t cmdid = 0x0301;
+    static constexpr uint16_t size = 19;
+    static constexpr protocol::direction_t direction = protocol::BOTH;
+    static constexpr uint16_t rate_hz = 10;
+
+    uint16_t data_cmd_id = 0;  // Content ID, 0xD180 for client custom data, 0x0200-0x02FF between robots
+    uint16_t sender_id = 0;  // Sending robot [robot_id_t]
+    uint16_t receiver_id = 0;  // Receiving robot, or client ID 0x0100 + robot ID
+    uint8_t data[13] = {};  // Content, three floats and a light mask for client custom data
+
+    bool decode(const uint8_t* payload, size_t length) {
+        if (length != size)
+            return false;
+        data_cmd_id = protocol::get<uint16_t>(payload + 0);
+        sender_id = protocol::get<uint16_t>(payload + 2);
+        receiver_id = protocol::get<uint16_t>(payload + 4);
+        for (size_t i = 0; i < 13; ++i)
+            data[i] = protocol::get<uint8_t>(payload + 6 + i * sizeof(uint8_t));
+        return true;
+    }
+
+    void encode(uint8_t* payload) const {
+        memset(payload, 0, size);
+        protocol::put<uint16_t>(payload + 0, data_cmd_id);
+        protocol::put<uint16_t>(payload + 2, sender_id);
+        protocol::put<uint16_t>(payload + 4, receiver_id);
+        for (size_t i = 0; i < 13; ++i)
+            protocol::put<uint8_t>(payload + 6 + i * sizeof(uint8_t), data[i]);
+    }
+
+    template <typename Visitor>
+    void visit(Visitor&& visitor) const {
+        visitor("data_cmd_id", data_cmd_id);
+        visitor("sender_id", sender_id);
+        visitor("receiver_id", receiver_id);
+        visitor("data", data);
+    }
+};
+
+// Call f(msg) with a default constructed instance of every message
+template <typename F>
+void for_each_message(F&& f) {
+    f(game_state_t());
+    f(game_result_t());
+    f(game_robot_survivors_t());
+    f(event_data_t());
+    f(supply_projectile_action_t());
+    f(supply_projectile_booking_t());
+    f(game_robot_state_t());
+    f(power_heat_data_t());
+    f(game_robot_pos_t());
+    f(buff_musk_t());
+    f(aerial_robot_energy_t());
+    f(robot_hurt_t());
+    f(shoot_data_t());
+    f(student_interactive_t());
+}
+
+// Decode data with the firmware struct and with the codec, return the number of fields that differ.
+// Defined in referee_2019_layout.cpp, which builds against the firmware headers
+int layout_check(const uint8_t* data);
+
+// Decode a frame payload and pass the message to handler(msg). False for unknown cmdids and bad sizes
+template <typename Handler>
+bool dispatch(uint16_t cmdid, const uint8_t* data, size_t length, Handler&& handler) {
+    switch (cmdid) {
+        case CMD_GAME_STATE: {
+            game_state_t msg;
+            if (!msg.decode(data, length))
+                return false;
+            handler(msg);
+            return true;
+        }
+        case CMD_GAME_RESULT: {
+            game_result_t msg;
+            if (!msg.decode(data, length))
+                return false;
+            handler(msg);
+            return true;
+        }
+        case CMD_GAME_ROBOT_SURVIVORS: {
+            game_robot_survivors_t msg;
+            if (!msg.decode(data, length))
+                return false;
+            handler(msg);
+            return true;
+        }
+        case CMD_EVENT_DATA: {
+            event_data_t msg;
+            if (!msg.decode(data, length))
+                return false;
+            handler(msg);
+            return true;
+        }
+        case CMD_SUPPLY_PROJECTILE_ACTION: {
+            supply_projectile_action_t msg;
+            if (!msg.decode(data, length))
+                return false;
+            handler(msg);
+            return true;
+        }
+        case CMD_SUPPLY_PROJECTILE_BOOKING: {
+            supply_projectile_booking_t msg;
+            if (!msg.decode(data, length))
+                return false;
+            handler(msg);
+            return true;
+        }
+        case CMD_GAME_ROBOT_STATE: {
+            game_robot_state_t msg;
+            if (!msg.decode(data, length))
+                return false;
+            handler(msg);
+            return true;
+        }
+        case CMD_POWER_HEAT_DATA: {
+            power_heat_data_t msg;
+            if (!msg.decode(data, length))
+                return false;
+            handler(msg);
+            return true;
+        }
+        case CMD_GAME_ROBOT_POS: {
+            game_robot_pos_t msg;
+            if (!msg.decode(data, length))
+                return false;
+            handler(msg);
+            return true;
+        }
+        case CMD_BUFF_MUSK: {
+            buff_musk_t msg;
+            if (!msg.decode(data, length))
+                return false;
+            handler(msg);
+            return true;
+        }
+        case CMD_AERIAL_ROBOT_ENERGY: {
+            aerial_robot_energy_t msg;
+            if (!msg.decode(data, length))
+                return false;
+            handler(msg);
+            return true;
+        }
+        case CMD_ROBOT_HURT: {
+            robot_hurt_t msg;
+            if (!msg.decode(data, length))
+                return false;
+            handler(msg);
+            return true;
+        }
+        case CMD_SHOOT_DATA: {
+            shoot_data_t msg;
+            if (!msg.decode(data, length))
+                return false;
+            handler(msg);
+            return true;
+        }
+        case CMD_STUDENT_INTERACTIVE: {
+            student_interactive_t msg;
+            if (!msg.decode(data, length))
+                return false;
+            handler(msg);
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+}  // namespace referee_2019
@@ -0,0 +1,277 @@
+// Firmware struct layout check. Generated from Tools/protocol/referee_2019.json by protogen.py, do not edit
+
+#include "referee_2019_codec.hpp"
+
+extern "C" {
+#include "referee_2019_protocol.h"
+}
+
+namespace referee_2019 {
+
+int layout_check(const uint8_t* data) {
+    int mismatch = 0;
+    {
+        ::game_state_t firmware;
+        referee_2019::game_state_t host;
+        static_assert(sizeof(firmware) == referee_2019::game_state_t::size, "game_state_t size");
+        memcpy(&firmware, data, sizeof(firmware));
+        host.decode(data, sizeof(firmware));
+        mismatch += firmware.game_type != host.game_type;
+        mismatch += firmware.game_progress != host.game_progress;
+        {
+            uint16_t value = firmware.stage_remain_time;
+            mismatch += memcmp(&value, &host.stage_remain_time, sizeof(value)) != 0;
+        }
+    }
+    {
+        ::game_result_t firmware;
+        referee_2019::game_result_t host;
+        static_assert(sizeof(firmware) == referee_2019::game_result_t::size, "game_result_t size");
+        memcpy(&firmware, data, sizeof(firmware));
+        host.decode(data, sizeof(firmware));
+        {
+            uint8_t value = firmware.winner;
+            mismatch += memcmp(&value, &host.winner, sizeof(value)) != 0;
+        }
+    }
+    {
+        ::game_robot_survivors_t firmware;
+        referee_2019::game_robot_survivors_t host;
+        static_assert(sizeof(firmware) == referee_2019::game_robot_survivors_t::size, "game_robot_survivors_t size");
+        memcpy(&firmware, data, sizeof(firmware));
+        host.decode(data, sizeof(firmware));
+        {
+            uint16_t value = firmware.robot_legion;
+            mismatch += memcmp(&value, &host.robot_legion, sizeof(value)) != 0;
+        }
+    }
+    {
+        ::event_data_t firmware;
+        referee_2019::event_data_t host;
+        static_assert(sizeof(firmware) == referee_2019::event_data_t::size, "event_data_t size");
+        memcpy(&firmware, data, sizeof(firmware));
+        host.decode(data, sizeof(firmware));
+        {
+            uint32_t value = firmware.event_type;
+            mismatch += memcmp(&value, &host.event_type, sizeof(value)) != 0;
+        }
+    }
+    {
+        ::supply_projectile_action_t firmware;
+        referee_2019::supply_projectile_action_t host;
+        static_assert(sizeof(firmware) == referee_2019::supply_projectile_action_t::size, "supply_projectile_action_t size");
+        memcpy(&firmware, data, sizeof(firmware));
+        host.decode(data, sizeof(firmware));
+        {
+            uint8_t value = firmware.supply_projectile_id;
+            mismatch += memcmp(&value, &host.supply_projectile_id, sizeof(value)) != 0;
+        }
+        {
+            uint8_t value = firmware.supply_robot_id;
+            mismatch += memcmp(&value, &host.supply_robot_id, sizeof(value)) != 0;
+        }
+        {
+            uint8_t value = firmware.supply_projectile_step;
+            mismatch += memcmp(&value, &host.supply_projectile_step, sizeof(value)) != 0;
+        }
+        {
+            uint8_t value = firmware.supply_projectile_num;
+            mismatch += memcmp(&value, &host.supply_projectile_num, sizeof(value)) != 0;
+        }
+    }
+    {
+        ::supply_projectile_booking_t firmware;
+        referee_2019::supply_projectile_booking_t host;
+        static_assert(sizeof(firmware) == referee_2019::supply_projectile_booking_t::size, "supply_projectile_booking_t size");
+        memcpy(&firmware, data, sizeof(firmware));
+        host.decode(data, sizeof(firmware));
+        {
+            uint8_t value = firmware.supply_projectile_id;
+            mismatch += memcmp(&value, &host.supply_projectile_id, sizeof(value)) != 0;
+        }
+        {
+            uint8_t value = firmware.supply_robot_id;
+            mismatch += memcmp(&value, &host.supply_robot_id, sizeof(value)) != 0;
+        }
+        {
+            uint8_t value = firmware.supply_num;
+            mismatch += memcmp(&value, &host.supply_num, sizeof(value)) != 0;
+        }
+    }
+    {
+        ::game_robot_state_t firmware;
+        referee_2019::game_robot_state_t host;
+        static_assert(sizeof(firmware) == referee_2019::game_robot_state_t::size, "game_robot_state_t size");
+        memcpy(&firmware, data, sizeof(firmware));
+        host.decode(data, sizeof(firmware));
+        {
+            uint8_t value = firmware.robot_id;
+            mismatch += memcmp(&value, &host.robot_id, sizeof(value)) != 0;
+        }
+        {
+            uint8_t value = firmware.robot_level;
+            mismatch += memcmp(&value, &host.robot_level, sizeof(value)) != 0;
+        }
+        {
+            uint16_t value = firmware.remain_hp;
+            mismatch += memcmp(&value, &host.remain_hp, sizeof(value)) != 0;
+        }
+        {
+            uint16_t value = firmware.max_hp;
+            mismatch += memcmp(&value, &host.max_hp, sizeof(value)) != 0;
+        }
+        {
+            uint16_t value = firmware.shooter_heat0_cooling_rate;
+            mismatch += memcmp(&value, &host.shooter_heat0_cooling_rate, sizeof(value)) != 0;
+        }
+        {
+            uint16_t value = firmware.shooter_heat0_cooling_limit;
+            mismatch += memcmp(&value, &host.shooter_heat0_cooling_limit, sizeof(value)) != 0;
+        }
+        {
+            uint16_t value = firmware.shooter_heat1_cooling_rate;
+            mismatch += memcmp(&value, &host.shooter_heat1_cooling_rate, sizeof(value)) != 0;
+        }
+        {
+            uint16_t value = firmware.shooter_heat1_cooling_limit;
+            mismatch += memcmp(&value, &host.shooter_heat1_cooling_limit, sizeof(value)) != 0;
+        }
+        mismatch += firmware.mains_power_gimbal_output != host.mains_power_gimbal_output;
+        mismatch += firmware.mains_power_chassis_output != host.mains_power_chassis_output;
+        mismatch += firmware.mains_power_shooter_output != host.mains_power_shooter_output;
+        mismatch += firmware.mains_power_reserve != host.mains_power_reserve;
+    }
+    {
+        ::power_heat_data_t firmware;
+        referee_2019::power_heat_data_t host;
+        static_assert(sizeof(firmware) == referee_2019::power_heat_data_t::size, "power_heat_data_t size");
+        memcpy(&firmware, data, sizeof(firmware));
+        host.decode(data, sizeof(firmware));
+        {
+            uint16_t value = firmware.chassis_volt;
+            mismatch += memcmp(&value, &host.chassis_volt, sizeof(value)) != 0;
+        }
+        {
+            uint16_t value = firmware.chassis_current;
+            mismatch += memcmp(&value, &host.chassis_current, sizeof(value)) != 0;
+        }
+        {
+            float value = firmware.chassis_power;
+            mismatch += memcmp(&value, &host.chassis_power, sizeof(value)) != 0;
+        }
+        {
+            uint16_t value = firmware.chassis_power_buffer;
+            mismatch += memcmp(&value, &host.chassis_power_buffer, sizeof(value)) != 0;
+        }
+        {
+            uint16_t value = firmware.shooter_heat0;
+            mismatch += memcmp(&value, &host.shooter_heat0, sizeof(value)) != 0;
+        }
+        {
+            uint16_t value = firmware.shooter_heat1;
+            mismatch += memcmp(&value, &host.shooter_heat1, sizeof(value)) != 0;
+        }
+    }
+    {
+        ::game_robot_pos_t firmware;
+        referee_2019::game_robot_pos_t host;
+        static_assert(sizeof(firmware) == referee_2019::game_robot_pos_t::size, "game_robot_pos_t size");
+        memcpy(&firmware, data, sizeof(firmware));
+        host.decode(data, sizeof(firmware));
+        {
+            float value = firmware.x;
+            mismatch += memcmp(&value, &host.x, sizeof(value)) != 0;
+        }
+        {
+            float value = firmware.y;
+            mismatch += memcmp(&value, &host.y, sizeof(value)) != 0;
+        }
+        {
+            float value = firmware.z;
+            mismatch += memcmp(&value, &host.z, sizeof(value)) != 0;
+        }
+        {
+            float value = firmware.yaw;
+            mismatch += memcmp(&value, &host.yaw, sizeof(value)) != 0;
+        }
+    }
+    {
+        ::buff_musk_t firmware;
+        referee_2019::buff_musk_t host;
+        static_assert(sizeof(firmware) == referee_2019::buff_musk_t::size, "buff_musk_t size");
+        memcpy(&firmware, data, sizeof(firmware));
+        host.decode(data, sizeof(firmware));
+        mismatch += firmware.buff_heal != host.buff_heal;
+        mismatch += firmware.buff_cool_down != host.buff_cool_down;
+        mismatch += firmware.buff_defense != host.buff_defense;
+        mismatch += firmware.buff_attack != host.buff_attack;
+        mismatch += firmware.buff_reserve != host.buff_reserve;
+    }
+    {
+        ::aerial_robot_energy_t firmware;
+        referee_2019::aerial_robot_energy_t host;
+        static_assert(sizeof(firmware) == referee_2019::aerial_robot_energy_t::size, "aerial_robot_energy_t size");
+        memcpy(&firmware, data, sizeof(firmware));
+        host.decode(data, sizeof(firmware));
+        {
+            uint8_t value = firmware.energy_point;
+            mismatch += memcmp(&value, &host.energy_point, sizeof(value)) != 0;
+        }
+        {
+            uint8_t value = firmware.attack_time;
+            mismatch += memcmp(&value, &host.attack_time, sizeof(value)) != 0;
+        }
+    }
+    {
+        ::robot_hurt_t firmware;
+        referee_2019::robot_hurt_t host;
+        static_assert(sizeof(firmware) == referee_2019::robot_hurt_t::size, "robot_hurt_t size");
+        memcpy(&firmware, data, sizeof(firmware));
+        host.decode(data, sizeof(firmware));
+        mismatch += firmware.armor_id != host.armor_id;
+        mismatch += firmware.hurt_type != host.hurt_type;
+    }
+    {
+        ::shoot_data_t firmware;
+        referee_2019::shoot_data_t host;
+        static_assert(sizeof(firmware) == referee_2019::shoot_data_t::size, "shoot_data_t size");
+        memcpy(&firmware, data, sizeof(firmware));
+        host.decode(data, sizeof(firmware));
+        {
+            uint8_t value = firmware.bullet_type;
+            mismatch += memcmp(&value, &host.bullet_type, sizeof(value)) != 0;
+        }
+        {
+            uint8_t value = firmware.bullet_freq;
+            mismatch += memcmp(&value, &host.bullet_freq, sizeof(value)) != 0;
+        }
+        {
+            float value = firmware.bullet_speed;
+            mismatch += memcmp(&value, &host.bullet_speed, sizeof(value)) != 0;
+        }
+    }
+    {
+        ::student_interactive_t firmware;
+        referee_2019::student_interactive_t host;
+        static_assert(sizeof(firmware) == referee_2019::student_interactive_t::size, "student_interactive_t size");
+        memcpy(&firmware, data, sizeof(firmware));
+        host.decode(data, sizeof(firmware));
+        {
+            uint16_t value = firmware.data_cmd_id;
+            mismatch += memcmp(&value, &host.data_cmd_id, sizeof(value)) != 0;
+        }
+        {
+            uint16_t value = firmware.sender_id;
+            mismatch += memcmp(&value, &host.sender_id, sizeof(value)) != 0;
+        }
+        {
+            uint16_t value = firmware.receiver_id;
+            mismatch += memcmp(&value, &host.receiver_id, sizeof(value)) != 0;
+        }
+        for (size_t i = 0; i < 13; ++i)
+            mismatch += memcmp(&firmware.data[i], &host.data[i], sizeof(host.data[i])) != 0;
+    }
+    return mismatch;
+}
+
+}  // namespace referee_2019
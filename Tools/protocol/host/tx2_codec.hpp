@@ -0,0 +1,162 @@
+// TX2 messages. Generated from Tools/protocol/tx2.json by protogen.py, do not edit
+// Structs mirror the firmware ones. Fields are decoded one by one, so this does not rely on host struct layout.
+
+#pragma once
+
+#include "protocol_frame.hpp"
+
+namespace tx2 {
+
+constexpr uint8_t sof = 0xA0;
+
+enum cmdid_t : uint16_t {
+    CMD_GIMBAL_CONTROL = 0x00A1,
+    CMD_AIM_REQUEST = 0x0012,
+    CMD_FOUR_INT16 = 0x00F0,
+};
+
+// CMD_GIMBAL_CONTROL 0x00A1, rx on event
+struct gimbal_control_t {
+    static constexpr uint16_t cmdid = 0x00A1;
+    static constexpr uint16_t size = 4;
+    static constexpr protocol::direction_t direction = protocol::RX;
+    static constexpr uint16_t rate_hz = 0;
+
+    uint16_t pitch_ref = 0;
+    uint16_t yaw_ref = 0;
+
+    bool decode(const uint8_t* payload, size_t length) {
+        if (length != size)
+            return false;
+        pitch_ref = protocol::get<uint16_t>(payload + 0);
+        yaw_ref = protocol::get<uint16_t>(payload + 2);
+        return true;
+    }
+
+    void encode(uint8_t* payload) const {
+        memset(payload, 0, size);
+        protocol::put<uint16_t>(payload + 0, pitch_ref);
+        protocol::put<uint16_t>(payload + 2, yaw_ref);
+    }
+
+    template <typename Visitor>
+    void visit(Visitor&& visitor) const {
+        visitor("pitch_ref", pitch_ref);
+        visitor("yaw_ref", yaw_ref);
+    }
+};
+
+enum aim_mode_t {
+    RUNE = 0,
+    AUTOAIM = 1,
+};
+
+// CMD_AIM_REQUEST 0x0012, tx on event
+struct aim_request_t {
+    static constexpr uint16_t cmdid = 0x0012;
+    static constexpr uint16_t size = 1;
+    static constexpr protocol::direction_t direction = protocol::TX;
+    static constexpr uint16_t rate_hz = 0;
+
+    uint8_t aim_mode = 0;  // [aim_mode_t]
+
+    bool decode(const uint8_t* payload, size_t length) {
+        if (length != size)
+            return false;
+        aim_mode = protocol::get<uint8_t>(payload + 0);
+        return true;
+    }
+
+    void encode(uint8_t* payload) const {
+        memset(payload, 0, size);
+        protocol::put<uint8_t>(payload + 0, aim_mode);
+    }
+
+    template <typename Visitor>
+    void visit(Visitor&& visitor) const {
+        visitor("aim_mode", aim_mode);
+    }
+};
+
+// CMD_FOUR_INT16 0x00F0, both on event
+struct four_int16_t {
+    static constexpr uint16_t cmdid = 0x00F0;
+    static constexpr uint16_t size = 8;
+    static constexpr protocol::direction_t direction = protocol::BOTH;
+    static constexpr uint16_t rate_hz = 0;
+
+    int16_t x = 0;
+    int16_t y = 0;
+    int16_t z = 0;
+    int16_t w = 0;
+
+    bool decode(const uint8_t* payload, size_t length) {
+        if (length != size)
+            return false;
+        x = protocol::get<int16_t>(payload + 0);
+        y = protocol::get<int16_t>(payload + 2);
+        z = protocol::get<int16_t>(payload + 4);
+        w = protocol::get<int16_t>(payload + 6);
+        return true;
+    }
+
+    void encode(uint8_t* payload) const {
+        memset(payload, 0, size);
+        protocol::put<int16_t>(payload + 0, x);
+        protocol::put<int16_t>(payload + 2, y);
+        protocol::put<int16_t>(payload + 4, z);
+        protocol::put<int16_t>(payload + 6, w);
+    }
+
+    template <typename Visitor>
+    void visit(Visitor&& visitor) const {
+        visitor("x", x);
+        visitor("y", y);
+        visitor("z", z);
+        visitor("w", w);
+    }
+};
+
+// Call f(msg) with a default constructed instance of every message
+template <typename F>
+void for_each_message(F&& f) {
+    f(gimbal_control_t());
+    f(aim_request_t());
+    f(four_int16_t());
+}
+
+// Decode data with the firmware struct and with the codec, return the number of fields that differ.
+// Defined in tx2_layout.cpp, which builds against the firmware headers
+int layout_check(const uint8_t* data);
+
+// Decode a frame payload and pass the message to handler(msg). False for unknown cmdids and bad sizes
+template <typename Handler>
+bool dispatch(uint16_t cmdid, const uint8_t* data, size_t length, Handler&& handler) {
+    switch (cmdid) {
+        case CMD_GIMBAL_CONTROL: {
+            gimbal_control_t msg;
+            if (!msg.decode(data, length))
+                return false;
+            handler(msg);
+            return true;
+        }
+        case CMD_AIM_REQUEST: {
+            aim_request_t msg;
+            if (!msg.decode(data, length))
+                return false;
+            handler(msg);
+            return true;
+        }
+        case CMD_FOUR_INT16: {
+            four_int16_t msg;
+            if (!msg.decode(data, length))
+                return false;
+            handler(msg);
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+}  // namespace tx2
@@ -0,0 +1,65 @@
+// Firmware struct layout check. Generated from Tools/protocol/tx2.json by protogen.py, do not edit
+
+#include "tx2_codec.hpp"
+
+extern "C" {
+#include "tx2_protocol.h"
+}
+
+namespace tx2 {
+
+int layout_check(const uint8_t* data) {
+    int mismatch = 0;
+    {
+        ::gimbal_control_t firmware;
+        tx2::gimbal_control_t host;
+        static_assert(sizeof(firmware) == tx2::gimbal_control_t::size, "gimbal_control_t size");
+        memcpy(&firmware, data, sizeof(firmware));
+        host.decode(data, sizeof(firmware));
+        {
+            uint16_t value = firmware.pitch_ref;
+            mismatch += memcmp(&value, &host.pitch_ref, sizeof(value)) != 0;
+        }
+        {
+            uint16_t value = firmware.yaw_ref;
+            mismatch += memcmp(&value, &host.yaw_ref, sizeof(value)) != 0;
+        }
+    }
+    {
+        ::aim_request_t firmware;
+        tx2::aim_request_t host;
+        static_assert(sizeof(firmware) == tx2::aim_request_t::size, "aim_request_t size");
+        memcpy(&firmware, data, sizeof(firmware));
+        host.decode(data, sizeof(firmware));
+        {
+            uint8_t value = firmware.aim_mode;
+            mismatch += memcmp(&value, &host.aim_mode, sizeof(value)) != 0;
+        }
+    }
+    {
+        ::four_int16_t firmware;
+        tx2::four_int16_t host;
+        static_assert(sizeof(firmware) == tx2::four_int16_t::size, "four_int16_t size");
+        memcpy(&firmware, data, sizeof(firmware));
+        host.decode(data, sizeof(firmware));
+        {
+            int16_t value = firmware.x;
+            mismatch += memcmp(&value, &host.x, sizeof(value)) != 0;
+        }
+        {
+            int16_t value = firmware.y;
+            mismatch += memcmp(&value, &host.y, sizeof(value)) != 0;
+        }
+        {
+            int16_t value = firmware.z;
+            mismatch += memcmp(&value, &host.z, sizeof(value)) != 0;
+        }
+        {
+            int16_t value = firmware.w;
+            mismatch += memcmp(&value, &host.w, sizeof(value)) != 0;
+        }
+    }
+    return mismatch;
+}
+
+}  // namespace tx2
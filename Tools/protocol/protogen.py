@@ -0,0 +1,433 @@
+#!/usr/bin/env python3
+#
+#  Copyright (C) 2018
+#  Illini RoboMaster @ University of Illinois at Urbana-Champaign.
+#
+#  This program is free software: you can redistribute it and/or modify
+#  it under the terms of the GNU General Public License as published by
+#  the Free Software Foundation, either version 3 of the License, or
+#  (at your option) any later version.
+#
+#  This program is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with this program. If not, see <http://www.gnu.org/licenses/>.
+
+"""Generate protocol code for a serial link from its message schema.
+
+For a schema the files are named after "output", which defaults to "link". Several rule sets of a link may each
+have a schema, with a "guard" condition that selects one of them at compile time. This writes
+    <c_dir>/<output>_protocol.h     message structs, enums, cmdids and the aggregate struct
+    <c_dir>/<output>_protocol.c     size checks and the data_process_msg_t table
+    <cpp_dir>/<output>_codec.hpp    host side structs with field by field decode / encode and a dispatcher
+    <cpp_dir>/<output>_layout.cpp   check that the firmware structs decode the same as the codec, for codec_check
+
+Usage: protogen.py [--c-dir DIR] [--cpp-dir DIR] schema.json...
+"""
+
+import argparse
+import json
+import os
+import sys
+
+# schema type -> (C type, size)
+TYPES = {
+    "uint8":  ("uint8_t", 1),
+    "int8":   ("int8_t", 1),
+    "uint16": ("uint16_t", 2),
+    "int16":  ("int16_t", 2),
+    "uint32": ("uint32_t", 4),
+    "int32":  ("int32_t", 4),
+    "float":  ("float", 4),
+}
+
+DIRECTIONS = {
+    "rx":   "DATA_PROCESS_RX",
+    "tx":   "DATA_PROCESS_TX",
+    "both": "DATA_PROCESS_RX | DATA_PROCESS_TX",
+}
+
+CPP_DIRECTIONS = {"rx": "protocol::RX", "tx": "protocol::TX", "both": "protocol::BOTH"}
+
+LICENSE = """/**************************************************************************
+ *  Copyright (C) 2018
+ *  Illini RoboMaster @ University of Illinois at Urbana-Champaign.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+"""
+
+
+class SchemaError(Exception):
+    pass
+
+
+def load(path):
+    with open(path) as f:
+        schema = json.load(f)
+    link = schema["link"]
+    cmdids = set()
+    for msg in schema["messages"]:
+        where = "%s: %s" % (path, msg.get("name"))
+        msg["cmdid"] = int(msg["cmdid"], 0)
+        if msg["cmdid"] in cmdids:
+            raise SchemaError("%s: duplicate cmdid 0x%04X" % (where, msg["cmdid"]))
+        cmdids.add(msg["cmdid"])
+        if msg["direction"] not in DIRECTIONS:
+            raise SchemaError("%s: direction must be one of %s" % (where, ", ".join(DIRECTIONS)))
+        msg.setdefault("member", msg["name"])
+        msg.setdefault("type", msg["name"] + "_t")
+        msg.setdefault("rate_hz", 0)
+        msg.setdefault("enums", [])
+        if msg["direction"] != "tx":
+            msg.setdefault("decode", schema.get("decode"))     # Schema wide decode callback for rx messages
+        layout(msg, where)
+    schema["sof"] = int(schema["sof"], 0)
+    schema.setdefault("version", [])
+    schema["prefix"] = link.upper()
+    schema.setdefault("output", link)
+    return schema
+
+
+def layout(msg, where):
+    """Assign byte offsets. Consecutive bit fields of one type share a unit, filled from bit 0 up, which is
+    how arm-none-eabi-gcc and armcc lay out __packed bit fields on a little endian target."""
+    offset = 0
+    unit = None
+    for field in msg["fields"]:
+        if field["type"] not in TYPES:
+            raise SchemaError("%s.%s: unknown type %s" % (where, field["name"], field["type"]))
+        ctype, size = TYPES[field["type"]]
+        field["ctype"] = ctype
+        field.setdefault("count", 1)
+        if "bits" in field:
+            if field["type"] == "float" or field["count"] != 1:
+                raise SchemaError("%s.%s: bit fields must be single integers" % (where, field["name"]))
+            if unit is None or unit["type"] != field["type"] or unit["used"] + field["bits"] > size * 8:
+                if unit is not None and unit["used"] != unit["size"] * 8:
+                    raise SchemaError("%s.%s: bit fields before it leave their unit partly filled" % (where, field["name"]))
+                unit = {"type": field["type"], "size": size, "offset": offset, "used": 0}
+                offset += size
+            field["offset"] = unit["offset"]
+            field["shift"] = unit["used"]
+            unit["used"] += field["bits"]
+        else:
+            if unit is not None and unit["used"] != unit["size"] * 8:
+                raise SchemaError("%s.%s: bit fields before it leave their unit partly filled" % (where, field["name"]))
+            unit = None
+            field["offset"] = offset
+            offset += size * field["count"]
+    if unit is not None and unit["used"] != unit["size"] * 8:
+        raise SchemaError("%s: trailing bit fields leave their unit partly filled" % where)
+    msg["size"] = offset
+
+
+def cmd_name(msg):
+    return "CMD_" + msg["name"].upper()
+
+
+def rate(msg):
+    return "%u Hz" % msg["rate_hz"] if msg["rate_hz"] else "on event"
+
+
+def column(lines, gap=4):
+    """Align the trailing // comment of each (code, comment) pair"""
+    width = max(len(code) for code, _ in lines) + gap
+    width = (width + 3) // 4 * 4
+    return [code.ljust(width) + "// " + comment if comment else code for code, comment in lines]
+
+
+def c_struct(msg):
+    ctype_width = max(len(f["ctype"]) for f in msg["fields"])
+    ctype_width = (ctype_width + 4) // 4 * 4
+    lines = []
+    for f in msg["fields"]:
+        decl = "    " + f["ctype"].ljust(ctype_width) + f["name"]
+        if "bits" in f:
+            decl += ":%u" % f["bits"]
+        elif f["count"] > 1:
+            decl += "[%u]" % f["count"]
+        lines.append((decl + ";", f.get("comment", "")))
+    out = ["/* ===== %s 0x%04X, %s %s ===== */" % (cmd_name(msg), msg["cmdid"], msg["direction"], rate(msg)),
+           "typedef struct {"]
+    out += column(lines)
+    out.append("} __packed %s;" % msg["type"])
+    return out
+
+
+def c_enum(enum):
+    width = max(len(v["name"]) for v in enum["values"]) + 1
+    width = (width + 3) // 4 * 4
+    lines = []
+    for v in enum["values"]:
+        code = "%s%s = %d," % ("// " if v.get("disabled") else "    ", v["name"].ljust(width), v["value"])
+        lines.append((code, v.get("comment", "")))
+    return ["typedef enum {"] + column(lines) + ["} %s;" % enum["name"]]
+
+
+def gen_c_header(schema, source_name):
+    link, prefix, output = schema["link"], schema["prefix"], schema["output"]
+    out = [LICENSE,
+           "/**",
+           " * @file    %s_protocol.h" % output,
+           " * @brief   %s. Generated from Tools/protocol/%s by protogen.py, do not edit" % (schema["brief"], source_name),
+           " */",
+           "",
+           "#ifndef _%s_PROTOCOL_H_" % output.upper(),
+           "#define _%s_PROTOCOL_H_" % output.upper(),
+           "",
+           '#include "data_process.h"',
+           ""]
+    if schema["version"]:
+        out += ["/*"] + [" * " + v for v in schema["version"]] + [" */", ""]
+    out += ["#define %s_PROTOCOL_SOF    0x%02X" % (prefix, schema["sof"]),
+            "#define %s_PROTOCOL_MSGS   %u" % (prefix, len(schema["messages"])),
+            ""]
+
+    width = max(len(cmd_name(m)) for m in schema["messages"]) + 4
+    width = (width + 3) // 4 * 4
+    out.append("typedef enum {")
+    for m in schema["messages"]:
+        out.append("    %s= 0x%04X," % (cmd_name(m).ljust(width), m["cmdid"]))
+    out += ["} %s;" % schema["cmdid_enum"], ""]
+
+    for m in schema["messages"]:
+        out += c_struct(m)
+        for e in m["enums"]:
+            out += [""] + c_enum(e)
+        out.append("")
+
+    out += ["/* ============================== */", ""]
+    type_width = (max(len(m["type"]) for m in schema["messages"]) + 4) // 4 * 4
+    lines = [("    %s%s;" % (m["type"].ljust(type_width), m["member"]), "0x%04X" % m["cmdid"]) for m in schema["messages"]]
+    out += ["typedef struct {"] + column(lines) + ["} %s;" % schema["aggregate"], ""]
+
+    out += ["/* Every message of the link, offsets are into %s */" % schema["aggregate"],
+            "extern const data_process_msg_t %s_protocol[%s_PROTOCOL_MSGS];" % (link, prefix),
+            ""]
+    hooks = sorted({m["decode"] for m in schema["messages"] if m.get("decode")})
+    if hooks:
+        out.append("/* Decode callbacks named by the schema, implemented by hand */")
+        for h in hooks:
+            out.append("uint8_t %s(void* target, const uint8_t* data, uint16_t length);" % h)
+        out.append("")
+    out += ["#endif", ""]
+    return "\n".join(out)
+
+
+def gen_c_source(schema, source_name):
+    link, prefix, output = schema["link"], schema["prefix"], schema["output"]
+    out = [LICENSE,
+           "/**",
+           " * @file    %s_protocol.c" % output,
+           " * @brief   %s. Generated from Tools/protocol/%s by protogen.py, do not edit" % (schema["brief"], source_name),
+           " */",
+           ""]
+    guard = schema.get("guard")
+    if guard:
+        out += ['#include "%s"' % guard["header"], "", "#if %s" % guard["condition"], ""]
+    out += ['#include "%s_protocol.h"' % output,
+            "#include <stddef.h>",
+            "",
+           "/* Structs must match the wire size from the schema, a mismatch fails to compile */",
+           "#define %s_SIZE_CHECK(type, size) typedef char type##_size_check[(sizeof(type) == (size)) ? 1 : -1]" % prefix,
+           ""]
+    for m in schema["messages"]:
+        out.append("%s_SIZE_CHECK(%s, %u);" % (prefix, m["type"], m["size"]))
+    out += ["", "const data_process_msg_t %s_protocol[%s_PROTOCOL_MSGS] = {" % (link, prefix)]
+    for m in schema["messages"]:
+        out.append("    {%s, %s, offsetof(%s, %s), sizeof(%s), %s}," % (
+            cmd_name(m), DIRECTIONS[m["direction"]], schema["aggregate"], m["member"], m["type"], m.get("decode") or "NULL"))
+    out += ["};", ""]
+    if guard:
+        out += ["#endif", ""]
+    return "\n".join(out)
+
+
+def cpp_field_type(f):
+    return f["ctype"]
+
+
+def gen_cpp(schema, source_name):
+    link = schema["output"]
+    out = ["// %s. Generated from Tools/protocol/%s by protogen.py, do not edit" % (schema["brief"], source_name),
+           "// Structs mirror the firmware ones. Fields are decoded one by one, so this does not rely on host struct layout.",
+           "",
+           "#pragma once",
+           "",
+           '#include "protocol_frame.hpp"',
+           "",
+           "namespace %s {" % link,
+           "",
+           "constexpr uint8_t sof = 0x%02X;" % schema["sof"],
+           "",
+           "enum cmdid_t : uint16_t {"]
+    for m in schema["messages"]:
+        out.append("    %s = 0x%04X," % (cmd_name(m), m["cmdid"]))
+    out += ["};", ""]
+
+    for m in schema["messages"]:
+        for e in m["enums"]:
+            out.append("enum %s {" % e["name"])
+            for v in e["values"]:
+                if not v.get("disabled"):
+                    out.append("    %s = %d," % (v["name"], v["value"]))
+            out += ["};", ""]
+
+        out += ["// %s 0x%04X, %s %s" % (cmd_name(m), m["cmdid"], m["direction"], rate(m)),
+                "struct %s {" % m["type"],
+                "    static constexpr uint16_t cmdid = 0x%04X;" % m["cmdid"],
+                "    static constexpr uint16_t size = %u;" % m["size"],
+                "    static constexpr protocol::direction_t direction = %s;" % CPP_DIRECTIONS[m["direction"]],
+                "    static constexpr uint16_t rate_hz = %u;" % m["rate_hz"],
+                ""]
+        for f in m["fields"]:
+            decl = "    %s %s" % (cpp_field_type(f), f["name"])
+            decl += "[%u] = {};" % f["count"] if f["count"] > 1 else " = 0;"
+            if f.get("comment"):
+                decl += "  // " + f["comment"]
+            out.append(decl)
+
+        out += ["", "    bool decode(const uint8_t* payload, size_t length) {",
+                "        if (length != size)",
+                "            return false;"]
+        for f in m["fields"]:
+            if "bits" in f:
+                out.append("        %s = protocol::get_bits<%s>(payload + %u, %u, %u);" % (f["name"], f["ctype"], f["offset"], f["shift"], f["bits"]))
+            elif f["count"] > 1:
+                out.append("        for (size_t i = 0; i < %u; ++i)" % f["count"])
+                out.append("            %s[i] = protocol::get<%s>(payload + %u + i * sizeof(%s));" % (f["name"], f["ctype"], f["offset"], f["ctype"]))
+            else:
+                out.append("        %s = protocol::get<%s>(payload + %u);" % (f["name"], f["ctype"], f["offset"]))
+        out += ["        return true;", "    }", "",
+                "    void encode(uint8_t* payload) const {",
+                "        memset(payload, 0, size);"]
+        for f in m["fields"]:
+            if "bits" in f:
+                out.append("        protocol::put_bits<%s>(payload + %u, %u, %u, %s);" % (f["ctype"], f["offset"], f["shift"], f["bits"], f["name"]))
+            elif f["count"] > 1:
+                out.append("        for (size_t i = 0; i < %u; ++i)" % f["count"])
+                out.append("            protocol::put<%s>(payload + %u + i * sizeof(%s), %s[i]);" % (f["ctype"], f["offset"], f["ctype"], f["name"]))
+            else:
+                out.append("        protocol::put<%s>(payload + %u, %s);" % (f["ctype"], f["offset"], f["name"]))
+        out += ["    }", "",
+                "    template <typename Visitor>",
+                "    void visit(Visitor&& visitor) const {"]
+        for f in m["fields"]:
+            out.append('        visitor("%s", %s);' % (f["name"], f["name"]))
+        out += ["    }", "};", ""]
+
+    out += ["// Call f(msg) with a default constructed instance of every message",
+            "template <typename F>",
+            "void for_each_message(F&& f) {"]
+    for m in schema["messages"]:
+        out.append("    f(%s());" % m["type"])
+    out += ["}", ""]
+
+    out += ["// Decode data with the firmware struct and with the codec, return the number of fields that differ.",
+            "// Defined in %s_layout.cpp, which builds against the firmware headers" % link,
+            "int layout_check(const uint8_t* data);",
+            ""]
+
+    out += ["// Decode a frame payload and pass the message to handler(msg). False for unknown cmdids and bad sizes",
+            "template <typename Handler>",
+            "bool dispatch(uint16_t cmdid, const uint8_t* data, size_t length, Handler&& handler) {",
+            "    switch (cmdid) {"]
+    for m in schema["messages"]:
+        out += ["        case %s: {" % cmd_name(m),
+                "            %s msg;" % m["type"],
+                "            if (!msg.decode(data, length))",
+                "                return false;",
+                "            handler(msg);",
+                "            return true;",
+                "        }"]
+    out += ["        default:", "            return false;", "    }", "}", "",
+            "}  // namespace %s" % link, ""]
+    return "\n".join(out)
+
+
+def gen_layout(schema, source_name):
+    link = schema["output"]
+    out = ["// Firmware struct layout check. Generated from Tools/protocol/%s by protogen.py, do not edit" % source_name,
+           "",
+           '#include "%s_codec.hpp"' % link,
+           "",
+           'extern "C" {',
+           '#include "%s_protocol.h"' % link,
+           "}",
+           "",
+           "namespace %s {" % link,
+           "",
+           "int layout_check(const uint8_t* data) {",
+           "    int mismatch = 0;"]
+    for m in schema["messages"]:
+        out += ["    {",
+                "        ::%s firmware;" % m["type"],
+                "        %s::%s host;" % (link, m["type"]),
+                '        static_assert(sizeof(firmware) == %s::%s::size, "%s size");' % (link, m["type"], m["type"]),
+                "        memcpy(&firmware, data, sizeof(firmware));",
+                "        host.decode(data, sizeof(firmware));"]
+        for f in m["fields"]:
+            if f["count"] > 1:
+                out += ["        for (size_t i = 0; i < %u; ++i)" % f["count"],
+                        "            mismatch += memcmp(&firmware.%s[i], &host.%s[i], sizeof(host.%s[i])) != 0;" % (f["name"], f["name"], f["name"])]
+            elif "bits" in f:
+                out.append("        mismatch += firmware.%s != host.%s;" % (f["name"], f["name"]))
+            else:
+                out += ["        {",
+                        "            %s value = firmware.%s;" % (f["ctype"], f["name"]),
+                        "            mismatch += memcmp(&value, &host.%s, sizeof(value)) != 0;" % f["name"],
+                        "        }"]
+        out.append("    }")
+    out += ["    return mismatch;", "}", "", "}  // namespace %s" % link, ""]
+    return "\n".join(out)
+
+
+def write(path, text):
+    old = None
+    if os.path.exists(path):
+        with open(path) as f:
+            old = f.read()
+    if old != text:
+        with open(path, "w") as f:
+            f.write(text)
+        print("wrote " + path)
+
+
+def main():
+    here = os.path.dirname(os.path.abspath(__file__))
+    parser = argparse.ArgumentParser(description="Generate protocol code from message schemas")
+    parser.add_argument("--c-dir", default=os.path.join(here, "..", "..", "Libraries"))
+    parser.add_argument("--cpp-dir", default=os.path.join(here, "host"))
+    parser.add_argument("schemas", nargs="+")
+    args = parser.parse_args()
+
+    for path in args.schemas:
+        try:
+            schema = load(path)
+        except (SchemaError, KeyError, ValueError) as e:
+            sys.exit("protogen: %s" % e)
+        name = os.path.basename(path)
+        output = schema["output"]
+        write(os.path.join(args.c_dir, output + "_protocol.h"), gen_c_header(schema, name))
+        write(os.path.join(args.c_dir, output + "_protocol.c"), gen_c_source(schema, name))
+        write(os.path.join(args.cpp_dir, output + "_codec.hpp"), gen_cpp(schema, name))
+        write(os.path.join(args.cpp_dir, output + "_layout.cpp"), gen_layout(schema, name))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,110 @@
+/**************************************************************************
+ *  Copyright (C) 2018 
+ *  Illini RoboMaster @ University of Illinois at Urbana-Champaign.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+/* UART, DMA and BSP functions the referee library calls, with the simulator at the other end of the line */
+
+#include <stdio.h>
+#include <stdarg.h>
+#include "host_uart.h"
+
+static USART_TypeDef        host_usart[4];
+static DMA_Stream_TypeDef   host_rx_stream, host_tx_stream;
+static DMA_HandleTypeDef    host_rx_dma = {&host_rx_stream, {DMA_PERIPH_TO_MEMORY}, NULL, NULL, HAL_DMA_STATE_READY, 0};
+static DMA_HandleTypeDef    host_tx_dma = {&host_tx_stream, {DMA_MEMORY_TO_PERIPH}, NULL, NULL, HAL_DMA_STATE_READY, 0};
+
+UART_HandleTypeDef huart1 = {&host_usart[0], NULL, NULL, NULL, 0, HAL_UART_STATE_READY, HAL_UART_STATE_READY, 0};
+UART_HandleTypeDef huart6 = {&host_usart[1], &host_rx_dma, &host_tx_dma, NULL, 0, HAL_UART_STATE_READY, HAL_UART_STATE_READY, 0};
+UART_HandleTypeDef huart7 = {&host_usart[2], NULL, NULL, NULL, 0, HAL_UART_STATE_READY, HAL_UART_STATE_READY, 0};
+UART_HandleTypeDef huart8 = {&host_usart[3], NULL, NULL, NULL, 0, HAL_UART_STATE_READY, HAL_UART_STATE_READY, 0};
+
+static data_process_t   *host_source;
+static const uint8_t    *host_tx_data;
+static uint16_t         host_tx_size;
+
+void host_uart_init(data_process_t* source) {
+    host_source = source;
+}
+
+void host_uart_rx(const uint8_t* data, uint16_t length) {
+    DMA_Stream_TypeDef *stream = &host_rx_stream;
+    uint16_t size = host_source->buff_size;
+    for (uint16_t i = 0; i < length; ++i) {
+        /* NDTR counts down the current memory, then the stream reloads it and switches to the other one */
+        uint8_t target = (stream->CR & DMA_SxCR_CT) != 0;
+        host_source->buff[target][size - stream->NDTR] = data[i];
+        if (--stream->NDTR == 0) {
+            stream->CR  ^= DMA_SxCR_CT;
+            stream->NDTR = size;
+        }
+    }
+}
+
+uint16_t host_uart_tx_size(void) {
+    return huart6.gState == HAL_UART_STATE_BUSY_TX ? host_tx_size : 0;
+}
+
+uint16_t host_uart_tx_take(uint8_t* data) {
+    uint16_t size = host_uart_tx_size();
+    if (size == 0)
+        return 0;
+    /* The DMA reads the frame while it is on the wire, so take it only now */
+    memcpy(data, host_tx_data, size);
+    huart6.gState = HAL_UART_STATE_READY;
+    HAL_UART_TxCpltCallback(&huart6);
+    return size;
+}
+
+HAL_StatusTypeDef HAL_DMA_Start(DMA_HandleTypeDef *hdma, uint32_t SrcAddress, uint32_t DstAddress, uint32_t DataLength) {
+    UNUSED(SrcAddress);
+    UNUSED(DstAddress);
+    hdma->Instance->NDTR = DataLength;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_Transmit(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size, uint32_t Timeout) {
+    UNUSED(Timeout);
+    if (huart != &huart6)
+        fwrite(pData, 1, Size, stderr);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_Transmit_DMA(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size) {
+    if (huart != &huart6)
+        return HAL_UART_Transmit(huart, pData, Size, 0);
+    if (huart->gState != HAL_UART_STATE_READY)
+        return HAL_BUSY;
+    huart->gState = HAL_UART_STATE_BUSY_TX;
+    host_tx_data  = pData;
+    host_tx_size  = Size;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_Transmit_IT(UART_HandleTypeDef *huart, uint8_t *pData, uint16_t Size) {
+    return HAL_UART_Transmit_DMA(huart, pData, Size);
+}
+
+void print(const char *fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    vfprintf(stderr, fmt, args);
+    va_end(args);
+}
+
+void bsp_error_handler(const char* func, int line, char* msg) {
+    fprintf(stderr, "[ERROR] %s:%d %s\n", func, line, msg);
+}
@@ -0,0 +1,53 @@
+/**************************************************************************
+ *  Copyright (C) 2018 
+ *  Illini RoboMaster @ University of Illinois at Urbana-Champaign.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+#ifndef _HOST_UART_H_
+#define _HOST_UART_H_
+
+#include "data_process.h"
+
+/**
+ * Attach the referee port to a data process instance. Call after data_process_init and before referee_init.
+ * DMA addresses are 32 bit on the robot, so received bytes are written through the instance's buffers instead.
+ *
+ * @param  source     Data process instance of BSP_REFEREE_PORT
+ */
+void host_uart_init(data_process_t* source);
+
+/**
+ * Put bytes on the rx line. They land in the double buffer as the rx DMA would put them there.
+ *
+ * @param  data       Bytes received
+ * @param  length     Number of bytes
+ */
+void host_uart_rx(const uint8_t* data, uint16_t length);
+
+/**
+ * @return            Size of the frame the robot is transmitting, 0 if the tx line is idle
+ */
+uint16_t host_uart_tx_size(void);
+
+/**
+ * Finish the frame on the tx line and raise the tx complete interrupt, which may start the next one
+ *
+ * @param  data       Receives the frame, at least host_uart_tx_size bytes
+ * @return            Size of the frame, 0 if the tx line is idle
+ */
+uint16_t host_uart_tx_take(uint8_t* data);
+
+#endif
@@ -0,0 +1,362 @@
+// Referee simulator front end.
+//  check            run the firmware referee library in-process against the simulator, in virtual time
+//  pty              serve the simulator on a new pseudo-terminal, in real time
+//  serial DEVICE    serve the simulator on a serial port at the referee baud rate, in real time
+//
+// On pty and serial, stdin takes commands:
+//  current A B C D      chassis motor current commands, C620 units
+//  shoot 17|42 SPEED    a projectile leaves the barrel
+//  hit ARMOR [17|42]    a projectile hits an armor
+//  respawn              full HP, buffer and cold barrels
+//  stats                print the simulator statistics
+//  quit
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+#undef CR3                          // A termios delay flag, and a USART register in the HAL
+
+#include "referee_sim.hpp"
+
+extern "C" {
+#include "referee.h"
+#include "host_uart.h"
+}
+
+using namespace referee_sim;
+
+static int failures;
+
+#define CHECK(cond, ...) do { if (!(cond)) { failures++; printf("FAIL: " __VA_ARGS__); printf("\n"); } } while (0)
+
+/* ===== In-process check ===== */
+
+static uint32_t virtual_ms = 1;    // Stamps of 0 mean never
+
+// The firmware reads time through HAL_GetTick, which host_os.c leaves weak
+extern "C" uint32_t HAL_GetTick(void) {
+    return virtual_ms;
+}
+
+// Bytes on one direction of the UART, moved at the line rate
+struct line_t {
+    std::deque<uint8_t> bytes;
+    float               credit = 0;
+
+    size_t take(uint8_t* out, size_t size) {
+        credit = std::min(credit + bytes_per_s / 1000.0f, static_cast<float>(bytes_per_s) / 1000 + 1);
+        size_t n = std::min({size, bytes.size(), static_cast<size_t>(credit)});
+        std::copy(bytes.begin(), bytes.begin() + n, out);
+        bytes.erase(bytes.begin(), bytes.begin() + n);
+        credit = bytes.empty() ? 0 : credit - n;
+        return n;
+    }
+};
+
+// What the robot does during one phase of the check
+struct phase_t {
+    const char* name;
+    bool        limited;            // Keep chassis power and barrel heat within the referee's limits
+    uint32_t    custom_period_ms;   // Custom data period, the referee allows 10 Hz
+};
+
+// Robot side control, reading the referee through referee_snapshot as the chassis and shooter code would
+struct robot_t {
+    const phase_t*  phase;
+    uint32_t        stamp_ms = 0;
+    uint32_t        custom_ms = 0;
+    uint32_t        shots[8] = {};  // Times of the last shots
+    uint8_t         shot_idx = 0;
+    uint32_t        stale = 0;      // Power and heat messages that did not match what the simulator sent
+    uint32_t        fresh = 0;
+
+    void run(simulator& sim) {
+        referee_snapshot_t referee;
+        uint8_t received = referee_snapshot(&referee);
+        if (received && referee.power_heat_stamp_ms != stamp_ms) {
+            stamp_ms = referee.power_heat_stamp_ms;
+            fresh++;
+            stale += referee.chassis_power != sim.sent_power();
+        }
+
+        /* Chassis: drive hard, and back off as the power buffer runs low */
+        float scale = 1;
+        if (phase->limited)
+            scale = received ? std::clamp((referee.chassis_power_buffer - 20) / 30, 0.0f, 1.0f) : 0;
+        int16_t command[4];
+        std::fill(command, command + 4, static_cast<int16_t>(6000 * scale));
+        sim.set_motor_currents(command, 4);
+
+        /* Shooter: 20 shots per second at 25 m/s, held back when the barrel would go over its limit */
+        const float speed = 25;
+        if (virtual_ms % 50 == 0) {
+            uint16_t limit = referee.cooling_limit_17 ? referee.cooling_limit_17 : sim.config().heat_limit_17;
+            /* Shots after the last power and heat message, and the few ms it took on the wire, are not in it yet */
+            uint32_t pending = std::count_if(shots, shots + 8, [&](uint32_t shot) { return shot + 10 >= stamp_ms && shot != 0; });
+            if (!phase->limited || referee.barrel_heat_17 + (pending + 1) * speed <= limit) {
+                sim.shoot(rules::BULLET_17MM, speed);
+                shots[shot_idx++ % 8] = virtual_ms;
+            }
+        }
+
+        /* Custom data to the operator's client */
+        if (virtual_ms - custom_ms >= phase->custom_period_ms) {
+            custom_ms = virtual_ms;
+#if REFEREE_PROTOCOL == 2019
+            uint8_t id = sim.config().robot_id;
+            referee_info.student_interactive.data_cmd_id = 0xD180;
+            referee_info.student_interactive.sender_id   = id;
+            referee_info.student_interactive.receiver_id = 0x0100 + id;
+            memcpy(referee_info.student_interactive.data, &referee.chassis_power, sizeof(float));
+            referee_packer(&referee_info, referee_process, CMD_STUDENT_INTERACTIVE);
+#else
+            referee_info.custom_data.data1 = referee.chassis_power;
+            referee_info.custom_data.data2 = referee.chassis_power_buffer;
+            referee_info.custom_data.data3 = referee.barrel_heat_17;
+            referee_packer(&referee_info, referee_process, CMD_CUSTOM_DATA);
+#endif
+        }
+    }
+};
+
+static int run_check(uint32_t phase_ms) {
+    referee_process = data_process_init(&BSP_REFEREE_PORT, NULL, REFEREE_FIFO_SIZE, REFEREE_BUFF_SIZE, REFEREE_SOF,
+                                        referee_dispatcher, &referee_info, NULL, referee_packer);
+    if (referee_process == NULL)
+        return 1;
+    host_uart_init(referee_process);
+    if (!referee_init(referee_process))
+        return 1;
+
+    simulator sim;
+    line_t down, up;
+    std::vector<uint8_t> out;
+    uint8_t buffer[512];
+    uint32_t tx_start = 0;
+
+    const phase_t phases[] = {
+        {"Unlimited", false, 50},
+        {"Limited",   true,  100},
+    };
+    for (const phase_t& phase : phases) {
+        sim.respawn();
+        stats_t before = sim.stats();
+        /* Carry on from the last phase: the link keeps its timing, and a power message may still be on the wire */
+        robot_t robot;
+        referee_snapshot_t referee;
+        robot.phase     = &phase;
+        robot.custom_ms = virtual_ms;
+        robot.stamp_ms  = referee_snapshot(&referee) ? referee.power_heat_stamp_ms : 0;
+        for (uint32_t end = virtual_ms + phase_ms; virtual_ms < end; ++virtual_ms) {
+            /* Referee */
+            out.clear();
+            sim.step(virtual_ms, out);
+            down.bytes.insert(down.bytes.end(), out.begin(), out.end());
+            size_t n = down.take(buffer, sizeof(buffer));
+            host_uart_rx(buffer, n);
+
+            /* Robot, the referee task runs on the idle line interrupt */
+            data_process_rx(referee_process);
+            robot.run(sim);
+            if (virtual_ms % 2000 == 1000)
+                sim.hit(0, rules::BULLET_17MM);
+
+            /* The frame on the robot's tx line reaches the referee once all its bytes are out */
+            uint16_t size = host_uart_tx_size();
+            if (size == 0)
+                tx_start = virtual_ms;
+            else if (virtual_ms - tx_start >= (size * 1000u + bytes_per_s - 1) / bytes_per_s) {
+                host_uart_tx_take(buffer);
+                sim.receive(buffer, size, virtual_ms);
+                tx_start = virtual_ms;
+            }
+        }
+
+        const stats_t& after = sim.stats();
+        float lost_power = after.hp_lost_power - before.hp_lost_power;
+        float lost_heat  = after.hp_lost_heat - before.hp_lost_heat;
+        uint32_t too_fast = after.uplink.too_fast - before.uplink.too_fast;
+        uint32_t frames   = after.uplink.frames - before.uplink.frames;
+        printf("%s: HP lost %.0f to power, %.0f to heat, %u custom frames, %u too fast, power seen %u times, %u stale\n",
+               phase.name, lost_power, lost_heat, frames, too_fast, robot.fresh, robot.stale);
+        CHECK(robot.fresh >= phase_ms / 20 - 1, "%s: power and heat arrived %u times", phase.name, robot.fresh);
+        CHECK(robot.stale == 0, "%s: robot saw power other than what was sent", phase.name);
+        CHECK(frames >= phase_ms / phase.custom_period_ms - 2, "%s: referee got %u custom frames", phase.name, frames);
+        if (phase.limited) {
+            CHECK(lost_power == 0 && lost_heat == 0, "%s: robot went over the power or heat limit", phase.name);
+            CHECK(too_fast == 0 && after.uplink.over_budget == before.uplink.over_budget, "%s: custom data over the limits", phase.name);
+        }
+        else {
+            CHECK(lost_power > 0 && lost_heat > 0, "%s: model did not punish power or heat over the limits", phase.name);
+            CHECK(too_fast > 0, "%s: custom data above 10 Hz went unnoticed", phase.name);
+        }
+    }
+
+    rules::for_each_message([&](auto msg) {
+        using Msg = decltype(msg);
+        if (Msg::direction & protocol::RX)
+            CHECK(data_process_stamp(referee_process, Msg::cmdid) != 0, "firmware never decoded 0x%04X", Msg::cmdid);
+    });
+    const data_process_stats_t& rx = referee_process->stats;
+    CHECK(rx.crc8_fail == 0 && rx.crc16_fail == 0 && rx.unknown == 0 && rx.bad_length == 0 && rx.lost == 0,
+          "firmware rx errors");
+    CHECK(sim.stats().uplink.unexpected == 0 && sim.stats().uplink.garbage == 0, "referee got bad frames");
+    CHECK(sim.stats().hp_lost_damage > 0, "hits did not cost HP");
+
+    sim.print_stats(stdout);
+    print_data_process_stats(referee_process);
+    printf("%s\n", failures ? "FAILED" : "All referee simulator checks passed");
+    return failures ? 1 : 0;
+}
+
+/* ===== pty and serial ===== */
+
+static volatile sig_atomic_t quit;
+
+static void on_signal(int) {
+    quit = 1;
+}
+
+static bool set_raw(int fd, bool set_speed) {
+    termios tio;
+    if (tcgetattr(fd, &tio) != 0)
+        return false;
+    cfmakeraw(&tio);
+    if (set_speed && (cfsetispeed(&tio, B115200) != 0 || cfsetospeed(&tio, B115200) != 0))
+        return false;
+    return tcsetattr(fd, TCSANOW, &tio) == 0;
+}
+
+static void command(simulator& sim, const std::string& line) {
+    char word[16] = {};
+    int a = 0, b = 0, c = 0, d = 0;
+    float speed = 0;
+    if (sscanf(line.c_str(), "%15s", word) != 1)
+        return;
+    std::string cmd = word;
+    if (cmd == "current" && sscanf(line.c_str(), "%*s %d %d %d %d", &a, &b, &c, &d) == 4) {
+        int16_t currents[4] = {static_cast<int16_t>(a), static_cast<int16_t>(b), static_cast<int16_t>(c), static_cast<int16_t>(d)};
+        sim.set_motor_currents(currents, 4);
+    }
+    else if (cmd == "shoot" && sscanf(line.c_str(), "%*s %d %f", &a, &speed) == 2)
+        sim.shoot(a == 42 ? rules::BULLET_42MM : rules::BULLET_17MM, speed);
+    else if (cmd == "hit" && sscanf(line.c_str(), "%*s %d %d", &a, &b) >= 1)
+        sim.hit(static_cast<uint8_t>(a), b == 42 ? rules::BULLET_42MM : rules::BULLET_17MM);
+    else if (cmd == "respawn")
+        sim.respawn();
+    else if (cmd == "stats")
+        sim.print_stats(stdout);
+    else if (cmd == "quit")
+        quit = 1;
+    else
+        fprintf(stderr, "Unknown command: %s", line.c_str());
+}
+
+static int serve(int fd) {
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+    simulator sim;
+    std::vector<uint8_t> out;
+    std::string line;
+    uint8_t buffer[512];
+    auto start = std::chrono::steady_clock::now();
+    bool peer = false;
+
+    while (!quit) {
+        uint32_t now = static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start).count());
+        out.clear();
+        sim.step(now, out);
+        for (size_t sent = 0; sent < out.size();) {
+            ssize_t n = write(fd, out.data() + sent, out.size() - sent);
+            if (n > 0)
+                sent += n;
+            else if (n < 0 && errno != EAGAIN && errno != EIO)
+                return perror("write"), 1;
+            else
+                break;  // Nobody has the pty open yet, or its buffer is full. The referee does not wait either
+        }
+
+        pollfd fds[2] = {{fd, POLLIN, 0}, {STDIN_FILENO, POLLIN, 0}};
+        if (poll(fds, 2, 1) < 0 && errno != EINTR)
+            return perror("poll"), 1;
+        if (fds[0].revents & POLLIN) {
+            ssize_t n = read(fd, buffer, sizeof(buffer));
+            if (n > 0) {
+                if (!peer)
+                    fprintf(stderr, "Robot connected\n");
+                peer = true;
+                sim.receive(buffer, n, now);
+            }
+        }
+        if (fds[1].revents & (POLLIN | POLLHUP)) {
+            ssize_t n = read(STDIN_FILENO, buffer, sizeof(buffer));
+            if (n <= 0)
+                fds[1].fd = -1;
+            for (ssize_t i = 0; i < n; ++i) {
+                line += static_cast<char>(buffer[i]);
+                if (buffer[i] == '\n') {
+                    command(sim, line);
+                    line.clear();
+                }
+            }
+        }
+    }
+    sim.print_stats(stdout);
+    return 0;
+}
+
+static int run_pty() {
+    int fd = posix_openpt(O_RDWR | O_NOCTTY);
+    if (fd < 0 || grantpt(fd) != 0 || unlockpt(fd) != 0)
+        return perror("posix_openpt"), 1;
+    /* Raw on the robot's side too, so that no byte of a frame is taken as a control character */
+    int slave = open(ptsname(fd), O_RDWR | O_NOCTTY);
+    if (slave < 0 || !set_raw(slave, false))
+        return perror("pty"), 1;
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    printf("Referee on %s\n", ptsname(fd));
+    fflush(stdout);
+    int status = serve(fd);
+    close(slave);
+    close(fd);
+    return status;
+}
+
+static int run_serial(const char* device) {
+    int fd = open(device, O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if (fd < 0 || !set_raw(fd, true))
+        return perror(device), 1;
+    printf("Referee on %s at %u baud\n", device, baud_rate);
+    fflush(stdout);
+    int status = serve(fd);
+    close(fd);
+    return status;
+}
+
+static int usage() {
+    fprintf(stderr, "Usage: referee_sim check [SECONDS] | pty | serial DEVICE\n");
+    return 2;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2)
+        return usage();
+    std::string mode = argv[1];
+    if (mode == "check")
+        return run_check((argc > 2 ? atoi(argv[2]) : 10) * 1000);
+    if (mode == "pty")
+        return run_pty();
+    if (mode == "serial" && argc > 2)
+        return run_serial(argv[2]);
+    return usage();
+}
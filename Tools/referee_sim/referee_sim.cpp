@@ -0,0 +1,366 @@
+// Referee model and traffic. Rules follow the referee manual where it is specific and stay simple where it is not:
+//  - chassis current is the idle draw plus a fixed share of the commanded motor current, the voltage sags with it
+//  - the power buffer drains by the power over the limit and refills below it
+//  - every 100ms, an empty buffer with power over the limit costs 10%, 20% or 40% of max HP per second, for up to
+//    10%, 20% or more over the limit
+//  - a shot adds its speed to the barrel heat. Every 100ms, heat over the limit costs (heat - limit) / 250 of max HP
+//    per second, then the barrel cools. Heat over twice the limit costs the excess at once and is cut to 2x
+
+#include "referee_sim.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace referee_sim {
+
+#if REFEREE_PROTOCOL == 2019
+constexpr uint16_t cmd_hurt         = rules::CMD_ROBOT_HURT;
+constexpr uint8_t  hurt_armor       = rules::HURT_ARMOR;
+constexpr uint8_t  hurt_over_heat   = rules::HURT_OVER_HEAT;
+constexpr uint8_t  hurt_over_power  = rules::HURT_OVER_POWER;
+#else
+constexpr uint16_t cmd_hurt         = rules::CMD_DAMAGE_DATA;
+constexpr uint8_t  hurt_armor       = rules::DAMAGE_ARMOR;
+constexpr uint8_t  hurt_over_heat   = 4;    // DAMAGE_OVERHEAT, commented out in the schema
+constexpr uint8_t  hurt_over_power  = 5;    // DAMAGE_POWER_LIMIT
+#endif
+
+constexpr uint32_t tick_period_ms = 100;
+
+// True once now has reached then, across the wrap of the tick
+static bool reached(uint32_t now, uint32_t then) {
+    return static_cast<int32_t>(now - then) >= 0;
+}
+
+static uint16_t hp_of(const state_t& state) {
+    return static_cast<uint16_t>(std::ceil(state.hp));
+}
+
+// Messages are filled from the model here, any message without an overload goes out with default fields
+
+template <typename Msg>
+static void fill(const simulator&, Msg&) {}
+
+#if REFEREE_PROTOCOL == 2019
+
+static void fill(const simulator& sim, rules::game_state_t& msg) {
+    msg.game_type         = rules::GAME_TYPE_RMUC;
+    msg.game_progress     = sim.state().game_progress;
+    msg.stage_remain_time = static_cast<uint16_t>(sim.state().remain_ms / 1000);
+}
+
+static void fill(const simulator& sim, rules::game_result_t& msg) {
+    msg.winner = sim.state().result;
+}
+
+static void fill(const simulator& sim, rules::game_robot_survivors_t& msg) {
+    uint8_t id = sim.config().robot_id;
+    uint16_t self = static_cast<uint16_t>(1u << (id < 10 ? id - 1 : id - 11 + 8));
+    msg.robot_legion = sim.state().hp > 0 ? 0x7f7f : 0x7f7f & ~self;
+}
+
+static void fill(const simulator& sim, rules::game_robot_state_t& msg) {
+    const config_t& config = sim.config();
+    msg.robot_id                    = config.robot_id;
+    msg.robot_level                 = config.robot_level;
+    msg.remain_hp                   = hp_of(sim.state());
+    msg.max_hp                      = config.max_hp;
+    msg.shooter_heat0_cooling_rate  = config.cooling_rate_17;
+    msg.shooter_heat0_cooling_limit = config.heat_limit_17;
+    msg.shooter_heat1_cooling_rate  = config.cooling_rate_42;
+    msg.shooter_heat1_cooling_limit = config.heat_limit_42;
+    msg.mains_power_gimbal_output   = sim.state().hp > 0;
+    msg.mains_power_chassis_output  = sim.state().hp > 0;
+    msg.mains_power_shooter_output  = sim.state().hp > 0;
+}
+
+static void fill(const simulator& sim, rules::power_heat_data_t& msg) {
+    const state_t& state = sim.state();
+    msg.chassis_volt         = static_cast<uint16_t>(state.chassis_volt * 1000);
+    msg.chassis_current      = static_cast<uint16_t>(state.chassis_current * 1000);
+    msg.chassis_power        = state.chassis_power;
+    msg.chassis_power_buffer = static_cast<uint16_t>(state.power_buffer);
+    msg.shooter_heat0        = static_cast<uint16_t>(state.heat_17);
+    msg.shooter_heat1        = static_cast<uint16_t>(state.heat_42);
+}
+
+static void fill(const simulator& sim, rules::robot_hurt_t& msg) {
+    msg.armor_id  = sim.state().hurt_armor;
+    msg.hurt_type = sim.state().hurt_type;
+}
+
+static void fill(const simulator& sim, rules::shoot_data_t& msg) {
+    msg.bullet_type  = sim.state().bullet_type;
+    msg.bullet_freq  = sim.state().bullet_freq;
+    msg.bullet_speed = sim.state().bullet_speed;
+}
+
+// Relayed from a teammate
+static void fill(const simulator& sim, rules::student_interactive_t& msg) {
+    uint8_t id = sim.config().robot_id;
+    msg.data_cmd_id = 0x0200;
+    msg.sender_id   = id % 10 == 3 ? id + 1 : id - 1;
+    msg.receiver_id = id;
+}
+
+#else
+
+static void fill(const simulator& sim, rules::game_robot_info_t& msg) {
+    msg.stage_remain_time = static_cast<uint16_t>(sim.state().remain_ms / 1000);
+    msg.game_process      = sim.state().game_progress;
+    msg.robot_grade       = sim.config().robot_level;
+    msg.remain_hp         = hp_of(sim.state());
+    msg.max_hp            = sim.config().max_hp;
+}
+
+static void fill(const simulator& sim, rules::damage_data_t& msg) {
+    msg.armor_damage = sim.state().hurt_armor;
+    msg.damage_type  = sim.state().hurt_type;
+}
+
+static void fill(const simulator& sim, rules::shoot_data_t& msg) {
+    msg.bullet_type = sim.state().bullet_type;
+    msg.bullet_freq = sim.state().bullet_freq;
+    msg.bullet_spd  = sim.state().bullet_speed;
+}
+
+static void fill(const simulator& sim, rules::power_heat_data_t& msg) {
+    const state_t& state = sim.state();
+    msg.chassis_volt    = state.chassis_volt;
+    msg.chassis_current = state.chassis_current;
+    msg.chassis_power   = state.chassis_power;
+    msg.chassis_pwr_buf = state.power_buffer;
+    msg.barrel_heat_17  = static_cast<uint16_t>(state.heat_17);
+    msg.barrel_heat_42  = static_cast<uint16_t>(state.heat_42);
+}
+
+static void fill(const simulator& sim, rules::game_result_t& msg) {
+    msg.result = sim.state().result;
+}
+
+#endif
+
+simulator::simulator(const config_t& config) : config_(config) {
+    respawn();
+    state_.game_progress = rules::GAME_IN_GAME;
+    state_.remain_ms     = config_.match_s * 1000;
+}
+
+void simulator::set_motor_currents(const int16_t* command, size_t count) {
+    motor_amps_ = 0;
+    for (size_t i = 0; i < count; ++i)
+        motor_amps_ += std::fabs(command[i] * config_.amps_per_command);
+}
+
+void simulator::shoot(uint8_t bullet_type, float speed) {
+    if (state_.hp <= 0)
+        return;
+    bool big = bullet_type == rules::BULLET_42MM;
+    float& heat = big ? state_.heat_42 : state_.heat_17;
+    uint16_t limit = big ? config_.heat_limit_42 : config_.heat_limit_17;
+    heat += speed;
+    if (heat > 2 * limit) {
+        hurt(hurt_over_heat, 0, config_.max_hp * (heat - 2 * limit) / 250, stats_.hp_lost_heat);
+        heat = 2 * limit;
+    }
+    uint32_t interval = now_ms_ - shot_ms_;
+    state_.bullet_type  = bullet_type;
+    state_.bullet_freq  = static_cast<uint8_t>(std::min<uint32_t>(255, interval ? 1000 / interval : 255));
+    state_.bullet_speed = speed;
+    shot_ms_ = now_ms_;
+    events_.push_back(rules::CMD_SHOOT_DATA);
+}
+
+void simulator::hit(uint8_t armor_id, uint8_t bullet_type) {
+    hurt(hurt_armor, armor_id, bullet_type == rules::BULLET_42MM ? config_.damage_42 : config_.damage_17, stats_.hp_lost_damage);
+}
+
+void simulator::respawn() {
+    state_.hp           = config_.max_hp;
+    state_.power_buffer = config_.buffer_max;
+    state_.heat_17      = 0;
+    state_.heat_42      = 0;
+}
+
+void simulator::hurt(uint8_t type, uint8_t armor, float hp, float& lost) {
+    if (state_.hp <= 0)
+        return;
+    hp = std::min(hp, state_.hp);
+    state_.hp        -= hp;
+    lost             += hp;
+    state_.hurt_type  = type;
+    state_.hurt_armor = armor;
+    events_.push_back(cmd_hurt);
+}
+
+void simulator::model() {
+    const float dt = 0.001f;
+    /* The referee cuts chassis power when the robot is destroyed */
+    float current = state_.hp > 0 ? config_.idle_current + config_.bus_per_motor * motor_amps_ : 0;
+    state_.chassis_current = current;
+    state_.chassis_volt    = config_.battery_volt - config_.battery_ohm * current;
+    state_.chassis_power   = state_.chassis_volt * current;
+    state_.power_buffer    = std::clamp(state_.power_buffer + (config_.power_limit - state_.chassis_power) * dt, 0.0f, config_.buffer_max);
+    if (reached(now_ms_, tick_ms_ + tick_period_ms)) {
+        tick_ms_ += tick_period_ms;
+        referee_tick();
+    }
+}
+
+void simulator::referee_tick() {
+    if (state_.power_buffer <= 0 && state_.chassis_power > config_.power_limit) {
+        float over = (state_.chassis_power - config_.power_limit) / config_.power_limit;
+        float per_s = over <= 0.1f ? 0.1f : over <= 0.2f ? 0.2f : 0.4f;
+        stats_.over_power_ticks++;
+        hurt(hurt_over_power, 0, config_.max_hp * per_s * tick_period_ms / 1000, stats_.hp_lost_power);
+    }
+    barrel_tick(state_.heat_17, config_.heat_limit_17, config_.cooling_rate_17);
+    barrel_tick(state_.heat_42, config_.heat_limit_42, config_.cooling_rate_42);
+
+    if (state_.game_progress == rules::GAME_IN_GAME) {
+        state_.remain_ms -= std::min(state_.remain_ms, tick_period_ms);
+        if (state_.remain_ms == 0) {
+            state_.game_progress = rules::GAME_RESULT;
+            state_.result        = rules::RESULT_DRAW;
+            events_.push_back(rules::CMD_GAME_RESULT);
+        }
+    }
+}
+
+void simulator::barrel_tick(float& heat, uint16_t limit, uint16_t cooling_rate) {
+    if (heat > limit) {
+        stats_.over_heat_ticks++;
+        hurt(hurt_over_heat, 0, config_.max_hp * (heat - limit) / 250 * tick_period_ms / 1000, stats_.hp_lost_heat);
+    }
+    heat = std::max(0.0f, heat - cooling_rate * tick_period_ms / 1000.0f);
+}
+
+template <typename Msg>
+void simulator::send(std::vector<uint8_t>& out) {
+    Msg msg;
+    fill(*this, msg);
+    size_t start = out.size();
+    protocol::encode_frame(rules::sof, seq_++, msg, out);
+    stats_.sent[Msg::cmdid]++;
+    stats_.bytes_sent += out.size() - start;
+    if constexpr (Msg::cmdid == rules::CMD_POWER_HEAT_DATA)
+        sent_power_ = state_.chassis_power;
+}
+
+void simulator::step(uint32_t now_ms, std::vector<uint8_t>& out) {
+    if (!started_) {
+        /* Every message goes out once at the start, so that event messages are seen without an event */
+        started_ = true;
+        start_ms_ = now_ms_ = tick_ms_ = shot_ms_ = now_ms;
+        rules::for_each_message([&](auto msg) {
+            using Msg = decltype(msg);
+            if (Msg::direction & protocol::RX) {
+                events_.push_back(Msg::cmdid);
+                next_ms_[Msg::cmdid] = now_ms;
+            }
+        });
+    }
+    while (!reached(now_ms_, now_ms)) {
+        now_ms_++;
+        model();
+    }
+
+    rules::for_each_message([&](auto msg) {
+        using Msg = decltype(msg);
+        if (!(Msg::direction & protocol::RX))
+            return;
+        bool due = false;
+        auto event = std::find(events_.begin(), events_.end(), Msg::cmdid);
+        if (event != events_.end()) {
+            events_.erase(event);
+            due = true;
+        }
+        if (Msg::rate_hz != 0 && reached(now_ms_, next_ms_[Msg::cmdid])) {
+            uint32_t& next = next_ms_[Msg::cmdid];
+            next += 1000 / Msg::rate_hz;
+            /* After a stall, carry on at the rate instead of catching up in a burst */
+            if (reached(now_ms_, next))
+                next = now_ms_ + 1000 / Msg::rate_hz;
+            due = true;
+        }
+        if (due)
+            send<Msg>(out);
+    });
+}
+
+void simulator::receive(const uint8_t* data, size_t length, uint32_t now_ms) {
+    rx_.insert(rx_.end(), data, data + length);
+    size_t offset = 0;
+    while (offset < rx_.size()) {
+        protocol::frame_t frame;
+        bool found;
+        size_t used = protocol::parse_frame(rules::sof, rx_.data() + offset, rx_.size() - offset, frame, found);
+        offset += used;
+        if (!found) {
+            stats_.uplink.garbage += used;
+            break;
+        }
+        stats_.uplink.garbage += used - (protocol::overhead + frame.length);
+        uplink_frame(frame, now_ms);
+    }
+    rx_.erase(rx_.begin(), rx_.begin() + offset);
+}
+
+void simulator::uplink_frame(const protocol::frame_t& frame, uint32_t now_ms) {
+    uplink_t& uplink = stats_.uplink;
+    uint16_t rate_hz = 0;
+    bool known = false;
+    rules::for_each_message([&](auto msg) {
+        using Msg = decltype(msg);
+        if (Msg::cmdid == frame.cmdid && (Msg::direction & protocol::TX) && Msg::size == frame.length) {
+            known = true;
+            rate_hz = Msg::rate_hz;
+        }
+    });
+    if (!known) {
+        uplink.unexpected++;
+        return;
+    }
+    uint32_t size = protocol::overhead + frame.length;
+    uplink.frames++;
+    uplink.bytes += size;
+
+    auto last = rx_ms_.find(frame.cmdid);
+    if (last != rx_ms_.end()) {
+        uint32_t interval = now_ms - last->second;
+        if (uplink.min_interval_ms == 0 || interval < uplink.min_interval_ms)
+            uplink.min_interval_ms = interval;
+        if (rate_hz != 0 && interval + config_.rate_slack_ms < 1000u / rate_hz)
+            uplink.too_fast++;
+    }
+    rx_ms_[frame.cmdid] = now_ms;
+
+    window_.emplace_back(now_ms, size);
+    window_bytes_ += size;
+    while (reached(now_ms, window_.front().first + 1000)) {
+        window_bytes_ -= window_.front().second;
+        window_.pop_front();
+    }
+    if (config_.uplink_bytes_per_s != 0 && window_bytes_ > config_.uplink_bytes_per_s)
+        uplink.over_budget++;
+}
+
+void simulator::print_stats(FILE* file) const {
+    uint32_t elapsed_ms = now_ms_ - start_ms_;
+    uint32_t frames = 0;
+    for (const auto& sent : stats_.sent)
+        frames += sent.second;
+    fprintf(file, "Sent %u frames, %u bytes in %.1f s, %.0f%% of the link\n", frames, stats_.bytes_sent, elapsed_ms / 1000.0,
+            elapsed_ms ? 100.0 * stats_.bytes_sent / (bytes_per_s * (elapsed_ms / 1000.0)) : 0.0);
+    for (const auto& sent : stats_.sent)
+        fprintf(file, "  0x%04X  %u\n", sent.first, sent.second);
+    fprintf(file, "HP %u of %u, lost %.0f to hits, %.0f to power (%u ticks over), %.0f to heat (%u ticks over)\n",
+            hp_of(state_), config_.max_hp, stats_.hp_lost_damage, stats_.hp_lost_power, stats_.over_power_ticks,
+            stats_.hp_lost_heat, stats_.over_heat_ticks);
+    const uplink_t& uplink = stats_.uplink;
+    fprintf(file, "Received %u frames, %u bytes, min interval %u ms, %u too fast, %u over budget, %u unexpected, %u garbage bytes\n",
+            uplink.frames, uplink.bytes, uplink.min_interval_ms, uplink.too_fast, uplink.over_budget, uplink.unexpected,
+            uplink.garbage);
+}
+
+}  // namespace referee_sim
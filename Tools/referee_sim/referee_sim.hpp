@@ -0,0 +1,153 @@
+// Referee system simulator. Plays the referee's end of the link for host and bench tests: it sends every message the
+// robot receives at the rate from its schema, filled from a model of chassis power, barrel heat and HP, and checks the
+// custom data the robot sends back against the referee's limits. Time is passed in by the caller, so the same model
+// runs in-process against the firmware in virtual time and on a serial port in real time.
+//
+// REFEREE_PROTOCOL selects the rule set, as in the firmware.
+
+#pragma once
+
+#include <cstdio>
+#include <deque>
+#include <map>
+#include <vector>
+
+#if REFEREE_PROTOCOL == 2019
+#include "referee_2019_codec.hpp"
+#else
+#include "referee_2018_codec.hpp"
+#endif
+
+namespace referee_sim {
+
+#if REFEREE_PROTOCOL == 2019
+namespace rules = referee_2019;
+#else
+namespace rules = referee_2018;
+#endif
+
+constexpr uint32_t baud_rate    = 115200;           // Referee UART, 8N1
+constexpr uint32_t bytes_per_s  = baud_rate / 10;
+
+// Defaults are a level 1 infantry
+struct config_t {
+    uint8_t  robot_id           = 3;                // Red infantry
+    uint8_t  robot_level        = 1;
+    uint16_t max_hp             = 200;
+    uint32_t match_s            = 420;              // Length of the combat stage
+
+    float    power_limit        = 80;               // Chassis power limit (watt)
+    float    buffer_max         = 60;               // Chassis power buffer (joule)
+    float    battery_volt       = 24;               // Open circuit battery voltage
+    float    battery_ohm        = 0.1f;             // Internal resistance, the voltage sags under load
+    float    idle_current       = 0.5f;             // Chassis current with the motors off (ampere)
+    float    amps_per_command   = 20.0f / 16384;    // C620 current command to motor ampere
+    float    bus_per_motor      = 0.25f;            // Battery ampere per motor ampere, motors at moderate speed
+
+    uint16_t heat_limit_17      = 240;
+    uint16_t cooling_rate_17    = 40;               // Heat removed per second
+    uint16_t heat_limit_42      = 200;
+    uint16_t cooling_rate_42    = 20;
+    uint16_t damage_17          = 10;               // HP lost per armor hit
+    uint16_t damage_42          = 100;
+
+    uint32_t uplink_bytes_per_s = REFEREE_PROTOCOL == 2019 ? 3720 : 0;    // Custom data budget, 0 for none
+    uint32_t rate_slack_ms      = 2;                // How early a frame may come against its schema rate
+};
+
+// What the referee knows about the robot
+struct state_t {
+    uint8_t  game_progress;
+    uint32_t remain_ms;         // Of the current stage
+    float    hp;
+    float    chassis_volt;
+    float    chassis_current;
+    float    chassis_power;
+    float    power_buffer;
+    float    heat_17;
+    float    heat_42;
+    uint8_t  bullet_type;       // Last shot
+    uint8_t  bullet_freq;
+    float    bullet_speed;
+    uint8_t  hurt_armor;        // Last hurt event, in the rule set's codes
+    uint8_t  hurt_type;
+    uint8_t  result;
+};
+
+// Frames the robot sent. Each cmdid is checked against its schema rate, and all of them against the byte budget
+struct uplink_t {
+    uint32_t frames;
+    uint32_t bytes;
+    uint32_t garbage;           // Bytes outside good frames
+    uint32_t unexpected;        // Frames the robot may not send, or with the wrong size
+    uint32_t too_fast;
+    uint32_t over_budget;
+    uint32_t min_interval_ms;   // Between two frames of one cmdid
+};
+
+struct stats_t {
+    std::map<uint16_t, uint32_t> sent;  // Frames per cmdid
+    uint32_t bytes_sent;
+    uint32_t over_power_ticks;          // 100ms ticks with an empty buffer and power over the limit
+    uint32_t over_heat_ticks;           // 100ms ticks with a barrel over its limit
+    float    hp_lost_damage;
+    float    hp_lost_power;
+    float    hp_lost_heat;
+    uplink_t uplink;
+};
+
+class simulator {
+public:
+    explicit simulator(const config_t& config = config_t());
+
+    // Chassis motor current commands, in C620 units
+    void set_motor_currents(const int16_t* command, size_t count);
+    // A projectile leaves the barrel, bullet_type is rules::BULLET_17MM or rules::BULLET_42MM
+    void shoot(uint8_t bullet_type, float speed);
+    // A projectile hits an armor
+    void hit(uint8_t armor_id, uint8_t bullet_type);
+    // Full HP, buffer and cold barrels, the link carries on
+    void respawn();
+
+    // Advance the model to now_ms and append the frames that are due
+    void step(uint32_t now_ms, std::vector<uint8_t>& out);
+    // Bytes from the robot that arrived by now_ms
+    void receive(const uint8_t* data, size_t length, uint32_t now_ms);
+
+    const config_t& config() const { return config_; }
+    const state_t&  state() const { return state_; }
+    const stats_t&  stats() const { return stats_; }
+    // Chassis power in the last power and heat message
+    float sent_power() const { return sent_power_; }
+    void print_stats(FILE* file) const;
+
+private:
+    void model();
+    void referee_tick();
+    void barrel_tick(float& heat, uint16_t limit, uint16_t cooling_rate);
+    void hurt(uint8_t type, uint8_t armor, float hp, float& lost);
+    void uplink_frame(const protocol::frame_t& frame, uint32_t now_ms);
+    template <typename Msg>
+    void send(std::vector<uint8_t>& out);
+
+    config_t config_;
+    state_t  state_  = {};
+    stats_t  stats_  = {};
+    float    motor_amps_ = 0;
+    float    sent_power_ = 0;
+    bool     started_    = false;
+    uint32_t start_ms_   = 0;
+    uint32_t now_ms_     = 0;
+    uint32_t tick_ms_    = 0;
+    uint32_t shot_ms_    = 0;
+    uint8_t  seq_        = 0;
+
+    std::map<uint16_t, uint32_t> next_ms_;          // Next periodic send per cmdid
+    std::vector<uint16_t>        events_;           // Event messages to send on the next step
+    std::vector<uint8_t>         rx_;               // Robot bytes not parsed yet
+    std::map<uint16_t, uint32_t> rx_ms_;            // Last arrival per cmdid
+    std::deque<std::pair<uint32_t, uint32_t>> window_;  // Arrival and size of uplink frames in the last second
+    uint32_t window_bytes_ = 0;
+};
+
+}  // namespace referee_sim
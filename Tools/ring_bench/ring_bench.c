@@ -0,0 +1,175 @@
+/**************************************************************************
+ *  Copyright (C) 2018 
+ *  Illini RoboMaster @ University of Illinois at Urbana-Champaign.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *************************************************************************/
+
+/*
+ * Host benchmark and stress test of spsc_ring_t against the mutex based fifo_s_t.
+ *
+ *   ring_bench [megabytes]
+ *
+ * The benchmark moves data through each queue from one thread in chunks of
+ * several sizes. The stress test runs a producer and a consumer thread with
+ * random chunk sizes over a sequence pattern and checks every byte arrives
+ * once and in order, including across index wrap.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include "data_fifo.h"
+#include "spsc_ring.h"
+
+#define BENCH_CAPACITY  1024    // above 256 on purpose, the old uint8_t indices broke here
+
+typedef struct {
+    const char  *name;
+    void        *queue;
+    uint32_t    (*put)(void *queue, const uint8_t *src, uint32_t len);
+    uint32_t    (*get)(void *queue, uint8_t *dst, uint32_t len);
+} bench_queue_t;
+
+typedef struct {
+    const bench_queue_t *queue;
+    uint64_t            bytes;
+    uint64_t            errors;
+    uint32_t            seed;
+} bench_stress_t;
+
+static uint32_t fifo_put(void *queue, const uint8_t *src, uint32_t len) {
+    int32_t put = fifo_s_puts(queue, (uint8_t*)src, len);
+    return put < 0 ? 0 : put;
+}
+
+static uint32_t fifo_get(void *queue, uint8_t *dst, uint32_t len) {
+    return fifo_s_gets(queue, dst, len);
+}
+
+static uint32_t ring_put(void *queue, const uint8_t *src, uint32_t len) {
+    return spsc_ring_put(queue, src, len);
+}
+
+static uint32_t ring_get(void *queue, uint8_t *dst, uint32_t len) {
+    return spsc_ring_get(queue, dst, len);
+}
+
+static uint64_t bench_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+static uint32_t bench_rand(uint32_t *state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state;
+}
+
+static double bench_throughput(const bench_queue_t *queue, uint32_t chunk, uint64_t total) {
+    uint8_t src[BENCH_CAPACITY], dst[BENCH_CAPACITY];
+    memset(src, 0x5A, sizeof(src));
+    uint64_t start = bench_now_ns();
+    for (uint64_t moved = 0; moved < total; moved += chunk) {
+        queue->put(queue->queue, src, chunk);
+        queue->get(queue->queue, dst, chunk);
+    }
+    return (double)(bench_now_ns() - start) / total;
+}
+
+static void *bench_producer(void *arg) {
+    bench_stress_t *stress = arg;
+    uint8_t chunk[BENCH_CAPACITY];
+    uint64_t sent = 0;
+    while (sent < stress->bytes) {
+        uint32_t len = bench_rand(&stress->seed) % (BENCH_CAPACITY / 2) + 1;
+        if (len > stress->bytes - sent)
+            len = stress->bytes - sent;
+        for (uint32_t i = 0; i < len; ++i)
+            chunk[i] = (uint8_t)((sent + i) * 7);
+        uint32_t done = 0;
+        while (done < len) {
+            uint32_t put = stress->queue->put(stress->queue->queue, chunk + done, len - done);
+            if (put == 0)
+                sched_yield();
+            done += put;
+        }
+        sent += len;
+    }
+    return NULL;
+}
+
+static void *bench_consumer(void *arg) {
+    bench_stress_t *stress = arg;
+    uint8_t chunk[BENCH_CAPACITY];
+    uint32_t seed = stress->seed * 31 + 7;
+    uint64_t got = 0;
+    while (got < stress->bytes) {
+        uint32_t len = stress->queue->get(stress->queue->queue, chunk, bench_rand(&seed) % (BENCH_CAPACITY / 2) + 1);
+        if (len == 0)
+            sched_yield();
+        for (uint32_t i = 0; i < len; ++i)
+            if (chunk[i] != (uint8_t)((got + i) * 7))
+                stress->errors++;
+        got += len;
+    }
+    return NULL;
+}
+
+static uint8_t bench_stress(const bench_queue_t *queue, uint64_t total) {
+    bench_stress_t stress = {queue, total, 0, 12345};
+    pthread_t producer, consumer;
+    uint64_t start = bench_now_ns();
+    pthread_create(&consumer, NULL, bench_consumer, &stress);
+    pthread_create(&producer, NULL, bench_producer, &stress);
+    pthread_join(producer, NULL);
+    pthread_join(consumer, NULL);
+    double ns = (double)(bench_now_ns() - start);
+    printf("%-8s stress %8.1f MB/s  %llu bad bytes%s\n", queue->name, total * 1e3 / ns,
+           (unsigned long long)stress.errors, stress.errors ? "  FAIL" : "");
+    return stress.errors == 0;
+}
+
+int main(int argc, char **argv) {
+    uint64_t total = (argc > 1 ? strtoull(argv[1], NULL, 10) : 64) << 20;
+    static uint8_t fifo_storage[BENCH_CAPACITY], ring_storage[BENCH_CAPACITY];
+    static fifo_s_t fifo;
+    static spsc_ring_t ring;
+    fifo_s_init(&fifo, fifo_storage, BENCH_CAPACITY, host_mutex_create());
+    spsc_ring_init(&ring, ring_storage, BENCH_CAPACITY);
+    const bench_queue_t queues[] = {
+        {"fifo_s", &fifo, fifo_put, fifo_get},
+        {"spsc",   &ring, ring_put, ring_get},
+    };
+    const uint32_t chunks[] = {1, 8, 64, 256};
+
+    printf("%-8s %10s", "queue", "ns/byte:");
+    for (size_t c = 0; c < sizeof(chunks) / sizeof(chunks[0]); ++c)
+        printf(" %7u B", chunks[c]);
+    printf("\n");
+    for (size_t q = 0; q < sizeof(queues) / sizeof(queues[0]); ++q) {
+        printf("%-8s %10s", queues[q].name, "");
+        for (size_t c = 0; c < sizeof(chunks) / sizeof(chunks[0]); ++c)
+            printf(" %9.2f", bench_throughput(&queues[q], chunks[c], chunks[c] == 1 ? total / 8 : total));
+        printf("\n");
+    }
+    uint8_t pass = 1;
+    for (size_t q = 0; q < sizeof(queues) / sizeof(queues[0]); ++q)
+        pass &= bench_stress(&queues[q], total);
+    return pass ? 0 : 1;
+}